@@ -113,6 +113,7 @@ renderer/gfx/GFXUtils.cpp
 ifeq ($(USE_GFX_RENDERER),1)
 LOCAL_SRC_FILES += \
 renderer/Types.cpp \
+renderer/gfx/CommandBuffer.cpp \
 renderer/gfx/DeviceGraphics.cpp \
 renderer/gfx/FrameBuffer.cpp \
 renderer/gfx/GFX.cpp \
@@ -124,6 +125,7 @@ renderer/gfx/RenderTarget.cpp \
 renderer/gfx/State.cpp \
 renderer/gfx/Texture.cpp \
 renderer/gfx/Texture2D.cpp \
+renderer/gfx/TextureUploader.cpp \
 renderer/gfx/VertexBuffer.cpp \
 renderer/gfx/VertexFormat.cpp \
 renderer/renderer/BaseRenderer.cpp \
@@ -135,6 +137,7 @@ renderer/renderer/Light.cpp \
 renderer/renderer/Model.cpp \
 renderer/renderer/Pass.cpp \
 renderer/renderer/ProgramLib.cpp \
+renderer/renderer/PropertyBlock.cpp \
 renderer/renderer/Scene.cpp \
 renderer/renderer/Technique.cpp \
 renderer/renderer/View.cpp \
@@ -153,6 +156,9 @@ renderer/scene/assembler/SimpleSprite3D.cpp \
 renderer/scene/assembler/SlicedSprite3D.cpp \
 renderer/scene/assembler/MeshAssembler.cpp \
 renderer/scene/MeshBuffer.cpp \
+renderer/scene/InstanceBuffer.cpp \
+renderer/scene/MatrixPalette.cpp \
+renderer/scene/DynamicAtlas.cpp \
 renderer/scene/ModelBatcher.cpp \
 renderer/scene/NodeProxy.cpp \
 renderer/scene/RenderFlow.cpp \
@@ -198,6 +204,11 @@ LOCAL_STATIC_LIBRARIES += cocos_ssl_static
 LOCAL_STATIC_LIBRARIES += cocos_crypto_static
 endif # USE_SOCKET
 
+ifeq ($(USE_NULL_GL),1)
+LOCAL_SRC_FILES += \
+platform/null/CCGL-null.cpp
+endif # USE_NULL_GL
+
 ifneq ($(USE_MIDDLEWARE),0)
 LOCAL_STATIC_LIBRARIES += editor_support_static
 endif # USE_MIDDLEWARE
@@ -249,6 +260,11 @@ LOCAL_CPPFLAGS := -Wno-deprecated-declarations
 LOCAL_EXPORT_CFLAGS   := -DUSE_FILE32API
 LOCAL_EXPORT_CPPFLAGS := -Wno-deprecated-declarations
 
+ifeq ($(USE_NULL_GL),1)
+LOCAL_CFLAGS += -DUSE_NULL_GL=1
+LOCAL_EXPORT_CFLAGS += -DUSE_NULL_GL=1
+endif # USE_NULL_GL
+
 include $(BUILD_STATIC_LIBRARY)
 
 
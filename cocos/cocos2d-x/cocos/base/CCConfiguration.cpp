@@ -54,6 +54,10 @@ Configuration::Configuration()
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
 , _supportsOESMapBuffer(false)
+, _supportsMapBufferRange(false)
+, _supportsProgramBinary(false)
+, _supportsInstancedArrays(false)
+, _supportsPixelBufferObject(false)
 , _supportsFloatTexture(false)
 , _isOpenglES3(false)
 , _maxSamplesAllowed(0)
@@ -163,6 +167,19 @@ void Configuration::gatherGPUInfo()
     _supportsOESMapBuffer = checkForGLExtension("GL_OES_mapbuffer");
     _valueDict["gl.supports_OES_map_buffer"] = Value(_supportsOESMapBuffer);
 
+    // ES3 contexts expose it as a core entry point.
+    _supportsMapBufferRange = _isOpenglES3 || (version && strncmp(version, "OpenGL ES 3", 11) == 0) || checkForGLExtension("GL_EXT_map_buffer_range");
+    _valueDict["gl.supports_map_buffer_range"] = Value(_supportsMapBufferRange);
+
+    _supportsProgramBinary = _isOpenglES3 || (version && strncmp(version, "OpenGL ES 3", 11) == 0) || checkForGLExtension("GL_OES_get_program_binary");
+    _valueDict["gl.supports_program_binary"] = Value(_supportsProgramBinary);
+
+    _supportsInstancedArrays = _isOpenglES3 || (version && strncmp(version, "OpenGL ES 3", 11) == 0) || checkForGLExtension("GL_EXT_instanced_arrays");
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
+    _supportsPixelBufferObject = _isOpenglES3 || (version && strncmp(version, "OpenGL ES 3", 11) == 0);
+    _valueDict["gl.supports_pixel_buffer_object"] = Value(_supportsPixelBufferObject);
+
     _supportsOESDepth24 = checkForGLExtension("GL_OES_depth24");
     _valueDict["gl.supports_OES_depth24"] = Value(_supportsOESDepth24);
 
@@ -305,6 +322,26 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsMapBufferRange() const
+{
+    return _supportsMapBufferRange;
+}
+
+bool Configuration::supportsProgramBinary() const
+{
+    return _supportsProgramBinary;
+}
+
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
+bool Configuration::supportsPixelBufferObject() const
+{
+    return _supportsPixelBufferObject;
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
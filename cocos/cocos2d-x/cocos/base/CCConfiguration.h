@@ -174,6 +174,38 @@ public:
      * @since v3.13
      */
     bool supportsMapBuffer() const;
+
+    /** Whether or not glMapBufferRange() is supported.
+     *
+     * It returns `true` on OpenGL ES 3 or if the extension `GL_EXT_map_buffer_range` is available.
+     *
+     * @return Whether or not `glMapBufferRange()` is supported.
+     */
+    bool supportsMapBufferRange() const;
+
+    /** Whether or not linked programs can be retrieved and reloaded with glGetProgramBinary() and glProgramBinary().
+     *
+     * It returns `true` on OpenGL ES 3 or if the extension `GL_OES_get_program_binary` is available.
+     *
+     * @return Whether or not program binaries are supported.
+     */
+    bool supportsProgramBinary() const;
+
+    /** Whether or not glDrawElementsInstanced() and glVertexAttribDivisor() are supported.
+     *
+     * It returns `true` on OpenGL ES 3 or if the extension `GL_EXT_instanced_arrays` is available.
+     *
+     * @return Whether or not instanced arrays are supported.
+     */
+    bool supportsInstancedArrays() const;
+
+    /** Whether or not pixel buffer objects can be bound to GL_PIXEL_UNPACK_BUFFER.
+     *
+     * It returns `true` on OpenGL ES 3.
+     *
+     * @return Whether or not pixel buffer objects are supported.
+     */
+    bool supportsPixelBufferObject() const;
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -264,6 +296,10 @@ protected:
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
     bool            _supportsOESMapBuffer;
+    bool            _supportsMapBufferRange;
+    bool            _supportsProgramBinary;
+    bool            _supportsInstancedArrays;
+    bool            _supportsPixelBufferObject;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
     bool            _supportsFloatTexture;
@@ -189,10 +189,13 @@ void ccBindVertexArray(GLuint VAO)
     if (__currentVertexArray != VAO)
     {
         __currentVertexArray = VAO;
+        // The element array binding is part of the vertex array state.
+        __currentIndexBuffer = -1;
         glBindVertexArray(VAO);
     }
 #else
     __currentVertexArray = VAO;
+    __currentIndexBuffer = -1;
     glBindVertexArray(VAO);
 #endif
 }
@@ -61,6 +61,15 @@ THE SOFTWARE.
 #define USE_MIDDLEWARE 1
 #endif
 
+/** @def USE_NULL_GL
+ * If enabled, the GL calls of the renderer are routed to a null backend which only counts them.
+ * It is used to measure the CPU cost of rendering without a GPU driver.
+ * Default value: 0
+ */
+#ifndef USE_NULL_GL
+#define USE_NULL_GL 0
+#endif
+
 #if USE_GFX_RENDERER > 0 && USE_MIDDLEWARE > 0
 
 #ifndef USE_SPINE
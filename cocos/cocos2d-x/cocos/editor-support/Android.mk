@@ -15,6 +15,10 @@ middleware-adapter.cpp \
 TypedArrayPool.cpp \
 IOTypedArray.cpp \
 MiddlewareManager.cpp \
+PackedMesh.cpp \
+FrameCacheBudget.cpp \
+FrameCacheFile.cpp \
+UpdateLOD.cpp \
 ../scripting/js-bindings/auto/jsb_cocos2dx_editor_support_auto.cpp
 
 ifeq ($(USE_PARTICLE),1)
@@ -95,6 +99,7 @@ spine-creator-support/VertexEffectDelegate.cpp \
 spine-creator-support/SkeletonCacheMgr.cpp \
 spine-creator-support/SkeletonCache.cpp \
 spine-creator-support/SkeletonCacheAnimation.cpp \
+spine-creator-support/SpineAllocator.cpp \
 ../scripting/js-bindings/manual/jsb_spine_manual.cpp \
 ../scripting/js-bindings/auto/jsb_cocos2dx_spine_auto.cpp
 endif # USE_SPINE
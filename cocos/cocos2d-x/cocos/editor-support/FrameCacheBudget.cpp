@@ -0,0 +1,88 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "FrameCacheBudget.h"
+#include <algorithm>
+
+MIDDLEWARE_BEGIN
+
+FrameCacheBudget* FrameCacheBudget::_instance = nullptr;
+
+void FrameCacheBudget::setBudget (std::size_t bytes)
+{
+    _budget = bytes;
+    trim(nullptr);
+}
+
+void FrameCacheBudget::addAnimation (ICachedAnimation* animation)
+{
+    _animations.push_back(animation);
+    _usedBytes += animation->_cachedBytes;
+}
+
+void FrameCacheBudget::removeAnimation (ICachedAnimation* animation)
+{
+    auto it = std::find(_animations.begin(), _animations.end(), animation);
+    if (it != _animations.end())
+    {
+        _usedBytes -= animation->_cachedBytes;
+        _animations.erase(it);
+    }
+}
+
+void FrameCacheBudget::resize (ICachedAnimation* animation, std::ptrdiff_t bytes)
+{
+    animation->_cachedBytes += bytes;
+    _usedBytes += bytes;
+    if (bytes > 0)
+    {
+        trim(animation);
+    }
+}
+
+void FrameCacheBudget::trim (ICachedAnimation* keep)
+{
+    while (_budget > 0 && _usedBytes > _budget)
+    {
+        ICachedAnimation* oldest = nullptr;
+        for (auto animation : _animations)
+        {
+            if (animation == keep || animation->_cachedBytes == 0) continue;
+            // Still playing, evicting it would only make it bake again and evict another one.
+            if (animation->_lastUsedFrame + 1 >= _frame) continue;
+            if (!oldest || animation->_lastUsed < oldest->_lastUsed)
+            {
+                oldest = animation;
+            }
+        }
+        if (!oldest) break;
+        
+        std::size_t usedBytes = _usedBytes;
+        oldest->evictFrames();
+        // An animation which couldn't release anything would be picked forever.
+        if (_usedBytes >= usedBytes) break;
+    }
+}
+
+MIDDLEWARE_END
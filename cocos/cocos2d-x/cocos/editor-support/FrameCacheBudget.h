@@ -0,0 +1,135 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "MiddlewareMacro.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+MIDDLEWARE_BEGIN
+
+/**
+ * Baked frames of one animation of SkeletonCache or ArmatureCache, as seen by FrameCacheBudget.
+ */
+class ICachedAnimation
+{
+public:
+    virtual ~ICachedAnimation () {}
+    /**
+     * @brief Releases all baked frames, they are baked again when the animation is played.
+     */
+    virtual void evictFrames () = 0;
+    
+    std::size_t getCachedBytes () const
+    {
+        return _cachedBytes;
+    }
+private:
+    friend class FrameCacheBudget;
+    std::size_t _cachedBytes = 0;
+    mutable uint64_t _lastUsed = 0;
+    mutable uint32_t _lastUsedFrame = 0;
+};
+
+/**
+ * Global byte budget of the baked frames of all cached animations.
+ * When the frames exceed the budget, the least recently used animations are evicted.
+ * Animations used in the current or previous frame are never evicted, so the budget may be
+ * exceeded while they play instead of them evicting each other every frame.
+ * Only used on the main thread.
+ */
+class FrameCacheBudget
+{
+public:
+    static FrameCacheBudget* getInstance ()
+    {
+        if (_instance == nullptr)
+        {
+            _instance = new FrameCacheBudget;
+        }
+        return _instance;
+    }
+    
+    static void destroyInstance ()
+    {
+        if (_instance)
+        {
+            delete _instance;
+            _instance = nullptr;
+        }
+    }
+    
+    /**
+     * @brief Sets the budget in bytes, 0 disables eviction.
+     */
+    void setBudget (std::size_t bytes);
+    std::size_t getBudget () const
+    {
+        return _budget;
+    }
+    
+    std::size_t getUsedBytes () const
+    {
+        return _usedBytes;
+    }
+    
+    void addAnimation (ICachedAnimation* animation);
+    void removeAnimation (ICachedAnimation* animation);
+    
+    /**
+     * @brief Marks an animation as used by the current frame.
+     */
+    void touch (const ICachedAnimation* animation)
+    {
+        animation->_lastUsed = ++_clock;
+        animation->_lastUsedFrame = _frame;
+    }
+    
+    /**
+     * @brief Advances the frame counter, invoked once per frame.
+     */
+    void beginFrame ()
+    {
+        ++_frame;
+    }
+    
+    /**
+     * @brief Accounts bytes added to or released from an animation, other animations are evicted if the budget is exceeded.
+     */
+    void resize (ICachedAnimation* animation, std::ptrdiff_t bytes);
+private:
+    void trim (ICachedAnimation* keep);
+    
+    static FrameCacheBudget* _instance;
+    std::vector<ICachedAnimation*> _animations;
+    std::size_t _budget = 64 * 1024 * 1024;
+    std::size_t _usedBytes = 0;
+    uint64_t _clock = 0;
+    // Starts at 2, so that animations never used are not taken for used in the previous frame.
+    uint32_t _frame = 2;
+};
+
+MIDDLEWARE_END
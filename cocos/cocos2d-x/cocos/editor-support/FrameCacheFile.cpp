@@ -0,0 +1,211 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "FrameCacheFile.h"
+#include "platform/CCFileUtils.h"
+#include "base/CCThreadPool.h"
+#include <string.h>
+#include <memory>
+
+USING_NS_CC;
+
+MIDDLEWARE_BEGIN
+
+static const char* FrameCache_Directory = "frame-cache/";
+
+bool FrameCacheFile::_enabled = true;
+
+void FrameCacheFile::setEnabled (bool enabled)
+{
+    _enabled = enabled;
+}
+
+bool FrameCacheFile::isEnabled ()
+{
+    return _enabled;
+}
+
+std::string FrameCacheFile::getPath (const std::string& cacheKey, const std::string& animationName)
+{
+    uint64_t key = hash(animationName, hash(cacheKey));
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return FileUtils::getInstance()->getWritablePath() + FrameCache_Directory + name;
+}
+
+uint64_t FrameCacheFile::hash (const void* data, std::size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t result = seed;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        result ^= bytes[i];
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+FrameCacheWriter::FrameCacheWriter (uint64_t sourceHash, const std::string& animationName)
+{
+    writeUint32(FrameCacheFile::Magic);
+    writeUint32(FrameCacheFile::Version);
+    writeUint32((uint32_t)sourceHash);
+    writeUint32((uint32_t)(sourceHash >> 32));
+    writeArray(animationName.data(), animationName.size());
+}
+
+void FrameCacheWriter::writeUint32 (uint32_t value)
+{
+    std::size_t pos = _buffer.size();
+    _buffer.resize(pos + sizeof(value));
+    memcpy(_buffer.data() + pos, &value, sizeof(value));
+}
+
+void FrameCacheWriter::writeFloat (float value)
+{
+    std::size_t pos = _buffer.size();
+    _buffer.resize(pos + sizeof(value));
+    memcpy(_buffer.data() + pos, &value, sizeof(value));
+}
+
+void FrameCacheWriter::writeArray (const void* data, std::size_t bytes)
+{
+    writeUint32((uint32_t)bytes);
+    std::size_t pos = _buffer.size();
+    _buffer.resize(pos + ((bytes + 3) & ~(std::size_t)3), 0);
+    if (bytes > 0)
+    {
+        memcpy(_buffer.data() + pos, data, bytes);
+    }
+}
+
+void FrameCacheWriter::saveAsync (const std::string& path)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string directory = fileUtils->getWritablePath() + FrameCache_Directory;
+    if (!fileUtils->isDirectoryExist(directory) && !fileUtils->createDirectory(directory))
+    {
+        return;
+    }
+    
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+    buffer->swap(_buffer);
+    ThreadPool::getDefaultThreadPool()->pushTask([buffer, path](int /*tid*/) {
+        Data data;
+        data.fastSet(buffer->data(), (ssize_t)buffer->size());
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = path + ".tmp";
+        if (fileUtils->writeDataToFile(data, tempPath))
+        {
+            fileUtils->renameFile(tempPath, path);
+        }
+        // The bytes are owned by the vector.
+        data.takeBuffer();
+    });
+}
+
+bool FrameCacheReader::open (const std::string& path, uint64_t sourceHash, const std::string& animationName)
+{
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(path))
+    {
+        _data.clear();
+        _pos = 0;
+        _failed = true;
+        return false;
+    }
+    return open(fileUtils->getDataFromFile(path), sourceHash, animationName);
+}
+
+bool FrameCacheReader::open (const Data& data, uint64_t sourceHash, const std::string& animationName)
+{
+    _data = data;
+    _pos = 0;
+    _failed = false;
+    
+    uint32_t magic = 0, version = 0, hashLow = 0, hashHigh = 0;
+    readUint32(magic);
+    readUint32(version);
+    readUint32(hashLow);
+    readUint32(hashHigh);
+    std::size_t nameBytes = 0;
+    const uint8_t* name = readArray(nameBytes);
+    
+    if (_failed || magic != FrameCacheFile::Magic || version != FrameCacheFile::Version ||
+        (((uint64_t)hashHigh << 32) | hashLow) != sourceHash ||
+        nameBytes != animationName.size() || memcmp(name, animationName.data(), nameBytes) != 0)
+    {
+        _data.clear();
+        _failed = true;
+        return false;
+    }
+    return true;
+}
+
+const uint8_t* FrameCacheReader::read (std::size_t bytes)
+{
+    if (_failed || bytes > (std::size_t)_data.getSize() - _pos)
+    {
+        _failed = true;
+        return nullptr;
+    }
+    const uint8_t* result = _data.getBytes() + _pos;
+    _pos += bytes;
+    return result;
+}
+
+bool FrameCacheReader::readUint32 (uint32_t& value)
+{
+    const uint8_t* bytes = read(sizeof(value));
+    if (!bytes) return false;
+    memcpy(&value, bytes, sizeof(value));
+    return true;
+}
+
+bool FrameCacheReader::readFloat (float& value)
+{
+    const uint8_t* bytes = read(sizeof(value));
+    if (!bytes) return false;
+    memcpy(&value, bytes, sizeof(value));
+    return true;
+}
+
+const uint8_t* FrameCacheReader::readArray (std::size_t& bytes)
+{
+    uint32_t count = 0;
+    bytes = 0;
+    if (!readUint32(count)) return nullptr;
+    // Checked before padding, so that a corrupt count can neither wrap nor size an allocation of the caller.
+    if (count > getRemaining())
+    {
+        _failed = true;
+        return nullptr;
+    }
+    const uint8_t* result = read(((std::size_t)count + 3) & ~(std::size_t)3);
+    if (!result) return nullptr;
+    bytes = count;
+    return result;
+}
+
+MIDDLEWARE_END
@@ -0,0 +1,153 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "MiddlewareMacro.h"
+#include "base/CCData.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+MIDDLEWARE_BEGIN
+
+/**
+ * Versioned binary files of baked animation frames, stored under the writable path so that
+ * later runs load the frames instead of baking them again.
+ * A file starts with the format version, a hash of the source data and the animation name,
+ * files whose header doesn't match are ignored. Every field is 4 bytes aligned, so that
+ * arrays are read in place from the loaded data.
+ */
+class FrameCacheFile
+{
+public:
+    static const uint32_t Magic = 0x43464343;
+    static const uint32_t Version = 1;
+    static const uint64_t HashSeed = 14695981039346656037ULL;
+    
+    static void setEnabled (bool enabled);
+    static bool isEnabled ();
+    
+    /**
+     * @brief Gets the file of an animation.
+     * @param[in] cacheKey Key of the skeleton, e.g. its uuid and atlas uuid.
+     * @param[in] animationName Name of the animation.
+     */
+    static std::string getPath (const std::string& cacheKey, const std::string& animationName);
+    
+    /**
+     * @brief FNV-1a hash, used to validate files against their source data.
+     */
+    static uint64_t hash (const void* data, std::size_t size, uint64_t seed = HashSeed);
+    static uint64_t hash (const std::string& value, uint64_t seed = HashSeed)
+    {
+        return hash(value.data(), value.size(), seed);
+    }
+    template<typename T>
+    static uint64_t hashValue (T value, uint64_t seed = HashSeed)
+    {
+        return hash(&value, sizeof(value), seed);
+    }
+private:
+    static bool _enabled;
+};
+
+/**
+ * Serializes the frames of one animation into memory, then writes them to a file.
+ */
+class FrameCacheWriter
+{
+public:
+    FrameCacheWriter (uint64_t sourceHash, const std::string& animationName);
+    
+    void writeUint32 (uint32_t value);
+    void writeFloat (float value);
+    /**
+     * @brief Writes the count of bytes followed by the bytes, padded to 4 bytes.
+     */
+    void writeArray (const void* data, std::size_t bytes);
+    
+    /**
+     * @brief Writes the file on a worker thread, through a temporary file so that a partial file is never read.
+     */
+    void saveAsync (const std::string& path);
+    
+    /**
+     * @brief Bytes written so far, empty once saveAsync has taken them.
+     */
+    const std::vector<uint8_t>& getBuffer () const
+    {
+        return _buffer;
+    }
+private:
+    std::vector<uint8_t> _buffer;
+};
+
+/**
+ * Reads a file written by FrameCacheWriter. Every read is bounds checked, a read out of
+ * range fails and leaves the reader in the failed state.
+ */
+class FrameCacheReader
+{
+public:
+    /**
+     * @brief Loads a file, fails if it is missing or doesn't match the source data.
+     */
+    bool open (const std::string& path, uint64_t sourceHash, const std::string& animationName);
+    /**
+     * @brief Reads data already in memory, fails if it doesn't match the source data.
+     */
+    bool open (const cocos2d::Data& data, uint64_t sourceHash, const std::string& animationName);
+    
+    bool readUint32 (uint32_t& value);
+    bool readFloat (float& value);
+    /**
+     * @brief Reads an array written by writeArray.
+     * @param[out] bytes Count of bytes of the array.
+     * @return Bytes of the array inside the loaded data, nullptr if out of range, so bytes never exceeds the loaded data.
+     */
+    const uint8_t* readArray (std::size_t& bytes);
+    
+    bool isFailed () const
+    {
+        return _failed;
+    }
+    bool isEnd () const
+    {
+        return _pos == (std::size_t)_data.getSize();
+    }
+    std::size_t getRemaining () const
+    {
+        return (std::size_t)_data.getSize() - _pos;
+    }
+private:
+    const uint8_t* read (std::size_t bytes);
+    
+    cocos2d::Data _data;
+    std::size_t _pos = 0;
+    bool _failed = false;
+};
+
+MIDDLEWARE_END
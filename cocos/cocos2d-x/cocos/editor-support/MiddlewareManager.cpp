@@ -24,10 +24,16 @@
 #include "MiddlewareManager.h"
 #include "base/CCGLUtils.h"
 #include "scripting/js-bindings/jswrapper/SeApi.h"
+#include "renderer/scene/ParallelTask.hpp"
+#include "UpdateLOD.h"
+#include "FrameCacheBudget.h"
 #include <algorithm>
 
 MIDDLEWARE_BEGIN
-    
+
+// Below this count the update isn't worth waking up the workers.
+static const std::size_t ParallelUpdate_Min_Count = 4;
+
 MiddlewareManager* MiddlewareManager::_instance = nullptr;
 
 MiddlewareManager::MiddlewareManager()
@@ -61,38 +67,59 @@ MeshBuffer* MiddlewareManager::getMeshBuffer(int format)
 
 void MiddlewareManager::_clearRemoveList()
 {
-    for (std::size_t i = 0; i < _removeList.size(); i++)
-    {
-        auto editor = _removeList[i];
-        auto it = std::find(_updateList.begin(), _updateList.end(), editor);
-        if (it != _updateList.end())
-        {
-            _updateList.erase(it);
-        }
-    }
+    if (_removedCount == 0) return;
     
-    _removeList.clear();
+    _updateList.erase(std::remove(_updateList.begin(), _updateList.end(), nullptr), _updateList.end());
+    _removedCount = 0;
 }
 
 void MiddlewareManager::update(float dt)
 {
     isUpdating = true;
+    UpdateLOD::beginFrame();
+    FrameCacheBudget::getInstance()->beginFrame();
     
-    for (std::size_t i = 0, n = _updateList.size(); i < n; i++)
+    // Updates in list order, callbacks may add or remove middleware or change the middleware after them.
+    // A run of parallel updatable middleware is only collected once the middleware before it is updated,
+    // so that the workers see what the callbacks changed, as a serial update would.
+    std::size_t count = _updateList.size();
+    for (std::size_t i = 0; i < count;)
     {
-        auto editor = _updateList[i];
-        if (_removeList.size() > 0)
+        _parallelIndices.clear();
+        std::size_t runEnd = i;
+        if (_parallelTask)
         {
-            auto removeIt = std::find(_removeList.begin(), _removeList.end(), editor);
-            if (removeIt == _removeList.end())
+            for (; runEnd < count; runEnd++)
             {
-                editor->update(dt);
+                auto editor = _updateList[runEnd];
+                if (!editor) continue;
+                if (!editor->isParallelUpdatable()) break;
+                _parallelIndices.push_back(runEnd);
             }
         }
-        else
+        
+        if (_parallelIndices.size() >= ParallelUpdate_Min_Count)
         {
-            editor->update(dt);
+            isParallelUpdating = true;
+            _parallelTask->run(_parallelIndices.size(), 1, [this, dt](int tid, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    _updateList[_parallelIndices[i]]->update(dt);
+                }
+            });
+            isParallelUpdating = false;
+            
+            for (auto index : _parallelIndices)
+            {
+                auto editor = _updateList[index];
+                if (editor) editor->postUpdate();
+            }
+            i = runEnd;
+            continue;
         }
+        
+        auto editor = _updateList[i++];
+        if (editor) editor->update(dt);
     }
     
     isUpdating = false;
@@ -116,15 +143,7 @@ void MiddlewareManager::render(float dt)
     for (std::size_t i = 0, n = _updateList.size(); i < n; i++)
     {
         auto editor = _updateList[i];
-        if (_removeList.size() > 0)
-        {
-            auto removeIt = std::find(_removeList.begin(), _removeList.end(), editor);
-            if (removeIt == _removeList.end())
-            {
-                editor->render(dt);
-            }
-        }
-        else
+        if (editor)
         {
             editor->render(dt);
         }
@@ -147,32 +166,30 @@ void MiddlewareManager::render(float dt)
 
 void MiddlewareManager::addTimer(IMiddleware* editor)
 {
-    auto it0 = std::find(_updateList.begin(), _updateList.end(), editor);
-    if (it0 != _updateList.end()) {
+    auto it = std::find(_updateList.begin(), _updateList.end(), editor);
+    if (it != _updateList.end()) {
         return;
     }
     
-    auto it1 = std::find(_removeList.begin(), _removeList.end(), editor);
-    if (it1 != _removeList.end())
-    {
-        _removeList.erase(it1);
-    }
     _updateList.push_back(editor);
 }
 
 void MiddlewareManager::removeTimer(IMiddleware* editor)
 {
+    auto it = std::find(_updateList.begin(), _updateList.end(), editor);
+    if (it == _updateList.end())
+    {
+        return;
+    }
+    
     if (isUpdating || isRendering)
     {
-        _removeList.push_back(editor);
+        *it = nullptr;
+        _removedCount++;
     }
     else
     {
-        auto it = std::find(_updateList.begin(), _updateList.end(), editor);
-        if (it != _updateList.end())
-        {
-            _updateList.erase(it);
-        }
+        _updateList.erase(it);
     }
 }
 MIDDLEWARE_END
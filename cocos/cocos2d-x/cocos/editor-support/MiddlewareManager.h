@@ -29,6 +29,10 @@
 #include "base/CCRef.h"
 #include "MiddlewareMacro.h"
 
+namespace cocos2d { namespace renderer {
+    class ParallelTask;
+}}
+
 MIDDLEWARE_BEGIN
 
 /**
@@ -40,6 +44,16 @@ public:
     virtual ~IMiddleware() {}
     virtual void update(float dt) = 0;
     virtual void render(float dt) = 0;
+    /**
+     * Middleware whose update only touches its own state and calls nothing back into
+     * script in this frame may return true. The manager then runs the update of a run
+     * of such middleware on worker threads, once the middleware before them in the
+     * update list is updated, and calls postUpdate on the calling thread afterwards,
+     * in the order of the update list. Work which must happen on the calling thread is
+     * deferred to postUpdate while MiddlewareManager::isParallelUpdating is set.
+     */
+    virtual bool isParallelUpdatable() const { return false; }
+    virtual void postUpdate() {}
 };
 
 /**
@@ -99,17 +113,27 @@ public:
     
     MeshBuffer* getMeshBuffer(int format);
     
+    /**
+     * @brief Workers running the update of parallel updatable middleware, nullptr updates everything on the calling thread.
+     */
+    void setParallelTask(cocos2d::renderer::ParallelTask* task) { _parallelTask = task; }
+    
     MiddlewareManager();
     ~MiddlewareManager();
     
     bool isRendering = false;
     bool isUpdating = false;
+    bool isParallelUpdating = false;
 private:
     void _clearRemoveList();
 private:
 
+    // Middleware removed while updating or rendering leave a nullptr behind, compacted by _clearRemoveList.
     std::vector<IMiddleware*> _updateList;
-    std::vector<IMiddleware*> _removeList;
+    std::size_t _removedCount = 0;
+    // Indices into _updateList of the run of middleware being updated by the workers.
+    std::vector<std::size_t> _parallelIndices;
+    cocos2d::renderer::ParallelTask* _parallelTask = nullptr;
     std::map<int, MeshBuffer*> _mbMap;
     
     static MiddlewareManager* _instance;
@@ -0,0 +1,198 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "PackedMesh.h"
+#include "FrameCacheFile.h"
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+
+MIDDLEWARE_BEGIN
+
+void PackedMesh::pack (const float* vertices, std::size_t vertexCount, std::size_t floatStride, const uint16_t* indices, std::size_t indexCount, const PackedMesh* previous)
+{
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (std::size_t i = 0; i < vertexCount; i++)
+    {
+        const float* vertex = vertices + i * floatStride;
+        minX = std::min(minX, vertex[0]);
+        minY = std::min(minY, vertex[1]);
+        maxX = std::max(maxX, vertex[0]);
+        maxY = std::max(maxY, vertex[1]);
+    }
+    if (vertexCount == 0)
+    {
+        minX = minY = maxX = maxY = 0.0f;
+    }
+    
+    float rangeX = maxX - minX, rangeY = maxY - minY;
+    float quantizeX = rangeX > 0.0f ? 65535.0f / rangeX : 0.0f;
+    float quantizeY = rangeY > 0.0f ? 65535.0f / rangeY : 0.0f;
+    _minX = minX;
+    _minY = minY;
+    _scaleX = rangeX / 65535.0f;
+    _scaleY = rangeY / 65535.0f;
+    
+    _positions.resize(vertexCount * 2);
+    for (std::size_t i = 0; i < vertexCount; i++)
+    {
+        const float* vertex = vertices + i * floatStride;
+        _positions[i * 2] = (uint16_t)std::min((vertex[0] - minX) * quantizeX + 0.5f, 65535.0f);
+        _positions[i * 2 + 1] = (uint16_t)std::min((vertex[1] - minY) * quantizeY + 0.5f, 65535.0f);
+    }
+    _byteSize = sizeof(PackedMesh) + _positions.size() * sizeof(uint16_t);
+    
+    bool sameUVs = previous && previous->_uvs && previous->_uvs->size() == vertexCount * 2;
+    if (sameUVs)
+    {
+        const float* uvs = previous->_uvs->data();
+        for (std::size_t i = 0; i < vertexCount && sameUVs; i++)
+        {
+            const float* vertex = vertices + i * floatStride;
+            sameUVs = uvs[i * 2] == vertex[2] && uvs[i * 2 + 1] == vertex[3];
+        }
+    }
+    if (sameUVs)
+    {
+        _uvs = previous->_uvs;
+    }
+    else
+    {
+        auto uvs = std::make_shared<std::vector<float>>(vertexCount * 2);
+        for (std::size_t i = 0; i < vertexCount; i++)
+        {
+            const float* vertex = vertices + i * floatStride;
+            (*uvs)[i * 2] = vertex[2];
+            (*uvs)[i * 2 + 1] = vertex[3];
+        }
+        _uvs = uvs;
+        _byteSize += uvs->size() * sizeof(float);
+    }
+    
+    bool sameIndices = previous && previous->_indices && previous->_indices->size() == indexCount
+        && memcmp(previous->_indices->data(), indices, indexCount * sizeof(uint16_t)) == 0;
+    if (sameIndices)
+    {
+        _indices = previous->_indices;
+    }
+    else
+    {
+        _indices = std::make_shared<std::vector<uint16_t>>(indices, indices + indexCount);
+        _byteSize += indexCount * sizeof(uint16_t);
+    }
+}
+
+void PackedMesh::unpack (std::size_t first, std::size_t count, float* dst, std::size_t floatStride) const
+{
+    const uint16_t* positions = _positions.data() + first * 2;
+    const float* uvs = _uvs->data() + first * 2;
+    for (std::size_t i = 0; i < count; i++, dst += floatStride)
+    {
+        dst[0] = _minX + positions[i * 2] * _scaleX;
+        dst[1] = _minY + positions[i * 2 + 1] * _scaleY;
+        dst[2] = uvs[i * 2];
+        dst[3] = uvs[i * 2 + 1];
+    }
+}
+
+void PackedMesh::write (FrameCacheWriter& writer, const PackedMesh* previous) const
+{
+    writer.writeFloat(_minX);
+    writer.writeFloat(_minY);
+    writer.writeFloat(_scaleX);
+    writer.writeFloat(_scaleY);
+    writer.writeArray(_positions.data(), _positions.size() * sizeof(uint16_t));
+    
+    bool sharedUVs = previous && previous->_uvs == _uvs;
+    writer.writeUint32(sharedUVs ? 1 : 0);
+    if (!sharedUVs)
+    {
+        writer.writeArray(_uvs->data(), _uvs->size() * sizeof(float));
+    }
+    
+    bool sharedIndices = previous && previous->_indices == _indices;
+    writer.writeUint32(sharedIndices ? 1 : 0);
+    if (!sharedIndices)
+    {
+        writer.writeArray(_indices->data(), _indices->size() * sizeof(uint16_t));
+    }
+}
+
+bool PackedMesh::read (FrameCacheReader& reader, const PackedMesh* previous)
+{
+    reader.readFloat(_minX);
+    reader.readFloat(_minY);
+    reader.readFloat(_scaleX);
+    reader.readFloat(_scaleY);
+    
+    std::size_t bytes = 0;
+    const uint8_t* data = reader.readArray(bytes);
+    if (!data || bytes % (sizeof(uint16_t) * 2) != 0) return false;
+    _positions.resize(bytes / sizeof(uint16_t));
+    memcpy(_positions.data(), data, bytes);
+    _byteSize = sizeof(PackedMesh) + bytes;
+    
+    std::size_t vertexCount = _positions.size() / 2;
+    uint32_t shared = 0;
+    if (!reader.readUint32(shared)) return false;
+    if (shared)
+    {
+        if (!previous || !previous->_uvs) return false;
+        _uvs = previous->_uvs;
+    }
+    else
+    {
+        data = reader.readArray(bytes);
+        if (!data || bytes % sizeof(float) != 0) return false;
+        auto uvs = std::make_shared<std::vector<float>>(bytes / sizeof(float));
+        memcpy(uvs->data(), data, bytes);
+        _uvs = uvs;
+        _byteSize += bytes;
+    }
+    if (_uvs->size() != vertexCount * 2) return false;
+    
+    if (!reader.readUint32(shared)) return false;
+    if (shared)
+    {
+        if (!previous || !previous->_indices) return false;
+        _indices = previous->_indices;
+    }
+    else
+    {
+        data = reader.readArray(bytes);
+        if (!data || bytes % sizeof(uint16_t) != 0) return false;
+        auto indices = std::make_shared<std::vector<uint16_t>>(bytes / sizeof(uint16_t));
+        memcpy(indices->data(), data, bytes);
+        _indices = indices;
+        _byteSize += bytes;
+    }
+    // Indices are rebased onto the mesh buffer, one past the vertices would draw another mesh.
+    for (auto index : *_indices)
+    {
+        if (index >= vertexCount) return false;
+    }
+    return !reader.isFailed();
+}
+
+MIDDLEWARE_END
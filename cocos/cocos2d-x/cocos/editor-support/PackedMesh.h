@@ -0,0 +1,109 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "MiddlewareMacro.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+MIDDLEWARE_BEGIN
+
+class FrameCacheWriter;
+class FrameCacheReader;
+
+/**
+ * Geometry of a baked animation frame in compact form.
+ * Positions are quantized to 16 bits within the bounds of the frame. Uvs and indices
+ * are shared with the previous frame while the attachments and the draw order don't change.
+ */
+class PackedMesh
+{
+public:
+    /**
+     * @brief Packs float vertices which start with x, y, u, v.
+     * @param[in] vertices Source vertices.
+     * @param[in] vertexCount Count of source vertices.
+     * @param[in] floatStride Floats per source vertex.
+     * @param[in] indices Source indices.
+     * @param[in] indexCount Count of source indices.
+     * @param[in] previous Mesh of the previous frame to share data with, may be nullptr.
+     */
+    void pack (const float* vertices, std::size_t vertexCount, std::size_t floatStride, const uint16_t* indices, std::size_t indexCount, const PackedMesh* previous);
+    
+    /**
+     * @brief Writes x, y, u, v of a range of vertices, the other floats of the destination are left untouched.
+     * @param[in] first First vertex to unpack.
+     * @param[in] count Count of vertices to unpack.
+     * @param[in] dst Destination of the first vertex.
+     * @param[in] floatStride Floats per destination vertex.
+     */
+    void unpack (std::size_t first, std::size_t count, float* dst, std::size_t floatStride) const;
+    
+    /**
+     * @brief Writes the mesh to a frame cache file, data shared with the previous frame is written as a reference.
+     */
+    void write (FrameCacheWriter& writer, const PackedMesh* previous) const;
+    /**
+     * @brief Reads a mesh written by write, previous must be the mesh read before it.
+     * @return false if the data is invalid.
+     */
+    bool read (FrameCacheReader& reader, const PackedMesh* previous);
+    
+    std::size_t getVertexCount () const
+    {
+        return _positions.size() / 2;
+    }
+    
+    const uint16_t* getIndices () const
+    {
+        return _indices ? _indices->data() : nullptr;
+    }
+    
+    std::size_t getIndexCount () const
+    {
+        return _indices ? _indices->size() : 0;
+    }
+    
+    /**
+     * @brief Bytes owned by this mesh, data shared with the previous frame isn't counted.
+     */
+    std::size_t getByteSize () const
+    {
+        return _byteSize;
+    }
+private:
+    float _minX = 0.0f;
+    float _minY = 0.0f;
+    float _scaleX = 0.0f;
+    float _scaleY = 0.0f;
+    std::vector<uint16_t> _positions;
+    std::shared_ptr<const std::vector<float>> _uvs;
+    std::shared_ptr<const std::vector<uint16_t>> _indices;
+    std::size_t _byteSize = 0;
+};
+
+MIDDLEWARE_END
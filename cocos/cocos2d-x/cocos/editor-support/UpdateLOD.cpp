@@ -0,0 +1,117 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "UpdateLOD.h"
+#include "renderer/scene/RenderFlow.hpp"
+
+using namespace cocos2d::renderer;
+
+MIDDLEWARE_BEGIN
+
+bool UpdateLOD::_enabled = true;
+float UpdateLOD::_halfRate = 0.02f;
+float UpdateLOD::_quarterRate = 0.005f;
+float UpdateLOD::_noConstraints = 0.002f;
+std::atomic<uint32_t> UpdateLOD::_counts[UpdateLOD::LEVEL_COUNT];
+uint32_t UpdateLOD::_lastCounts[UpdateLOD::LEVEL_COUNT] = {0};
+uint32_t UpdateLOD::_globalFrame = 0;
+
+void UpdateLOD::setEnabled (bool enabled)
+{
+    _enabled = enabled;
+}
+
+bool UpdateLOD::isEnabled ()
+{
+    return _enabled;
+}
+
+void UpdateLOD::setThresholds (float halfRate, float quarterRate, float noConstraints)
+{
+    _halfRate = halfRate;
+    _quarterRate = quarterRate;
+    _noConstraints = noConstraints;
+}
+
+void UpdateLOD::beginFrame ()
+{
+    _globalFrame++;
+    for (int i = 0; i < LEVEL_COUNT; i++)
+    {
+        _lastCounts[i] = _counts[i].exchange(0, std::memory_order_relaxed);
+    }
+}
+
+uint32_t UpdateLOD::getLevelCount (Level level)
+{
+    return level < LEVEL_COUNT ? _lastCounts[level] : 0;
+}
+
+UpdateLOD::UpdateLOD ()
+{
+    // Spread the reduced updates of different skeletons over different frames.
+    _frame = (uint32_t)((uintptr_t)this >> 4);
+}
+
+float UpdateLOD::step (NodeProxy* node, float dt)
+{
+    _level = FULL;
+    _coverage = 1.0f;
+    _stepFrame = _globalFrame;
+    
+    RenderFlow* flow = RenderFlow::getInstance();
+    if (_enabled && _priority <= 0 && node && flow && node->getLevelIndex() != NODE_INDEX_INVALID)
+    {
+        std::size_t level = node->getLevel(), index = node->getLevelIndex();
+        if (!(flow->getVisibility(level, index) & RenderFlow::SELF_VISIBLE))
+        {
+            _level = CULLED;
+        }
+        else
+        {
+            _coverage = flow->getScreenCoverage(level, index);
+            float coverage = _priority < 0 ? _coverage * 0.25f : _coverage;
+            if (coverage < _quarterRate)
+            {
+                _level = QUARTER;
+            }
+            else if (coverage < _halfRate)
+            {
+                _level = HALF;
+            }
+        }
+    }
+    _counts[_level].fetch_add(1, std::memory_order_relaxed);
+    
+    uint32_t interval = _level == FULL ? 1 : (_level == HALF ? 2 : 4);
+    _accTime += dt;
+    _updated = ++_frame % interval == 0;
+    if (!_updated) return 0.0f;
+    
+    float time = _accTime;
+    _accTime = 0.0f;
+    return time;
+}
+
+MIDDLEWARE_END
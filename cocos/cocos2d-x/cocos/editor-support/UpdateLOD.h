@@ -0,0 +1,136 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "MiddlewareMacro.h"
+#include <atomic>
+#include <cstdint>
+
+namespace cocos2d { namespace renderer {
+    class NodeProxy;
+}}
+
+MIDDLEWARE_BEGIN
+
+/**
+ * Update rate policy of one skeleton. The level is picked from the visibility and the screen
+ * coverage of its node in the last rendered frame, skipped updates accumulate their time so
+ * that the animation keeps its pace.
+ */
+class UpdateLOD
+{
+public:
+    enum Level
+    {
+        FULL = 0,
+        HALF,
+        QUARTER,
+        // Off screen, updated at quarter rate and rendered only when updated.
+        CULLED,
+        LEVEL_COUNT
+    };
+    
+    static void setEnabled (bool enabled);
+    static bool isEnabled ();
+    /**
+     * @brief Sets the screen coverages under which skeletons update at half and quarter rate, and stop solving constraints.
+     */
+    static void setThresholds (float halfRate, float quarterRate, float noConstraints);
+    /**
+     * @brief Starts counting a new frame, called by MiddlewareManager before the updates.
+     */
+    static void beginFrame ();
+    /**
+     * @brief Gets how many skeletons ran at a level in the last frame.
+     */
+    static uint32_t getLevelCount (Level level);
+    
+    UpdateLOD ();
+    
+    /**
+     * @brief Sets the priority, skeletons above 0 always update at full rate, below 0 they are reduced 4 times earlier.
+     */
+    void setPriority (int priority)
+    {
+        _priority = priority;
+    }
+    int getPriority () const
+    {
+        return _priority;
+    }
+    
+    /**
+     * @brief Picks the level of this frame and accumulates the time.
+     * @param[in] node Node of the skeleton, the level is FULL without it.
+     * @param[in] dt Time of this frame.
+     * @return The time to advance the skeleton by, 0 if it skips this frame.
+     */
+    float step (cocos2d::renderer::NodeProxy* node, float dt);
+    
+    Level getLevel () const
+    {
+        return _level;
+    }
+    /**
+     * @brief Whether the last step advanced the skeleton.
+     */
+    bool isUpdated () const
+    {
+        return _updated;
+    }
+    /**
+     * @brief Whether IK, path and transform constraints are worth solving at the current size.
+     */
+    bool needsConstraints () const
+    {
+        return _level != CULLED && _coverage >= _noConstraints;
+    }
+    /**
+     * @brief Whether the vertices of this frame can be skipped, the pose didn't change and the node is off screen.
+     * False if step wasn't called in this frame, as for a skeleton no longer updated.
+     */
+    bool canSkipRender () const
+    {
+        return _level == CULLED && !_updated && _stepFrame == _globalFrame;
+    }
+private:
+    static bool _enabled;
+    static float _halfRate;
+    static float _quarterRate;
+    static float _noConstraints;
+    static std::atomic<uint32_t> _counts[LEVEL_COUNT];
+    static uint32_t _lastCounts[LEVEL_COUNT];
+    static uint32_t _globalFrame;
+    
+    Level _level = FULL;
+    float _coverage = 1.0f;
+    float _accTime = 0.0f;
+    uint32_t _frame = 0;
+    uint32_t _stepFrame = 0;
+    int _priority = 0;
+    bool _updated = true;
+};
+
+MIDDLEWARE_END
@@ -25,6 +25,7 @@
 #include "CCFactory.h"
 #include "base/ccTypes.h"
 #include "renderer/gfx/Texture.h"
+#include "CCTextureAtlasData.h"
 
 USING_NS_CC;
 USING_NS_MW;
@@ -64,12 +65,6 @@ ArmatureCache::FrameData::FrameData()
 
 ArmatureCache::FrameData::~FrameData() 
 {
-    for (std::size_t i = 0, c = _colors.size(); i < c; i++) 
-    {
-        delete _colors[i];
-    }
-    _colors.clear();
-
     for (std::size_t i = 0, c = _segments.size(); i < c; i++) 
     {
         delete _segments[i];
@@ -77,19 +72,9 @@ ArmatureCache::FrameData::~FrameData()
     _segments.clear();
 }
 
-ArmatureCache::ColorData* ArmatureCache::FrameData::buildColorData(std::size_t index) 
-{
-    if (index > _colors.size()) return nullptr;
-    if (index == _colors.size()) {
-        ColorData* colorData = new ColorData;
-        _colors.push_back(colorData);
-    }
-    return _colors[index];
-}
-
 std::size_t ArmatureCache::FrameData::getColorCount() const 
 {
-    return _colors.size();
+    return _colors ? _colors->size() : 0;
 }
 
 ArmatureCache::SegmentData* ArmatureCache::FrameData::buildSegmentData(std::size_t index) 
@@ -110,12 +95,13 @@ std::size_t ArmatureCache::FrameData::getSegmentCount() const
 
 ArmatureCache::AnimationData::AnimationData() 
 {
-
+    FrameCacheBudget::getInstance()->addAnimation(this);
 }
 
 ArmatureCache::AnimationData::~AnimationData() 
 {
     reset();
+    FrameCacheBudget::getInstance()->removeAnimation(this);
 }
 
 void ArmatureCache::AnimationData::reset() 
@@ -127,6 +113,13 @@ void ArmatureCache::AnimationData::reset()
     _frames.clear();
     _isComplete = false;
     _totalTime = 0.0f;
+    _persisted = false;
+    FrameCacheBudget::getInstance()->resize(this, -(std::ptrdiff_t)getCachedBytes());
+}
+
+void ArmatureCache::AnimationData::evictFrames()
+{
+    reset();
 }
 
 bool ArmatureCache::AnimationData::needUpdate(int toFrameIdx) const 
@@ -154,6 +147,7 @@ ArmatureCache::FrameData* ArmatureCache::AnimationData::getFrameData(std::size_t
     {
         return nullptr;
     }
+    FrameCacheBudget::getInstance()->touch(this);
     return _frames[frameIdx];
 }
 
@@ -164,6 +158,8 @@ std::size_t ArmatureCache::AnimationData::getFrameCount() const
 
 ArmatureCache::ArmatureCache(const std::string& armatureName, const std::string& armatureKey, const std::string& atlasUUID)
 {
+    _cacheKey = armatureName + "|" + armatureKey + "|" + atlasUUID;
+    _atlasUUID = atlasUUID;
     _armatureDisplay = dragonBones::CCFactory::getFactory()->buildArmatureDisplay(armatureName, armatureKey, "", atlasUUID);
     if (_armatureDisplay) 
     {
@@ -239,7 +235,12 @@ void ArmatureCache::updateToFrame(const std::string& animationName, int toFrameI
 
     if (_curAnimationName != animationName) 
     {
-        updateToFrame(_curAnimationName);
+        // Finish the previous animation, unless it was evicted and has to start over anyway.
+        AnimationData* preAnimationData = getAnimationData(_curAnimationName);
+        if (preAnimationData && preAnimationData->getFrameCount() > 0)
+        {
+            updateToFrame(_curAnimationName);
+        }
         _curAnimationName = animationName;
     }
 
@@ -248,24 +249,37 @@ void ArmatureCache::updateToFrame(const std::string& animationName, int toFrameI
 
     if (animationData->getFrameCount() == 0) 
     {
+        if (loadAnimationData(animationData)) return;
         animation->play(animationName, 1);
     }
 
+    std::size_t bytes = 0;
     do {
         armature->advanceTime(FrameTime);
         renderAnimationFrame(animationData);
+        bytes += animationData->_frames.back()->getByteSize();
         animationData->_totalTime += FrameTime;
         if (animation->isCompleted()) 
         {
             animationData->_isComplete = true;
         }
     } while (animationData->needUpdate(toFrameIdx));
+
+    FrameCacheBudget::getInstance()->resize(animationData, (std::ptrdiff_t)bytes);
+
+    if (!animationData->needUpdate(-1) && !animationData->_persisted)
+    {
+        saveAnimationData(animationData);
+    }
 }
 
 void ArmatureCache::renderAnimationFrame(AnimationData* animationData) 
 {
     std::size_t frameIndex = animationData->getFrameCount();
     _frameData = animationData->buildFrameData(frameIndex);
+    _vb.reset();
+    _ib.reset();
+    _colors.clear();
 
     _preColor = Color4F(-1.0f, -1.0f, -1.0f, -1.0f);
     _color = Color4F(1.0f, 1.0f, 1.0f, 1.0f);
@@ -288,20 +302,38 @@ void ArmatureCache::renderAnimationFrame(AnimationData* animationData)
         preSegmentData->vertexFloatCount = _curVSegLen;
     }
 
-    auto colorCount = _frameData->getColorCount();
-    if (colorCount > 0) 
+    if (_colors.size() > 0) 
     {
-        ColorData* preColorData = _frameData->buildColorData(colorCount - 1);
-        preColorData->vertexFloatOffset = (int)_frameData->vb.getCurPos() / sizeof(float);
+        _colors.back().vertexFloatOffset = (int)_vb.getCurPos() / sizeof(float);
     }
 
+    // Geometry and colors are shared with the previous frame when unchanged.
+    FrameData* lastFrame = frameIndex > 0 ? animationData->getFrameData(frameIndex - 1) : nullptr;
+    const int vs = sizeof(middleware::V2F_T2F_C4B) / sizeof(float);
+    _frameData->_mesh.pack((const float*)_vb.getBuffer(), _vb.getCurPos() / sizeof(middleware::V2F_T2F_C4B), vs,
+                           (const uint16_t*)_ib.getBuffer(), _ib.getCurPos() / sizeof(unsigned short),
+                           lastFrame ? &lastFrame->_mesh : nullptr);
+
+    std::size_t byteSize = sizeof(FrameData) + _frameData->_mesh.getByteSize();
+    if (lastFrame && *lastFrame->_colors == _colors)
+    {
+        _frameData->_colors = lastFrame->_colors;
+    }
+    else
+    {
+        _frameData->_colors = std::make_shared<std::vector<ColorData>>(_colors);
+        byteSize += _colors.size() * sizeof(ColorData);
+    }
+    byteSize += _frameData->_segments.size() * (sizeof(SegmentData) + sizeof(SegmentData*));
+    _frameData->_byteSize = byteSize;
+
     _frameData = nullptr;
 }
 
 void ArmatureCache::traverseArmature(Armature* armature, float parentOpacity/*= 1.0f*/) 
 {
-    middleware::IOBuffer& vb = _frameData->vb;
-    middleware::IOBuffer& ib = _frameData->ib;
+    middleware::IOBuffer& vb = _vb;
+    middleware::IOBuffer& ib = _ib;
 
     auto& slots = armature->getSlots();
     CCSlot* slot = nullptr;
@@ -365,13 +397,11 @@ void ArmatureCache::traverseArmature(Armature* armature, float parentOpacity/*=
 
         if (preColor != color) {
             preColor = color;
-            auto colorCount = _frameData->getColorCount();
-            if (colorCount > 0) {
-                ColorData* preColorData = _frameData->buildColorData(colorCount - 1);
-                preColorData->vertexFloatOffset = vb.getCurPos() / sizeof(float);
+            if (_colors.size() > 0) {
+                _colors.back().vertexFloatOffset = vb.getCurPos() / sizeof(float);
             }
-            ColorData* colorData = _frameData->buildColorData(colorCount);
-            colorData->color = color;
+            _colors.push_back(ColorData());
+            _colors.back().color = color;
         }
 
         middleware::Triangles& triangles = slot->triangles;
@@ -384,11 +414,6 @@ void ArmatureCache::traverseArmature(Armature* armature, float parentOpacity/*=
             middleware::V2F_T2F_C4B* worldVertex = worldTriangles + v;
             worldVertex->vertex.x = vertex->vertex.x * worldMatrix->m[0] + vertex->vertex.y * worldMatrix->m[4] + worldMatrix->m[12];
             worldVertex->vertex.y = vertex->vertex.x * worldMatrix->m[1] + vertex->vertex.y * worldMatrix->m[5] + worldMatrix->m[13];
-
-            worldVertex->color.r = (GLubyte)color.r;
-            worldVertex->color.g = (GLubyte)color.g;
-            worldVertex->color.b = (GLubyte)color.b;
-            worldVertex->color.a = (GLubyte)color.a;
         }
 
         vb.writeBytes((char*)worldTriangles, vbSize);
@@ -407,6 +432,206 @@ void ArmatureCache::traverseArmature(Armature* armature, float parentOpacity/*=
     } // End slot traverse
 }
 
+uint64_t ArmatureCache::getSourceHash()
+{
+    const ArmatureData* data = _armatureDisplay->getArmature()->getArmatureData();
+    uint64_t hash = FrameCacheFile::hash(_cacheKey);
+    if (data->parent)
+    {
+        hash = FrameCacheFile::hash(data->parent->version, hash);
+    }
+    hash = FrameCacheFile::hashValue(data->frameRate, hash);
+    hash = FrameCacheFile::hashValue((uint32_t)data->sortedBones.size(), hash);
+    hash = FrameCacheFile::hashValue((uint32_t)data->sortedSlots.size(), hash);
+    for (const auto& name : data->animationNames)
+    {
+        hash = FrameCacheFile::hash(name, hash);
+        auto it = data->animations.find(name);
+        if (it != data->animations.end())
+        {
+            hash = FrameCacheFile::hashValue(it->second->duration, hash);
+            hash = FrameCacheFile::hashValue(it->second->frameCount, hash);
+        }
+    }
+    hash = FrameCacheFile::hashValue(FrameTime, hash);
+    hash = FrameCacheFile::hashValue(MaxCacheTime, hash);
+
+    std::map<int, middleware::Texture2D*> textures;
+    collectTextures(textures);
+    for (auto& it : textures)
+    {
+        hash = FrameCacheFile::hashValue(it.first, hash);
+        hash = FrameCacheFile::hashValue(it.second->getPixelsWide(), hash);
+        hash = FrameCacheFile::hashValue(it.second->getPixelsHigh(), hash);
+    }
+    return hash;
+}
+
+void ArmatureCache::collectTextures(std::map<int, middleware::Texture2D*>& textures)
+{
+    auto textureAtlasDatas = CCFactory::getFactory()->getTextureAtlasData(_atlasUUID);
+    if (!textureAtlasDatas) return;
+    for (auto textureAtlasData : *textureAtlasDatas)
+    {
+        middleware::Texture2D* texture = ((CCTextureAtlasData*)textureAtlasData)->getRenderTexture();
+        if (texture)
+        {
+            textures[texture->getRealTextureIndex()] = texture;
+        }
+    }
+}
+
+void ArmatureCache::saveAnimationData(AnimationData* animationData)
+{
+    animationData->_persisted = true;
+    if (!FrameCacheFile::isEnabled() || !_armatureDisplay) return;
+
+    FrameCacheWriter writer(getSourceHash(), animationData->_animationName);
+    writer.writeUint32(animationData->_isComplete ? 1 : 0);
+    writer.writeUint32((uint32_t)animationData->_frames.size());
+
+    const FrameData* lastFrame = nullptr;
+    for (auto frameData : animationData->_frames)
+    {
+        writer.writeUint32((uint32_t)frameData->_segments.size());
+        for (auto segment : frameData->_segments)
+        {
+            writer.writeUint32((uint32_t)segment->_texture->getRealTextureIndex());
+            writer.writeUint32((uint32_t)segment->blendMode);
+            writer.writeUint32((uint32_t)segment->indexCount);
+            writer.writeUint32((uint32_t)segment->vertexFloatCount);
+        }
+
+        bool sharedColors = lastFrame && lastFrame->_colors == frameData->_colors;
+        writer.writeUint32(sharedColors ? 1 : 0);
+        if (!sharedColors)
+        {
+            auto& colors = *frameData->_colors;
+            writer.writeUint32((uint32_t)colors.size());
+            for (auto& color : colors)
+            {
+                writer.writeFloat(color.color.r);
+                writer.writeFloat(color.color.g);
+                writer.writeFloat(color.color.b);
+                writer.writeFloat(color.color.a);
+                writer.writeUint32((uint32_t)color.vertexFloatOffset);
+            }
+        }
+
+        frameData->_mesh.write(writer, lastFrame ? &lastFrame->_mesh : nullptr);
+        lastFrame = frameData;
+    }
+
+    writer.saveAsync(FrameCacheFile::getPath(_cacheKey, animationData->_animationName));
+}
+
+bool ArmatureCache::loadAnimationData(AnimationData* animationData)
+{
+    if (!FrameCacheFile::isEnabled() || !_armatureDisplay) return false;
+
+    FrameCacheReader reader;
+    if (!reader.open(FrameCacheFile::getPath(_cacheKey, animationData->_animationName), getSourceHash(), animationData->_animationName))
+    {
+        return false;
+    }
+
+    std::map<int, middleware::Texture2D*> textures;
+    collectTextures(textures);
+
+    uint32_t isComplete = 0, frameCount = 0;
+    reader.readUint32(isComplete);
+    reader.readUint32(frameCount);
+
+    std::vector<FrameData*> frames;
+    auto fail = [&]()
+    {
+        for (auto frameData : frames)
+        {
+            delete frameData;
+        }
+        return false;
+    };
+
+    const FrameData* lastFrame = nullptr;
+    std::size_t bytes = 0;
+    for (uint32_t i = 0; i < frameCount && !reader.isFailed(); i++)
+    {
+        FrameData* frameData = new FrameData();
+        frames.push_back(frameData);
+
+        uint32_t segmentCount = 0;
+        if (!reader.readUint32(segmentCount)) return fail();
+        std::size_t indexCount = 0, vertexFloatCount = 0;
+        for (uint32_t j = 0; j < segmentCount; j++)
+        {
+            uint32_t textureIndex = 0, blendMode = 0, segmentIndexCount = 0, segmentFloatCount = 0;
+            reader.readUint32(textureIndex);
+            reader.readUint32(blendMode);
+            reader.readUint32(segmentIndexCount);
+            if (!reader.readUint32(segmentFloatCount)) return fail();
+            auto it = textures.find((int)textureIndex);
+            if (it == textures.end()) return fail();
+
+            SegmentData* segment = frameData->buildSegmentData(j);
+            segment->setTexture(it->second);
+            segment->blendMode = (int)blendMode;
+            segment->indexCount = segmentIndexCount;
+            segment->vertexFloatCount = segmentFloatCount;
+            indexCount += segmentIndexCount;
+            vertexFloatCount += segmentFloatCount;
+        }
+
+        uint32_t sharedColors = 0;
+        if (!reader.readUint32(sharedColors)) return fail();
+        std::size_t byteSize = sizeof(FrameData);
+        if (sharedColors)
+        {
+            if (!lastFrame) return fail();
+            frameData->_colors = lastFrame->_colors;
+        }
+        else
+        {
+            uint32_t colorCount = 0;
+            if (!reader.readUint32(colorCount) || colorCount > reader.getRemaining() / (5 * sizeof(float))) return fail();
+            auto colors = std::make_shared<std::vector<ColorData>>(colorCount);
+            for (auto& color : *colors)
+            {
+                uint32_t vertexFloatOffset = 0;
+                reader.readFloat(color.color.r);
+                reader.readFloat(color.color.g);
+                reader.readFloat(color.color.b);
+                reader.readFloat(color.color.a);
+                reader.readUint32(vertexFloatOffset);
+                color.vertexFloatOffset = vertexFloatOffset;
+            }
+            frameData->_colors = colors;
+            byteSize += colorCount * sizeof(ColorData);
+        }
+
+        if (!frameData->_mesh.read(reader, lastFrame ? &lastFrame->_mesh : nullptr)) return fail();
+
+        // The renderer walks the segments and the color runs over the whole mesh.
+        auto& colors = *frameData->_colors;
+        const int vs = sizeof(middleware::V2F_T2F_C4B) / sizeof(float);
+        if (vertexFloatCount != frameData->_mesh.getVertexCount() * vs || indexCount != frameData->_mesh.getIndexCount()) return fail();
+        if (segmentCount > 0 && (colors.empty() || colors.back().vertexFloatOffset < vertexFloatCount)) return fail();
+
+        byteSize += frameData->_mesh.getByteSize();
+        byteSize += segmentCount * (sizeof(SegmentData) + sizeof(SegmentData*));
+        frameData->_byteSize = byteSize;
+        bytes += byteSize;
+        lastFrame = frameData;
+    }
+    if (reader.isFailed() || !reader.isEnd()) return fail();
+
+    animationData->_frames.swap(frames);
+    animationData->_isComplete = isComplete != 0;
+    animationData->_totalTime = frameCount * FrameTime;
+    animationData->_persisted = true;
+    FrameCacheBudget::getInstance()->resize(animationData, (std::ptrdiff_t)bytes);
+    return true;
+}
+
 void ArmatureCache::resetAllAnimationData() 
 {
     for (auto it = _animationCaches.begin(); it != _animationCaches.end(); it++)
@@ -24,7 +24,11 @@
 #pragma once
 
 #include "IOBuffer.h"
+#include "PackedMesh.h"
+#include "FrameCacheBudget.h"
+#include "FrameCacheFile.h"
 #include "CCArmatureDisplay.h"
+#include <memory>
 
 DRAGONBONES_NAMESPACE_BEGIN
 
@@ -49,17 +53,27 @@ public:
     struct ColorData {
         cocos2d::Color4F color;
         std::size_t vertexFloatOffset = 0;
+
+        bool operator==(const ColorData& other) const
+        {
+            return color == other.color && vertexFloatOffset == other.vertexFloatOffset;
+        }
     };
 
+    /**
+     * A baked frame. Vertices are kept in a PackedMesh without colors, the colors
+     * of the vertices are given by the color runs, which are shared with the
+     * previous frame when they didn't change.
+     */
     struct FrameData {
         friend class ArmatureCache;
 
         FrameData();
         ~FrameData();
 
-        const std::vector<ColorData*>& getColors() const 
+        const std::vector<ColorData>& getColors() const 
         {
-            return _colors;
+            return *_colors;
         }
         std::size_t getColorCount() const;
 
@@ -68,18 +82,25 @@ public:
             return _segments;
         }
         std::size_t getSegmentCount() const;
+
+        const cocos2d::middleware::PackedMesh& getMesh() const
+        {
+            return _mesh;
+        }
+        std::size_t getByteSize() const
+        {
+            return _byteSize;
+        }
     private:
         SegmentData* buildSegmentData(std::size_t index);
-        ColorData* buildColorData(std::size_t index);
 
-        std::vector<ColorData*> _colors;
+        std::shared_ptr<const std::vector<ColorData>> _colors;
         std::vector<SegmentData*> _segments;
-    public:
-        cocos2d::middleware::IOBuffer ib;
-        cocos2d::middleware::IOBuffer vb;
+        cocos2d::middleware::PackedMesh _mesh;
+        std::size_t _byteSize = 0;
     };
 
-    struct AnimationData {
+    struct AnimationData : public cocos2d::middleware::ICachedAnimation {
         friend class ArmatureCache;
 
         AnimationData();
@@ -91,6 +112,8 @@ public:
 
         bool isComplete() const { return _isComplete; }
         bool needUpdate(int toFrameIdx) const;
+
+        virtual void evictFrames() override;
     private:
         FrameData* buildFrameData(std::size_t frameIdx);
     private:
@@ -98,6 +121,8 @@ public:
         bool _isComplete = false;
         float _totalTime = 0.0f;
         std::vector<FrameData*> _frames;
+        // Whether the file of the animation holds the current frames.
+        bool _persisted = false;
     };
 
     ArmatureCache(const std::string& armatureName, const std::string& armatureKey, const std::string& atlasUUID);
@@ -113,11 +138,20 @@ public:
 private:
     void renderAnimationFrame(AnimationData* animationData);
     void traverseArmature(Armature* armature, float parentOpacity = 1.0f);
+
+    uint64_t getSourceHash();
+    void collectTextures(std::map<int, cocos2d::middleware::Texture2D*>& textures);
+    bool loadAnimationData(AnimationData* animationData);
+    void saveAnimationData(AnimationData* animationData);
 public:
     static float FrameTime;
     static float MaxCacheTime;
 private:
     FrameData* _frameData = nullptr;
+    // Scratch buffers of the frame being baked, packed into _frameData once the armature is traversed.
+    cocos2d::middleware::IOBuffer _vb;
+    cocos2d::middleware::IOBuffer _ib;
+    std::vector<ColorData> _colors;
     cocos2d::Color4F _preColor = cocos2d::Color4F(-1.0f, -1.0f, -1.0f, -1.0f);
     cocos2d::Color4F _color = cocos2d::Color4F(1.0f, 1.0f, 1.0f, 1.0f);
     CCArmatureDisplay* _armatureDisplay = nullptr;
@@ -131,6 +165,9 @@ private:
     cocos2d::renderer::BlendFactor _curBlendSrc;
     cocos2d::renderer::BlendFactor _curBlendDst;
     std::string _curAnimationName = "";
+    // Armature name, armature key and atlas uuid, identifies the files of the baked animations.
+    std::string _cacheKey = "";
+    std::string _atlasUUID = "";
     std::map<std::string, AnimationData*> _animationCaches;
 };
 
@@ -161,20 +161,21 @@ void CCArmatureCacheDisplay::render(float dt)
     middleware::MeshBuffer* mb = mgr->getMeshBuffer(VF_XYUVC);
     middleware::IOBuffer& vb = mb->getVB();
     middleware::IOBuffer& ib = mb->getIB();
-    const auto& srcVB = frameData->vb;
-    const auto& srcIB = frameData->ib;
+    const auto& srcMesh = frameData->getMesh();
+    const unsigned short* srcIB = srcMesh.getIndices();
 
     const cocos2d::Mat4& nodeWorldMat = _nodeProxy->getWorldMatrix();
 
     int colorOffset = 0;
-    ArmatureCache::ColorData* nowColor = colors[colorOffset++];
+    const ArmatureCache::ColorData* nowColor = &colors[colorOffset++];
     auto maxVFOffset = nowColor->vertexFloatOffset;
 
     Color4B color;
     float tempR = 0.0f, tempG = 0.0f, tempB = 0.0f, tempA = 0.0f;
     float multiplier = 1.0f;
-    std::size_t srcVertexBytesOffset = 0;
-    std::size_t srcIndexBytesOffset = 0;
+    std::size_t srcVertexOffset = 0;
+    std::size_t srcIndexOffset = 0;
+    std::size_t vertexCount = 0;
     std::size_t vertexBytes = 0;
     std::size_t indexBytes = 0;
     GLuint textureHandle = 0;
@@ -184,19 +185,10 @@ void CCArmatureCacheDisplay::render(float dt)
     float* dstVertexBuffer = nullptr;
     unsigned int* dstColorBuffer = nullptr;
     unsigned short* dstIndexBuffer = nullptr;
-    bool needColor = false;
     BlendFactor curBlendSrc = BlendFactor::ONE;
     BlendFactor curBlendDst = BlendFactor::ZERO;
 
-    if (abs(_nodeColor.r - 1.0f) > 0.0001f ||
-        abs(_nodeColor.g - 1.0f) > 0.0001f ||
-        abs(_nodeColor.b - 1.0f) > 0.0001f ||
-        abs(_nodeColor.a - 1.0f) > 0.0001f ||
-        _premultipliedAlpha) {
-        needColor = true;
-    }
-
-    auto handleColor = [&](ArmatureCache::ColorData* colorData) 
+    auto handleColor = [&](const ArmatureCache::ColorData* colorData) 
     {
         tempA = colorData->color.a * _nodeColor.a;
         multiplier = _premultipliedAlpha ? tempA / 255 : 1;
@@ -215,55 +207,46 @@ void CCArmatureCacheDisplay::render(float dt)
     for (std::size_t segIndex = 0, segLen = segments.size(); segIndex < segLen; segIndex++) 
     {
         auto segment = segments[segIndex];
+        vertexCount = segment->vertexFloatCount / 5;
         vertexBytes = segment->vertexFloatCount * sizeof(float);
 
         vb.checkSpace(vertexBytes, true);
         dstVertexOffset = vb.getCurPos() / sizeof(V2F_T2F_C4B);
         dstVertexBuffer = (float*)vb.getCurBuffer();
         dstColorBuffer = (unsigned int*)vb.getCurBuffer();
-        vb.writeBytes((char*)srcVB.getBuffer() + srcVertexBytesOffset, vertexBytes);
+        srcMesh.unpack(srcVertexOffset, vertexCount, dstVertexBuffer, 5);
+        vb.move((int)vertexBytes);
 
         if (_batch) 
         {
-            cocos2d::Vec3* point = nullptr;
-            float tempZ = 0.0f;
-            for (auto posIndex = 0; posIndex < segment->vertexFloatCount; posIndex += 5)
-            {
-                point = (cocos2d::Vec3*)(dstVertexBuffer + posIndex);
-                tempZ = point->z;
-                point->z = 0;
-                nodeWorldMat.transformPoint(point);
-                point->z = tempZ;
-            }
+            cocos2d::MathUtil::transformVec2Batch(nodeWorldMat.m, dstVertexBuffer, segment->vertexFloatCount / 5, 5);
         }
 
-        if (needColor) 
+        // Baked vertices hold no colors, they are written from the color runs of the frame.
+        auto frameFloatOffset = srcVertexOffset * 5;
+        for (auto colorIndex = 0; colorIndex < segment->vertexFloatCount; colorIndex += 5, frameFloatOffset += 5)
         {
-            auto frameFloatOffset = srcVertexBytesOffset / sizeof(float);
-            for (auto colorIndex = 0; colorIndex < segment->vertexFloatCount; colorIndex += 5, frameFloatOffset += 5)
+            if (frameFloatOffset >= maxVFOffset) 
             {
-                if (frameFloatOffset >= maxVFOffset) 
-                {
-                    nowColor = colors[colorOffset++];
-                    handleColor(nowColor);
-                    maxVFOffset = nowColor->vertexFloatOffset;
-                }
-                memcpy(dstColorBuffer + colorIndex + 4, &color, sizeof(color));
+                nowColor = &colors[colorOffset++];
+                handleColor(nowColor);
+                maxVFOffset = nowColor->vertexFloatOffset;
             }
+            memcpy(dstColorBuffer + colorIndex + 4, &color, sizeof(color));
         }
 
-        srcVertexBytesOffset += vertexBytes;
+        srcVertexOffset += vertexCount;
 
         indexBytes = segment->indexCount * sizeof(unsigned short);
         ib.checkSpace(indexBytes, true);
         assembler->updateIARange(segIndex, (int)ib.getCurPos() / sizeof(unsigned short), (int)segment->indexCount);
         dstIndexBuffer = (unsigned short*)ib.getCurBuffer();
-        ib.writeBytes((char*)srcIB.getBuffer() + srcIndexBytesOffset, indexBytes);
+        ib.writeBytes((const char*)(srcIB + srcIndexOffset), indexBytes);
         for (auto indexPos = 0; indexPos < segment->indexCount; indexPos++) 
         {
             dstIndexBuffer[indexPos] += dstVertexOffset;
         }
-        srcIndexBytesOffset += indexBytes;
+        srcIndexOffset += segment->indexCount;
 
         assembler->updateIABuffer(segIndex, mb->getGLVB(), mb->getGLIB());
 
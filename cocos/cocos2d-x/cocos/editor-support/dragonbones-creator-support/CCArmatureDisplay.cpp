@@ -26,6 +26,8 @@
 #include "renderer/renderer/Pass.h"
 #include "renderer/renderer/Technique.h"
 #include "renderer/gfx/Texture.h"
+#include <algorithm>
+#include <cfloat>
 
 USING_NS_CC;
 USING_NS_MW;
@@ -91,6 +93,24 @@ void CCArmatureDisplay::dbClear()
 
 void CCArmatureDisplay::dbUpdate() {}
 
+float CCArmatureDisplay::dbAdvanceTime(float passedTime)
+{
+    // Child armatures follow the node of the root display, armatures without a node always advance.
+    auto node = getRootDisplay()->_nodeProxy;
+    if (node == nullptr)
+    {
+        return passedTime;
+    }
+    
+    float time = _updateLOD.step(node, passedTime);
+    if (!_updateLOD.isUpdated())
+    {
+        return -1.0f;
+    }
+    _armature->updateConstraints = _updateLOD.needsConstraints();
+    return time;
+}
+
 void CCArmatureDisplay::dbRender()
 {
     if (_nodeProxy == nullptr)
@@ -109,6 +129,10 @@ void CCArmatureDisplay::dbRender()
     if (this->_armature->getParent())
         return;
     
+    // The pose didn't change and the node is off screen, the bounds of the last render are kept for culling.
+    if (_updateLOD.canSkipRender())
+        return;
+    
     auto mgr = MiddlewareManager::getInstance();
     if (!mgr->isRendering) return;
     
@@ -120,6 +144,8 @@ void CCArmatureDisplay::dbRender()
     
     _debugSlotsLen = 0;
     _materialLen = 0;
+    _boundsMin.set(FLT_MAX, FLT_MAX);
+    _boundsMax.set(-FLT_MAX, -FLT_MAX);
     
     traverseArmature(_armature);
     if (_preISegWritePos != -1)
@@ -127,6 +153,15 @@ void CCArmatureDisplay::dbRender()
 		_assembler->updateIARange(_materialLen - 1, _preISegWritePos, _curISegLen);
     }
     
+    if (_boundsMin.x <= _boundsMax.x)
+    {
+        _assembler->setLocalBounds(Vec3(_boundsMin.x, _boundsMin.y, 0), Vec3(_boundsMax.x, _boundsMax.y, 0));
+    }
+    else
+    {
+        _assembler->clearLocalBounds();
+    }
+    
     if (_debugDraw)
     {
         if (_debugBuffer == nullptr)
@@ -203,7 +238,6 @@ CCArmatureDisplay* CCArmatureDisplay::getRootDisplay()
 
 void CCArmatureDisplay::traverseArmature(Armature* armature, float parentOpacity)
 {
-    static cocos2d::Mat4 matrixTemp;
     const cocos2d::Mat4& nodeWorldMat = _nodeProxy->getWorldMatrix();
     
     auto& slots = armature->getSlots();
@@ -343,11 +377,8 @@ void CCArmatureDisplay::traverseArmature(Armature* armature, float parentOpacity
         b = _nodeColor.b * slot->color.b * multiplier;
         
         middleware::Triangles& triangles = slot->triangles;
-        cocos2d::Mat4* worldMatrix = &slot->worldMatrix;
-        if (_batch) {
-            cocos2d::Mat4::multiply(nodeWorldMat, *worldMatrix, &matrixTemp);
-            worldMatrix = &matrixTemp;
-        }
+        const cocos2d::Mat4& slotMatrix = slot->worldMatrix;
+        const float* nm = nodeWorldMat.m;
         
         middleware::V2F_T2F_C4B* worldTriangles = slot->worldVerts;
         
@@ -355,8 +386,22 @@ void CCArmatureDisplay::traverseArmature(Armature* armature, float parentOpacity
         {
             middleware::V2F_T2F_C4B* vertex = triangles.verts + v;
             middleware::V2F_T2F_C4B* worldVertex = worldTriangles + v;
-            worldVertex->vertex.x = vertex->vertex.x * worldMatrix->m[0] + vertex->vertex.y * worldMatrix->m[4] + worldMatrix->m[12];
-            worldVertex->vertex.y = vertex->vertex.x * worldMatrix->m[1] + vertex->vertex.y * worldMatrix->m[5] + worldMatrix->m[13];
+            float x = vertex->vertex.x * slotMatrix.m[0] + vertex->vertex.y * slotMatrix.m[4] + slotMatrix.m[12];
+            float y = vertex->vertex.x * slotMatrix.m[1] + vertex->vertex.y * slotMatrix.m[5] + slotMatrix.m[13];
+            _boundsMin.x = std::min(_boundsMin.x, x);
+            _boundsMin.y = std::min(_boundsMin.y, y);
+            _boundsMax.x = std::max(_boundsMax.x, x);
+            _boundsMax.y = std::max(_boundsMax.y, y);
+            if (_batch)
+            {
+                worldVertex->vertex.x = x * nm[0] + y * nm[4] + nm[12];
+                worldVertex->vertex.y = x * nm[1] + y * nm[5] + nm[13];
+            }
+            else
+            {
+                worldVertex->vertex.x = x;
+                worldVertex->vertex.y = y;
+            }
             
             worldVertex->color.r = (GLubyte)r;
             worldVertex->color.g = (GLubyte)g;
@@ -37,6 +37,7 @@
 #include "middleware-adapter.h"
 #include "renderer/scene/assembler/CustomAssembler.hpp"
 #include "renderer/Types.h"
+#include "UpdateLOD.h"
 
 DRAGONBONES_NAMESPACE_BEGIN
 /**
@@ -81,6 +82,10 @@ public:
      * @inheritDoc
      */
     virtual void dbRender() override;
+    /**
+     * @inheritDoc
+     */
+    virtual float dbAdvanceTime(float passedTime) override;
     /**
      * @inheritDoc
      */
@@ -174,6 +179,14 @@ public:
         _premultipliedAlpha = value;
     }
     
+    /**
+     * @brief Gets the update rate policy, armatures small or off screen are updated less often.
+     */
+    cocos2d::middleware::UpdateLOD& getUpdateLOD()
+    {
+        return _updateLOD;
+    }
+    
     /**
      * @brief Convert component position to global position.
      * @param[in] pos Component position
@@ -208,6 +221,10 @@ private:
     cocos2d::renderer::NodeProxy* _nodeProxy = nullptr;
     cocos2d::renderer::Effect* _effect = nullptr;
     cocos2d::renderer::CustomAssembler* _assembler = nullptr;
+    cocos2d::middleware::UpdateLOD _updateLOD;
+    // Local bounds of the vertices written by traverseArmature.
+    cocos2d::Vec2 _boundsMin;
+    cocos2d::Vec2 _boundsMax;
 };
 
 DRAGONBONES_NAMESPACE_END
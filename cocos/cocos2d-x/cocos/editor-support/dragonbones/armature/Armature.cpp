@@ -59,6 +59,7 @@ void Armature::_onClear()
     }
 
     inheritAnimation = true;
+    updateConstraints = true;
     userData = nullptr;
 
     _debugDraw = false;
@@ -195,6 +196,12 @@ void Armature::advanceTime(float passedTime)
         return;
     }
 
+    passedTime = _proxy->dbAdvanceTime(passedTime);
+    if (passedTime < 0.0f) // Skipped by the proxy in this frame.
+    {
+        return;
+    }
+
     const auto prevCacheFrameIndex = _cacheFrameIndex;
 
     _animation->advanceTime(passedTime);
@@ -70,6 +70,17 @@ public:
      * @language zh_CN
      */
     bool inheritAnimation;
+    /**
+     * - Whether to update the IK and path constraints, an engine can turn them off for armatures too small on screen to show them.
+     * @default true
+     * @language en_US
+     */
+    /**
+     * - 是否更新 IK 和路径约束，引擎可以为屏幕上过小的骨架关闭它们。
+     * @default true
+     * @language zh_CN
+     */
+    bool updateConstraints;
     /**
      * @private
      */
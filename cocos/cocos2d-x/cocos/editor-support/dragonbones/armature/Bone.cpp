@@ -296,7 +296,7 @@ void Bone::update(int cacheFrameIndex)
         }
         else 
         {
-            if (_hasConstraint) // Update constraints.
+            if (_hasConstraint && _armature->updateConstraints) // Update constraints.
             {
                 for (const auto constraint : _armature->_constraints) 
                 {
@@ -326,7 +326,7 @@ void Bone::update(int cacheFrameIndex)
     }
     else 
     {
-        if (_hasConstraint) // Update constraints.
+        if (_hasConstraint && _armature->updateConstraints) // Update constraints.
         {
             for (const auto constraint : _armature->_constraints)
             {
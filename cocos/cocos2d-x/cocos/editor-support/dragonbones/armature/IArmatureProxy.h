@@ -61,6 +61,14 @@ public:
      * @internal
      */
     virtual void dbRender() = 0;
+    /**
+     * - Filters the time the armature advances by, a negative time skips the update of this frame.
+     * @internal
+     */
+    virtual float dbAdvanceTime(float passedTime)
+    {
+        return passedTime;
+    }
     /**
      * - Dispose the instance and the Armature instance. (The Armature instance will return to the object pool)
      * @example
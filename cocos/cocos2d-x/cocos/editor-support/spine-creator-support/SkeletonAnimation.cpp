@@ -114,6 +114,7 @@ SkeletonAnimation* SkeletonAnimation::createWithBinaryFile (const std::string& s
 
 void SkeletonAnimation::initialize () {
     super::initialize();
+    SpineAllocator::Scope scope(_arena);
 
     _ownsAnimationStateData = true;
     _state = new (__FILE__, __LINE__) AnimationState(new (__FILE__, __LINE__) AnimationStateData(_skeleton->getData()));
@@ -142,17 +143,58 @@ SkeletonAnimation::~SkeletonAnimation () {
 
 void SkeletonAnimation::update (float deltaTime) {
 	if (!_skeleton) return;
-    if (!_paused) {
-        deltaTime *= _timeScale * GlobalTimeScale;
+    // Stepped while paused too, so that the level follows the node back on screen.
+    deltaTime = _updateLOD.step(_nodeProxy, _paused ? 0 : deltaTime * _timeScale * GlobalTimeScale);
+    if (!_paused && _updateLOD.isUpdated()) {
+        SpineAllocator::Scope scope(_arena);
+        
+        // Listeners call into script, on a worker thread their events stay queued until postUpdate.
+        bool deferEvents = cocos2d::middleware::MiddlewareManager::getInstance()->isParallelUpdating;
+        if (deferEvents) _state->disableQueue();
+        
         if (_ownsSkeleton) _skeleton->update(deltaTime);
         _state->update(deltaTime);
         _state->apply(*_skeleton);
-        _skeleton->updateWorldTransform();
+        if (_updateLOD.needsConstraints()) {
+            _skeleton->updateWorldTransform();
+        } else {
+            _skeleton->updateWorldTransformWithoutConstraints();
+        }
+        
+        if (deferEvents) _state->enableQueue();
     }
 }
 
+bool SkeletonAnimation::isParallelUpdatable () const {
+    // A shared skeleton is posed by every animation using it. Listeners may change other skeletons,
+    // they must be called back before the skeletons after this one in the update list are updated.
+    return _ownsSkeleton && !hasListeners();
+}
+
+bool SkeletonAnimation::hasListeners () const {
+    if (_startListener || _interruptListener || _endListener || _disposeListener || _completeListener || _eventListener) return true;
+    if (!_state) return false;
+    
+    // Entries given their own listeners, queued ones and the ones still mixed out included.
+    auto& tracks = _state->getTracks();
+    for (size_t i = 0; i < tracks.size(); i++) {
+        for (TrackEntry* entry = tracks[i]; entry; entry = entry->getNext()) {
+            for (TrackEntry* from = entry; from; from = from->getMixingFrom()) {
+                if (from->getRendererObject()) return true;
+            }
+        }
+    }
+    return false;
+}
+
+void SkeletonAnimation::postUpdate () {
+    SpineAllocator::Scope scope(_arena);
+    if (_state) _state->drainQueue();
+}
+
 void SkeletonAnimation::setAnimationStateData (AnimationStateData* stateData) {
     CCASSERT(stateData, "stateData cannot be null.");
+    SpineAllocator::Scope scope(_arena);
 
 	if (_state) {
     	if (_ownsAnimationStateData) delete _state->getData();
@@ -166,12 +208,15 @@ void SkeletonAnimation::setAnimationStateData (AnimationStateData* stateData) {
 }
 
 void SkeletonAnimation::setMix (const std::string& fromAnimation, const std::string& toAnimation, float duration) {
+    SpineAllocator::Scope scope(_arena);
     if (_state) {
     	_state->getData()->setMix(fromAnimation.c_str(), toAnimation.c_str(), duration);
 	}
 }
 
 TrackEntry* SkeletonAnimation::setAnimation (int trackIndex, const std::string& name, bool loop) {
+    // Track entries and the queued events belong to the skeleton as much as its bones do.
+    SpineAllocator::Scope scope(_arena);
 	if (!_skeleton) return 0;
     Animation* animation = _skeleton->getData()->findAnimation(name.c_str());
     if (!animation) {
@@ -184,6 +229,7 @@ TrackEntry* SkeletonAnimation::setAnimation (int trackIndex, const std::string&
 }
 
 TrackEntry* SkeletonAnimation::addAnimation (int trackIndex, const std::string& name, bool loop, float delay) {
+    SpineAllocator::Scope scope(_arena);
 	if (!_skeleton) return 0;
     Animation* animation = _skeleton->getData()->findAnimation(name.c_str());
     if (!animation) {
@@ -194,6 +240,7 @@ TrackEntry* SkeletonAnimation::addAnimation (int trackIndex, const std::string&
 }
 
 TrackEntry* SkeletonAnimation::setEmptyAnimation (int trackIndex, float mixDuration) {
+    SpineAllocator::Scope scope(_arena);
 	if (_state) {
     	return _state->setEmptyAnimation(trackIndex, mixDuration);
 	}
@@ -201,12 +248,14 @@ TrackEntry* SkeletonAnimation::setEmptyAnimation (int trackIndex, float mixDurat
 }
 
 void SkeletonAnimation::setEmptyAnimations (float mixDuration) {
+    SpineAllocator::Scope scope(_arena);
     if (_state) {
         _state->setEmptyAnimations(mixDuration);
     }
 }
 
 TrackEntry* SkeletonAnimation::addEmptyAnimation (int trackIndex, float mixDuration, float delay) {
+    SpineAllocator::Scope scope(_arena);
     if (_state) {
         return _state->addEmptyAnimation(trackIndex, mixDuration, delay);
     }
@@ -228,12 +277,14 @@ TrackEntry* SkeletonAnimation::getCurrent (int trackIndex) {
 }
 
 void SkeletonAnimation::clearTracks () {
+    SpineAllocator::Scope scope(_arena);
     if (_state) {
         _state->clearTracks();
     }
 }
 
 void SkeletonAnimation::clearTrack (int trackIndex) {
+    SpineAllocator::Scope scope(_arena);
     if (_state) {
         _state->clearTrack(trackIndex);
     }
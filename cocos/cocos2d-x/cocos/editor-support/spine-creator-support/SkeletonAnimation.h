@@ -60,6 +60,8 @@ public:
     }
 
     virtual void update (float deltaTime) override;
+    virtual bool isParallelUpdatable () const override;
+    virtual void postUpdate () override;
 
     void setAnimationStateData (AnimationStateData* stateData);
     void setMix (const std::string& fromAnimation, const std::string& toAnimation, float duration);
@@ -110,6 +112,7 @@ protected:
     CompleteListener        _completeListener = nullptr;
     EventListener           _eventListener = nullptr;
 private:
+    bool hasListeners () const;
     typedef SkeletonRenderer super;
 };
 
@@ -30,6 +30,10 @@
 #include "SkeletonCache.h"
 #include "spine-creator-support/AttachmentVertices.h"
 #include "renderer/gfx/Texture.h"
+#include "base/CCThreadPool.h"
+#include <mutex>
+#include <atomic>
+#include <thread>
 
 USING_NS_CC;
 USING_NS_MW;
@@ -37,6 +41,62 @@ using namespace cocos2d::renderer;
 
 namespace spine {
     
+    /**
+     * Bake jobs run on their own thread, a job bakes until its animation completes and
+     * would otherwise hold a thread of the default pool used by asset loading.
+     */
+    static ThreadPool* getBakeThreadPool () {
+        static ThreadPool* pool = ThreadPool::newSingleThreadPool();
+        return pool;
+    }
+    
+    /**
+     * Bakes the frames of one animation on a worker thread. The job owns its own
+     * skeleton and animation state so that it never touches the ones of the cache,
+     * baked frames wait in the job until the main thread publishes them.
+     */
+    struct SkeletonCache::BakeJob {
+        enum State {
+            QUEUED,
+            RUNNING,
+            DONE,
+        };
+        
+        ~BakeJob () {
+            discardFrames();
+            if (state) delete state;
+            if (skeleton) delete skeleton;
+            if (clipper) delete clipper;
+        }
+        
+        // Frames which aren't published hold no reference to their textures.
+        void discardFrames () {
+            for (auto frameData : baked) {
+                for (auto segment : frameData->_segments) {
+                    segment->_texture = nullptr;
+                }
+                delete frameData;
+            }
+            baked.clear();
+        }
+        
+        Skeleton* skeleton = nullptr;
+        AnimationState* state = nullptr;
+        SkeletonClipping* clipper = nullptr;
+        
+        middleware::IOBuffer vb;
+        middleware::IOBuffer ib;
+        std::vector<ColorData> colors;
+        const FrameData* lastFrame = nullptr;
+        float totalTime = 0.0f;
+        bool complete = false;
+        
+        std::mutex mutex;
+        std::vector<FrameData*> baked;
+        std::atomic<bool> cancelled{false};
+        std::atomic<int> status{QUEUED};
+    };
+    
     float SkeletonCache::FrameTime = 1.0f / 60.0f;
     float SkeletonCache::MaxCacheTime = 120.0f;
     
@@ -63,28 +123,14 @@ namespace spine {
     }
     
     SkeletonCache::FrameData::~FrameData () {
-        for (std::size_t i = 0, c = _colors.size(); i < c; i++) {
-            delete _colors[i];
-        }
-        _colors.clear();
-        
         for (std::size_t i = 0, c = _segments.size(); i < c; i++) {
             delete _segments[i];
         }
         _segments.clear();
     }
     
-    SkeletonCache::ColorData* SkeletonCache::FrameData::buildColorData (std::size_t index) {
-        if (index > _colors.size()) return nullptr;
-        if (index == _colors.size()) {
-            ColorData* colorData = new ColorData;
-            _colors.push_back(colorData);
-        }
-        return _colors[index];
-    }
-    
     std::size_t SkeletonCache::FrameData::getColorCount () const {
-        return _colors.size();
+        return _colors ? _colors->size() : 0;
     }
     
     SkeletonCache::SegmentData* SkeletonCache::FrameData::buildSegmentData (std::size_t index) {
@@ -101,41 +147,84 @@ namespace spine {
     }
 
     SkeletonCache::AnimationData::AnimationData () {
-        
+        FrameCacheBudget::getInstance()->addAnimation(this);
     }
 
     SkeletonCache::AnimationData::~AnimationData () {
         reset();
+        FrameCacheBudget::getInstance()->removeAnimation(this);
     }
     
     void SkeletonCache::AnimationData::reset () {
+        stopBake();
         for (std::size_t i = 0, c = _frames.size(); i < c; i++) {
             delete _frames[i];
         }
         _frames.clear();
         _isComplete = false;
         _totalTime = 0.0f;
+        _persisted = false;
+        FrameCacheBudget::getInstance()->resize(this, -(std::ptrdiff_t)getCachedBytes());
     }
     
-    bool SkeletonCache::AnimationData::needUpdate (int toFrameIdx) const {
-        return !_isComplete && _totalTime <= MaxCacheTime && (toFrameIdx == -1 || _frames.size() < toFrameIdx + 1);
+    void SkeletonCache::AnimationData::evictFrames () {
+        reset();
     }
     
-    SkeletonCache::FrameData* SkeletonCache::AnimationData::buildFrameData (std::size_t frameIdx) {
-        if (frameIdx > _frames.size()) {
-            return nullptr;
+    void SkeletonCache::AnimationData::stopBake () {
+        if (!_bakeJob) return;
+        
+        _bakeJob->cancelled = true;
+        int queued = BakeJob::QUEUED;
+        if (!_bakeJob->status.compare_exchange_strong(queued, BakeJob::DONE)) {
+            while (_bakeJob->status.load() != BakeJob::DONE) {
+                std::this_thread::yield();
+            }
+        }
+        _bakeJob->discardFrames();
+        _bakeJob = nullptr;
+    }
+    
+    void SkeletonCache::AnimationData::publishFrames () {
+        if (!_bakeJob) return;
+        
+        // Read the status first, so that no frame baked before DONE is missed.
+        bool done = _bakeJob->status.load() == BakeJob::DONE;
+        std::vector<FrameData*> baked;
+        {
+            std::lock_guard<std::mutex> lock(_bakeJob->mutex);
+            baked.swap(_bakeJob->baked);
         }
-        if (frameIdx == _frames.size()) {
-            auto frameData = new FrameData();
+        
+        std::size_t bytes = 0;
+        for (auto frameData : baked) {
+            for (auto segment : frameData->_segments) {
+                CC_SAFE_RETAIN(segment->_texture);
+            }
             _frames.push_back(frameData);
+            _totalTime += FrameTime;
+            bytes += frameData->_byteSize;
+        }
+        
+        if (done) {
+            _isComplete = _bakeJob->complete;
+            _bakeJob = nullptr;
+        }
+        
+        if (bytes > 0) {
+            FrameCacheBudget::getInstance()->resize(this, (std::ptrdiff_t)bytes);
         }
-        return _frames[frameIdx];
+    }
+    
+    bool SkeletonCache::AnimationData::needUpdate (int toFrameIdx) const {
+        return !_isComplete && _totalTime <= MaxCacheTime && (toFrameIdx == -1 || _frames.size() < toFrameIdx + 1);
     }
     
     SkeletonCache::FrameData* SkeletonCache::AnimationData::getFrameData (std::size_t frameIdx) const {
         if (frameIdx >= _frames.size()) {
             return nullptr;
         }
+        FrameCacheBudget::getInstance()->touch(this);
         return _frames[frameIdx];
     }
     
@@ -194,33 +283,129 @@ namespace spine {
         }
         
         AnimationData* animationData = it->second;
-        if (!animationData || !animationData->needUpdate(toFrameIdx)) {
+        if (!animationData) return;
+        
+        animationData->publishFrames();
+        if (!animationData->_bakeJob && !animationData->needUpdate(-1) && !animationData->_persisted) {
+            saveAnimationData(animationData);
+        }
+        if (!animationData->needUpdate(toFrameIdx) || animationData->_bakeJob) {
             return;
         }
         
-        if (_curAnimationName != animationName) {
-            updateToFrame(_curAnimationName);
-            _curAnimationName = animationName;
+        // A job ends only when the animation completes or exceeds MaxCacheTime,
+        // so a new job always starts from the first frame.
+        if (animationData->getFrameCount() > 0) return;
+        
+        if (loadAnimationData(animationData)) return;
+        
+        auto job = createBakeJob(animationName);
+        if (!job) return;
+        
+        // Bake the first frame at once, so that the animation is never drawn empty.
+        bakeFrame(*job);
+        if (job->complete || job->totalTime > MaxCacheTime) {
+            job->status = BakeJob::DONE;
+        } else {
+            getBakeThreadPool()->pushTask([job](int /*tid*/) {
+                runBakeJob(job);
+            });
         }
+        animationData->_bakeJob = job;
+        animationData->publishFrames();
+    }
+    
+    std::shared_ptr<SkeletonCache::BakeJob> SkeletonCache::createBakeJob (const std::string& animationName) {
+        if (!_skeleton || !_state) return nullptr;
+        auto animation = findAnimation(animationName);
+        if (!animation) return nullptr;
+        
+        auto job = std::make_shared<BakeJob>();
         
-        if (animationData->getFrameCount() == 0) {
-            setAnimation(0, animationName, false);
+        // Start from the current pose of the cache skeleton.
+        Skeleton* skeleton = new (__FILE__, __LINE__) Skeleton(_skeleton->getData());
+        skeleton->setSkin(_skeleton->getSkin());
+        auto& srcSlots = _skeleton->getSlots();
+        auto& dstSlots = skeleton->getSlots();
+        for (size_t i = 0, n = srcSlots.size(); i < n; ++i) {
+            Slot* srcSlot = srcSlots[i];
+            Slot* dstSlot = dstSlots[i];
+            dstSlot->setAttachment(srcSlot->getAttachment());
+            dstSlot->getColor().set(srcSlot->getColor());
+            if (srcSlot->hasDarkColor()) {
+                dstSlot->getDarkColor().set(srcSlot->getDarkColor());
+            }
         }
+        skeleton->getColor().set(_skeleton->getColor());
+        job->skeleton = skeleton;
         
-        do {
-            update(FrameTime);
-            renderAnimationFrame(animationData);
-            animationData->_totalTime += FrameTime;
-        } while (animationData->needUpdate(toFrameIdx));
+        job->state = new (__FILE__, __LINE__) AnimationState(_state->getData());
+        job->state->setRendererObject(job.get());
+        job->state->setListener([](AnimationState* state, EventType type, TrackEntry* entry, Event* event) {
+            if (type == EventType_Complete) {
+                ((BakeJob*)state->getRendererObject())->complete = true;
+            }
+        });
+        job->state->setAnimation(0, animation, false);
+        
+        job->clipper = new (__FILE__, __LINE__) SkeletonClipping();
+        return job;
+    }
+    
+    void SkeletonCache::runBakeJob (const std::shared_ptr<BakeJob>& job) {
+        int queued = BakeJob::QUEUED;
+        if (!job->status.compare_exchange_strong(queued, BakeJob::RUNNING)) {
+            return;
+        }
+        while (!job->cancelled && !job->complete && job->totalTime <= MaxCacheTime) {
+            bakeFrame(*job);
+        }
+        job->status = BakeJob::DONE;
     }
     
-    void SkeletonCache::renderAnimationFrame (AnimationData* animationData) {
-        std::size_t frameIndex = animationData->getFrameCount();
-        FrameData* frameData = animationData->buildFrameData(frameIndex);
+    void SkeletonCache::bakeFrame (BakeJob& job) {
+        job.skeleton->update(FrameTime);
+        job.state->update(FrameTime);
+        job.state->apply(*job.skeleton);
+        job.skeleton->updateWorldTransform();
         
-        if (!_skeleton) return;
+        job.vb.reset();
+        job.ib.reset();
+        job.colors.clear();
+        
+        FrameData* frameData = new FrameData();
+        renderAnimationFrame(job, frameData);
+        
+        // Geometry and colors are packed here, they are shared with the previous frame when unchanged.
+        const FrameData* lastFrame = job.lastFrame;
+        const int vs = sizeof(V2F_T2F_C4B_C4B) / sizeof(float);
+        frameData->_mesh.pack((const float*)job.vb.getBuffer(), job.vb.getCurPos() / sizeof(V2F_T2F_C4B_C4B), vs,
+                              (const uint16_t*)job.ib.getBuffer(), job.ib.getCurPos() / sizeof(unsigned short),
+                              lastFrame ? &lastFrame->_mesh : nullptr);
+        
+        std::size_t byteSize = sizeof(FrameData) + frameData->_mesh.getByteSize();
+        if (lastFrame && *lastFrame->_colors == job.colors) {
+            frameData->_colors = lastFrame->_colors;
+        } else {
+            frameData->_colors = std::make_shared<std::vector<ColorData>>(job.colors);
+            byteSize += job.colors.size() * sizeof(ColorData);
+        }
+        byteSize += frameData->_segments.size() * (sizeof(SegmentData) + sizeof(SegmentData*));
+        frameData->_byteSize = byteSize;
+        
+        job.totalTime += FrameTime;
+        job.lastFrame = frameData;
         
-        if (_skeleton->getColor().a == 0) {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.baked.push_back(frameData);
+    }
+    
+    void SkeletonCache::renderAnimationFrame (BakeJob& job, FrameData* frameData) {
+        Skeleton* skeleton = job.skeleton;
+        SkeletonClipping* clipper = job.clipper;
+        std::vector<ColorData>& colors = job.colors;
+        
+        if (skeleton->getColor().a == 0) {
             return;
         }
         
@@ -230,8 +415,8 @@ namespace spine {
         Color4F darkColor;
         
         AttachmentVertices* attachmentVertices = nullptr;
-        middleware::IOBuffer& vb = frameData->vb;
-        middleware::IOBuffer& ib = frameData->ib;
+        middleware::IOBuffer& vb = job.vb;
+        middleware::IOBuffer& ib = job.ib;
         
         int vbs2 = sizeof(V2F_T2F_C4B_C4B);
         int vs2 = vbs2 / sizeof(float);
@@ -260,7 +445,8 @@ namespace spine {
             }
             
             SegmentData* segmentData = frameData->buildSegmentData(materialLen);
-            segmentData->setTexture(texture);
+            // Retained when the frame is published on the main thread.
+            segmentData->_texture = texture;
             segmentData->blendMode = slot->getData().getBlendMode();
             
             preISegWritePos = (int)ib.getCurPos() / sizeof(unsigned short);
@@ -271,17 +457,17 @@ namespace spine {
             materialLen++;
         };
         
-        auto& drawOrder = _skeleton->getDrawOrder();
+        auto& drawOrder = skeleton->getDrawOrder();
         for (size_t i = 0, n = drawOrder.size(); i < n; ++i) {
             slot = drawOrder[i];
             
             if (!slot->getAttachment()) {
-                _clipper->clipEnd(*slot);
+                clipper->clipEnd(*slot);
                 continue;
             }
             
             if (slot->getColor().a == 0) {
-                _clipper->clipEnd(*slot);
+                clipper->clipEnd(*slot);
                 continue;
             }
             
@@ -292,7 +478,7 @@ namespace spine {
                 attachmentVertices = (AttachmentVertices*)attachment->getRendererObject();
                 
                 if (attachment->getColor().a == 0) {
-                    _clipper->clipEnd(*slot);
+                    clipper->clipEnd(*slot);
                     continue;
                 }
                 
@@ -321,7 +507,7 @@ namespace spine {
                 attachmentVertices = (AttachmentVertices*)attachment->getRendererObject();
                 
                 if (attachment->getColor().a == 0) {
-                    _clipper->clipEnd(*slot);
+                    clipper->clipEnd(*slot);
                     continue;
                 }
                 
@@ -347,22 +533,22 @@ namespace spine {
                 
             } else if (slot->getAttachment()->getRTTI().isExactly(ClippingAttachment::rtti)) {
                 ClippingAttachment* clip = (ClippingAttachment*)slot->getAttachment();
-                _clipper->clipStart(*slot, clip);
+                clipper->clipStart(*slot, clip);
                 continue;
             } else {
-                _clipper->clipEnd(*slot);
+                clipper->clipEnd(*slot);
                 continue;
             }
             
-            color.a = _skeleton->getColor().a * slot->getColor().a * color.a * 255;
+            color.a = skeleton->getColor().a * slot->getColor().a * color.a * 255;
             if (color.a == 0) {
-                _clipper->clipEnd(*slot);
+                clipper->clipEnd(*slot);
                 continue;
             }
             
-            float red = _skeleton->getColor().r * color.r * 255;
-            float green = _skeleton->getColor().g * color.g * 255;
-            float blue = _skeleton->getColor().b * color.b * 255;
+            float red = skeleton->getColor().r * color.r * 255;
+            float green = skeleton->getColor().g * color.g * 255;
+            float blue = skeleton->getColor().b * color.b * 255;
             
             color.r = red * slot->getColor().r;
             color.g = green * slot->getColor().g;
@@ -382,36 +568,35 @@ namespace spine {
             if (preColor != color || preDarkColor != darkColor) {
                 preColor = color;
                 preDarkColor = darkColor;
-                auto colorCount = frameData->getColorCount();
-                if (colorCount > 0) {
-                    ColorData* preColorData = frameData->buildColorData(colorCount - 1);
-                    preColorData->vertexFloatOffset = (int) vb.getCurPos() / sizeof(float);
+                if (colors.size() > 0) {
+                    colors.back().vertexFloatOffset = (int) vb.getCurPos() / sizeof(float);
                 }
-                ColorData* colorData = frameData->buildColorData(colorCount);
-                colorData->finalColor = color;
-                colorData->darkColor = darkColor;
+                colors.push_back(ColorData());
+                colors.back().finalColor = color;
+                colors.back().darkColor = darkColor;
             }
             
-            if (_clipper->isClipping()) {
-                _clipper->clipTriangles((float*)&trianglesTwoColor.verts[0].vertex, trianglesTwoColor.indices, trianglesTwoColor.indexCount, (float*)&trianglesTwoColor.verts[0].texCoord, vs2);
+            if (clipper->isClipping()) {
+                clipper->clipTriangles((float*)&trianglesTwoColor.verts[0].vertex, trianglesTwoColor.indices, trianglesTwoColor.indexCount, (float*)&trianglesTwoColor.verts[0].texCoord, vs2);
                 
-                if (_clipper->getClippedTriangles().size() == 0) {
-                    _clipper->clipEnd(*slot);
+                if (clipper->getClippedTriangles().size() == 0) {
+                    clipper->clipEnd(*slot);
                     continue;
                 }
                 
-                trianglesTwoColor.vertCount = (int)_clipper->getClippedVertices().size() >> 1;
+                trianglesTwoColor.vertCount = (int)clipper->getClippedVertices().size() >> 1;
                 vbSize = trianglesTwoColor.vertCount * sizeof(V2F_T2F_C4B_C4B);
                 vb.checkSpace(vbSize, true);
                 trianglesTwoColor.verts = (V2F_T2F_C4B_C4B*)vb.getCurBuffer();
                 
-                trianglesTwoColor.indexCount = (int)_clipper->getClippedTriangles().size();
+                trianglesTwoColor.indexCount = (int)clipper->getClippedTriangles().size();
                 ibSize = trianglesTwoColor.indexCount * sizeof(unsigned short);
+                ib.checkSpace(ibSize, true);
                 trianglesTwoColor.indices = (unsigned short*)ib.getCurBuffer();
-                memcpy(trianglesTwoColor.indices, _clipper->getClippedTriangles().buffer(), sizeof(unsigned short) * _clipper->getClippedTriangles().size());
+                memcpy(trianglesTwoColor.indices, clipper->getClippedTriangles().buffer(), sizeof(unsigned short) * clipper->getClippedTriangles().size());
                 
-                float* verts = _clipper->getClippedVertices().buffer();
-                float* uvs = _clipper->getClippedUVs().buffer();
+                float* verts = clipper->getClippedVertices().buffer();
+                float* uvs = clipper->getClippedUVs().buffer();
                 
                 for (int v = 0, vn = trianglesTwoColor.vertCount, vv = 0; v < vn; ++v, vv += 2) {
                     V2F_T2F_C4B_C4B* vertex = trianglesTwoColor.verts + v;
@@ -419,26 +604,6 @@ namespace spine {
                     vertex->vertex.y = verts[vv + 1];
                     vertex->texCoord.u = uvs[vv];
                     vertex->texCoord.v = uvs[vv + 1];
-                    vertex->color.r = (GLubyte)color.r;
-                    vertex->color.g = (GLubyte)color.g;
-                    vertex->color.b = (GLubyte)color.b;
-                    vertex->color.a = (GLubyte)color.a;
-                    vertex->color2.r = (GLubyte)darkColor.r;
-                    vertex->color2.g = (GLubyte)darkColor.g;
-                    vertex->color2.b = (GLubyte)darkColor.b;
-                    vertex->color2.a = (GLubyte)darkColor.a;
-                }
-            } else {
-                for (int v = 0, vn = trianglesTwoColor.vertCount; v < vn; ++v) {
-                    V2F_T2F_C4B_C4B* vertex = trianglesTwoColor.verts + v;
-                    vertex->color.r = (GLubyte)color.r;
-                    vertex->color.g = (GLubyte)color.g;
-                    vertex->color.b = (GLubyte)color.b;
-                    vertex->color.a = (GLubyte)color.a;
-                    vertex->color2.r = (GLubyte)darkColor.r;
-                    vertex->color2.g = (GLubyte)darkColor.g;
-                    vertex->color2.b = (GLubyte)darkColor.b;
-                    vertex->color2.a = (GLubyte)darkColor.a;
                 }
             }
             
@@ -464,10 +629,10 @@ namespace spine {
                 curVSegLen += vbSize / sizeof(float);
             }
             
-            _clipper->clipEnd(*slot);
+            clipper->clipEnd(*slot);
         } // End slot traverse
         
-        _clipper->clipEnd();
+        clipper->clipEnd();
         
         if (preISegWritePos != -1) {
             SegmentData* preSegmentData = frameData->buildSegmentData(materialLen - 1);
@@ -475,25 +640,203 @@ namespace spine {
             preSegmentData->vertexFloatCount = curVSegLen;
         }
         
-        auto colorCount = frameData->getColorCount();
-        if (colorCount > 0) {
-            ColorData* preColorData = frameData->buildColorData(colorCount - 1);
-            preColorData->vertexFloatOffset = (int) vb.getCurPos() / sizeof(float);
+        if (colors.size() > 0) {
+            colors.back().vertexFloatOffset = (int) vb.getCurPos() / sizeof(float);
+        }
+    }
+    
+    uint64_t SkeletonCache::getSourceHash () {
+        SkeletonData* data = _skeleton->getData();
+        uint64_t hash = FrameCacheFile::hash(_uuid);
+        hash = FrameCacheFile::hash(data->getHash().buffer(), data->getHash().length(), hash);
+        hash = FrameCacheFile::hash(data->getVersion().buffer(), data->getVersion().length(), hash);
+        hash = FrameCacheFile::hashValue((uint32_t)data->getBones().size(), hash);
+        hash = FrameCacheFile::hashValue((uint32_t)data->getSlots().size(), hash);
+        auto& animations = data->getAnimations();
+        for (size_t i = 0, n = animations.size(); i < n; ++i) {
+            hash = FrameCacheFile::hash(animations[i]->getName().buffer(), animations[i]->getName().length(), hash);
+            hash = FrameCacheFile::hashValue(animations[i]->getDuration(), hash);
+        }
+        
+        // Frames are baked with the current skin.
+        Skin* skin = _skeleton->getSkin();
+        if (skin) {
+            hash = FrameCacheFile::hash(skin->getName().buffer(), skin->getName().length(), hash);
+        }
+        hash = FrameCacheFile::hashValue(FrameTime, hash);
+        hash = FrameCacheFile::hashValue(MaxCacheTime, hash);
+        
+        std::map<int, middleware::Texture2D*> textures;
+        collectTextures(textures);
+        for (auto& it : textures) {
+            hash = FrameCacheFile::hashValue(it.first, hash);
+            hash = FrameCacheFile::hashValue(it.second->getPixelsWide(), hash);
+            hash = FrameCacheFile::hashValue(it.second->getPixelsHigh(), hash);
+        }
+        return hash;
+    }
+    
+    void SkeletonCache::collectTextures (std::map<int, middleware::Texture2D*>& textures) {
+        auto& skins = _skeleton->getData()->getSkins();
+        for (size_t i = 0, n = skins.size(); i < n; ++i) {
+            auto entries = skins[i]->getAttachments();
+            while (entries.hasNext()) {
+                Attachment* attachment = entries.next()._attachment;
+                AttachmentVertices* attachmentVertices = nullptr;
+                if (attachment->getRTTI().isExactly(RegionAttachment::rtti)) {
+                    attachmentVertices = (AttachmentVertices*)((RegionAttachment*)attachment)->getRendererObject();
+                } else if (attachment->getRTTI().isExactly(MeshAttachment::rtti)) {
+                    attachmentVertices = (AttachmentVertices*)((MeshAttachment*)attachment)->getRendererObject();
+                }
+                if (attachmentVertices && attachmentVertices->_texture) {
+                    textures[attachmentVertices->_texture->getRealTextureIndex()] = attachmentVertices->_texture;
+                }
+            }
+        }
+    }
+    
+    void SkeletonCache::saveAnimationData (AnimationData* animationData) {
+        animationData->_persisted = true;
+        if (!FrameCacheFile::isEnabled() || _uuid.empty() || !_skeleton) return;
+        
+        FrameCacheWriter writer(getSourceHash(), animationData->_animationName);
+        writer.writeUint32(animationData->_isComplete ? 1 : 0);
+        writer.writeUint32((uint32_t)animationData->_frames.size());
+        
+        const FrameData* lastFrame = nullptr;
+        for (auto frameData : animationData->_frames) {
+            writer.writeUint32((uint32_t)frameData->_segments.size());
+            for (auto segment : frameData->_segments) {
+                writer.writeUint32((uint32_t)segment->_texture->getRealTextureIndex());
+                writer.writeUint32((uint32_t)segment->blendMode);
+                writer.writeUint32((uint32_t)segment->indexCount);
+                writer.writeUint32((uint32_t)segment->vertexFloatCount);
+            }
+            
+            bool sharedColors = lastFrame && lastFrame->_colors == frameData->_colors;
+            writer.writeUint32(sharedColors ? 1 : 0);
+            if (!sharedColors) {
+                auto& colors = *frameData->_colors;
+                writer.writeUint32((uint32_t)colors.size());
+                for (auto& color : colors) {
+                    writer.writeFloat(color.finalColor.r);
+                    writer.writeFloat(color.finalColor.g);
+                    writer.writeFloat(color.finalColor.b);
+                    writer.writeFloat(color.finalColor.a);
+                    writer.writeFloat(color.darkColor.r);
+                    writer.writeFloat(color.darkColor.g);
+                    writer.writeFloat(color.darkColor.b);
+                    writer.writeFloat(color.darkColor.a);
+                    writer.writeUint32((uint32_t)color.vertexFloatOffset);
+                }
+            }
+            
+            frameData->_mesh.write(writer, lastFrame ? &lastFrame->_mesh : nullptr);
+            lastFrame = frameData;
         }
+        
+        writer.saveAsync(FrameCacheFile::getPath(_uuid, animationData->_animationName));
     }
     
-    void SkeletonCache::onAnimationStateEvent (TrackEntry* entry, EventType type, Event* event) {
-        SkeletonAnimation::onAnimationStateEvent(entry, type, event);
-        if (type == EventType_Complete && entry) {
-            Animation* ani = entry->getAnimation();
-            if (!ani) return;
-            std::string aniName = ani->getName().buffer();
-            if (aniName == _curAnimationName) {
-                AnimationData* aniData = getAnimationData(_curAnimationName);
-                if (!aniData) return;
-                aniData->_isComplete = true;
+    bool SkeletonCache::loadAnimationData (AnimationData* animationData) {
+        if (!FrameCacheFile::isEnabled() || _uuid.empty() || !_skeleton) return false;
+        
+        FrameCacheReader reader;
+        if (!reader.open(FrameCacheFile::getPath(_uuid, animationData->_animationName), getSourceHash(), animationData->_animationName)) {
+            return false;
+        }
+        
+        std::map<int, middleware::Texture2D*> textures;
+        collectTextures(textures);
+        
+        uint32_t isComplete = 0, frameCount = 0;
+        reader.readUint32(isComplete);
+        reader.readUint32(frameCount);
+        
+        std::vector<FrameData*> frames;
+        auto fail = [&]() {
+            for (auto frameData : frames) {
+                delete frameData;
+            }
+            return false;
+        };
+        
+        const FrameData* lastFrame = nullptr;
+        std::size_t bytes = 0;
+        for (uint32_t i = 0; i < frameCount && !reader.isFailed(); i++) {
+            FrameData* frameData = new FrameData();
+            frames.push_back(frameData);
+            
+            uint32_t segmentCount = 0;
+            if (!reader.readUint32(segmentCount)) return fail();
+            std::size_t indexCount = 0, vertexFloatCount = 0;
+            for (uint32_t j = 0; j < segmentCount; j++) {
+                uint32_t textureIndex = 0, blendMode = 0, segmentIndexCount = 0, segmentFloatCount = 0;
+                reader.readUint32(textureIndex);
+                reader.readUint32(blendMode);
+                reader.readUint32(segmentIndexCount);
+                if (!reader.readUint32(segmentFloatCount)) return fail();
+                auto it = textures.find((int)textureIndex);
+                if (it == textures.end()) return fail();
+                
+                SegmentData* segment = frameData->buildSegmentData(j);
+                segment->setTexture(it->second);
+                segment->blendMode = (int)blendMode;
+                segment->indexCount = (int)segmentIndexCount;
+                segment->vertexFloatCount = (int)segmentFloatCount;
+                indexCount += segmentIndexCount;
+                vertexFloatCount += segmentFloatCount;
+            }
+            
+            uint32_t sharedColors = 0;
+            if (!reader.readUint32(sharedColors)) return fail();
+            std::size_t byteSize = sizeof(FrameData);
+            if (sharedColors) {
+                if (!lastFrame) return fail();
+                frameData->_colors = lastFrame->_colors;
+            } else {
+                uint32_t colorCount = 0;
+                if (!reader.readUint32(colorCount) || colorCount > reader.getRemaining() / (9 * sizeof(float))) return fail();
+                auto colors = std::make_shared<std::vector<ColorData>>(colorCount);
+                for (auto& color : *colors) {
+                    uint32_t vertexFloatOffset = 0;
+                    reader.readFloat(color.finalColor.r);
+                    reader.readFloat(color.finalColor.g);
+                    reader.readFloat(color.finalColor.b);
+                    reader.readFloat(color.finalColor.a);
+                    reader.readFloat(color.darkColor.r);
+                    reader.readFloat(color.darkColor.g);
+                    reader.readFloat(color.darkColor.b);
+                    reader.readFloat(color.darkColor.a);
+                    reader.readUint32(vertexFloatOffset);
+                    color.vertexFloatOffset = (int)vertexFloatOffset;
+                }
+                frameData->_colors = colors;
+                byteSize += colorCount * sizeof(ColorData);
             }
+            
+            if (!frameData->_mesh.read(reader, lastFrame ? &lastFrame->_mesh : nullptr)) return fail();
+            
+            // The renderer walks the segments and the color runs over the whole mesh.
+            auto& colors = *frameData->_colors;
+            const int vs = sizeof(V2F_T2F_C4B_C4B) / sizeof(float);
+            if (vertexFloatCount != frameData->_mesh.getVertexCount() * vs || indexCount != frameData->_mesh.getIndexCount()) return fail();
+            if (segmentCount > 0 && (colors.empty() || (std::size_t)colors.back().vertexFloatOffset < vertexFloatCount)) return fail();
+            
+            byteSize += frameData->_mesh.getByteSize();
+            byteSize += segmentCount * (sizeof(SegmentData) + sizeof(SegmentData*));
+            frameData->_byteSize = byteSize;
+            bytes += byteSize;
+            lastFrame = frameData;
         }
+        if (reader.isFailed() || !reader.isEnd()) return fail();
+        
+        animationData->_frames.swap(frames);
+        animationData->_isComplete = isComplete != 0;
+        animationData->_totalTime = frameCount * FrameTime;
+        animationData->_persisted = true;
+        FrameCacheBudget::getInstance()->resize(animationData, (std::ptrdiff_t)bytes);
+        return true;
     }
     
     void SkeletonCache::resetAllAnimationData() {
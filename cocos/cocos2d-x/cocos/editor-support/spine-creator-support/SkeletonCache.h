@@ -31,12 +31,18 @@
 
 #include "SkeletonAnimation.h"
 #include "IOBuffer.h"
+#include "PackedMesh.h"
+#include "FrameCacheBudget.h"
+#include "FrameCacheFile.h"
 #include "middleware-adapter.h"
 #include <vector>
+#include <memory>
 
 namespace spine {
     class SkeletonCache: public SkeletonAnimation {
     public:
+        struct BakeJob;
+        
         struct SegmentData {
             friend class SkeletonCache;
             
@@ -57,16 +63,25 @@ namespace spine {
             cocos2d::Color4F finalColor;
             cocos2d::Color4F darkColor;
             int vertexFloatOffset = 0;
+            
+            bool operator== (const ColorData& other) const {
+                return finalColor == other.finalColor && darkColor == other.darkColor && vertexFloatOffset == other.vertexFloatOffset;
+            }
         };
         
+        /**
+         * A baked frame. Vertices are kept in a PackedMesh without colors, the colors
+         * of the vertices are given by the color runs, which are shared with the
+         * previous frame when they didn't change.
+         */
         struct FrameData {
             friend class SkeletonCache;
             
             FrameData ();
             ~FrameData ();
             
-            const std::vector<ColorData*>& getColors () const {
-                return _colors;
+            const std::vector<ColorData>& getColors () const {
+                return *_colors;
             }
             std::size_t getColorCount () const;
             
@@ -74,18 +89,27 @@ namespace spine {
                 return _segments;
             }
             std::size_t getSegmentCount () const;
+            
+            const cocos2d::middleware::PackedMesh& getMesh () const {
+                return _mesh;
+            }
+            std::size_t getByteSize () const {
+                return _byteSize;
+            }
         private:
             SegmentData* buildSegmentData (std::size_t index);
-            ColorData* buildColorData (std::size_t index);
             
-            std::vector<ColorData*> _colors;
+            std::shared_ptr<const std::vector<ColorData>> _colors;
             std::vector<SegmentData*> _segments;
-        public:
-            cocos2d::middleware::IOBuffer ib;
-            cocos2d::middleware::IOBuffer vb;
+            cocos2d::middleware::PackedMesh _mesh;
+            std::size_t _byteSize = 0;
         };
         
-        struct AnimationData {
+        /**
+         * Frames of an animation, baked on a worker thread and published to the
+         * main thread by updateToFrame as they become available.
+         */
+        struct AnimationData : public cocos2d::middleware::ICachedAnimation {
             friend class SkeletonCache;
             
             AnimationData ();
@@ -97,13 +121,19 @@ namespace spine {
             
             bool isComplete () const { return _isComplete; }
             bool needUpdate (int toFrameIdx) const;
+            
+            virtual void evictFrames () override;
         private:
-            FrameData* buildFrameData (std::size_t frameIdx);
+            void publishFrames ();
+            void stopBake ();
         private:
             std::string _animationName = "";
             bool _isComplete = false;
             float _totalTime = 0.0f;
             std::vector<FrameData*> _frames;
+            std::shared_ptr<BakeJob> _bakeJob;
+            // Whether the file of the animation holds the current frames.
+            bool _persisted = false;
         };
         
         SkeletonCache ();
@@ -113,20 +143,31 @@ namespace spine {
         virtual void stopSchedule() override {}
         virtual void update (float deltaTime) override;
         virtual void render (float deltaTime) override {}
-        virtual void onAnimationStateEvent (TrackEntry* entry, EventType type, Event* event) override;
         
+        /**
+         * @brief Publishes the frames baked so far, and starts baking the animation in the background if it isn't complete.
+         * @param[in] animationName Animation to bake.
+         * @param[in] toFrameIdx Frame needed by the caller, -1 for the whole animation.
+         */
         void updateToFrame (const std::string& animationName, int toFrameIdx = -1);
         AnimationData* buildAnimationData (const std::string& animationName);
         AnimationData* getAnimationData (const std::string& animationName);
         void resetAllAnimationData();
         void resetAnimationData(const std::string& animationName);
     private:
-        void renderAnimationFrame (AnimationData* animationData);
+        std::shared_ptr<BakeJob> createBakeJob (const std::string& animationName);
+        static void runBakeJob (const std::shared_ptr<BakeJob>& job);
+        static void bakeFrame (BakeJob& job);
+        static void renderAnimationFrame (BakeJob& job, FrameData* frameData);
+        
+        uint64_t getSourceHash ();
+        void collectTextures (std::map<int, cocos2d::middleware::Texture2D*>& textures);
+        bool loadAnimationData (AnimationData* animationData);
+        void saveAnimationData (AnimationData* animationData);
     public:
         static float FrameTime;
         static float MaxCacheTime;
     private:
-        std::string _curAnimationName = "";
         std::map<std::string, AnimationData*> _animationCaches;
     };
 }
@@ -34,6 +34,7 @@
 #include "renderer/renderer/Technique.h"
 #include "renderer/scene/assembler/CustomAssembler.hpp"
 #include "renderer/gfx/Texture.h"
+#include "math/MathUtil.h"
 
 USING_NS_CC;
 USING_NS_MW;
@@ -151,7 +152,10 @@ namespace spine {
         assembler->setUseModel(!_batch);
         
         if (!_animationData) return;
-        SkeletonCache::FrameData* frameData = _animationData->getFrameData(_curFrameIndex);
+        // Frames are baked in the background, draw the last one available until the current one is ready.
+        int frameCount = (int)_animationData->getFrameCount();
+        if (frameCount == 0 || _curFrameIndex < 0) return;
+        SkeletonCache::FrameData* frameData = _animationData->getFrameData(std::min(_curFrameIndex, frameCount - 1));
         if (!frameData) return;
         
         auto& segments = frameData->getSegments();
@@ -166,22 +170,23 @@ namespace spine {
         middleware::MeshBuffer* mb = mgr->getMeshBuffer(VF_XYUVCC);
         middleware::IOBuffer& vb = mb->getVB();
         middleware::IOBuffer& ib = mb->getIB();
-        const auto& srcVB = frameData->vb;
-        const auto& srcIB = frameData->ib;
+        const auto& srcMesh = frameData->getMesh();
+        const unsigned short* srcIB = srcMesh.getIndices();
         
         const cocos2d::Mat4& nodeWorldMat = _nodeProxy->getWorldMatrix();
 
         int colorOffset = 0;
-        SkeletonCache::ColorData* nowColor = colors[colorOffset++];
+        const SkeletonCache::ColorData* nowColor = &colors[colorOffset++];
         auto maxVFOffset = nowColor->vertexFloatOffset;
         
         Color4B finalColor;
         Color4B darkColor;
         float tempR = 0.0f, tempG = 0.0f, tempB = 0.0f, tempA = 0.0f;
         float multiplier = 1.0f;
-        int srcVertexBytesOffset = 0;
+        int srcVertexOffset = 0;
+        int vertexCount = 0;
         int vertexBytes = 0;
-        int srcIndexBytesOffset = 0;
+        int srcIndexOffset = 0;
         int indexBytes = 0;
         GLuint textureHandle = 0;
         double effectHash = 0;
@@ -190,19 +195,10 @@ namespace spine {
         float* dstVertexBuffer = nullptr;
         unsigned int* dstColorBuffer = nullptr;
         unsigned short* dstIndexBuffer = nullptr;
-        bool needColor = false;
         BlendFactor curBlendSrc = BlendFactor::ONE;
         BlendFactor curBlendDst = BlendFactor::ZERO;
         
-        if (abs(_nodeColor.r - 1.0f) > 0.0001f ||
-            abs(_nodeColor.g - 1.0f) > 0.0001f ||
-            abs(_nodeColor.b - 1.0f) > 0.0001f ||
-            abs(_nodeColor.a - 1.0f) > 0.0001f ||
-            _premultipliedAlpha) {
-            needColor = true;
-        }
-        
-        auto handleColor = [&](SkeletonCache::ColorData* colorData){
+        auto handleColor = [&](const SkeletonCache::ColorData* colorData){
             tempA = colorData->finalColor.a * _nodeColor.a;
             multiplier = _premultipliedAlpha ? tempA / 255 : 1;
             tempR = _nodeColor.r * multiplier;
@@ -224,52 +220,44 @@ namespace spine {
         
         for (std::size_t segIndex = 0, segLen = segments.size(); segIndex < segLen; segIndex++) {
             auto segment = segments[segIndex];
+            vertexCount = segment->vertexFloatCount / 6;
             vertexBytes = segment->vertexFloatCount * sizeof(float);
 
             vb.checkSpace(vertexBytes, true);
             dstVertexOffset = (int)vb.getCurPos() / sizeof(V2F_T2F_C4B_C4B);
             dstVertexBuffer = (float*)vb.getCurBuffer();
             dstColorBuffer = (unsigned int*)vb.getCurBuffer();
-            vb.writeBytes((char*)srcVB.getBuffer() + srcVertexBytesOffset, vertexBytes);
+            srcMesh.unpack(srcVertexOffset, vertexCount, dstVertexBuffer, 6);
+            vb.move(vertexBytes);
             
             if (_batch) {
-                cocos2d::Vec3* point = nullptr;
-                float tempZ = 0.0f;
-                for (auto posIndex = 0; posIndex < segment->vertexFloatCount; posIndex += 6)
-                {
-                    point = (cocos2d::Vec3*)(dstVertexBuffer + posIndex);
-                    tempZ = point->z;
-                    point->z = 0;
-                    nodeWorldMat.transformPoint(point);
-                    point->z = tempZ;
-                }
+                cocos2d::MathUtil::transformVec2Batch(nodeWorldMat.m, dstVertexBuffer, segment->vertexFloatCount / 6, 6);
             }
             
-            if (needColor) {
-                int frameFloatOffset = srcVertexBytesOffset / sizeof(float);
-                for (auto colorIndex = 0; colorIndex < segment->vertexFloatCount; colorIndex += 6, frameFloatOffset += 6)
-                {
-                    if (frameFloatOffset >= maxVFOffset) {
-                        nowColor = colors[colorOffset++];
-                        handleColor(nowColor);
-                        maxVFOffset = nowColor->vertexFloatOffset;
-                    }
-                    memcpy(dstColorBuffer + colorIndex + 4, &finalColor, sizeof(finalColor));
-                    memcpy(dstColorBuffer + colorIndex + 5, &darkColor, sizeof(darkColor));
+            // Baked vertices hold no colors, they are written from the color runs of the frame.
+            int frameFloatOffset = srcVertexOffset * 6;
+            for (auto colorIndex = 0; colorIndex < segment->vertexFloatCount; colorIndex += 6, frameFloatOffset += 6)
+            {
+                if (frameFloatOffset >= maxVFOffset) {
+                    nowColor = &colors[colorOffset++];
+                    handleColor(nowColor);
+                    maxVFOffset = nowColor->vertexFloatOffset;
                 }
+                memcpy(dstColorBuffer + colorIndex + 4, &finalColor, sizeof(finalColor));
+                memcpy(dstColorBuffer + colorIndex + 5, &darkColor, sizeof(darkColor));
             }
             
-            srcVertexBytesOffset += vertexBytes;
+            srcVertexOffset += vertexCount;
             
             indexBytes = segment->indexCount * sizeof(unsigned short);
             ib.checkSpace(indexBytes, true);
             assembler->updateIARange(segIndex, (int)ib.getCurPos() / sizeof(unsigned short), segment->indexCount);
             dstIndexBuffer = (unsigned short*)ib.getCurBuffer();
-            ib.writeBytes((char*)srcIB.getBuffer() + srcIndexBytesOffset, indexBytes);
+            ib.writeBytes((const char*)(srcIB + srcIndexOffset), indexBytes);
             for (auto indexPos = 0; indexPos < segment->indexCount; indexPos ++) {
                 dstIndexBuffer[indexPos] += dstVertexOffset;
             }
-            srcIndexBytesOffset += indexBytes;
+            srcIndexOffset += segment->indexCount;
             
             assembler->updateIABuffer(segIndex, mb->getGLVB(), mb->getGLIB());
             
@@ -38,6 +38,7 @@
 #include "renderer/scene/assembler/CustomAssembler.hpp"
 #include "SkeletonDataMgr.h"
 #include "renderer/gfx/Texture.h"
+#include "math/MathUtil.h"
 
 USING_NS_CC;
 USING_NS_MW;
@@ -91,6 +92,9 @@ SkeletonRenderer* SkeletonRenderer::createWithFile (const std::string& skeletonD
 }
 
 void SkeletonRenderer::initialize () {
+    createArena();
+    SpineAllocator::Scope scope(_arena);
+    
     if (_clipper == nullptr) {
         _clipper = new (__FILE__, __LINE__) SkeletonClipping();
     }
@@ -121,10 +125,19 @@ void SkeletonRenderer::stopSchedule() {
 }
 
 void SkeletonRenderer::setSkeletonData (SkeletonData *skeletonData, bool ownsSkeletonData) {
+    createArena();
+    SpineAllocator::Scope scope(_arena);
+    
     _skeleton = new (__FILE__, __LINE__) Skeleton(skeletonData);
     _ownsSkeletonData = ownsSkeletonData;
 }
 
+void SkeletonRenderer::createArena () {
+    if (_arena == nullptr) {
+        _arena = SpineAllocator::createArena(_uuid);
+    }
+}
+
 SkeletonRenderer::SkeletonRenderer () {
 }
 
@@ -161,6 +174,10 @@ SkeletonRenderer::~SkeletonRenderer () {
     CC_SAFE_RELEASE(_nodeProxy);
     CC_SAFE_RELEASE(_effect);
     stopSchedule();
+    
+    // Blocks still referenced elsewhere keep the regions alive until they are freed.
+    SpineAllocator::closeArena(_arena);
+    _arena = nullptr;
 }
 
 void SkeletonRenderer::initWithUUID(const std::string& uuid) {
@@ -269,10 +286,14 @@ void SkeletonRenderer::render (float deltaTime) {
     assembler->reset();
     assembler->setUseModel(!_batch);
     
+    // The pose didn't change and the node is off screen, the bounds of the last render are kept for culling.
+    if (_updateLOD.canSkipRender()) return;
+    
     if (!_skeleton) return;
     auto mgr = MiddlewareManager::getInstance();
     if (!mgr->isRendering) return;
     
+    SpineAllocator::Scope scope(_arena);
     _nodeColor.a = _nodeProxy->getRealOpacity() / (float)255;
     
     if (_skeleton->getColor().a == 0) {
@@ -296,6 +317,10 @@ void SkeletonRenderer::render (float deltaTime) {
     
 	int vbSize = 0;
     int ibSize = 0;
+    
+    // Local bounds of the vertices, used by the culling and the update LOD of the next frame.
+    float boundsMinX = FLT_MAX, boundsMinY = FLT_MAX;
+    float boundsMaxX = -FLT_MAX, boundsMaxY = -FLT_MAX;
 
     BlendFactor curBlendSrc = BlendFactor::ONE;
     BlendFactor curBlendDst = BlendFactor::ZERO;
@@ -802,18 +827,18 @@ void SkeletonRenderer::render (float deltaTime) {
                 vertexOffset = vb.getCurPos() / vbs2;
             }
             
+            float* vbBuffer = (float*)vb.getCurBuffer();
+            int floatStride = vbs / sizeof(float);
+            for (int ii = 0, nn = vbSize / vbs; ii < nn; ii++) {
+                float x = vbBuffer[ii * floatStride], y = vbBuffer[ii * floatStride + 1];
+                boundsMinX = min(boundsMinX, x);
+                boundsMinY = min(boundsMinY, y);
+                boundsMaxX = max(boundsMaxX, x);
+                boundsMaxY = max(boundsMaxY, y);
+            }
+            
             if (_batch) {
-                uint8_t* vbBuffer = vb.getCurBuffer();
-                cocos2d::Vec3* point = nullptr;
-                float tempZ = 0.0f;
-                for (int ii = 0, nn = vbSize; ii < nn; ii += vbs)
-                {
-                    point = (cocos2d::Vec3*)(vbBuffer + ii);
-                    tempZ = point->z;
-                    point->z = 0;
-                    nodeWorldMat.transformPoint(point);
-                    point->z = tempZ;
-                }
+                cocos2d::MathUtil::transformVec2Batch(nodeWorldMat.m, vbBuffer, vbSize / vbs, floatStride);
             }
             
             if (vertexOffset > 0) {
@@ -839,6 +864,12 @@ void SkeletonRenderer::render (float deltaTime) {
 	if (preISegWritePos != -1) {
 		assembler->updateIARange(materialLen - 1, preISegWritePos, curISegLen);
     }
+    
+    if (boundsMinX <= boundsMaxX) {
+        assembler->setLocalBounds(Vec3(boundsMinX, boundsMinY, 0), Vec3(boundsMaxX, boundsMaxY, 0));
+    } else {
+        assembler->clearLocalBounds();
+    }
 
     if (_debugBones) {
         auto& bones = _skeleton->getBones();
@@ -40,6 +40,8 @@
 #include "renderer/scene/NodeProxy.hpp"
 #include "base/CCMap.h"
 #include "middleware-adapter.h"
+#include "UpdateLOD.h"
+#include "spine-creator-support/SpineAllocator.h"
 #include "base/ccMacros.h"
 
 namespace spine {
@@ -131,6 +133,11 @@ namespace spine {
         void setDebugSlotsEnabled (bool enabled);
         void setDebugMeshEnabled (bool enabled);
         
+        /**
+         * @brief Gets the update rate policy, skeletons small or off screen are updated less often.
+         */
+        cocos2d::middleware::UpdateLOD& getUpdateLOD () { return _updateLOD; }
+        
         void setOpacityModifyRGB (bool value);
         bool isOpacityModifyRGB () const;
         
@@ -159,6 +166,7 @@ namespace spine {
         virtual void initialize ();
     protected:
         void setSkeletonData (SkeletonData* skeletonData, bool ownsSkeletonData);
+        void createArena ();
         
         bool                _ownsSkeletonData = false;
         bool                _ownsSkeleton = false;
@@ -186,6 +194,9 @@ namespace spine {
         cocos2d::middleware::IOTypedArray* _debugBuffer = nullptr;
         cocos2d::renderer::NodeProxy* _nodeProxy = nullptr;
         cocos2d::renderer::Effect* _effect = nullptr;
+        cocos2d::middleware::UpdateLOD _updateLOD;
+        // Holds the skeleton, its clipper and animation state, and what they allocate while updating and rendering.
+        SpineAllocator::Arena* _arena = nullptr;
     };
 
 }
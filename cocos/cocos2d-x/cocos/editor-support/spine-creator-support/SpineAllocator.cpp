@@ -0,0 +1,319 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated May 1, 2019. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2019, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES, BUSINESS
+ * INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "spine-creator-support/SpineAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace spine {
+
+namespace {
+    const size_t HeaderSize = 16;
+    const size_t Granularity = 16;
+    const size_t ClassCount = SpineAllocator::MaxPooledSize / Granularity;
+    const uint8_t LargeClass = 0xff;
+    const size_t SlabSize = 64 * 1024;
+    const size_t RegionSize = 16 * 1024;
+    
+    struct FreeNode {
+        FreeNode* next;
+    };
+    
+    struct TagStats {
+        std::atomic<int64_t> liveBytes;
+        TagStats () : liveBytes(0) {}
+    };
+    
+    // Slabs are kept for the lifetime of the process, freed blocks only go back to their list.
+    struct SizeClassPool {
+        std::mutex mutex;
+        FreeNode* head = nullptr;
+        char* cursor = nullptr;
+        char* end = nullptr;
+    };
+    
+    struct BlockHeader {
+        SpineAllocator::Arena* arena;
+        uint32_t size;
+        uint8_t sizeClass;
+        bool fromRegion;
+        // Distance from the start of a large block to the pointer returned by malloc.
+        uint8_t mallocOffset;
+    };
+    static_assert(sizeof(BlockHeader) <= HeaderSize, "Spine block header doesn't fit.");
+    
+    // malloc only guarantees 8 bytes on 32 bit platforms, blocks start on 16 bytes so that the
+    // pointers after the header are 16 byte aligned everywhere, as the header size implies.
+    const uintptr_t BlockAlignment = 16;
+    
+    inline char* alignBlock (char* ptr) {
+        return (char*)(((uintptr_t)ptr + BlockAlignment - 1) & ~(BlockAlignment - 1));
+    }
+    
+    SizeClassPool pools[ClassCount];
+    std::atomic<int64_t> totalLiveBytes(0);
+    thread_local SpineAllocator::Arena* currentArena = nullptr;
+    
+    std::mutex& getTagMutex () {
+        static std::mutex mutex;
+        return mutex;
+    }
+    
+    // Never destroyed, arenas may free their blocks during the static destruction.
+    std::map<std::string, TagStats*>& getTagStats () {
+        static auto stats = new std::map<std::string, TagStats*>();
+        return *stats;
+    }
+    
+    inline uint8_t getSizeClass (size_t size) {
+        return size <= SpineAllocator::MaxPooledSize ? (uint8_t)((size + Granularity - 1) / Granularity - 1) : LargeClass;
+    }
+    
+    inline size_t getClassStride (uint8_t sizeClass) {
+        return HeaderSize + (sizeClass + 1) * Granularity;
+    }
+    
+    char* takePooled (uint8_t sizeClass) {
+        SizeClassPool& pool = pools[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.head) {
+            FreeNode* node = pool.head;
+            pool.head = node->next;
+            return (char*)node;
+        }
+        
+        size_t stride = getClassStride(sizeClass);
+        if (!pool.cursor || pool.cursor + stride > pool.end) {
+            char* slab = (char*)::malloc(SlabSize);
+            if (!slab) return nullptr;
+            pool.cursor = alignBlock(slab);
+            pool.end = slab + SlabSize;
+        }
+        char* block = pool.cursor;
+        pool.cursor += stride;
+        return block;
+    }
+    
+    char* mallocLarge (size_t size) {
+        char* ptr = (char*)::malloc(HeaderSize + size + BlockAlignment - 1);
+        if (!ptr) return nullptr;
+        char* block = alignBlock(ptr);
+        ((BlockHeader*)block)->mallocOffset = (uint8_t)(block - ptr);
+        return block;
+    }
+    
+    void releaseBlock (char* block, uint8_t sizeClass) {
+        if (sizeClass == LargeClass) {
+            ::free(block - ((BlockHeader*)block)->mallocOffset);
+            return;
+        }
+        SizeClassPool& pool = pools[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        FreeNode* node = (FreeNode*)block;
+        node->next = pool.head;
+        pool.head = node;
+    }
+}
+
+class SpineAllocator::Arena {
+public:
+    Arena (TagStats* stats, bool useRegions) : stats(stats), useRegions(useRegions) {
+        memset(freeLists, 0, sizeof(freeLists));
+    }
+    
+    ~Arena () {
+        for (auto region : regions) ::free(region);
+    }
+    
+    // Called with the mutex locked.
+    char* take (uint8_t sizeClass) {
+        if (freeLists[sizeClass]) {
+            FreeNode* node = freeLists[sizeClass];
+            freeLists[sizeClass] = node->next;
+            return (char*)node;
+        }
+        
+        size_t stride = getClassStride(sizeClass);
+        if (!cursor || cursor + stride > end) {
+            char* region = (char*)::malloc(RegionSize);
+            if (!region) return nullptr;
+            regions.push_back(region);
+            cursor = alignBlock(region);
+            end = region + RegionSize;
+        }
+        char* block = cursor;
+        cursor += stride;
+        return block;
+    }
+    
+    TagStats* stats;
+    bool useRegions;
+    std::mutex mutex;
+    std::vector<char*> regions;
+    char* cursor = nullptr;
+    char* end = nullptr;
+    FreeNode* freeLists[ClassCount];
+    uint32_t liveBlocks = 0;
+    bool closed = false;
+};
+
+SpineAllocator::Scope::Scope (Arena* arena) : _previous(currentArena) {
+    currentArena = arena;
+}
+
+SpineAllocator::Scope::~Scope () {
+    currentArena = _previous;
+}
+
+void* SpineAllocator::alloc (size_t size) {
+    if (size == 0 || size > UINT32_MAX) return nullptr;
+    
+    Arena* arena = currentArena;
+    uint8_t sizeClass = getSizeClass(size);
+    bool fromRegion = arena && arena->useRegions && sizeClass != LargeClass;
+    char* block = nullptr;
+    if (fromRegion) {
+        std::lock_guard<std::mutex> lock(arena->mutex);
+        block = arena->take(sizeClass);
+        if (block) arena->liveBlocks++;
+    } else {
+        block = sizeClass == LargeClass ? mallocLarge(size) : takePooled(sizeClass);
+        if (block && arena) {
+            std::lock_guard<std::mutex> lock(arena->mutex);
+            arena->liveBlocks++;
+        }
+    }
+    if (!block) return nullptr;
+    
+    BlockHeader* header = (BlockHeader*)block;
+    header->arena = arena;
+    header->size = (uint32_t)size;
+    header->sizeClass = sizeClass;
+    header->fromRegion = fromRegion;
+    
+    totalLiveBytes.fetch_add(size, std::memory_order_relaxed);
+    if (arena) arena->stats->liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return block + HeaderSize;
+}
+
+void* SpineAllocator::realloc (void* ptr, size_t size) {
+    if (!ptr) return alloc(size);
+    if (size == 0) {
+        free(ptr);
+        return nullptr;
+    }
+    
+    BlockHeader* header = (BlockHeader*)((char*)ptr - HeaderSize);
+    size_t oldSize = header->size;
+    // Grows in place while the size class has room.
+    if (header->sizeClass != LargeClass && getSizeClass(size) <= header->sizeClass) {
+        int64_t delta = (int64_t)size - (int64_t)oldSize;
+        totalLiveBytes.fetch_add(delta, std::memory_order_relaxed);
+        if (header->arena) header->arena->stats->liveBytes.fetch_add(delta, std::memory_order_relaxed);
+        header->size = (uint32_t)size;
+        return ptr;
+    }
+    
+    void* mem = alloc(size);
+    if (!mem) return nullptr;
+    memcpy(mem, ptr, std::min(oldSize, size));
+    free(ptr);
+    return mem;
+}
+
+void SpineAllocator::free (void* ptr) {
+    if (!ptr) return;
+    
+    char* block = (char*)ptr - HeaderSize;
+    BlockHeader* header = (BlockHeader*)block;
+    Arena* arena = header->arena;
+    uint32_t size = header->size;
+    uint8_t sizeClass = header->sizeClass;
+    bool fromRegion = header->fromRegion;
+    
+    totalLiveBytes.fetch_sub(size, std::memory_order_relaxed);
+    if (!arena) {
+        releaseBlock(block, sizeClass);
+        return;
+    }
+    
+    arena->stats->liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    bool destroy = false;
+    {
+        std::lock_guard<std::mutex> lock(arena->mutex);
+        if (fromRegion) {
+            FreeNode* node = (FreeNode*)block;
+            node->next = arena->freeLists[sizeClass];
+            arena->freeLists[sizeClass] = node;
+        }
+        destroy = --arena->liveBlocks == 0 && arena->closed;
+    }
+    if (!fromRegion) releaseBlock(block, sizeClass);
+    if (destroy) delete arena;
+}
+
+SpineAllocator::Arena* SpineAllocator::createArena (const std::string& tag, bool useRegions) {
+    TagStats* stats = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(getTagMutex());
+        TagStats*& tagStats = getTagStats()[tag];
+        if (!tagStats) tagStats = new TagStats();
+        stats = tagStats;
+    }
+    return new Arena(stats, useRegions);
+}
+
+void SpineAllocator::closeArena (Arena* arena) {
+    if (!arena) return;
+    bool destroy = false;
+    {
+        std::lock_guard<std::mutex> lock(arena->mutex);
+        arena->closed = true;
+        destroy = arena->liveBlocks == 0;
+    }
+    if (destroy) delete arena;
+}
+
+int64_t SpineAllocator::getLiveBytes (const std::string& tag) {
+    std::lock_guard<std::mutex> lock(getTagMutex());
+    auto& stats = getTagStats();
+    auto it = stats.find(tag);
+    return it != stats.end() ? it->second->liveBytes.load(std::memory_order_relaxed) : 0;
+}
+
+int64_t SpineAllocator::getTotalLiveBytes () {
+    return totalLiveBytes.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated May 1, 2019. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2019, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES, BUSINESS
+ * INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace spine {
+
+/**
+ * Allocator behind Cocos2dExtension. Blocks up to MaxPooledSize come from size class free lists
+ * carved out of shared slabs, and blocks allocated inside a Scope come from the regions of its
+ * arena, which are freed together once the arena is closed and its last block is freed.
+ * Every block carries a 16 byte header with its size and arena, so it can be freed from any thread,
+ * and the returned pointers are 16 byte aligned on every platform.
+ */
+class SpineAllocator {
+public:
+    class Arena;
+    
+    /**
+     * Routes the allocations of the calling thread into an arena until it is destroyed.
+     */
+    class Scope {
+    public:
+        Scope (Arena* arena);
+        ~Scope ();
+    private:
+        Arena* _previous;
+    };
+    
+    static const size_t MaxPooledSize = 512;
+    
+    static void* alloc (size_t size);
+    static void* realloc (void* ptr, size_t size);
+    static void free (void* ptr);
+    
+    /**
+     * @brief Creates an arena, usually one per skeleton instance.
+     * @param[in] tag Live bytes of the arena are reported under it, usually the uuid of the skeleton data.
+     * @param[in] useRegions False to only account the blocks without packing them into regions,
+     * for allocations most of which are freed soon, as the temporaries of a data load.
+     */
+    static Arena* createArena (const std::string& tag, bool useRegions = true);
+    /**
+     * @brief Releases the owner of an arena, its regions are freed with its last block.
+     */
+    static void closeArena (Arena* arena);
+    
+    /**
+     * @brief Gets the bytes currently allocated through the arenas of a tag.
+     */
+    static int64_t getLiveBytes (const std::string& tag);
+    /**
+     * @brief Gets the bytes currently allocated in total.
+     */
+    static int64_t getTotalLiveBytes ();
+};
+
+}
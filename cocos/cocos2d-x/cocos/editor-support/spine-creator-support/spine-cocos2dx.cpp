@@ -151,7 +151,7 @@ char *Cocos2dExtension::_readFile(const spine::String &path, int *length) {
     Data data = FileUtils::getInstance()->getDataFromFile(FileUtils::getInstance()->fullPathForFilename(path.buffer()));
     if (data.isNull()) return 0;
 
-    char *ret = (char*)malloc(sizeof(unsigned char) * data.getSize());
+    char *ret = SpineExtension::alloc<char>(data.getSize(), __FILE__, __LINE__);
     memcpy(ret, (char*)data.getBytes(), data.getSize());
     *length = (int)data.getSize();
     return ret;
@@ -161,7 +161,21 @@ SpineExtension *spine::getDefaultExtension () {
     return new Cocos2dExtension();
 }
 
+void *Cocos2dExtension::_alloc(size_t size, const char *file, int line) {
+    return SpineAllocator::alloc(size);
+}
+
+void *Cocos2dExtension::_calloc(size_t size, const char *file, int line) {
+    void *ptr = SpineAllocator::alloc(size);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+void *Cocos2dExtension::_realloc(void *ptr, size_t size, const char *file, int line) {
+    return SpineAllocator::realloc(ptr, size);
+}
+
 void Cocos2dExtension::_free(void *mem, const char *file, int line) {
     _spineObjectDisposeCallback(mem);
-    DefaultSpineExtension::_free(mem, file, line);
+    SpineAllocator::free(mem);
 }
@@ -35,6 +35,7 @@
 #include "spine-creator-support/SkeletonDataMgr.h"
 #include "spine-creator-support/SkeletonCacheMgr.h"
 #include "spine-creator-support/SkeletonCacheAnimation.h"
+#include "spine-creator-support/SpineAllocator.h"
 #include "middleware-adapter.h"
 
 namespace spine {
@@ -65,6 +66,12 @@ namespace spine {
         
         virtual ~Cocos2dExtension();
         
+        virtual void *_alloc(size_t size, const char *file, int line);
+        
+        virtual void *_calloc(size_t size, const char *file, int line);
+        
+        virtual void *_realloc(void *ptr, size_t size, const char *file, int line);
+        
         virtual void _free(void *mem, const char *file, int line);
     protected:
         virtual char *_readFile(const String &path, int *length);
@@ -244,6 +244,8 @@ namespace spine {
 
 		void disableQueue();
 		void enableQueue();
+		/// Delivers the events queued while the queue was disabled.
+		void drainQueue();
         
     private:
         
@@ -198,6 +198,23 @@ void Skeleton::printUpdateCache() {
 }
 
 void Skeleton::updateWorldTransform() {
+	resetAppliedTransforms();
+
+	for (size_t i = 0, n = _updateCache.size(); i < n; ++i) {
+		_updateCache[i]->update();
+	}
+}
+
+void Skeleton::updateWorldTransformWithoutConstraints() {
+	resetAppliedTransforms();
+
+	for (size_t i = 0, n = _updateCache.size(); i < n; ++i) {
+		Updatable *updatable = _updateCache[i];
+		if (updatable->getRTTI().isExactly(Bone::rtti)) updatable->update();
+	}
+}
+
+void Skeleton::resetAppliedTransforms() {
 	for (size_t i = 0, n = _updateCacheReset.size(); i < n; ++i) {
 		Bone *boneP = _updateCacheReset[i];
 		Bone &bone = *boneP;
@@ -210,10 +227,6 @@ void Skeleton::updateWorldTransform() {
 		bone._ashearY = bone._shearY;
 		bone._appliedValid = true;
 	}
-
-	for (size_t i = 0, n = _updateCache.size(); i < n; ++i) {
-		_updateCache[i]->update();
-	}
 }
 
 void Skeleton::setToSetupPose() {
@@ -104,6 +104,10 @@ public:
 
 	void updateWorldTransform();
 
+	/// Updates the world transform of the bones only, IK, path and transform constraints keep their last result.
+	/// Cheaper for skeletons too small on screen for the constraints to be visible.
+	void updateWorldTransformWithoutConstraints();
+
 	void setToSetupPose();
 
 	void setBonesToSetupPose();
@@ -211,6 +215,8 @@ private:
 	void sortBone(Bone *bone);
 
 	static void sortReset(Vector<Bone *> &bones);
+
+	void resetAppliedTransforms();
 };
 }
 
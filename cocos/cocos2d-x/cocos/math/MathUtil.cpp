@@ -271,6 +271,40 @@ void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 #endif
 }
 
+void MathUtil::transformVec2Batch(const float* m, float* points, size_t count, size_t stride)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformVec2Batch(m, points, count, stride);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVec2Batch(m, points, count, stride);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVec2Batch(m, points, count, stride);
+    else MathUtilC::transformVec2Batch(m, points, count, stride);
+#elif defined (USE_SSE)
+    __m128 col[4] = { _mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12) };
+    transformVec2Batch(col, points, count, stride);
+#else
+    MathUtilC::transformVec2Batch(m, points, count, stride);
+#endif
+}
+
+void MathUtil::transformVec3Batch(const float* m, float* points, size_t count, size_t stride)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformVec3Batch(m, points, count, stride);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVec3Batch(m, points, count, stride);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVec3Batch(m, points, count, stride);
+    else MathUtilC::transformVec3Batch(m, points, count, stride);
+#elif defined (USE_SSE)
+    __m128 col[4] = { _mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12) };
+    transformVec3Batch(col, points, count, stride);
+#else
+    MathUtilC::transformVec3Batch(m, points, count, stride);
+#endif
+}
+
 void MathUtil::combineHash(size_t& seed, const size_t& v)
 {
     seed ^= v + 0x9e3779b9 + (seed<<6) + (seed>>2);
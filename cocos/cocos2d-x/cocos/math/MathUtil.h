@@ -96,6 +96,27 @@ public:
      * @param v
      */
     static void combineHash(size_t& seed, const size_t& v);
+    
+    /**
+     * Transforms 2D positions in place by the given matrix, z is taken as 0 and w as 1, only x and y are written.
+     *
+     * @param m the column major matrix.
+     * @param points the first position.
+     * @param count the number of positions.
+     * @param stride the distance between two positions in floats, which allows interleaved vertex data.
+     */
+    static void transformVec2Batch(const float* m, float* points, size_t count, size_t stride);
+    
+    /**
+     * Transforms 3D positions in place by the given matrix, w is taken as 1 and the results are divided
+     * by the transformed w as Vec3::transformMat4 does.
+     *
+     * @param m the column major matrix.
+     * @param points the first position.
+     * @param count the number of positions.
+     * @param stride the distance between two positions in floats, which allows interleaved vertex data.
+     */
+    static void transformVec3Batch(const float* m, float* points, size_t count, size_t stride);
 private:
     static bool isNeon32Enabled();
     static bool isNeon64Enabled();
@@ -116,6 +137,10 @@ private:
     static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
 
     static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+    
+    static void transformVec2Batch(const __m128 m[4], float* points, size_t count, size_t stride);
+    
+    static void transformVec3Batch(const __m128 m[4], float* points, size_t count, size_t stride);
 #endif
     static void addMatrix(const float* m, float scalar, float* dst);
 
@@ -42,6 +42,10 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+    
+    inline static void transformVec2Batch(const float* m, float* points, size_t count, size_t stride);
+    
+    inline static void transformVec3Batch(const float* m, float* points, size_t count, size_t stride);
 };
 
 inline void MathUtilC::addMatrix(const float* m, float scalar, float* dst)
@@ -215,4 +219,33 @@ inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtilC::transformVec2Batch(const float* m, float* points, size_t count, size_t stride)
+{
+    const float m0 = m[0], m1 = m[1], m4 = m[4], m5 = m[5], m12 = m[12], m13 = m[13];
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        float x = points[0], y = points[1];
+        points[0] = x * m0 + y * m4 + m12;
+        points[1] = x * m1 + y * m5 + m13;
+    }
+}
+
+inline void MathUtilC::transformVec3Batch(const float* m, float* points, size_t count, size_t stride)
+{
+    bool affine = m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && m[15] == 1.0f;
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        float x = points[0], y = points[1], z = points[2];
+        float rhw = 1.0f;
+        if (!affine)
+        {
+            rhw = x * m[3] + y * m[7] + z * m[11] + m[15];
+            rhw = rhw ? 1.0f / rhw : 1.0f;
+        }
+        points[0] = (x * m[0] + y * m[4] + z * m[8] + m[12]) * rhw;
+        points[1] = (x * m[1] + y * m[5] + z * m[9] + m[13]) * rhw;
+        points[2] = (x * m[2] + y * m[6] + z * m[10] + m[14]) * rhw;
+    }
+}
+
 NS_CC_MATH_END
@@ -17,6 +17,9 @@
 
  This file was modified to fit the cocos2d-x project
  */
+
+#include <arm_neon.h>
+
 NS_CC_MATH_BEGIN
 
 class MathUtilNeon
@@ -41,6 +44,10 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+    
+    inline static void transformVec2Batch(const float* m, float* points, size_t count, size_t stride);
+    
+    inline static void transformVec3Batch(const float* m, float* points, size_t count, size_t stride);
 };
 
 inline void MathUtilNeon::addMatrix(const float* m, float scalar, float* dst)
@@ -268,4 +275,41 @@ inline void MathUtilNeon::crossVec3(const float* v1, const float* v2, float* dst
                  );
 }
 
+inline void MathUtilNeon::transformVec2Batch(const float* m, float* points, size_t count, size_t stride)
+{
+    const float32x2_t c0 = vld1_f32(m);
+    const float32x2_t c1 = vld1_f32(m + 4);
+    const float32x2_t c3 = vld1_f32(m + 12);
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        float32x2_t v = vld1_f32(points);
+        float32x2_t r = vmla_lane_f32(c3, c0, v, 0);
+        r = vmla_lane_f32(r, c1, v, 1);
+        vst1_f32(points, r);
+    }
+}
+
+inline void MathUtilNeon::transformVec3Batch(const float* m, float* points, size_t count, size_t stride)
+{
+    const float32x4_t c0 = vld1q_f32(m);
+    const float32x4_t c1 = vld1q_f32(m + 4);
+    const float32x4_t c2 = vld1q_f32(m + 8);
+    const float32x4_t c3 = vld1q_f32(m + 12);
+    bool affine = m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && m[15] == 1.0f;
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        float32x2_t v = vld1_f32(points);
+        float32x4_t r = vmlaq_lane_f32(c3, c0, v, 0);
+        r = vmlaq_lane_f32(r, c1, v, 1);
+        r = vmlaq_n_f32(r, c2, points[2]);
+        if (!affine)
+        {
+            float rhw = vgetq_lane_f32(r, 3);
+            r = vmulq_n_f32(r, rhw ? 1.0f / rhw : 1.0f);
+        }
+        vst1_f32(points, vget_low_f32(r));
+        vst1q_lane_f32(points + 2, r, 2);
+    }
+}
+
 NS_CC_MATH_END
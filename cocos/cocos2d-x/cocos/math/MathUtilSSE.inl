@@ -151,6 +151,41 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+void MathUtil::transformVec2Batch(const __m128 m[4], float* points, size_t count, size_t stride)
+{
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        __m128 v = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)points);
+        __m128 r = _mm_add_ps(
+                              _mm_add_ps(_mm_mul_ps(m[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))),
+                                         _mm_mul_ps(m[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+                              m[3]);
+        _mm_storel_pi((__m64*)points, r);
+    }
+}
+
+void MathUtil::transformVec3Batch(const __m128 m[4], float* points, size_t count, size_t stride)
+{
+    __m128 r0 = m[0], r1 = m[1], r2 = m[2], r3 = m[3];
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    bool affine = _mm_movemask_ps(_mm_cmpeq_ps(r3, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f))) == 0xf;
+    for (size_t i = 0; i < count; ++i, points += stride)
+    {
+        __m128 v = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)points);
+        __m128 r = _mm_add_ps(
+                              _mm_add_ps(_mm_mul_ps(m[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))),
+                                         _mm_mul_ps(m[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+                              _mm_add_ps(_mm_mul_ps(m[2], _mm_set1_ps(points[2])), m[3]));
+        if (!affine)
+        {
+            float rhw = _mm_cvtss_f32(_mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+            r = _mm_mul_ps(r, _mm_set1_ps(rhw ? 1.0f / rhw : 1.0f));
+        }
+        _mm_storel_pi((__m64*)points, r);
+        _mm_store_ss(points + 2, _mm_movehl_ps(r, r));
+    }
+}
+
 #endif
 
 
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __PLATFORM_CCGL_H__
 
 #include "platform/CCPlatformConfig.h"
+#include "base/ccConfig.h"
 
 #ifndef GL_TEXTURE_MIN_LOD
 #define GL_TEXTURE_MIN_LOD 0x813A
@@ -98,6 +99,10 @@ THE SOFTWARE.
 #define GL_DEPTH_STENCIL 0x84F9
 #endif
 
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+
 #if CC_TARGET_PLATFORM == CC_PLATFORM_MAC
 #include "platform/mac/CCGL-mac.h"
 #elif CC_TARGET_PLATFORM == CC_PLATFORM_IOS
@@ -112,5 +117,9 @@ THE SOFTWARE.
 #include "platform/linux/CCGL-linux.h"
 #endif
 
+#if USE_NULL_GL > 0
+#include "platform/null/CCGL-null.h"
+#endif
+
 #endif /* __PLATFORM_CCPLATFORMDEFINE_H__*/
 
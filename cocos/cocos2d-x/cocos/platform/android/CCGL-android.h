@@ -35,7 +35,12 @@ THE SOFTWARE.
 #define glGenVertexArrays           glGenVertexArraysOES
 #define glBindVertexArray           glBindVertexArrayOES
 #define glMapBuffer                 glMapBufferOES
-#define glUnmapBuffer               glUnmapBufferOES
+#define glUnmapBuffer               glUnmapBufferOESEXT
+#define glMapBufferRange            glMapBufferRangeEXTEXT
+#define glGetProgramBinary          glGetProgramBinaryOESEXT
+#define glProgramBinary             glProgramBinaryOESEXT
+#define glDrawElementsInstanced     glDrawElementsInstancedEXTEXT
+#define glVertexAttribDivisor       glVertexAttribDivisorEXTEXT
 #define glTexImage3D				glTexImage3DOES
 #define glCompressedTexImage3D		glCompressedTexImage3DOES
 #define glCompressedTexSubImage3D	glCompressedTexSubImage3DOES
@@ -45,6 +50,11 @@ THE SOFTWARE.
 
 #define GL_DEPTH24_STENCIL8         GL_DEPTH24_STENCIL8_OES
 #define GL_WRITE_ONLY               GL_WRITE_ONLY_OES
+#define GL_MAP_WRITE_BIT            GL_MAP_WRITE_BIT_EXT
+#define GL_MAP_INVALIDATE_BUFFER_BIT GL_MAP_INVALIDATE_BUFFER_BIT_EXT
+#define GL_MAP_UNSYNCHRONIZED_BIT   GL_MAP_UNSYNCHRONIZED_BIT_EXT
+#define GL_PROGRAM_BINARY_LENGTH    GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
 
 #define GL_MAX_TEXTURE_UNITS        GL_MAX_TEXTURE_IMAGE_UNITS
 
@@ -68,6 +78,13 @@ extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
 
+extern PFNGLMAPBUFFERRANGEEXTPROC glMapBufferRangeEXTEXT;
+extern PFNGLUNMAPBUFFEROESPROC glUnmapBufferOESEXT;
+extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT;
+extern PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT;
+extern PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXTEXT;
+extern PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT;
+
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 
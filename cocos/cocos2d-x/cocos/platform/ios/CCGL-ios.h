@@ -36,7 +36,14 @@ THE SOFTWARE.
 #define glDepthRange                glDepthRangef
 #define glGenVertexArrays           glGenVertexArraysOES
 #define glBindVertexArray           glBindVertexArrayOES
+#define glMapBufferRange            glMapBufferRangeEXT
+#define glUnmapBuffer               glUnmapBufferOES
+#define glDrawElementsInstanced     glDrawElementsInstancedEXT
+#define glVertexAttribDivisor       glVertexAttribDivisorEXT
 #define GL_DEPTH24_STENCIL8         GL_DEPTH24_STENCIL8_OES
+#define GL_MAP_WRITE_BIT            GL_MAP_WRITE_BIT_EXT
+#define GL_MAP_INVALIDATE_BUFFER_BIT GL_MAP_INVALIDATE_BUFFER_BIT_EXT
+#define GL_MAP_UNSYNCHRONIZED_BIT   GL_MAP_UNSYNCHRONIZED_BIT_EXT
 
 #define GL_MAX_TEXTURE_UNITS    GL_MAX_TEXTURE_IMAGE_UNITS
 
@@ -0,0 +1,708 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCGL.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace cocos2d { namespace nullgl {
+
+namespace {
+
+    struct Variable
+    {
+        std::string name;
+        GLenum type;
+        GLint size;
+    };
+
+    struct Shader
+    {
+        GLenum type;
+        std::string source;
+    };
+
+    struct Program
+    {
+        std::vector<GLuint> shaders;
+        std::vector<Variable> attributes;
+        std::vector<Variable> uniforms;
+    };
+
+    Stats _stats;
+    GLuint _nextName = 1;
+    std::unordered_map<GLuint, Shader> _shaders;
+    std::unordered_map<GLuint, Program> _programs;
+    std::vector<uint8_t> _mapped;
+
+    const std::unordered_map<std::string, GLenum> _glslTypes = {
+        { "float", GL_FLOAT },
+        { "vec2", GL_FLOAT_VEC2 },
+        { "vec3", GL_FLOAT_VEC3 },
+        { "vec4", GL_FLOAT_VEC4 },
+        { "int", GL_INT },
+        { "ivec2", GL_INT_VEC2 },
+        { "ivec3", GL_INT_VEC3 },
+        { "ivec4", GL_INT_VEC4 },
+        { "bool", GL_BOOL },
+        { "bvec2", GL_BOOL_VEC2 },
+        { "bvec3", GL_BOOL_VEC3 },
+        { "bvec4", GL_BOOL_VEC4 },
+        { "mat2", GL_FLOAT_MAT2 },
+        { "mat3", GL_FLOAT_MAT3 },
+        { "mat4", GL_FLOAT_MAT4 },
+        { "sampler2D", GL_SAMPLER_2D },
+        { "samplerCube", GL_SAMPLER_CUBE }
+    };
+
+    inline void stateChange()
+    {
+        ++_stats.calls;
+        ++_stats.stateChanges;
+    }
+
+    inline void uniform()
+    {
+        ++_stats.calls;
+        ++_stats.uniformUpdates;
+    }
+
+    inline void upload(GLsizeiptr bytes)
+    {
+        ++_stats.calls;
+        _stats.bytesUploaded += bytes > 0 ? bytes : 0;
+    }
+
+    void genNames(GLsizei n, GLuint* names)
+    {
+        ++_stats.calls;
+        for (GLsizei i = 0; i < n; ++i)
+            names[i] = _nextName++;
+    }
+
+    void copyString(const std::string& str, GLsizei bufSize, GLsizei* length, GLchar* out)
+    {
+        GLsizei written = 0;
+        if (out && bufSize > 0)
+        {
+            written = std::min((GLsizei)str.size(), bufSize - 1);
+            memcpy(out, str.data(), written);
+            out[written] = '\0';
+        }
+        if (length)
+            *length = written;
+    }
+
+    std::string trim(const std::string& str)
+    {
+        auto begin = str.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+            return "";
+        auto end = str.find_last_not_of(" \t\r");
+        return str.substr(begin, end - begin + 1);
+    }
+
+    // Evaluates the conditions the effect compiler emits: a define, its negation or a number.
+    // Anything more complex is considered true, which may only report extra variables.
+    bool evaluate(const std::string& expr, const std::unordered_map<std::string, std::string>& defines)
+    {
+        std::string token = trim(expr);
+        bool negate = false;
+        while (!token.empty() && token[0] == '!')
+        {
+            negate = !negate;
+            token = trim(token.substr(1));
+        }
+        if (token.empty())
+            return true;
+
+        bool value = true;
+        if (isdigit(token[0]))
+        {
+            value = atoi(token.c_str()) != 0;
+        }
+        else if (token.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_") == std::string::npos)
+        {
+            auto iter = defines.find(token);
+            value = iter != defines.end() && atoi(iter->second.c_str()) != 0;
+        }
+        return negate ? !value : value;
+    }
+
+    GLint arraySize(const std::string& size, const std::unordered_map<std::string, std::string>& defines)
+    {
+        std::string token = trim(size);
+        auto iter = defines.find(token);
+        if (iter != defines.end())
+            token = iter->second;
+        GLint count = atoi(token.c_str());
+        return count > 0 ? count : 1;
+    }
+
+    void addVariable(std::vector<Variable>& list, const Variable& var)
+    {
+        for (const auto& existing : list)
+        {
+            if (existing.name == var.name)
+                return;
+        }
+        list.push_back(var);
+    }
+
+    void reflect(const Shader& shader, Program& program)
+    {
+        struct Branch
+        {
+            bool parentActive;
+            bool active;
+            bool taken;
+        };
+
+        std::unordered_map<std::string, std::string> defines;
+        std::vector<Branch> branches;
+        bool active = true;
+
+        std::istringstream stream(shader.source);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            line = trim(line);
+            if (line.empty())
+                continue;
+
+            if (line[0] == '#')
+            {
+                std::istringstream directive(line.substr(1));
+                std::string keyword, rest;
+                directive >> keyword;
+                std::getline(directive, rest);
+
+                if (keyword == "if" || keyword == "ifdef" || keyword == "ifndef")
+                {
+                    bool cond;
+                    if (keyword == "if")
+                        cond = evaluate(rest, defines);
+                    else
+                        cond = (defines.find(trim(rest)) != defines.end()) == (keyword == "ifdef");
+                    branches.push_back({ active, active && cond, cond });
+                    active = branches.back().active;
+                }
+                else if (keyword == "elif" && !branches.empty())
+                {
+                    auto& branch = branches.back();
+                    bool cond = !branch.taken && evaluate(rest, defines);
+                    branch.taken = branch.taken || cond;
+                    branch.active = branch.parentActive && cond;
+                    active = branch.active;
+                }
+                else if (keyword == "else" && !branches.empty())
+                {
+                    auto& branch = branches.back();
+                    branch.active = branch.parentActive && !branch.taken;
+                    branch.taken = true;
+                    active = branch.active;
+                }
+                else if (keyword == "endif" && !branches.empty())
+                {
+                    active = branches.back().parentActive;
+                    branches.pop_back();
+                }
+                else if (keyword == "define" && active)
+                {
+                    std::istringstream define(rest);
+                    std::string name, value;
+                    define >> name;
+                    std::getline(define, value);
+                    value = trim(value);
+                    defines[name] = value.empty() ? "1" : value;
+                }
+                continue;
+            }
+
+            if (!active)
+                continue;
+
+            bool isAttribute = line.compare(0, 10, "attribute ") == 0;
+            bool isUniform = line.compare(0, 8, "uniform ") == 0;
+            if (!isAttribute && !isUniform)
+                continue;
+            if (isAttribute && shader.type != GL_VERTEX_SHADER)
+                continue;
+
+            std::replace(line.begin(), line.end(), ';', ' ');
+            std::istringstream decl(line);
+            std::string token, typeName, name;
+            decl >> token;
+            while (decl >> token)
+            {
+                if (token == "lowp" || token == "mediump" || token == "highp")
+                    continue;
+                if (typeName.empty())
+                    typeName = token;
+                else
+                {
+                    name = token;
+                    break;
+                }
+            }
+
+            auto type = _glslTypes.find(typeName);
+            if (name.empty() || type == _glslTypes.end())
+                continue;
+
+            // The array size may be attached to the name or follow it.
+            std::string size;
+            decl >> size;
+            auto bracket = name.find('[');
+            if (bracket != std::string::npos)
+            {
+                size = name.substr(bracket);
+                name = name.substr(0, bracket);
+            }
+
+            Variable var = { name, type->second, 1 };
+            if (!size.empty() && size[0] == '[')
+            {
+                var.size = arraySize(size.substr(1, size.find(']') - 1), defines);
+                var.name += "[0]";
+            }
+            addVariable(isAttribute ? program.attributes : program.uniforms, var);
+        }
+    }
+
+    GLsizei maxNameLength(const std::vector<Variable>& list)
+    {
+        GLsizei length = 0;
+        for (const auto& var : list)
+            length = std::max(length, (GLsizei)var.name.size() + 1);
+        return length;
+    }
+
+    GLint findVariable(const std::vector<Variable>& list, const GLchar* name)
+    {
+        std::string key = name;
+        for (std::size_t i = 0, len = list.size(); i < len; ++i)
+        {
+            const auto& varName = list[i].name;
+            if (varName == key || (list[i].size > 1 && varName.compare(0, varName.size() - 3, key) == 0 && key.size() == varName.size() - 3))
+                return (GLint)i;
+        }
+        return -1;
+    }
+
+    void getActive(const std::vector<Variable>& list, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+    {
+        ++_stats.calls;
+        if (index >= list.size())
+        {
+            copyString("", bufSize, length, name);
+            return;
+        }
+        const auto& var = list[index];
+        copyString(var.name, bufSize, length, name);
+        if (size)
+            *size = var.size;
+        if (type)
+            *type = var.type;
+    }
+
+    void drawn(GLsizei count, GLsizei instances)
+    {
+        ++_stats.calls;
+        ++_stats.drawCalls;
+        _stats.primitives += (uint64_t)std::max(count, 0) * std::max(instances, 0);
+    }
+
+    GLsizeiptr imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        GLsizeiptr bpp = 4;
+        switch (type)
+        {
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                bpp = 2;
+                break;
+            default:
+                switch (format)
+                {
+                    case GL_ALPHA:
+                    case GL_LUMINANCE:
+                        bpp = 1;
+                        break;
+                    case GL_LUMINANCE_ALPHA:
+                        bpp = 2;
+                        break;
+                    case GL_RGB:
+                        bpp = 3;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+        }
+        return (GLsizeiptr)width * height * bpp;
+    }
+}
+
+const Stats& getStats()
+{
+    return _stats;
+}
+
+void resetStats()
+{
+    _stats = Stats();
+}
+
+void ActiveTexture(GLenum) { stateChange(); }
+void AttachShader(GLuint program, GLuint shader)
+{
+    ++_stats.calls;
+    _programs[program].shaders.push_back(shader);
+}
+void BindBuffer(GLenum, GLuint) { stateChange(); }
+void BindFramebuffer(GLenum, GLuint) { stateChange(); }
+void BindRenderbuffer(GLenum, GLuint) { stateChange(); }
+void BindTexture(GLenum, GLuint) { stateChange(); }
+void BindVertexArray(GLuint) { stateChange(); }
+void BlendColor(GLfloat, GLfloat, GLfloat, GLfloat) { stateChange(); }
+void BlendEquation(GLenum) { stateChange(); }
+void BlendEquationSeparate(GLenum, GLenum) { stateChange(); }
+void BlendFunc(GLenum, GLenum) { stateChange(); }
+void BlendFuncSeparate(GLenum, GLenum, GLenum, GLenum) { stateChange(); }
+void BufferData(GLenum, GLsizeiptr size, const void* data, GLenum) { upload(data ? size : 0); }
+void BufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*) { upload(size); }
+GLenum CheckFramebufferStatus(GLenum)
+{
+    ++_stats.calls;
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+void Clear(GLbitfield) { ++_stats.calls; }
+void ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { ++_stats.calls; }
+void ClearDepth(double) { ++_stats.calls; }
+void ClearStencil(GLint) { ++_stats.calls; }
+void ColorMask(GLboolean, GLboolean, GLboolean, GLboolean) { stateChange(); }
+void CompileShader(GLuint)
+{
+    ++_stats.calls;
+    ++_stats.shaderCompiles;
+}
+void CompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei imageSize, const void* data) { upload(data ? imageSize : 0); }
+void CompressedTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei imageSize, const void*) { upload(imageSize); }
+GLuint CreateProgram()
+{
+    ++_stats.calls;
+    GLuint name = _nextName++;
+    _programs[name] = Program();
+    return name;
+}
+GLuint CreateShader(GLenum type)
+{
+    ++_stats.calls;
+    GLuint name = _nextName++;
+    _shaders[name] = { type, "" };
+    return name;
+}
+void CullFace(GLenum) { stateChange(); }
+void DeleteBuffers(GLsizei, const GLuint*) { ++_stats.calls; }
+void DeleteFramebuffers(GLsizei, const GLuint*) { ++_stats.calls; }
+void DeleteProgram(GLuint program)
+{
+    ++_stats.calls;
+    _programs.erase(program);
+}
+void DeleteRenderbuffers(GLsizei, const GLuint*) { ++_stats.calls; }
+void DeleteShader(GLuint shader)
+{
+    ++_stats.calls;
+    _shaders.erase(shader);
+}
+void DeleteTextures(GLsizei, const GLuint*) { ++_stats.calls; }
+void DeleteVertexArrays(GLsizei, const GLuint*) { ++_stats.calls; }
+void DepthFunc(GLenum) { stateChange(); }
+void DepthMask(GLboolean) { stateChange(); }
+void DepthRange(double, double) { stateChange(); }
+void Disable(GLenum) { stateChange(); }
+void DisableVertexAttribArray(GLuint) { stateChange(); }
+void DrawArrays(GLenum, GLint, GLsizei count) { drawn(count, 1); }
+void DrawBuffer(GLenum) { stateChange(); }
+void DrawElements(GLenum, GLsizei count, GLenum, const void*) { drawn(count, 1); }
+void DrawElementsInstanced(GLenum, GLsizei count, GLenum, const void*, GLsizei instancecount) { drawn(count, instancecount); }
+void Enable(GLenum) { stateChange(); }
+void EnableVertexAttribArray(GLuint) { stateChange(); }
+void FramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) { stateChange(); }
+void FramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) { stateChange(); }
+void GenBuffers(GLsizei n, GLuint* buffers) { genNames(n, buffers); }
+void GenerateMipmap(GLenum) { ++_stats.calls; }
+void GenFramebuffers(GLsizei n, GLuint* framebuffers) { genNames(n, framebuffers); }
+void GenRenderbuffers(GLsizei n, GLuint* renderbuffers) { genNames(n, renderbuffers); }
+void GenTextures(GLsizei n, GLuint* textures) { genNames(n, textures); }
+void GenVertexArrays(GLsizei n, GLuint* arrays) { genNames(n, arrays); }
+void GetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getActive(_programs[program].attributes, index, bufSize, length, size, type, name);
+}
+void GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getActive(_programs[program].uniforms, index, bufSize, length, size, type, name);
+}
+GLint GetAttribLocation(GLuint program, const GLchar* name)
+{
+    ++_stats.calls;
+    return findVariable(_programs[program].attributes, name);
+}
+void GetBooleanv(GLenum, GLboolean* data)
+{
+    ++_stats.calls;
+    *data = GL_FALSE;
+}
+GLenum GetError()
+{
+    ++_stats.calls;
+    return GL_NO_ERROR;
+}
+void GetIntegerv(GLenum pname, GLint* data)
+{
+    ++_stats.calls;
+    switch (pname)
+    {
+        case GL_MAX_TEXTURE_SIZE:
+            *data = 4096;
+            break;
+        case GL_MAX_VERTEX_ATTRIBS:
+        case GL_MAX_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS:
+            *data = 16;
+            break;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+            *data = 32;
+            break;
+        case GL_MAX_VERTEX_UNIFORM_VECTORS:
+        case GL_MAX_FRAGMENT_UNIFORM_VECTORS:
+            *data = 256;
+            break;
+#ifdef GL_MAX_FRAGMENT_UNIFORM_COMPONENTS
+        case GL_MAX_FRAGMENT_UNIFORM_COMPONENTS:
+            *data = 1024;
+            break;
+#endif
+#ifdef GL_MAX_COLOR_ATTACHMENTS
+        case GL_MAX_COLOR_ATTACHMENTS:
+            *data = 1;
+            break;
+#endif
+#ifdef GL_MAX_DRAW_BUFFERS
+        case GL_MAX_DRAW_BUFFERS:
+            *data = 1;
+            break;
+#endif
+        case GL_COMPRESSED_TEXTURE_FORMATS:
+            // GL_NUM_COMPRESSED_TEXTURE_FORMATS is 0, the caller's array is empty.
+            break;
+        default:
+            *data = 0;
+            break;
+    }
+}
+void GetProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*)
+{
+    ++_stats.calls;
+    if (length)
+        *length = 0;
+}
+void GetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    ++_stats.calls;
+    copyString("", bufSize, length, infoLog);
+}
+void GetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    ++_stats.calls;
+    const auto& prog = _programs[program];
+    switch (pname)
+    {
+        case GL_LINK_STATUS:
+        case GL_VALIDATE_STATUS:
+            *params = GL_TRUE;
+            break;
+        case GL_ACTIVE_ATTRIBUTES:
+            *params = (GLint)prog.attributes.size();
+            break;
+        case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+            *params = maxNameLength(prog.attributes);
+            break;
+        case GL_ACTIVE_UNIFORMS:
+            *params = (GLint)prog.uniforms.size();
+            break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *params = maxNameLength(prog.uniforms);
+            break;
+        case GL_ATTACHED_SHADERS:
+            *params = (GLint)prog.shaders.size();
+            break;
+        default:
+            *params = 0;
+            break;
+    }
+}
+void GetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    ++_stats.calls;
+    copyString("", bufSize, length, infoLog);
+}
+void GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    ++_stats.calls;
+    switch (pname)
+    {
+        case GL_COMPILE_STATUS:
+            *params = GL_TRUE;
+            break;
+        case GL_SHADER_TYPE:
+            *params = _shaders[shader].type;
+            break;
+        case GL_SHADER_SOURCE_LENGTH:
+            *params = (GLint)_shaders[shader].source.size() + 1;
+            break;
+        default:
+            *params = 0;
+            break;
+    }
+}
+void GetShaderSource(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* source)
+{
+    ++_stats.calls;
+    copyString(_shaders[shader].source, bufSize, length, source);
+}
+const GLubyte* GetString(GLenum name)
+{
+    ++_stats.calls;
+    switch (name)
+    {
+        case GL_VENDOR:
+            return (const GLubyte*)"cocos";
+        case GL_RENDERER:
+            return (const GLubyte*)"NullGL";
+        case GL_VERSION:
+            return (const GLubyte*)"OpenGL ES 2.0 NullGL";
+        case GL_SHADING_LANGUAGE_VERSION:
+            return (const GLubyte*)"OpenGL ES GLSL ES 1.00";
+        case GL_EXTENSIONS:
+            return (const GLubyte*)"GL_OES_vertex_array_object GL_OES_packed_depth_stencil GL_OES_element_index_uint "
+                                   "GL_OES_standard_derivatives GL_EXT_map_buffer_range GL_EXT_instanced_arrays";
+        default:
+            return (const GLubyte*)"";
+    }
+}
+GLint GetUniformLocation(GLuint program, const GLchar* name)
+{
+    ++_stats.calls;
+    return findVariable(_programs[program].uniforms, name);
+}
+void Hint(GLenum, GLenum) { ++_stats.calls; }
+void LinkProgram(GLuint program)
+{
+    ++_stats.calls;
+    ++_stats.programLinks;
+    auto& prog = _programs[program];
+    prog.attributes.clear();
+    prog.uniforms.clear();
+    for (auto shader : prog.shaders)
+    {
+        auto iter = _shaders.find(shader);
+        if (iter != _shaders.end())
+            reflect(iter->second, prog);
+    }
+}
+void* MapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+{
+    upload(length);
+    if (_mapped.size() < (std::size_t)length)
+        _mapped.resize(length);
+    return _mapped.data();
+}
+void PixelStorei(GLenum, GLint) { stateChange(); }
+void ProgramBinary(GLuint, GLenum, const void*, GLsizei length) { upload(length); }
+void ReadBuffer(GLenum) { stateChange(); }
+void RenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) { ++_stats.calls; }
+void Scissor(GLint, GLint, GLsizei, GLsizei) { stateChange(); }
+void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    ++_stats.calls;
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (length && length[i] >= 0)
+            source.append(string[i], length[i]);
+        else
+            source.append(string[i]);
+    }
+    _shaders[shader].source = std::move(source);
+}
+void StencilFunc(GLenum, GLint, GLuint) { stateChange(); }
+void StencilFuncSeparate(GLenum, GLenum, GLint, GLuint) { stateChange(); }
+void StencilMask(GLuint) { stateChange(); }
+void StencilMaskSeparate(GLenum, GLuint) { stateChange(); }
+void StencilOp(GLenum, GLenum, GLenum) { stateChange(); }
+void StencilOpSeparate(GLenum, GLenum, GLenum, GLenum) { stateChange(); }
+void TexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels)
+{
+    upload(pixels ? imageSize(width, height, format, type) : 0);
+}
+void TexParameteri(GLenum, GLenum, GLint) { stateChange(); }
+void TexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void*)
+{
+    upload(imageSize(width, height, format, type));
+}
+void Uniform1f(GLint, GLfloat) { uniform(); }
+void Uniform1fv(GLint, GLsizei, const GLfloat*) { uniform(); }
+void Uniform1i(GLint, GLint) { uniform(); }
+void Uniform1iv(GLint, GLsizei, const GLint*) { uniform(); }
+void Uniform2fv(GLint, GLsizei, const GLfloat*) { uniform(); }
+void Uniform2iv(GLint, GLsizei, const GLint*) { uniform(); }
+void Uniform3fv(GLint, GLsizei, const GLfloat*) { uniform(); }
+void Uniform3iv(GLint, GLsizei, const GLint*) { uniform(); }
+void Uniform4fv(GLint, GLsizei, const GLfloat*) { uniform(); }
+void Uniform4iv(GLint, GLsizei, const GLint*) { uniform(); }
+void UniformMatrix2fv(GLint, GLsizei, GLboolean, const GLfloat*) { uniform(); }
+void UniformMatrix3fv(GLint, GLsizei, GLboolean, const GLfloat*) { uniform(); }
+void UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { uniform(); }
+GLboolean UnmapBuffer(GLenum)
+{
+    ++_stats.calls;
+    return GL_TRUE;
+}
+void UseProgram(GLuint) { stateChange(); }
+void VertexAttribDivisor(GLuint, GLuint) { stateChange(); }
+void VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { stateChange(); }
+void Viewport(GLint, GLint, GLsizei, GLsizei) { stateChange(); }
+
+}} // namespace cocos2d::nullgl
@@ -0,0 +1,371 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCGL_NULL_H__
+#define __CCGL_NULL_H__
+
+/**
+ * A GL backend that issues nothing to the driver.
+ * Every call is counted, objects get sequential names and shader reflection is
+ * emulated from the GLSL sources, so the renderer runs its full CPU path and the
+ * cost of a frame can be measured without a GPU. Enabled with USE_NULL_GL.
+ */
+
+#include <stdint.h>
+
+namespace cocos2d { namespace nullgl {
+
+struct Stats
+{
+    // All GL calls.
+    uint64_t calls = 0;
+    // glDrawArrays, glDrawElements and glDrawElementsInstanced calls.
+    uint64_t drawCalls = 0;
+    // Vertices or indices submitted by draw calls, multiplied by the instance count.
+    uint64_t primitives = 0;
+    // Pipeline state, binding and vertex layout changes.
+    uint64_t stateChanges = 0;
+    // glUniform* calls.
+    uint64_t uniformUpdates = 0;
+    // Buffer and texture data handed to GL, mapped ranges included.
+    uint64_t bytesUploaded = 0;
+    uint64_t shaderCompiles = 0;
+    uint64_t programLinks = 0;
+};
+
+const Stats& getStats();
+void resetStats();
+
+void ActiveTexture(GLenum texture);
+void AttachShader(GLuint program, GLuint shader);
+void BindBuffer(GLenum target, GLuint buffer);
+void BindFramebuffer(GLenum target, GLuint framebuffer);
+void BindRenderbuffer(GLenum target, GLuint renderbuffer);
+void BindTexture(GLenum target, GLuint texture);
+void BindVertexArray(GLuint array);
+void BlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void BlendEquation(GLenum mode);
+void BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+void BlendFunc(GLenum sfactor, GLenum dfactor);
+void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+GLenum CheckFramebufferStatus(GLenum target);
+void Clear(GLbitfield mask);
+void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void ClearDepth(double depth);
+void ClearStencil(GLint s);
+void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+void CompileShader(GLuint shader);
+void CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data);
+void CompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data);
+GLuint CreateProgram();
+GLuint CreateShader(GLenum type);
+void CullFace(GLenum mode);
+void DeleteBuffers(GLsizei n, const GLuint* buffers);
+void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void DeleteProgram(GLuint program);
+void DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void DeleteShader(GLuint shader);
+void DeleteTextures(GLsizei n, const GLuint* textures);
+void DeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void DepthFunc(GLenum func);
+void DepthMask(GLboolean flag);
+void DepthRange(double n, double f);
+void Disable(GLenum cap);
+void DisableVertexAttribArray(GLuint index);
+void DrawArrays(GLenum mode, GLint first, GLsizei count);
+void DrawBuffer(GLenum buf);
+void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+void Enable(GLenum cap);
+void EnableVertexAttribArray(GLuint index);
+void FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void GenBuffers(GLsizei n, GLuint* buffers);
+void GenerateMipmap(GLenum target);
+void GenFramebuffers(GLsizei n, GLuint* framebuffers);
+void GenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void GenTextures(GLsizei n, GLuint* textures);
+void GenVertexArrays(GLsizei n, GLuint* arrays);
+void GetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+void GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+GLint GetAttribLocation(GLuint program, const GLchar* name);
+void GetBooleanv(GLenum pname, GLboolean* data);
+GLenum GetError();
+void GetIntegerv(GLenum pname, GLint* data);
+void GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+void GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void GetProgramiv(GLuint program, GLenum pname, GLint* params);
+void GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void GetShaderiv(GLuint shader, GLenum pname, GLint* params);
+void GetShaderSource(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* source);
+const GLubyte* GetString(GLenum name);
+GLint GetUniformLocation(GLuint program, const GLchar* name);
+void Hint(GLenum target, GLenum mode);
+void LinkProgram(GLuint program);
+void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+void PixelStorei(GLenum pname, GLint param);
+void ProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+void ReadBuffer(GLenum src);
+void RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void StencilFunc(GLenum func, GLint ref, GLuint mask);
+void StencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask);
+void StencilMask(GLuint mask);
+void StencilMaskSeparate(GLenum face, GLuint mask);
+void StencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+void StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+void TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+void TexParameteri(GLenum target, GLenum pname, GLint param);
+void TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+void Uniform1f(GLint location, GLfloat v0);
+void Uniform1fv(GLint location, GLsizei count, const GLfloat* value);
+void Uniform1i(GLint location, GLint v0);
+void Uniform1iv(GLint location, GLsizei count, const GLint* value);
+void Uniform2fv(GLint location, GLsizei count, const GLfloat* value);
+void Uniform2iv(GLint location, GLsizei count, const GLint* value);
+void Uniform3fv(GLint location, GLsizei count, const GLfloat* value);
+void Uniform3iv(GLint location, GLsizei count, const GLint* value);
+void Uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+void Uniform4iv(GLint location, GLsizei count, const GLint* value);
+void UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+GLboolean UnmapBuffer(GLenum target);
+void UseProgram(GLuint program);
+void VertexAttribDivisor(GLuint index, GLuint divisor);
+void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+}} // namespace cocos2d::nullgl
+
+// Route the engine's GL calls to the null backend, platform aliases included.
+#undef glActiveTexture
+#define glActiveTexture               ::cocos2d::nullgl::ActiveTexture
+#undef glAttachShader
+#define glAttachShader                ::cocos2d::nullgl::AttachShader
+#undef glBindBuffer
+#define glBindBuffer                  ::cocos2d::nullgl::BindBuffer
+#undef glBindFramebuffer
+#define glBindFramebuffer             ::cocos2d::nullgl::BindFramebuffer
+#undef glBindRenderbuffer
+#define glBindRenderbuffer            ::cocos2d::nullgl::BindRenderbuffer
+#undef glBindTexture
+#define glBindTexture                 ::cocos2d::nullgl::BindTexture
+#undef glBindVertexArray
+#define glBindVertexArray             ::cocos2d::nullgl::BindVertexArray
+#undef glBlendColor
+#define glBlendColor                  ::cocos2d::nullgl::BlendColor
+#undef glBlendEquation
+#define glBlendEquation               ::cocos2d::nullgl::BlendEquation
+#undef glBlendEquationSeparate
+#define glBlendEquationSeparate       ::cocos2d::nullgl::BlendEquationSeparate
+#undef glBlendFunc
+#define glBlendFunc                   ::cocos2d::nullgl::BlendFunc
+#undef glBlendFuncSeparate
+#define glBlendFuncSeparate           ::cocos2d::nullgl::BlendFuncSeparate
+#undef glBufferData
+#define glBufferData                  ::cocos2d::nullgl::BufferData
+#undef glBufferSubData
+#define glBufferSubData               ::cocos2d::nullgl::BufferSubData
+#undef glCheckFramebufferStatus
+#define glCheckFramebufferStatus      ::cocos2d::nullgl::CheckFramebufferStatus
+#undef glClear
+#define glClear                       ::cocos2d::nullgl::Clear
+#undef glClearColor
+#define glClearColor                  ::cocos2d::nullgl::ClearColor
+#undef glClearDepth
+#define glClearDepth                  ::cocos2d::nullgl::ClearDepth
+#undef glClearStencil
+#define glClearStencil                ::cocos2d::nullgl::ClearStencil
+#undef glColorMask
+#define glColorMask                   ::cocos2d::nullgl::ColorMask
+#undef glCompileShader
+#define glCompileShader               ::cocos2d::nullgl::CompileShader
+#undef glCompressedTexImage2D
+#define glCompressedTexImage2D        ::cocos2d::nullgl::CompressedTexImage2D
+#undef glCompressedTexSubImage2D
+#define glCompressedTexSubImage2D     ::cocos2d::nullgl::CompressedTexSubImage2D
+#undef glCreateProgram
+#define glCreateProgram               ::cocos2d::nullgl::CreateProgram
+#undef glCreateShader
+#define glCreateShader                ::cocos2d::nullgl::CreateShader
+#undef glCullFace
+#define glCullFace                    ::cocos2d::nullgl::CullFace
+#undef glDeleteBuffers
+#define glDeleteBuffers               ::cocos2d::nullgl::DeleteBuffers
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers          ::cocos2d::nullgl::DeleteFramebuffers
+#undef glDeleteProgram
+#define glDeleteProgram               ::cocos2d::nullgl::DeleteProgram
+#undef glDeleteRenderbuffers
+#define glDeleteRenderbuffers         ::cocos2d::nullgl::DeleteRenderbuffers
+#undef glDeleteShader
+#define glDeleteShader                ::cocos2d::nullgl::DeleteShader
+#undef glDeleteTextures
+#define glDeleteTextures              ::cocos2d::nullgl::DeleteTextures
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays          ::cocos2d::nullgl::DeleteVertexArrays
+#undef glDepthFunc
+#define glDepthFunc                   ::cocos2d::nullgl::DepthFunc
+#undef glDepthMask
+#define glDepthMask                   ::cocos2d::nullgl::DepthMask
+#undef glDepthRange
+#define glDepthRange                  ::cocos2d::nullgl::DepthRange
+#undef glDisable
+#define glDisable                     ::cocos2d::nullgl::Disable
+#undef glDisableVertexAttribArray
+#define glDisableVertexAttribArray    ::cocos2d::nullgl::DisableVertexAttribArray
+#undef glDrawArrays
+#define glDrawArrays                  ::cocos2d::nullgl::DrawArrays
+#undef glDrawBuffer
+#define glDrawBuffer                  ::cocos2d::nullgl::DrawBuffer
+#undef glDrawElements
+#define glDrawElements                ::cocos2d::nullgl::DrawElements
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced       ::cocos2d::nullgl::DrawElementsInstanced
+#undef glEnable
+#define glEnable                      ::cocos2d::nullgl::Enable
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray     ::cocos2d::nullgl::EnableVertexAttribArray
+#undef glFramebufferRenderbuffer
+#define glFramebufferRenderbuffer     ::cocos2d::nullgl::FramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D        ::cocos2d::nullgl::FramebufferTexture2D
+#undef glGenBuffers
+#define glGenBuffers                  ::cocos2d::nullgl::GenBuffers
+#undef glGenerateMipmap
+#define glGenerateMipmap              ::cocos2d::nullgl::GenerateMipmap
+#undef glGenFramebuffers
+#define glGenFramebuffers             ::cocos2d::nullgl::GenFramebuffers
+#undef glGenRenderbuffers
+#define glGenRenderbuffers            ::cocos2d::nullgl::GenRenderbuffers
+#undef glGenTextures
+#define glGenTextures                 ::cocos2d::nullgl::GenTextures
+#undef glGenVertexArrays
+#define glGenVertexArrays             ::cocos2d::nullgl::GenVertexArrays
+#undef glGetActiveAttrib
+#define glGetActiveAttrib             ::cocos2d::nullgl::GetActiveAttrib
+#undef glGetActiveUniform
+#define glGetActiveUniform            ::cocos2d::nullgl::GetActiveUniform
+#undef glGetAttribLocation
+#define glGetAttribLocation           ::cocos2d::nullgl::GetAttribLocation
+#undef glGetBooleanv
+#define glGetBooleanv                 ::cocos2d::nullgl::GetBooleanv
+#undef glGetError
+#define glGetError                    ::cocos2d::nullgl::GetError
+#undef glGetIntegerv
+#define glGetIntegerv                 ::cocos2d::nullgl::GetIntegerv
+#undef glGetProgramBinary
+#define glGetProgramBinary            ::cocos2d::nullgl::GetProgramBinary
+#undef glGetProgramInfoLog
+#define glGetProgramInfoLog           ::cocos2d::nullgl::GetProgramInfoLog
+#undef glGetProgramiv
+#define glGetProgramiv                ::cocos2d::nullgl::GetProgramiv
+#undef glGetShaderInfoLog
+#define glGetShaderInfoLog            ::cocos2d::nullgl::GetShaderInfoLog
+#undef glGetShaderiv
+#define glGetShaderiv                 ::cocos2d::nullgl::GetShaderiv
+#undef glGetShaderSource
+#define glGetShaderSource             ::cocos2d::nullgl::GetShaderSource
+#undef glGetString
+#define glGetString                   ::cocos2d::nullgl::GetString
+#undef glGetUniformLocation
+#define glGetUniformLocation          ::cocos2d::nullgl::GetUniformLocation
+#undef glHint
+#define glHint                        ::cocos2d::nullgl::Hint
+#undef glLinkProgram
+#define glLinkProgram                 ::cocos2d::nullgl::LinkProgram
+#undef glMapBufferRange
+#define glMapBufferRange              ::cocos2d::nullgl::MapBufferRange
+#undef glPixelStorei
+#define glPixelStorei                 ::cocos2d::nullgl::PixelStorei
+#undef glProgramBinary
+#define glProgramBinary               ::cocos2d::nullgl::ProgramBinary
+#undef glReadBuffer
+#define glReadBuffer                  ::cocos2d::nullgl::ReadBuffer
+#undef glRenderbufferStorage
+#define glRenderbufferStorage         ::cocos2d::nullgl::RenderbufferStorage
+#undef glScissor
+#define glScissor                     ::cocos2d::nullgl::Scissor
+#undef glShaderSource
+#define glShaderSource                ::cocos2d::nullgl::ShaderSource
+#undef glStencilFunc
+#define glStencilFunc                 ::cocos2d::nullgl::StencilFunc
+#undef glStencilFuncSeparate
+#define glStencilFuncSeparate         ::cocos2d::nullgl::StencilFuncSeparate
+#undef glStencilMask
+#define glStencilMask                 ::cocos2d::nullgl::StencilMask
+#undef glStencilMaskSeparate
+#define glStencilMaskSeparate         ::cocos2d::nullgl::StencilMaskSeparate
+#undef glStencilOp
+#define glStencilOp                   ::cocos2d::nullgl::StencilOp
+#undef glStencilOpSeparate
+#define glStencilOpSeparate           ::cocos2d::nullgl::StencilOpSeparate
+#undef glTexImage2D
+#define glTexImage2D                  ::cocos2d::nullgl::TexImage2D
+#undef glTexParameteri
+#define glTexParameteri               ::cocos2d::nullgl::TexParameteri
+#undef glTexSubImage2D
+#define glTexSubImage2D               ::cocos2d::nullgl::TexSubImage2D
+#undef glUniform1f
+#define glUniform1f                   ::cocos2d::nullgl::Uniform1f
+#undef glUniform1fv
+#define glUniform1fv                  ::cocos2d::nullgl::Uniform1fv
+#undef glUniform1i
+#define glUniform1i                   ::cocos2d::nullgl::Uniform1i
+#undef glUniform1iv
+#define glUniform1iv                  ::cocos2d::nullgl::Uniform1iv
+#undef glUniform2fv
+#define glUniform2fv                  ::cocos2d::nullgl::Uniform2fv
+#undef glUniform2iv
+#define glUniform2iv                  ::cocos2d::nullgl::Uniform2iv
+#undef glUniform3fv
+#define glUniform3fv                  ::cocos2d::nullgl::Uniform3fv
+#undef glUniform3iv
+#define glUniform3iv                  ::cocos2d::nullgl::Uniform3iv
+#undef glUniform4fv
+#define glUniform4fv                  ::cocos2d::nullgl::Uniform4fv
+#undef glUniform4iv
+#define glUniform4iv                  ::cocos2d::nullgl::Uniform4iv
+#undef glUniformMatrix2fv
+#define glUniformMatrix2fv            ::cocos2d::nullgl::UniformMatrix2fv
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv            ::cocos2d::nullgl::UniformMatrix3fv
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv            ::cocos2d::nullgl::UniformMatrix4fv
+#undef glUnmapBuffer
+#define glUnmapBuffer                 ::cocos2d::nullgl::UnmapBuffer
+#undef glUseProgram
+#define glUseProgram                  ::cocos2d::nullgl::UseProgram
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor         ::cocos2d::nullgl::VertexAttribDivisor
+#undef glVertexAttribPointer
+#define glVertexAttribPointer         ::cocos2d::nullgl::VertexAttribPointer
+#undef glViewport
+#define glViewport                    ::cocos2d::nullgl::Viewport
+
+#endif // __CCGL_NULL_H__
@@ -0,0 +1,273 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CommandBuffer.h"
+#include "FrameBuffer.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Texture.h"
+#include "Program.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <algorithm>
+
+RENDERER_BEGIN
+
+namespace
+{
+    void appendFormat(std::string& out, const char* format, ...)
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len > 0)
+            out.append(buf, std::min(len, (int)sizeof(buf) - 1));
+    }
+    
+    template <typename T>
+    unsigned int toUInt(T value)
+    {
+        return static_cast<unsigned int>(value);
+    }
+    
+    void dumpState(std::string& out, const State* state)
+    {
+        auto program = state->getProgram();
+        auto indexBuffer = state->getIndexBuffer();
+        appendFormat(out, " primitive=%u program=%u ib=%u vb=[",
+                     toUInt(state->primitiveType),
+                     program ? program->getHandle() : 0,
+                     indexBuffer ? indexBuffer->getHandle() : 0);
+        for (int i = 0; i <= state->maxStream; ++i)
+        {
+            auto vb = state->getVertexBuffer(i);
+            appendFormat(out, i > 0 ? " %u+%d" : "%u+%d", vb ? vb->getHandle() : 0, state->getVertexBufferOffset(i));
+        }
+        out += "] tex=[";
+        const auto& textureUnits = state->getTextureUnits();
+        bool first = true;
+        for (size_t i = 0, len = textureUnits.size(); i < len; ++i)
+        {
+            if (!textureUnits[i])
+                continue;
+            appendFormat(out, first ? "%u:%u" : " %u:%u", (unsigned int)i, textureUnits[i]->getHandle());
+            first = false;
+        }
+        out += "]";
+        
+        if (state->blend)
+        {
+            appendFormat(out, " blend=%x,%x,%x,%x,%x,%x color=%08x",
+                         toUInt(state->blendEq), toUInt(state->blendAlphaEq),
+                         toUInt(state->blendSrc), toUInt(state->blendDst),
+                         toUInt(state->blendSrcAlpha), toUInt(state->blendDstAlpha),
+                         state->blendColor);
+        }
+        if (state->depthTest)
+        {
+            appendFormat(out, " depth=%x write=%d", toUInt(state->depthFunc), state->depthWrite ? 1 : 0);
+        }
+        if (state->stencilTest)
+        {
+            appendFormat(out, " stencil=%x,%d,%x,%x,%x,%x,%x/%x,%d,%x,%x,%x,%x,%x",
+                         toUInt(state->stencilFuncFront), state->stencilRefFront, state->stencilMaskFront,
+                         toUInt(state->stencilFailOpFront), toUInt(state->stencilZFailOpFront),
+                         toUInt(state->stencilZPassOpFront), state->stencilWriteMaskFront,
+                         toUInt(state->stencilFuncBack), state->stencilRefBack, state->stencilMaskBack,
+                         toUInt(state->stencilFailOpBack), toUInt(state->stencilZFailOpBack),
+                         toUInt(state->stencilZPassOpBack), state->stencilWriteMaskBack);
+        }
+        appendFormat(out, " cull=%x", toUInt(state->cullMode));
+    }
+}
+
+CommandBuffer::CommandBuffer()
+{
+}
+
+CommandBuffer::~CommandBuffer()
+{
+    reset();
+    
+    for (auto state : _states)
+    {
+        delete state;
+    }
+    _states.clear();
+}
+
+void CommandBuffer::reset()
+{
+    for (uint32_t i = 0; i < _stateCount; ++i)
+    {
+        _states[i]->reset();
+    }
+    _stateCount = 0;
+    
+    for (auto fb : _frameBuffers)
+    {
+        RENDERER_SAFE_RELEASE(fb);
+    }
+    _frameBuffers.clear();
+    
+    _commands.clear();
+    _uniforms.clear();
+    _uniformData.clear();
+}
+
+void CommandBuffer::recordFrameBuffer(const FrameBuffer* fb)
+{
+    auto frameBuffer = const_cast<FrameBuffer*>(fb);
+    RENDERER_SAFE_RETAIN(frameBuffer);
+    _frameBuffers.push_back(frameBuffer);
+    
+    Command command;
+    command.type = CommandType::FRAME_BUFFER;
+    command.frameBuffer = fb;
+    _commands.push_back(command);
+}
+
+void CommandBuffer::recordViewport(int x, int y, int w, int h)
+{
+    Command command;
+    command.type = CommandType::VIEWPORT;
+    command.rect = { x, y, w, h };
+    _commands.push_back(command);
+}
+
+void CommandBuffer::recordScissor(int x, int y, int w, int h)
+{
+    Command command;
+    command.type = CommandType::SCISSOR;
+    command.rect = { x, y, w, h };
+    _commands.push_back(command);
+}
+
+void CommandBuffer::recordClear(uint8_t flags, const Color4F* color, double depth, int32_t stencil)
+{
+    Command command;
+    command.type = CommandType::CLEAR;
+    command.clear.flags = flags;
+    command.clear.color[0] = color ? color->r : 0;
+    command.clear.color[1] = color ? color->g : 0;
+    command.clear.color[2] = color ? color->b : 0;
+    command.clear.color[3] = color ? color->a : 0;
+    command.clear.depth = depth;
+    command.clear.stencil = stencil;
+    _commands.push_back(command);
+}
+
+State* CommandBuffer::recordDraw(size_t base, GLsizei count, GLsizei instanceCount)
+{
+    if (_stateCount >= _states.size())
+    {
+        _states.push_back(new State());
+    }
+    
+    Command command;
+    command.type = CommandType::DRAW;
+    command.draw.state = _stateCount;
+    command.draw.base = (uint32_t)base;
+    command.draw.count = count;
+    command.draw.instanceCount = instanceCount;
+    command.draw.uniformStart = (uint32_t)_uniforms.size();
+    command.draw.uniformCount = 0;
+    _commands.push_back(command);
+    
+    return _states[_stateCount++];
+}
+
+void CommandBuffer::recordUniform(uint32_t index, UniformElementType elementType, const void* value, uint32_t bytes)
+{
+    assert(!_commands.empty() && _commands.back().type == CommandType::DRAW);
+    
+    UniformValue uniform;
+    uniform.index = index;
+    uniform.elementType = elementType;
+    uniform.offset = (uint32_t)_uniformData.size();
+    uniform.bytes = bytes;
+    _uniforms.push_back(uniform);
+    
+    const uint8_t* data = static_cast<const uint8_t*>(value);
+    _uniformData.insert(_uniformData.end(), data, data + bytes);
+    
+    _commands.back().draw.uniformCount++;
+}
+
+std::string CommandBuffer::dump() const
+{
+    std::string out;
+    for (const auto& command : _commands)
+    {
+        switch (command.type)
+        {
+            case CommandType::FRAME_BUFFER:
+                appendFormat(out, "framebuffer %u\n", command.frameBuffer ? command.frameBuffer->getHandle() : 0);
+                break;
+            case CommandType::VIEWPORT:
+                appendFormat(out, "viewport %d %d %d %d\n", command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+                break;
+            case CommandType::SCISSOR:
+                appendFormat(out, "scissor %d %d %d %d\n", command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+                break;
+            case CommandType::CLEAR:
+                appendFormat(out, "clear %u %g %g %g %g %g %d\n", command.clear.flags,
+                             command.clear.color[0], command.clear.color[1], command.clear.color[2], command.clear.color[3],
+                             command.clear.depth, command.clear.stencil);
+                break;
+            case CommandType::DRAW:
+            {
+                const auto& draw = command.draw;
+                const State* state = _states[draw.state];
+                appendFormat(out, "draw base=%u count=%d instances=%d", draw.base, draw.count, draw.instanceCount);
+                dumpState(out, state);
+                out += "\n";
+                
+                auto program = state->getProgram();
+                for (uint32_t i = draw.uniformStart, end = draw.uniformStart + draw.uniformCount; i < end; ++i)
+                {
+                    const auto& uniform = _uniforms[i];
+                    const char* name = program && uniform.index < program->getUniforms().size() ? program->getUniforms()[uniform.index].name.c_str() : "?";
+                    appendFormat(out, "  uniform %s", name);
+                    const uint8_t* data = getUniformData(uniform);
+                    for (uint32_t offset = 0; offset + 4 <= uniform.bytes; offset += 4)
+                    {
+                        if (uniform.elementType == UniformElementType::INT)
+                            appendFormat(out, " %d", *(const int32_t*)(data + offset));
+                        else
+                            appendFormat(out, " %g", *(const float*)(data + offset));
+                    }
+                    out += "\n";
+                }
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+RENDERER_END
@@ -0,0 +1,162 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "base/ccTypes.h"
+#include "../Macro.h"
+#include "../Types.h"
+#include "State.h"
+
+RENDERER_BEGIN
+
+class FrameBuffer;
+
+/**
+ * @addtogroup gfx
+ * @{
+ */
+
+/**
+ * CommandBuffer stores the frame buffer bindings, viewports, clears and draws issued to DeviceGraphics while it is recording.
+ * Recording doesn't touch GL, so a command stream can be built and dumped without a GL context, the commands are
+ * replayed in order by DeviceGraphics::execute on the thread which owns the context.
+ * The states and uniform storage are reused by later frames, so steady recording doesn't allocate.
+ * @see `DeviceGraphics::beginRecording`
+ */
+class CommandBuffer final
+{
+public:
+    enum class CommandType : uint8_t
+    {
+        FRAME_BUFFER,
+        VIEWPORT,
+        SCISSOR,
+        CLEAR,
+        DRAW
+    };
+    
+    struct Rect
+    {
+        int x;
+        int y;
+        int w;
+        int h;
+    };
+    
+    struct Clear
+    {
+        float color[4];
+        double depth;
+        int32_t stencil;
+        uint8_t flags;
+    };
+    
+    struct Draw
+    {
+        /** index of the states in getState */
+        uint32_t state;
+        uint32_t base;
+        GLsizei count;
+        GLsizei instanceCount;
+        /** range of the uniform values uploaded before the draw */
+        uint32_t uniformStart;
+        uint32_t uniformCount;
+    };
+    
+    /**
+     * A recorded command, the member of the union is selected by type
+     */
+    struct Command
+    {
+        CommandType type;
+        union
+        {
+            const FrameBuffer* frameBuffer;
+            Rect rect;
+            Clear clear;
+            Draw draw;
+        };
+    };
+    
+    /**
+     * A uniform value of the program used by a draw
+     */
+    struct UniformValue
+    {
+        /** index in the uniforms of the program */
+        uint32_t index;
+        UniformElementType elementType;
+        /** byte offset in the uniform data */
+        uint32_t offset;
+        uint32_t bytes;
+    };
+    
+    CommandBuffer();
+    ~CommandBuffer();
+    
+    /**
+     * Removes all commands and releases the objects they reference
+     */
+    void reset();
+    
+    void recordFrameBuffer(const FrameBuffer* fb);
+    void recordViewport(int x, int y, int w, int h);
+    void recordScissor(int x, int y, int w, int h);
+    void recordClear(uint8_t flags, const Color4F* color, double depth, int32_t stencil);
+    /**
+     * Records a draw, the returned State should be filled with the states of the draw
+     */
+    State* recordDraw(size_t base, GLsizei count, GLsizei instanceCount);
+    /**
+     * Appends a uniform value to the last recorded draw
+     */
+    void recordUniform(uint32_t index, UniformElementType elementType, const void* value, uint32_t bytes);
+    
+    inline const std::vector<Command>& getCommands() const { return _commands; }
+    inline const State* getState(uint32_t index) const { return _states[index]; }
+    inline const UniformValue& getUniform(uint32_t index) const { return _uniforms[index]; }
+    inline const uint8_t* getUniformData(const UniformValue& uniform) const { return _uniformData.data() + uniform.offset; }
+    inline bool empty() const { return _commands.empty(); }
+    
+    /**
+     * Prints one line per command, GL objects are printed by their handles so that streams recorded by different runs can be diffed
+     */
+    std::string dump() const;
+    
+private:
+    std::vector<Command> _commands;
+    // Pooled states, the first _stateCount ones are used by the recorded draws.
+    std::vector<State*> _states;
+    uint32_t _stateCount = 0;
+    std::vector<UniformValue> _uniforms;
+    std::vector<uint8_t> _uniformData;
+    std::vector<FrameBuffer*> _frameBuffers;
+};
+
+
+RENDERER_END
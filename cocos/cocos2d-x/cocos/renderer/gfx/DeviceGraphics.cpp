@@ -26,6 +26,8 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "FrameBuffer.h"
+#include "CommandBuffer.h"
+#include "TextureUploader.h"
 #include "GraphicsHandle.h"
 #include "Texture2D.h"
 #include "RenderTarget.h"
@@ -34,6 +36,8 @@
 
 #include "platform/CCPlatformConfig.h"
 #include "base/CCGLUtils.h"
+#include "base/CCConfiguration.h"
+#include "math/MathUtil.h"
 
 RENDERER_BEGIN
 
@@ -66,6 +70,12 @@ DeviceGraphics* DeviceGraphics::getInstance()
 
 void DeviceGraphics::setFrameBuffer(const FrameBuffer* fb)
 {
+    if (_commandBuffer)
+    {
+        _commandBuffer->recordFrameBuffer(fb);
+        return;
+    }
+    
     if (fb == _frameBuffer)
         return;
     
@@ -111,6 +121,12 @@ void DeviceGraphics::setFrameBuffer(const FrameBuffer* fb)
 
 void DeviceGraphics::setViewport(int x, int y, int w, int h)
 {
+    if (_commandBuffer)
+    {
+        _commandBuffer->recordViewport(x, y, w, h);
+        return;
+    }
+    
     if (_vx != x ||
         _vy != y ||
         _vw != w ||
@@ -126,6 +142,12 @@ void DeviceGraphics::setViewport(int x, int y, int w, int h)
 
 void DeviceGraphics::setScissor(int x, int y, int w, int h)
 {
+    if (_commandBuffer)
+    {
+        _commandBuffer->recordScissor(x, y, w, h);
+        return;
+    }
+    
     if (_sx != x ||
         _sy != y ||
         _sw != w ||
@@ -141,6 +163,12 @@ void DeviceGraphics::setScissor(int x, int y, int w, int h)
 
 void DeviceGraphics::clear(uint8_t flags, Color4F *color, double depth, int32_t stencil)
 {
+    if (_commandBuffer)
+    {
+        _commandBuffer->recordClear(flags, color, depth, stencil);
+        return;
+    }
+    
     GLbitfield mask = 0;
     if (flags & ClearFlag::COLOR)
     {
@@ -356,26 +384,81 @@ void DeviceGraphics::setTextureArray(size_t hashName, const std::vector<Texture*
     setUniformiv(hashName, slots.size(), slots.data());
 }
 
+void DeviceGraphics::setTextureSlot(int uniformSlot, Texture* const* textures, int count, int firstSlot)
+{
+    if (firstSlot + count > _caps.maxTextureUnits)
+    {
+        RENDERER_LOGW("Can not set %d textures at stage %d, max texture exceed: %d",
+                 count, firstSlot, _caps.maxTextureUnits);
+        return;
+    }
+    
+    _textureSlots.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        _nextState->setTexture(firstSlot + i, textures[i]);
+        _textureSlots[i] = firstSlot + i;
+    }
+    
+    setUniformSlot(uniformSlot, _textureSlots.data(), count * sizeof(int), UniformElementType::INT);
+}
+
 void DeviceGraphics::setPrimitiveType(PrimitiveType type)
 {
     _nextState->primitiveType = type;
 }
 
 void DeviceGraphics::draw(size_t base, GLsizei count)
+{
+    commitDraw(base, count, 0);
+}
+
+void DeviceGraphics::drawInstanced(size_t base, GLsizei count, GLsizei instanceCount)
+{
+    if (!_instancedArraysSupported)
+    {
+        RENDERER_LOGW("Instanced arrays are not supported.");
+        return;
+    }
+    commitDraw(base, count, instanceCount);
+}
+
+void DeviceGraphics::commitDraw(size_t base, GLsizei count, GLsizei instanceCount)
+{
+    if (_commandBuffer)
+    {
+        recordDraw(base, count, instanceCount);
+        return;
+    }
+    
+    commitDrawStates();
+    commitUniforms();
+    issueDraw(base, count, instanceCount);
+}
+
+void DeviceGraphics::commitDrawStates()
 {
     commitBlendStates();
     commitDepthStates();
     commitStencilStates();
     commitCullMode();
-    commitVertexBuffer();
     
     auto nextIndexBuffer = _nextState->getIndexBuffer();
-    if (_currentState->getIndexBuffer() != nextIndexBuffer)
+    if (_vertexArraySupported)
     {
-        GL_CHECK(ccBindBuffer(GL_ELEMENT_ARRAY_BUFFER, nextIndexBuffer ? nextIndexBuffer->getHandle() : 0));
+        // The index buffer binding is part of the vertex array.
+        commitVertexArray(_currentState->getIndexBuffer() != nextIndexBuffer);
+    }
+    else
+    {
+        commitVertexBuffer();
+        
+        if (_currentState->getIndexBuffer() != nextIndexBuffer)
+        {
+            GL_CHECK(ccBindBuffer(GL_ELEMENT_ARRAY_BUFFER, nextIndexBuffer ? nextIndexBuffer->getHandle() : 0));
+        }
     }
     
-    bool programDirty = false;
     if (_currentState->getProgram() != _nextState->getProgram())
     {
         if (_nextState->getProgram()->isLinked())
@@ -384,28 +467,64 @@ void DeviceGraphics::draw(size_t base, GLsizei count)
         }
         else
             RENDERER_LOGW("Failed to use program: has not linked yet.");
-            
-        programDirty = true;
     }
     
     commitTextures();
-    
+}
+
+void DeviceGraphics::commitUniforms()
+{
+    // Uniform values are kept by each gl program, so only the slots changed since the program
+    // committed them last time need to be uploaded.
     const auto& uniformsInfo = _nextState->getProgram()->getUniforms();
+    const uint8_t* arena = _uniformArena.data();
     for (const auto& uniformInfo : uniformsInfo)
     {
-        auto iter = _uniforms.find(uniformInfo.hashName);
-        if (_uniforms.end() == iter)
+        const auto& uniform = _uniformSlots[uniformInfo.slot];
+        if (uniform.version == uniformInfo.version)
             continue;
         
-        auto& uniform = iter->second;
-        if (!programDirty && !uniform.dirty)
+        uniformInfo.version = uniform.version;
+        uniformInfo.setUniform(arena + uniform.offset, uniform.elementType);
+    }
+}
+
+void DeviceGraphics::recordDraw(size_t base, GLsizei count, GLsizei instanceCount)
+{
+    State* state = _commandBuffer->recordDraw(base, count, instanceCount);
+    *state = *_nextState;
+    
+    // The values are consumed as if they were committed, execute uploads them before the draw.
+    const auto& uniformsInfo = _nextState->getProgram()->getUniforms();
+    const uint8_t* arena = _uniformArena.data();
+    for (uint32_t i = 0, len = (uint32_t)uniformsInfo.size(); i < len; ++i)
+    {
+        const auto& uniformInfo = uniformsInfo[i];
+        const auto& uniform = _uniformSlots[uniformInfo.slot];
+        if (uniform.version == uniformInfo.version)
             continue;
         
-        uniform.dirty = false;
-        uniformInfo.setUniform(uniform.value, uniform.elementType);
+        uniformInfo.version = uniform.version;
+        _commandBuffer->recordUniform(i, uniform.elementType, arena + uniform.offset, uniform.bytes);
     }
     
-    if (nextIndexBuffer)
+    _nextState->reset();
+}
+
+void DeviceGraphics::issueDraw(size_t base, GLsizei count, GLsizei instanceCount)
+{
+    auto nextIndexBuffer = _nextState->getIndexBuffer();
+    if (instanceCount > 0 && nextIndexBuffer)
+    {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+        GL_CHECK(glDrawElementsInstanced(ENUM_CLASS_TO_GLENUM(_nextState->primitiveType),
+                                         count,
+                                         ENUM_CLASS_TO_GLENUM(nextIndexBuffer->getFormat()),
+                                         (GLvoid *)(base * nextIndexBuffer->getBytesPerIndex()),
+                                         instanceCount));
+#endif
+    }
+    else if (nextIndexBuffer)
     {
         GL_CHECK(glDrawElements(ENUM_CLASS_TO_GLENUM(_nextState->primitiveType),
                        count,
@@ -426,19 +545,104 @@ void DeviceGraphics::draw(size_t base, GLsizei count)
     _nextState->reset();
 }
 
+void DeviceGraphics::beginRecording(CommandBuffer* buffer)
+{
+    buffer->reset();
+    _commandBuffer = buffer;
+}
+
+void DeviceGraphics::endRecording()
+{
+    _commandBuffer = nullptr;
+}
+
+void DeviceGraphics::execute(const CommandBuffer* buffer)
+{
+    assert(!_commandBuffer);
+    
+    for (const auto& command : buffer->getCommands())
+    {
+        switch (command.type)
+        {
+            case CommandBuffer::CommandType::FRAME_BUFFER:
+                setFrameBuffer(command.frameBuffer);
+                break;
+            case CommandBuffer::CommandType::VIEWPORT:
+                setViewport(command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+                break;
+            case CommandBuffer::CommandType::SCISSOR:
+                setScissor(command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+                break;
+            case CommandBuffer::CommandType::CLEAR:
+            {
+                const auto& clearCommand = command.clear;
+                Color4F color(clearCommand.color[0], clearCommand.color[1], clearCommand.color[2], clearCommand.color[3]);
+                clear(clearCommand.flags, &color, clearCommand.depth, clearCommand.stencil);
+                break;
+            }
+            case CommandBuffer::CommandType::DRAW:
+            {
+                const auto& draw = command.draw;
+                *_nextState = *buffer->getState(draw.state);
+                commitDrawStates();
+                
+                const auto& uniformsInfo = _nextState->getProgram()->getUniforms();
+                for (uint32_t i = draw.uniformStart, end = draw.uniformStart + draw.uniformCount; i < end; ++i)
+                {
+                    const auto& uniform = buffer->getUniform(i);
+                    uniformsInfo[uniform.index].setUniform(buffer->getUniformData(uniform), uniform.elementType);
+                }
+                
+                issueDraw(draw.base, draw.count, draw.instanceCount);
+                break;
+            }
+        }
+    }
+    
+    unbindVertexArray();
+}
+
 void DeviceGraphics::setUniform(size_t hashName, const void* v, size_t bytes, UniformElementType elementType)
 {
-    auto iter = _uniforms.find(hashName);
-    if (iter == _uniforms.end())
+    setUniformSlot(getUniformSlot(hashName), v, bytes, elementType);
+}
+
+int DeviceGraphics::getUniformSlot(size_t hashName)
+{
+    auto iter = _uniformSlotIndices.find(hashName);
+    if (iter != _uniformSlotIndices.end())
+        return iter->second;
+    
+    int slot = (int)_uniformSlots.size();
+    _uniformSlots.emplace_back();
+    _uniformSlotIndices.emplace(hashName, slot);
+    return slot;
+}
+
+void DeviceGraphics::setUniformSlot(int slot, const void* v, size_t bytes, UniformElementType elementType)
+{
+    auto& uniform = _uniformSlots[slot];
+    if (bytes > uniform.capacity)
     {
-        _uniforms[hashName] = Uniform(v, bytes, elementType);
+        // Outgrown values are moved to the end of the arena, the old range is left unused.
+        // Uniform sizes are fixed by the shaders, so the arena stops growing after warm up.
+        uint32_t capacity = (uint32_t)((bytes + 15) & ~(size_t)15);
+        uniform.offset = (uint32_t)_uniformArena.size();
+        uniform.capacity = capacity;
+        _uniformArena.resize(_uniformArena.size() + capacity);
     }
-    else
+    else if (uniform.version != 0 &&
+             uniform.bytes == bytes &&
+             uniform.elementType == elementType &&
+             memcmp(_uniformArena.data() + uniform.offset, v, bytes) == 0)
     {
-        auto& uniform = iter->second;
-        uniform.dirty = true;
-        uniform.setValue(v, bytes);
+        return;
     }
+    
+    memcpy(_uniformArena.data() + uniform.offset, v, bytes);
+    uniform.bytes = (uint32_t)bytes;
+    uniform.elementType = elementType;
+    uniform.version = ++_uniformVersion;
 }
 
 void DeviceGraphics::setUniformi(size_t hashName, int i1)
@@ -549,6 +753,7 @@ DeviceGraphics::DeviceGraphics()
     
     _newAttributes.resize(_caps.maxVertexAttributes);
     _enabledAtrributes.resize(_caps.maxVertexAttributes);
+    _attributeDivisors.resize(_caps.maxVertexAttributes);
     
     
     _currentState = new State();
@@ -558,12 +763,55 @@ DeviceGraphics::DeviceGraphics()
     _nextState->setTexture(_caps.maxTextureUnits, nullptr);
     
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_defaultFbo);
+    
+    _vertexArraySupported = Configuration::getInstance()->supportsShareableVAO();
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    // Entry points are resolved at runtime on Android.
+    _vertexArraySupported = _vertexArraySupported &&
+        glGenVertexArraysOESEXT && glBindVertexArrayOESEXT && glDeleteVertexArraysOESEXT;
+#endif
+    
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+    _mapBufferRangeSupported = Configuration::getInstance()->supportsMapBufferRange();
+#endif
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    _mapBufferRangeSupported = _mapBufferRangeSupported && glMapBufferRangeEXTEXT && glUnmapBufferOESEXT;
+#endif
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    GLint binaryFormats = 0;
+    if (Configuration::getInstance()->supportsProgramBinary())
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    // Some drivers expose the entry points but accept no binary format at all.
+    _programBinarySupported = binaryFormats > 0 && glGetProgramBinaryOESEXT && glProgramBinaryOESEXT;
+#endif
+    
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+    _instancedArraysSupported = Configuration::getInstance()->supportsInstancedArrays();
+#endif
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    _instancedArraysSupported = _instancedArraysSupported && glDrawElementsInstancedEXTEXT && glVertexAttribDivisorEXTEXT;
+#endif
+    
+    // Staging buffers are written through glMapBufferRange.
+    _pixelBufferSupported = Configuration::getInstance()->supportsPixelBufferObject() && _mapBufferRangeSupported;
+    _textureUploader = new TextureUploader(this);
 }
 
 DeviceGraphics::~DeviceGraphics()
 {
+    unbindVertexArray();
+    for (auto& iter : _vertexArrays)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &iter.second));
+    }
+    _vertexArrays.clear();
+    
     RENDERER_SAFE_RELEASE(_frameBuffer);
     
+    delete _textureUploader;
+    _textureUploader = nullptr;
+    
     delete _currentState;
     delete _nextState;
     
@@ -970,6 +1218,25 @@ void DeviceGraphics::commitCullMode()
     GL_CHECK(glEnable(GL_CULL_FACE));
     GL_CHECK(glCullFace(ENUM_CLASS_TO_GLENUM(_nextState->cullMode)));
 }
+bool DeviceGraphics::isVertexBufferDirty() const
+{
+    if (_currentState->maxStream != _nextState->maxStream)
+        return true;
+    
+    if (_currentState->getProgram() != _nextState->getProgram())
+        return true;
+    
+    for (int i = 0; i < _nextState->maxStream + 1; ++i)
+    {
+        if (_currentState->getVertexBuffer(i) != _nextState->getVertexBuffer(i) ||
+            _currentState->getVertexBufferOffset(i) != _nextState->getVertexBufferOffset(i))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void DeviceGraphics::commitVertexBuffer()
 {
     if (-1 == _nextState->maxStream)
@@ -978,23 +1245,7 @@ void DeviceGraphics::commitVertexBuffer()
         return;
     }
     
-    bool attrsDirty = false;
-    if (_currentState->maxStream != _nextState->maxStream)
-        attrsDirty = true;
-    else if (_currentState->getProgram() != _nextState->getProgram())
-        attrsDirty = true;
-    else
-    {
-        for (int i = 0; i < _nextState->maxStream + 1; ++i)
-        {
-            if (_currentState->getVertexBuffer(i) != _nextState->getVertexBuffer(i) ||
-                _currentState->getVertexBufferOffset(i) != _nextState->getVertexBufferOffset(i))
-            {
-                attrsDirty = true;
-                break;
-            }
-        }
-    }
+    bool attrsDirty = isVertexBufferDirty();
     
     if (attrsDirty)
     {
@@ -1015,10 +1266,12 @@ void DeviceGraphics::commitVertexBuffer()
             for (int j = 0; j < usedAttriLen; ++j)
             {
                 const auto& attr = attributes[j];
-                const auto* el = vb->getFormat().getElement(attr.name);
+                const auto* el = vb->getFormat().getElement(attr.hashName);
                 if (!el || !el->isValid())
                 {
-                    RENDERER_LOGW("Can not find vertex attribute: %s", attr.name.c_str());
+                    // With several streams each buffer only provides part of the attributes.
+                    if (_nextState->maxStream == 0)
+                        RENDERER_LOGW("Can not find vertex attribute: %s", attr.name.c_str());
                     continue;
                 }
                 
@@ -1029,6 +1282,15 @@ void DeviceGraphics::commitVertexBuffer()
                 }
                 _newAttributes[attr.location] = 1;
                 
+                int divisor = vb->getFormat().isInstanced() ? 1 : 0;
+                if (_attributeDivisors[attr.location] != divisor)
+                {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+                    GL_CHECK(glVertexAttribDivisor(attr.location, divisor));
+#endif
+                    _attributeDivisors[attr.location] = divisor;
+                }
+                
                 GL_CHECK(ccVertexAttribPointer(attr.location,
                                       el->num,
                                       ENUM_CLASS_TO_GLENUM(el->type),
@@ -1045,97 +1307,209 @@ void DeviceGraphics::commitVertexBuffer()
                 GL_CHECK(ccDisableVertexAttribArray(i));
                 _enabledAtrributes[i] = 0;
             }
+            
+            if (_attributeDivisors[i] != 0 && _newAttributes[i] == 0)
+            {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+                GL_CHECK(glVertexAttribDivisor(i, 0));
+#endif
+                _attributeDivisors[i] = 0;
+            }
         }
     }
 }
 
-void DeviceGraphics::commitTextures()
+void DeviceGraphics::commitVertexArray(bool indexBufferDirty)
 {
-    const auto& curTextureUnits = _currentState->getTextureUnits();
-    int curTextureSize = static_cast<int>(curTextureUnits.size());
-    const auto& nextTextureUnits = _nextState->getTextureUnits();
-    int capacity = static_cast<int>(nextTextureUnits.size());
-    for (int i = 0; i < capacity; ++i)
+    if (-1 == _nextState->maxStream)
     {
-        if (i >= curTextureSize || curTextureUnits[i] != nextTextureUnits[i])
+        RENDERER_LOGW("VertexBuffer not assigned, please call setVertexBuffer before every draw.");
+        return;
+    }
+    
+    if (0 == _vertexArray || indexBufferDirty || isVertexBufferDirty())
+    {
+        VertexArrayKey key;
+        key.program = _nextState->getProgram();
+        key.indexBuffer = _nextState->getIndexBuffer();
+        key.maxStream = std::min(_nextState->maxStream, MAX_VERTEX_ARRAY_STREAMS - 1);
+        key.hash = std::hash<const void*>{}(key.program);
+        MathUtil::combineHash(key.hash, std::hash<const void*>{}(key.indexBuffer));
+        bool instanced = false;
+        for (int i = 0; i < key.maxStream + 1; ++i)
         {
-            auto texture = nextTextureUnits[i];
-            if (texture)
+            key.vertexBuffers[i] = _nextState->getVertexBuffer(i);
+            // Instanced streams change their offset with every batch, they are pointed after binding instead.
+            if (key.vertexBuffers[i] && key.vertexBuffers[i]->getFormat().isInstanced())
+                instanced = true;
+            else
+                key.offsets[i] = _nextState->getVertexBufferOffset(i);
+            MathUtil::combineHash(key.hash, std::hash<const void*>{}(key.vertexBuffers[i]));
+            MathUtil::combineHash(key.hash, std::hash<int32_t>{}(key.offsets[i]));
+        }
+        
+        auto iter = _vertexArrays.find(key);
+        if (iter != _vertexArrays.end())
+        {
+            _vertexArray = iter->second;
+        }
+        else
+        {
+            _vertexArray = createVertexArray(key);
+            _vertexArrays.emplace(key, _vertexArray);
+        }
+        
+        if (instanced)
+        {
+            ccBindVertexArray(_vertexArray);
+            for (int i = 0; i < key.maxStream + 1; ++i)
             {
-                GL_CHECK(glActiveTexture(GL_TEXTURE0 + i));
-                GL_CHECK(glBindTexture(texture->getTarget(),
-                                       texture->getHandle()));
+                auto vb = key.vertexBuffers[i];
+                if (vb && vb->getFormat().isInstanced())
+                {
+                    GL_CHECK(ccBindBuffer(GL_ARRAY_BUFFER, vb->getHandle()));
+                    setVertexAttributes(key.program, vb, _nextState->getVertexBufferOffset(i), false);
+                }
             }
         }
     }
+    
+    ccBindVertexArray(_vertexArray);
 }
 
-DeviceGraphics::Uniform::Uniform()
-: dirty(true)
-, elementType(UniformElementType::FLOAT)
-{}
-
-DeviceGraphics::Uniform::Uniform(const void* v, size_t bytes, UniformElementType elementType_)
-: dirty(true)
-, elementType(elementType_)
+GLuint DeviceGraphics::createVertexArray(const VertexArrayKey& key)
 {
-    setValue(v, bytes);
+    if (_nextState->maxStream >= MAX_VERTEX_ARRAY_STREAMS)
+    {
+        RENDERER_LOGW("Vertex streams after %d are ignored.", MAX_VERTEX_ARRAY_STREAMS - 1);
+    }
+    
+    GLuint vao = 0;
+    GL_CHECK(glGenVertexArrays(1, &vao));
+    ccBindVertexArray(vao);
+    
+    // Attribute states belong to the vertex array, so the global attribute cache of ccEnableVertexAttribArray is bypassed.
+    for (int i = 0; i < key.maxStream + 1; ++i)
+    {
+        auto vb = key.vertexBuffers[i];
+        if (!vb)
+            continue;
+        
+        GL_CHECK(ccBindBuffer(GL_ARRAY_BUFFER, vb->getHandle()));
+        setVertexAttributes(key.program, vb, key.offsets[i], key.maxStream == 0);
+    }
+    
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, key.indexBuffer ? key.indexBuffer->getHandle() : 0));
+    return vao;
 }
 
-DeviceGraphics::Uniform::Uniform(Uniform&& h)
+void DeviceGraphics::setVertexAttributes(const Program* program, const VertexBuffer* vb, int32_t offset, bool warnMissing)
 {
-    if (this == &h)
-        return;
+    const auto& format = vb->getFormat();
+    for (const auto& attr : program->getAttributes())
+    {
+        const auto* el = format.getElement(attr.hashName);
+        if (!el || !el->isValid())
+        {
+            if (warnMissing)
+                RENDERER_LOGW("Can not find vertex attribute: %s", attr.name.c_str());
+            continue;
+        }
+        
+        GL_CHECK(glEnableVertexAttribArray(attr.location));
+        GL_CHECK(glVertexAttribPointer(attr.location,
+                                       el->num,
+                                       ENUM_CLASS_TO_GLENUM(el->type),
+                                       el->normalize,
+                                       el->stride,
+                                       (GLvoid*)(el->offset + offset * el->stride)));
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+        if (format.isInstanced())
+        {
+            GL_CHECK(glVertexAttribDivisor(attr.location, 1));
+        }
+#endif
+    }
+}
 
-    if (value != nullptr)
+void DeviceGraphics::removeVertexArrays(const GraphicsHandle* handle)
+{
+    for (auto iter = _vertexArrays.begin(); iter != _vertexArrays.end();)
     {
-        free(value);
+        if (!iter->first.references(handle))
+        {
+            ++iter;
+            continue;
+        }
+        
+        GLuint vao = iter->second;
+        if (vao == _vertexArray)
+        {
+            _vertexArray = 0;
+        }
+        if ((GLint)vao == ccGetBoundVertexArray())
+        {
+            ccBindVertexArray(0);
+        }
+        GL_CHECK(glDeleteVertexArrays(1, &vao));
+        iter = _vertexArrays.erase(iter);
     }
-    value = h.value;
-    h.value = nullptr;
-    
-    dirty = h.dirty;
-    elementType = h.elementType;
 }
 
-DeviceGraphics::Uniform::~Uniform()
+void DeviceGraphics::unbindVertexArray()
 {
-    if (value)
+    // Replaying a recorded buffer unbinds it when all commands are executed.
+    if (_vertexArraySupported && !_commandBuffer)
     {
-        free(value);
-        value = nullptr;
+        ccBindVertexArray(0);
     }
 }
 
-DeviceGraphics::Uniform& DeviceGraphics::Uniform::operator=(Uniform&& h)
+bool DeviceGraphics::VertexArrayKey::operator==(const VertexArrayKey& o) const
 {
-    if (this == &h)
-        return *this;
+    if (hash != o.hash || program != o.program || indexBuffer != o.indexBuffer || maxStream != o.maxStream)
+        return false;
     
-    dirty = h.dirty;
-
-    if (value != nullptr)
+    for (int i = 0; i < maxStream + 1; ++i)
     {
-        free(value);
+        if (vertexBuffers[i] != o.vertexBuffers[i] || offsets[i] != o.offsets[i])
+            return false;
     }
-    value = h.value;
-    h.value = nullptr;
-    elementType = h.elementType;
+    return true;
+}
+
+bool DeviceGraphics::VertexArrayKey::references(const GraphicsHandle* handle) const
+{
+    if (program == handle || indexBuffer == handle)
+        return true;
     
-    return *this;
+    for (int i = 0; i < maxStream + 1; ++i)
+    {
+        if (vertexBuffers[i] == handle)
+            return true;
+    }
+    return false;
 }
 
-void DeviceGraphics::Uniform::setValue(const void* v, size_t valueBytes)
+void DeviceGraphics::commitTextures()
 {
-    if (bytes != valueBytes || !value) {
-        if (value)
-            free(value);
-        value = malloc(valueBytes);
-        
-        bytes = valueBytes;
+    const auto& curTextureUnits = _currentState->getTextureUnits();
+    int curTextureSize = static_cast<int>(curTextureUnits.size());
+    const auto& nextTextureUnits = _nextState->getTextureUnits();
+    int capacity = static_cast<int>(nextTextureUnits.size());
+    for (int i = 0; i < capacity; ++i)
+    {
+        if (i >= curTextureSize || curTextureUnits[i] != nextTextureUnits[i])
+        {
+            auto texture = nextTextureUnits[i];
+            if (texture)
+            {
+                GL_CHECK(glActiveTexture(GL_TEXTURE0 + i));
+                GL_CHECK(glBindTexture(texture->getTarget(),
+                                       texture->getHandle()));
+            }
+        }
     }
-    
-    memcpy(value, v, valueBytes);
 }
 
 RENDERER_END
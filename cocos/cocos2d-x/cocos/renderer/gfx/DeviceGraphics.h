@@ -41,10 +41,13 @@
 RENDERER_BEGIN
 
 class FrameBuffer;
+class CommandBuffer;
+class TextureUploader;
 class VertexBuffer;
 class IndexBuffer;
 class Program;
 class Texture;
+class GraphicsHandle;
 
 /**
  * @addtogroup gfx
@@ -68,27 +71,6 @@ public:
         int maxColorAttatchments;
     };
     
-    struct Uniform
-    {
-        Uniform(const void* v, size_t bytes, UniformElementType elementType_);
-        Uniform(Uniform&& h);
-        Uniform();
-        ~Uniform();
-        
-        Uniform& operator=(Uniform&& h);
-        
-        void setValue(const void* v, size_t bytes);
-        
-        void* value = nullptr;
-        size_t bytes = 0;
-        
-        bool dirty;
-        UniformElementType elementType;
-        
-    private:
-        Uniform& operator=(const Uniform& o);
-    };
-    
     /**
      * Returns a shared instance of the director.
      */
@@ -211,6 +193,11 @@ public:
      * Sets textures array into GL texture slots then set to the specified uniform
      */
     void setTextureArray(size_t hashName, const std::vector<Texture*>& textures, const std::vector<int>& slots);
+    /**
+     * Sets textures into consecutive GL texture slots starting from firstSlot, then set the slots to the uniform
+     * in the given uniform slot, see getUniformSlot
+     */
+    void setTextureSlot(int uniformSlot, Texture* const* textures, int count, int firstSlot);
 
     /**
      * Sets a integer to the specified uniform
@@ -284,6 +271,14 @@ public:
      * Sets data specified by data pointer, type and bytes to the given uniform
      */
     void setUniform(size_t hashName, const void* v, size_t bytes, UniformElementType elementType);
+    /**
+     * Gets the dense slot of the given uniform, a new slot is assigned the first time a name is seen
+     */
+    int getUniformSlot(size_t hashName);
+    /**
+     * Sets data specified by data pointer, type and bytes to the uniform in the given slot, see getUniformSlot
+     */
+    void setUniformSlot(int slot, const void* v, size_t bytes, UniformElementType elementType);
 
     /**
      * Sets the primitive type for draw calls
@@ -294,6 +289,30 @@ public:
      * Draw elements using the current gl states
      */
     void draw(size_t base, GLsizei count);
+    /**
+     * Draw instanceCount instances of the elements using the current gl states,
+     * attributes of vertex buffers with an instanced format advance once per instance
+     */
+    void drawInstanced(size_t base, GLsizei count, GLsizei instanceCount);
+    
+    /**
+     * Starts recording frame buffer bindings, viewports, scissors, clears and draws into the given buffer instead of issuing them to GL,
+     * the buffer is reset first. Uniform values are captured when a draw is recorded, so every recorded buffer should be executed once, in recording order
+     */
+    void beginRecording(CommandBuffer* buffer);
+    /**
+     * Stops recording, later calls are issued to GL again
+     */
+    void endRecording();
+    /**
+     * Indicates whether calls are recorded into a command buffer
+     */
+    inline bool isRecording() const { return _commandBuffer != nullptr; }
+    /**
+     * Replays the commands of a recorded buffer, it must be called on the thread which owns the GL context.
+     * The default vertex array is bound when all commands are replayed
+     */
+    void execute(const CommandBuffer* buffer);
 
     /**
      * Resets the draw call counter to 0
@@ -306,7 +325,78 @@ public:
     
     inline const Capacity& getCapacity() const { return _caps; }
     
+    /**
+     * Indicates whether vertex attribute bindings are cached in vertex array objects
+     */
+    inline bool isVertexArraySupported() const { return _vertexArraySupported; }
+    /**
+     * Indicates whether buffers can be written through glMapBufferRange
+     */
+    inline bool isMapBufferRangeSupported() const { return _mapBufferRangeSupported; }
+    /**
+     * Indicates whether linked programs can be saved and restored through glGetProgramBinary and glProgramBinary
+     */
+    inline bool isProgramBinarySupported() const { return _programBinarySupported; }
+    /**
+     * Indicates whether drawInstanced can be used
+     */
+    inline bool isInstancedArraysSupported() const { return _instancedArraysSupported; }
+    /**
+     * Indicates whether texture uploads can be staged in pixel buffer objects
+     */
+    inline bool isPixelBufferSupported() const { return _pixelBufferSupported; }
+    /**
+     * Gets the queue which uploads texture images under a per frame budget
+     */
+    inline TextureUploader* getTextureUploader() const { return _textureUploader; }
+    /**
+     * Deletes cached vertex array objects which reference the given program, vertex buffer or index buffer
+     */
+    void removeVertexArrays(const GraphicsHandle* handle);
+    /**
+     * Binds the default vertex array so that GL calls made outside the renderer can't modify the cached ones,
+     * it should be called when a frame has been rendered
+     */
+    void unbindVertexArray();
+    
 private:
+    static const int MAX_VERTEX_ARRAY_STREAMS = 4;
+    
+    /**
+     * Identifies the vertex attribute bindings captured by a vertex array object
+     */
+    struct VertexArrayKey
+    {
+        const Program* program = nullptr;
+        const IndexBuffer* indexBuffer = nullptr;
+        const VertexBuffer* vertexBuffers[MAX_VERTEX_ARRAY_STREAMS] = {};
+        int32_t offsets[MAX_VERTEX_ARRAY_STREAMS] = {};
+        int32_t maxStream = -1;
+        size_t hash = 0;
+        
+        bool operator==(const VertexArrayKey& o) const;
+        bool references(const GraphicsHandle* handle) const;
+    };
+    
+    struct VertexArrayKeyHasher
+    {
+        size_t operator()(const VertexArrayKey& key) const { return key.hash; }
+    };
+    
+    /**
+     * Locates the value of a uniform slot in the uniform arena, version is bumped whenever the value changes
+     * and stays 0 until the uniform is set
+     */
+    struct UniformSlot
+    {
+        uint32_t offset = 0;
+        uint32_t capacity = 0;
+        uint32_t bytes = 0;
+        UniformElementType elementType = UniformElementType::FLOAT;
+        uint64_t version = 0;
+    };
+    
+
     DeviceGraphics();
     ~DeviceGraphics();
     CC_DISALLOW_COPY_ASSIGN_AND_MOVE(DeviceGraphics);
@@ -320,7 +410,16 @@ private:
     inline void commitDepthStates();
     inline void commitStencilStates();
     inline void commitCullMode();
+    inline bool isVertexBufferDirty() const;
     inline void commitVertexBuffer();
+    inline void commitVertexArray(bool indexBufferDirty);
+    GLuint createVertexArray(const VertexArrayKey& key);
+    void setVertexAttributes(const Program* program, const VertexBuffer* vb, int32_t offset, bool warnMissing);
+    void commitDraw(size_t base, GLsizei count, GLsizei instanceCount);
+    inline void commitDrawStates();
+    inline void commitUniforms();
+    void recordDraw(size_t base, GLsizei count, GLsizei instanceCount);
+    void issueDraw(size_t base, GLsizei count, GLsizei instanceCount);
     inline void commitTextures();
 
     int _vx;
@@ -343,11 +442,27 @@ private:
     FrameBuffer *_frameBuffer;
     std::vector<int> _enabledAtrributes;
     std::vector<int> _newAttributes;
-    std::unordered_map<size_t, Uniform> _uniforms;
+    std::vector<int> _attributeDivisors;
+    std::unordered_map<size_t, int> _uniformSlotIndices;
+    std::vector<UniformSlot> _uniformSlots;
+    std::vector<uint8_t> _uniformArena;
+    uint64_t _uniformVersion = 0;
+    std::vector<int> _textureSlots;
+    
+    bool _vertexArraySupported = false;
+    bool _mapBufferRangeSupported = false;
+    bool _programBinarySupported = false;
+    bool _instancedArraysSupported = false;
+    bool _pixelBufferSupported = false;
+    GLuint _vertexArray = 0;
+    std::unordered_map<VertexArrayKey, GLuint, VertexArrayKeyHasher> _vertexArrays;
     
     State* _nextState;
     State* _currentState;
     
+    CommandBuffer* _commandBuffer = nullptr;
+    TextureUploader* _textureUploader = nullptr;
+    
     friend class IndexBuffer;
     friend class Texture2D;
 };
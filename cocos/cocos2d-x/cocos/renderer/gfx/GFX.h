@@ -32,4 +32,5 @@
 #include "RenderBuffer.h"
 #include "RenderTarget.h"
 #include "Texture2D.h"
+#include "TextureUploader.h"
 #include "Program.h"
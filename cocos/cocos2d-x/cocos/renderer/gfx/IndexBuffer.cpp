@@ -91,6 +91,7 @@ void IndexBuffer::update(uint32_t offset, const void* data, size_t dataByteLengt
     if (!data)
     {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, _bytes, nullptr, glUsage);
+        _storageBytes = _bytes;
     }
     else
     {
@@ -101,16 +102,76 @@ void IndexBuffer::update(uint32_t offset, const void* data, size_t dataByteLengt
         else
         {
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)dataByteLength, data, glUsage);
+            _storageBytes = (uint32_t)dataByteLength;
         }
     }
     _device->restoreIndexBuffer();
 }
 
+void IndexBuffer::replace(const void* data, size_t dataByteLength, bool mapRange)
+{
+    if (_glID == 0)
+    {
+        RENDERER_LOGE("The buffer is destroyed");
+        return;
+    }
+
+    if (dataByteLength > _bytes)
+    {
+        RENDERER_LOGE("Failed to replace index buffer data, bytes exceed.");
+        return;
+    }
+
+    if (!data || dataByteLength == 0)
+        return;
+
+    GLenum glUsage = (GLenum)_usage;
+    ccBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _glID);
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+    if (mapRange)
+    {
+        if (_storageBytes != _bytes)
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _bytes, nullptr, glUsage);
+            _storageBytes = _bytes;
+        }
+        
+        void* dst = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, (GLsizeiptr)dataByteLength,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst)
+        {
+            memcpy(dst, data, dataByteLength);
+            // The content is undefined if the storage was lost while mapped, upload it again below.
+            mapRange = glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_TRUE;
+        }
+        else
+        {
+            mapRange = false;
+        }
+    }
+#else
+    mapRange = false;
+#endif
+    if (!mapRange)
+    {
+        // Orphans the old storage so that the driver doesn't wait for draws which still read it.
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _bytes, nullptr, glUsage);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, (GLsizeiptr)dataByteLength, (const GLvoid*)data);
+        _storageBytes = _bytes;
+    }
+    _device->restoreIndexBuffer();
+}
+
 void IndexBuffer::destroy()
 {
     if (_glID == 0)
         return;
     
+    if (_device)
+    {
+        _device->removeVertexArrays(this);
+    }
+    
     ccDeleteBuffers(1, &_glID);
     _glID = 0;
 }
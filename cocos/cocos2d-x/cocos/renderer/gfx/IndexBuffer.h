@@ -76,6 +76,14 @@ public:
      * @param[in] dataByteLength Data byte length to be updated.
      */
     void update(uint32_t offset, const void* data, size_t dataByteLength);
+    /**
+     * Replaces the whole content of the GL index buffer without waiting for draws still reading the old one,
+     * the storage is sized to getBytes() so that it can be reused by later frames
+     * @param[in] data Data to be uploaded.
+     * @param[in] dataByteLength Data byte length to be uploaded.
+     * @param[in] mapRange Writes through glMapBufferRange with invalidate and unsynchronized flags instead of orphaning the storage with glBufferData.
+     */
+    void replace(const void* data, size_t dataByteLength, bool mapRange);
 
     /**
      * Gets the count of indices.
@@ -145,6 +153,7 @@ private:
     uint32_t _numIndices;
     uint32_t _bytesPerIndex;
     uint32_t _bytes;
+    uint32_t _storageBytes = 0;
 
     FetchDataCallback _fetchDataCallback;
 
@@ -24,6 +24,7 @@
 
 #include "Program.h"
 #include "GFXUtils.h"
+#include "DeviceGraphics.h"
 
 #include <unordered_map>
 #include <stdlib.h>
@@ -222,6 +223,24 @@ namespace {
         { GL_SAMPLER_2D, setUniform1iv },
         { GL_SAMPLER_CUBE, setUniform1iv }
     };
+
+    uint32_t getBuiltinUniform(const char* name)
+    {
+        if (strcmp(name, "cc_matWorldIT") == 0)
+            return cocos2d::renderer::Program::BUILTIN_WORLD_IT;
+        
+        if (strncmp(name, "cc_dirLight", 11) == 0 ||
+            strncmp(name, "cc_pointLight", 13) == 0 ||
+            strncmp(name, "cc_spotLight", 12) == 0)
+            return cocos2d::renderer::Program::BUILTIN_LIGHTS;
+        
+        if (strcmp(name, "cc_shadow_map") == 0 ||
+            strcmp(name, "cc_shadow_lightViewProjMatrix") == 0 ||
+            strcmp(name, "cc_shadow_info") == 0)
+            return cocos2d::renderer::Program::BUILTIN_SHADOWS;
+        
+        return 0;
+    }
 } // namespace {
 
 RENDERER_BEGIN
@@ -242,6 +261,10 @@ Program::Program()
 
 Program::~Program()
 {
+    if (_device)
+    {
+        _device->removeVertexArrays(this);
+    }
     GL_CHECK(glDeleteProgram(_glID));
 }
 
@@ -301,6 +324,63 @@ void Program::link()
     glDeleteShader(fragShader);
 
     _glID = program;
+    fetchActiveVariables();
+    _linked = true;
+}
+
+bool Program::linkBinary(GLenum format, const void* binary, GLsizei length)
+{
+    if (_linked) {
+        return true;
+    }
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    GLuint program = glCreateProgram();
+    GL_CHECK(glProgramBinary(program, format, binary, length));
+
+    // Drivers reject binaries produced by another driver version, the caller falls back to link().
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    _glID = program;
+    fetchActiveVariables();
+    _linked = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Program::getBinary(GLenum& format, std::vector<uint8_t>& binary) const
+{
+    if (!_linked) {
+        return false;
+    }
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    GLint length = 0;
+    glGetProgramiv(_glID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    binary.resize(length);
+    GLsizei written = 0;
+    GL_CHECK(glGetProgramBinary(_glID, length, &written, &format, binary.data()));
+    binary.resize(written);
+    return written > 0;
+#else
+    return false;
+#endif
+}
+
+void Program::fetchActiveVariables()
+{
+    GLuint program = _glID;
 
     GLint numAttributes;
     glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &numAttributes);
@@ -318,6 +398,7 @@ void Program::link()
                 glGetActiveAttrib(program, i, length, nullptr, &attribute.size, &attribute.type, attribName);
                 attribName[length] = '\0';
                 attribute.name = attribName;
+                attribute.hashName = std::hash<std::string>{}(attribute.name);
                 attribute.location = glGetAttribLocation(program, attribName);
 
                 _attributes.push_back(std::move(attribute));
@@ -354,6 +435,9 @@ void Program::link()
 
                 uniform.name = uniformName;
                 uniform.hashName = std::hash<std::string>{}(uniformName);
+                uniform.slot = _device->getUniformSlot(uniform.hashName);
+                uniform.version = 0;
+                _builtinUniforms |= getBuiltinUniform(uniformName);
                 GL_CHECK(uniform.location = glGetUniformLocation(program, uniformName));
 
                 GLenum err = glGetError();
@@ -382,8 +466,6 @@ void Program::link()
             free(uniformName);
         }
     }
-
-    _linked = true;
 }
 
 RENDERER_END
@@ -57,6 +57,10 @@ public:
          * Attribute name
          */
         std::string name;
+        /**
+         * Attribute hash name, used to resolve the vertex format element without hashing the name string
+         */
+        size_t hashName;
         /**
          * Number of components per attribute
          */
@@ -98,6 +102,14 @@ public:
          * Uniform type
          */
         GLenum type;
+        /**
+         * Uniform slot in DeviceGraphics
+         */
+        int slot;
+        /**
+         * Version of the slot value last committed to this program
+         */
+        mutable uint64_t version;
         /**
          * Sets the uniform value
          */
@@ -110,6 +122,16 @@ public:
         SetUniformCallback _callback;
         friend class Program;
     };
+    
+    /**
+     * Builtin uniform groups which are computed by the renderer, only submitted to the programs referencing them
+     */
+    enum BuiltinUniform : uint32_t
+    {
+        BUILTIN_WORLD_IT = 1 << 0,  // cc_matWorldIT
+        BUILTIN_LIGHTS = 1 << 1,    // cc_dirLight*, cc_pointLight*, cc_spotLight*
+        BUILTIN_SHADOWS = 1 << 2    // cc_shadow_map, cc_shadow_lightViewProjMatrix, cc_shadow_info
+    };
 
     /**
      * Creates a Program with device and shader sources
@@ -137,6 +159,10 @@ public:
      * Gets the uniforms used in the program
      */
     inline const std::vector<Uniform>& getUniforms() const { return _uniforms; }
+    /**
+     * Gets the builtin uniform groups referenced by the program, a combination of BuiltinUniform flags
+     */
+    inline uint32_t getBuiltinUniforms() const { return _builtinUniforms; }
     /**
      * Indicates whether the program is successfully linked
      */
@@ -145,10 +171,26 @@ public:
      * Link the program with its shader sources
      */
     void link();
+    /**
+     * Link the program with a binary previously retrieved by getBinary
+     * @param[in] format Binary format returned by getBinary
+     * @param[in] binary Binary data
+     * @param[in] length Binary data length in bytes
+     * @return false if program binaries are unsupported or the driver rejects the binary, link() should be used instead
+     */
+    bool linkBinary(GLenum format, const void* binary, GLsizei length);
+    /**
+     * Retrieves the driver specific binary of the linked program
+     * @param[out] format Binary format
+     * @param[out] binary Binary data
+     */
+    bool getBinary(GLenum& format, std::vector<uint8_t>& binary) const;
     
     inline size_t getHash() const { return _hash; }
     inline void setHash(size_t hash) { _hash = hash; }
 private:
+    void fetchActiveVariables();
+
     DeviceGraphics* _device;
     std::vector<Attribute> _attributes;
     std::vector<Uniform> _uniforms;
@@ -157,6 +199,7 @@ private:
     uint32_t _id;
     bool _linked;
     size_t _hash = 0;
+    uint32_t _builtinUniforms = 0;
 };
 
 
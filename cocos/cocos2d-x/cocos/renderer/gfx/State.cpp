@@ -24,6 +24,8 @@
 
 #include "State.h"
 
+#include <algorithm>
+
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "Texture2D.h"
@@ -121,6 +123,69 @@ void State::reset()
     _program = nullptr;
 }
 
+State& State::operator=(const State& o)
+{
+    if (this == &o)
+        return *this;
+    
+    blend = o.blend;
+    blendSeparation = o.blendSeparation;
+    blendColor = o.blendColor;
+    blendEq = o.blendEq;
+    blendAlphaEq = o.blendAlphaEq;
+    blendSrc = o.blendSrc;
+    blendDst = o.blendDst;
+    blendSrcAlpha = o.blendSrcAlpha;
+    blendDstAlpha = o.blendDstAlpha;
+    depthTest = o.depthTest;
+    depthWrite = o.depthWrite;
+    depthFunc = o.depthFunc;
+    stencilTest = o.stencilTest;
+    stencilSeparation = o.stencilSeparation;
+    stencilFuncFront = o.stencilFuncFront;
+    stencilRefFront = o.stencilRefFront;
+    stencilMaskFront = o.stencilMaskFront;
+    stencilFailOpFront = o.stencilFailOpFront;
+    stencilZFailOpFront = o.stencilZFailOpFront;
+    stencilZPassOpFront = o.stencilZPassOpFront;
+    stencilWriteMaskFront = o.stencilWriteMaskFront;
+    stencilFuncBack = o.stencilFuncBack;
+    stencilRefBack = o.stencilRefBack;
+    stencilMaskBack = o.stencilMaskBack;
+    stencilFailOpBack = o.stencilFailOpBack;
+    stencilZFailOpBack = o.stencilZFailOpBack;
+    stencilZPassOpBack = o.stencilZPassOpBack;
+    stencilWriteMaskBack = o.stencilWriteMaskBack;
+    cullMode = o.cullMode;
+    
+    primitiveType = o.primitiveType;
+    
+    maxStream = o.maxStream;
+    
+    for (size_t i = 0, len = std::max(_textureUnits.size(), o._textureUnits.size()); i < len; ++i)
+    {
+        setTexture(i, i < o._textureUnits.size() ? o._textureUnits[i] : nullptr);
+    }
+    
+    for (size_t i = 0, len = std::max(_vertexBuffers.size(), o._vertexBuffers.size()); i < len; ++i)
+    {
+        setVertexBuffer(i, i < o._vertexBuffers.size() ? o._vertexBuffers[i] : nullptr);
+    }
+    for (size_t i = 0, len = o._vertexBufferOffsets.size(); i < len; ++i)
+    {
+        setVertexBufferOffset(i, o._vertexBufferOffsets[i]);
+    }
+    
+    setIndexBuffer(o._indexBuffer);
+    if (_program != o._program)
+    {
+        RENDERER_SAFE_RELEASE(_program);
+        _program = o._program;
+        RENDERER_SAFE_RETAIN(_program);
+    }
+    return *this;
+}
+
 void State::setVertexBuffer(size_t index, VertexBuffer* vertBuf)
 {
     if (index >= _vertexBuffers.size())
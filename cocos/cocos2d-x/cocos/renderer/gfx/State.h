@@ -59,6 +59,10 @@ struct State final
      * Reset all states to default values
      */
     void reset();
+    /**
+     * Copies all states from another State, the buffers, textures and program are retained
+     */
+    State& operator=(const State& o);
 
     /**
      @name Blend
@@ -25,6 +25,7 @@
 #include "Texture2D.h"
 #include "DeviceGraphics.h"
 #include "GFXUtils.h"
+#include "TextureUploader.h"
 
 #include "base/CCGLUtils.h"
 
@@ -36,6 +37,10 @@ Texture2D::Texture2D()
 
 Texture2D::~Texture2D()
 {
+    if (_device && _device->getTextureUploader())
+    {
+        _device->getTextureUploader()->cancel(this);
+    }
 }
 
 bool Texture2D::init(DeviceGraphics* device, Options& options)
@@ -0,0 +1,270 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "TextureUploader.h"
+#include "DeviceGraphics.h"
+#include "Texture2D.h"
+#include "GFXUtils.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+RENDERER_BEGIN
+
+namespace
+{
+    void flipRows(uint8_t* pixels, uint32_t bytesPerRow, uint16_t rows)
+    {
+        std::vector<uint8_t> temp(bytesPerRow);
+        for (uint16_t top = 0, bottom = rows - 1; top < bottom; ++top, --bottom)
+        {
+            uint8_t* topRow = pixels + top * bytesPerRow;
+            uint8_t* bottomRow = pixels + bottom * bytesPerRow;
+            memcpy(temp.data(), topRow, bytesPerRow);
+            memcpy(topRow, bottomRow, bytesPerRow);
+            memcpy(bottomRow, temp.data(), bytesPerRow);
+        }
+    }
+}
+
+TextureUploader::TextureUploader(DeviceGraphics* device)
+: _device(device)
+{
+}
+
+TextureUploader::~TextureUploader()
+{
+    if (_pixelBuffer)
+    {
+        GL_CHECK(glDeleteBuffers(1, &_pixelBuffer));
+    }
+}
+
+void TextureUploader::enqueue(Texture2D* texture, const ImageInfo& info, std::vector<uint8_t>&& data, const Callback& callback)
+{
+    if (!texture || data.empty() || info.width == 0 || info.height == 0 ||
+        (!info.compressed && data.size() % info.height != 0))
+    {
+        RENDERER_LOGW("TextureUploader::enqueue: invalid image of %ux%u, %u bytes", info.width, info.height, (uint32_t)data.size());
+        return;
+    }
+    
+    Task task;
+    task.texture = texture;
+    task.info = info;
+    task.data = std::move(data);
+    task.callback = callback;
+    
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.queuedBytes += task.data.size();
+    ++_stats.queuedImages;
+    _pending.push_back(std::move(task));
+}
+
+void TextureUploader::cancel(const Texture2D* texture)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto drop = [this, texture](Task& task) {
+        if (task.texture != texture)
+        {
+            return false;
+        }
+        uint32_t bytesPerRow = task.info.compressed ? 0 : (uint32_t)(task.data.size() / task.info.height);
+        _stats.queuedBytes -= task.data.size() - task.row * bytesPerRow;
+        --_stats.queuedImages;
+        // Invoked by the next process, cancel may run in a texture destructor where calling out is not safe.
+        if (task.callback)
+        {
+            _cancelled.push_back(std::move(task.callback));
+        }
+        return true;
+    };
+    _pending.erase(std::remove_if(_pending.begin(), _pending.end(), drop), _pending.end());
+    _tasks.erase(std::remove_if(_tasks.begin(), _tasks.end(), drop), _tasks.end());
+}
+
+void TextureUploader::setBudget(uint32_t bytes, float milliseconds)
+{
+    _bytesPerFrame = bytes;
+    _msPerFrame = milliseconds;
+}
+
+TextureUploader::Stats TextureUploader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void TextureUploader::process()
+{
+    std::vector<Callback> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& task : _pending)
+        {
+            _tasks.push_back(std::move(task));
+        }
+        _pending.clear();
+        cancelled.swap(_cancelled);
+    }
+    
+    for (auto& callback : cancelled)
+    {
+        callback(false);
+    }
+    
+    if (_tasks.empty())
+    {
+        return;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    uint32_t budget = _bytesPerFrame;
+    while (!_tasks.empty())
+    {
+        Task& task = _tasks.front();
+        uint32_t bytes = upload(task, budget);
+        bool done = task.row >= task.info.height;
+        budget = bytes < budget ? budget - bytes : 0;
+        
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats.queuedBytes -= bytes;
+            _stats.uploadedBytes += bytes;
+            if (done)
+            {
+                --_stats.queuedImages;
+                ++_stats.uploadedImages;
+            }
+        }
+        
+        if (done)
+        {
+            // The callback may queue or cancel uploads, the task is gone before it runs.
+            Callback callback = std::move(task.callback);
+            _tasks.pop_front();
+            if (callback)
+            {
+                callback(true);
+            }
+        }
+        
+        float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (budget == 0 || elapsed >= _msPerFrame)
+        {
+            break;
+        }
+    }
+}
+
+uint32_t TextureUploader::upload(Task& task, uint32_t budget)
+{
+    const ImageInfo& info = task.info;
+    if (!task.allocated)
+    {
+        Texture::ImageOption option;
+        option.level = info.level;
+        option.width = info.width;
+        option.height = info.height;
+        task.allocated = true;
+        
+        if (info.compressed)
+        {
+            option.image.data = task.data.data();
+            option.image.length = task.data.size();
+            task.texture->updateImage(option);
+            task.row = info.height;
+            return (uint32_t)task.data.size();
+        }
+        
+        // Allocates the level, pixels follow in bands.
+        task.texture->updateImage(option);
+    }
+    
+    uint32_t bytesPerRow = (uint32_t)(task.data.size() / info.height);
+    uint32_t rows = std::max(budget / bytesPerRow, 1u);
+    rows = std::min(rows, (uint32_t)(info.height - task.row));
+    return uploadBand(task, (uint16_t)rows, bytesPerRow);
+}
+
+uint32_t TextureUploader::uploadBand(Task& task, uint16_t rows, uint32_t bytesPerRow)
+{
+    const ImageInfo& info = task.info;
+    uint8_t* band = task.data.data() + task.row * bytesPerRow;
+    uint32_t bytes = rows * bytesPerRow;
+    
+    uint16_t y = task.row;
+    if (info.flipY)
+    {
+        // Bands are placed bottom up and flipped in place.
+        y = info.height - task.row - rows;
+        flipRows(band, bytesPerRow, rows);
+    }
+    
+    Texture::SubImageOption option(0, y, info.width, rows, info.level, false, info.premultiplyAlpha);
+    option.imageData = band;
+    option.imageDataLength = bytes;
+    
+    // Premultiplying needs the pixels in client memory.
+    bool staged = false;
+    if (_device->isPixelBufferSupported() && !info.premultiplyAlpha)
+    {
+        if (!_pixelBuffer)
+        {
+            GL_CHECK(glGenBuffers(1, &_pixelBuffer));
+        }
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffer));
+        // Orphans the storage of the previous band, so the driver doesn't wait for it to be consumed.
+        GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW));
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (dst)
+        {
+            memcpy(dst, band, bytes);
+            staged = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+        }
+        
+        if (staged)
+        {
+            // Pixels are read from offset 0 of the bound buffer.
+            option.imageData = nullptr;
+        }
+        else
+        {
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+    }
+    
+    task.texture->updateSubImage(option);
+    
+    if (staged)
+    {
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    }
+    
+    task.row += rows;
+    return bytes;
+}
+
+RENDERER_END
@@ -0,0 +1,142 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "../Macro.h"
+#include "platform/CCGL.h"
+
+RENDERER_BEGIN
+
+class DeviceGraphics;
+class Texture2D;
+
+/**
+ * @addtogroup gfx
+ * @{
+ */
+
+/**
+ * TextureUploader queues texture images and uploads them on the GL thread under a per frame budget of bytes and time.
+ * Images can be queued from any thread. Uncompressed images are uploaded in row bands, so a large texture is spread
+ * over several frames instead of stalling one. Bands are staged in a pixel buffer object when the device supports it.
+ * The queue is drained by process, which RenderFlow invokes once per frame before rendering.
+ */
+class TextureUploader final
+{
+public:
+    /**
+     * Invoked on the GL thread once the whole image is uploaded.
+     */
+    using Callback = std::function<void(bool success)>;
+    
+    /**
+     * Describes the image to upload, the level must already have the given size.
+     */
+    struct ImageInfo
+    {
+        uint16_t width = 0;
+        uint16_t height = 0;
+        uint8_t level = 0;
+        bool flipY = false;
+        bool premultiplyAlpha = false;
+        bool compressed = false;
+    };
+    
+    struct Stats
+    {
+        /** Bytes queued and not uploaded yet */
+        uint64_t queuedBytes = 0;
+        /** Bytes uploaded since the uploader was created */
+        uint64_t uploadedBytes = 0;
+        /** Images queued and not completed yet */
+        uint32_t queuedImages = 0;
+        /** Images completed since the uploader was created */
+        uint32_t uploadedImages = 0;
+    };
+    
+    TextureUploader(DeviceGraphics* device);
+    ~TextureUploader();
+    
+    /**
+     * Queues an image of a texture, thread safe.
+     * The texture must be alive until the upload completes, destroying it cancels its uploads.
+     * @param[in] texture The texture to update
+     * @param[in] info Size, mipmap level and pixel options of the image
+     * @param[in] data Pixels of the image, owned by the uploader afterwards
+     * @param[in] callback Optional completion callback, invoked with false by the next process if the upload is cancelled
+     */
+    void enqueue(Texture2D* texture, const ImageInfo& info, std::vector<uint8_t>&& data, const Callback& callback);
+    /**
+     * Cancels all queued uploads of a texture, must be invoked on the GL thread.
+     * Callbacks of the cancelled uploads are deferred to the next process, outside of the lock.
+     */
+    void cancel(const Texture2D* texture);
+    /**
+     * Uploads queued images until the frame budget is spent, must be invoked on the GL thread.
+     */
+    void process();
+    /**
+     * Sets the frame budget, at least one row is uploaded per frame whatever the budget is.
+     * @param[in] bytes Bytes uploaded per frame
+     * @param[in] milliseconds Time spent uploading per frame
+     */
+    void setBudget(uint32_t bytes, float milliseconds);
+    /**
+     * Gets queued and uploaded bytes and images.
+     */
+    Stats getStats() const;
+    
+private:
+    struct Task
+    {
+        Texture2D* texture = nullptr;
+        ImageInfo info;
+        std::vector<uint8_t> data;
+        Callback callback;
+        uint16_t row = 0;
+        bool allocated = false;
+    };
+    
+    uint32_t upload(Task& task, uint32_t budget);
+    uint32_t uploadBand(Task& task, uint16_t rows, uint32_t bytesPerRow);
+    
+    DeviceGraphics* _device = nullptr;
+    std::deque<Task> _tasks;
+    std::vector<Task> _pending;
+    std::vector<Callback> _cancelled;
+    mutable std::mutex _mutex;
+    Stats _stats;
+    uint32_t _bytesPerFrame = 4 * 1024 * 1024;
+    float _msPerFrame = 4.0f;
+    GLuint _pixelBuffer = 0;
+};
+
+
+RENDERER_END
@@ -96,6 +96,7 @@ VertexFormat::VertexFormat(const std::vector<Info>& infos)
 
         _names.push_back(el.name);
         _attr2el[el.name] = el;
+        _hash2el[std::hash<std::string>{}(el.name)] = el;
         elements.push_back(&_attr2el[el.name]);
 
         _bytes += el.bytes;
@@ -107,6 +108,11 @@ VertexFormat::VertexFormat(const std::vector<Info>& infos)
         auto& el = elements[i];
         el->stride = _bytes;
     }
+    
+    for (auto& iter : _hash2el)
+    {
+        iter.second.stride = _bytes;
+    }
 }
 
 VertexFormat::VertexFormat(const VertexFormat& o)
@@ -127,6 +133,8 @@ VertexFormat& VertexFormat::operator=(const VertexFormat& o)
     {
         _names = o._names;
         _attr2el = o._attr2el;
+        _hash2el = o._hash2el;
+        _instanced = o._instanced;
 #if GFX_DEBUG > 0
         _elements = o._elements;
         _bytes = o._bytes;
@@ -141,6 +149,8 @@ VertexFormat& VertexFormat::operator=(VertexFormat&& o)
     {
         _names = std::move(o._names);
         _attr2el = std::move(o._attr2el);
+        _hash2el = std::move(o._hash2el);
+        _instanced = o._instanced;
 #if GFX_DEBUG > 0
         _elements = std::move(o._elements);
         _bytes = o._bytes;
@@ -161,4 +171,14 @@ const VertexFormat::Element* VertexFormat::getElement(const std::string& attrNam
     return INVALID_ELEMENT_VALUE;
 }
 
+const VertexFormat::Element* VertexFormat::getElement(size_t attrHashName) const
+{
+    const auto& iter = _hash2el.find(attrHashName);
+    if (iter != _hash2el.end())
+    {
+        return &iter->second;
+    }
+    return nullptr;
+}
+
 RENDERER_END
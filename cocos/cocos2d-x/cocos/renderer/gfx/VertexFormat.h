@@ -161,12 +161,25 @@ public:
      * Getes an attribute element by name
      */
     const Element* getElement(const std::string& attrName) const;
+    /**
+     * Getes an attribute element by hashed name, avoids hashing the name string on every lookup
+     */
+    const Element* getElement(size_t attrHashName) const;
     
     /**
      * Gets total byte size of a vertex
      */
     uint32_t getBytes() const { return _bytes; };
     
+    /**
+     * Sets whether the attributes advance once per instance instead of once per vertex
+     */
+    void setInstanced(bool instanced) { _instanced = instanced; }
+    /**
+     * Indicates whether the attributes advance once per instance
+     */
+    bool isInstanced() const { return _instanced; }
+    
     /*
      * Builtin VertexFormat with 2d position, uv, color, color0 attributes
      */
@@ -183,10 +196,12 @@ public:
 private:
     std::vector<std::string> _names;
     std::unordered_map<std::string, Element> _attr2el;
+    std::unordered_map<size_t, Element> _hash2el;
 #if GFX_DEBUG > 0
     std::vector<Element> _elements;
 #endif
     uint32_t _bytes;
+    bool _instanced = false;
 
     friend class VertexBuffer;
 };
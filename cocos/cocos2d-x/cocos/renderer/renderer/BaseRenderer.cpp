@@ -56,6 +56,7 @@ const size_t BaseRenderer::cc_shadow_info = std::hash<std::string>{}("cc_shadow_
 const size_t BaseRenderer::cc_matView = std::hash<std::string>{}("cc_matView");
 const size_t BaseRenderer::cc_matWorld = std::hash<std::string>{}("cc_matWorld");
 const size_t BaseRenderer::cc_matWorldIT = std::hash<std::string>{}("cc_matWorldIT");
+const size_t BaseRenderer::cc_nodePalette = std::hash<std::string>{}("cc_nodePalette");
 const size_t BaseRenderer::cc_matpProj = std::hash<std::string>{}("cc_matpProj");
 const size_t BaseRenderer::cc_matViewProj = std::hash<std::string>{}("cc_matViewProj");
 const size_t BaseRenderer::cc_cameraPos = std::hash<std::string>{}("cc_cameraPos");
@@ -152,10 +153,18 @@ void BaseRenderer::render(const View& view, const Scene* scene)
     }
     
     _stageInfos->reset();
+    if (_stageItems.size() < view.stages.size())
+    {
+        _stageItems.resize(view.stages.size());
+    }
+    
     StageItem stageItem;
-    std::vector<StageItem> stageItems;
-    for (const auto& stage : view.stages)
+    for (size_t stageIndex = 0, stageCount = view.stages.size(); stageIndex < stageCount; stageIndex++)
     {
+        const auto& stage = view.stages[stageIndex];
+        // Reused across frames, so that collecting items doesn't allocate once the capacity is reached.
+        auto& stageItems = _stageItems[stageIndex];
+        stageItems.clear();
         for (size_t i = 0, len = _drawItems->getLength(); i < len; i++)
         {
             const DrawItem* item = _drawItems->getData(i);
@@ -192,88 +201,22 @@ void BaseRenderer::render(const View& view, const Scene* scene)
     }
 }
 
-void BaseRenderer::setProperty (Effect::Property& prop)
-{
-    Technique::Parameter::Type propType = prop.getType();
-    auto& propName = prop.getName();
-    auto propHashName = prop.getHashName();
-    if (Effect::Property::Type::UNKNOWN == propType)
-    {
-        RENDERER_LOGW("Failed to set technique property, type unknown");
-        return;
-    }
-    
-    if (nullptr == prop.getValue())
-    {
-        prop = Effect::Property(propName, propType);
-        
-        if (Effect::Property::Type::TEXTURE_2D == propType)
-        {
-            prop.setTexture(_defaultTexture);
-        }
-    }
-    
-    if (nullptr == prop.getValue())
-    {
-        RENDERER_LOGW("Failed to set technique property %s, value not found", propName.c_str());
-        return;
-    }
-    
-    if (Effect::Property::Type::TEXTURE_2D == propType ||
-        Effect::Property::Type::TEXTURE_CUBE == propType)
-    {
-        if (1 == prop.getCount())
-        {
-            _device->setTexture(propHashName,
-                                (renderer::Texture *)(prop.getValue()),
-                                allocTextureUnit());
-        }
-        else if (0 < prop.getCount())
-        {
-            std::vector<int> slots;
-            slots.reserve(10);
-            for (int i = 0; i < prop.getCount(); ++i)
-            {
-                slots.push_back(allocTextureUnit());
-            }
-            
-            _device->setTextureArray(propHashName,
-                                     prop.getTextureArray(),
-                                     slots);
-        }
-    }
-    else
-    {
-        uint16_t bytes = prop.getBytes();
-        if (Effect::Property::Type::INT == propType ||
-            Effect::Property::Type::INT2 == propType ||
-            Effect::Property::Type::INT4 == propType)
-        {
-            _device->setUniformiv(propHashName, bytes / sizeof(int), (const int*)prop.getValue());
-        }
-        else
-        {
-            _device->setUniformfv(propHashName, bytes / sizeof(float), (const float*)prop.getValue());
-        }
-    }
-}
-
 void BaseRenderer::draw(const StageItem& item)
 {
     const Mat4& worldMatrix = item.model->getWorldMatrix();
     _device->setUniformMat4(cc_matWorld, worldMatrix.m);
+    bool worldITDirty = true;
     
-    _tmpMat4->set(worldMatrix);
-    _tmpMat4->inverse();
-    _tmpMat4->transpose();
-    _device->setUniformMat4(cc_matWorldIT, _tmpMat4->m);
+    // Vertices of palette batches are transformed by the matrices of their nodes in the vertex shader.
+    const std::vector<float>& palette = item.model->getPalette();
+    if (!palette.empty())
+    {
+        _device->setUniformfv(cc_nodePalette, palette.size(), palette.data());
+    }
     
-    for (int i = 0, len = (int)item.uniforms->size(); i < len; i++)
+    for (auto block : *item.uniforms)
     {
-        std::unordered_map<std::string, Effect::Property>* properties = (*item.uniforms)[i];
-        for (auto& prop : *properties) {
-            setProperty(prop.second);
-        }
+        block->commit(_device, _defaultTexture, _usedTextureUnits);
     }
     
     auto ia = item.ia;
@@ -286,9 +229,32 @@ void BaseRenderer::draw(const StageItem& item)
         
         _device->setPrimitiveType(ia->_primitiveType);
         
-        _program = _programLib->switchProgram(pass->getHashName(), item.definesKeyHash, *(item.defines));
+        size_t programNameHash = pass->getHashName();
+        if (ia->_instanceBuffer)
+        {
+            _device->setVertexBuffer(1, ia->_instanceBuffer, ia->_instanceStart);
+            programNameHash = _programLib->getInstancedVariant(programNameHash);
+        }
+        else if (!palette.empty())
+        {
+            programNameHash = _programLib->getPaletteVariant(programNameHash);
+        }
+        
+        _program = _programLib->switchProgram(programNameHash, item.definesKeyHash, *(item.defines));
         _device->setProgram(_program);
         
+        // Most 2D programs don't read the inverse transpose world matrix, only compute it when referenced.
+        uint32_t builtinUniforms = _program->getBuiltinUniforms();
+        if ((builtinUniforms & Program::BUILTIN_WORLD_IT) && worldITDirty)
+        {
+            _tmpMat4->set(worldMatrix);
+            _tmpMat4->inverse();
+            _tmpMat4->transpose();
+            _device->setUniformMat4(cc_matWorldIT, _tmpMat4->m);
+            worldITDirty = false;
+        }
+        submitBuiltinUniforms(builtinUniforms);
+        
         _device->setCullMode(pass->_cullMode);
         
         if (pass->_blend)
@@ -331,7 +297,10 @@ void BaseRenderer::draw(const StageItem& item)
                                       pass->_stencilWriteMaskBack);
         }
         
-        _device->draw(ia->_start, ia->getPrimitiveCount());
+        if (ia->_instanceBuffer)
+            _device->drawInstanced(ia->_start, ia->getPrimitiveCount(), ia->_instanceCount);
+        else
+            _device->draw(ia->_start, ia->getPrimitiveCount());
         
         resetTextureUint();
     }
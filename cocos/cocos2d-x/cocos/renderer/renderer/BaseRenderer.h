@@ -65,7 +65,7 @@ public:
         Technique* technique = nullptr;
         std::vector<ValueMap*>* defines = nullptr;
         size_t definesKeyHash = 0;
-        std::vector<std::unordered_map<std::string, Effect::Property>*>* uniforms = nullptr;
+        std::vector<PropertyBlock*>* uniforms = nullptr;
         int sortKey = -1;
     };
     typedef std::function<void(const View&, std::vector<StageItem>&)> StageCallback;
@@ -106,7 +106,11 @@ public:
 protected:
     void render(const View&, const Scene* scene);
     void draw(const StageItem& item);
-    void setProperty (Effect::Property& prop);
+    /**
+     *  @brief Submits the builtin uniforms referenced by the program of the current pass.
+     *  @param[in] builtinUniforms Builtin uniform groups used by the program, see Program::BuiltinUniform.
+     */
+    virtual void submitBuiltinUniforms(uint32_t builtinUniforms) {}
     
     struct StageInfo
     {
@@ -127,6 +131,7 @@ protected:
     std::unordered_map<std::string, const StageCallback> _stage2fn;
     RecyclePool<DrawItem>* _drawItems = nullptr;
     RecyclePool<StageInfo>* _stageInfos = nullptr;
+    std::vector<std::vector<StageItem>> _stageItems;
     RecyclePool<View>* _views = nullptr;
     
     cocos2d::Mat4* _tmpMat4 = nullptr;
@@ -153,6 +158,7 @@ protected:
     static const size_t cc_matView;
     static const size_t cc_matWorld;
     static const size_t cc_matWorldIT;
+    static const size_t cc_nodePalette;
     static const size_t cc_matpProj;
     static const size_t cc_matViewProj;
     static const size_t cc_cameraPos;
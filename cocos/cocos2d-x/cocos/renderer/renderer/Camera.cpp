@@ -148,6 +148,17 @@ void Camera::extractView(View& out, int width, int height)
     out.cullingByID = true;
 }
 
+void Camera::calcViewProj(Mat4& out, int width, int height)
+{
+    if (_framebuffer != nullptr) {
+        width = _framebuffer->getWidth();
+        height = _framebuffer->getHeight();
+    }
+    
+    calcMatrices(width, height);
+    out.set(_matViewProj);
+}
+
 Vec3& Camera::screenToWorld(Vec3& out, const Vec3& screenPos, int width, int height)
 {
     calcMatrices(width, height);
@@ -178,6 +178,10 @@ public:
      *  @brief Extracts the camera info to view.
      */
     void extractView(View& view, int width, int height);
+    /**
+     *  @brief Computes the view projection matrix for the given render target size, the frame buffer size is used if the camera has one.
+     */
+    void calcViewProj(Mat4& out, int width, int height);
     /**
      *  @brief Transform a screen position to world in the current camera projection.
      */
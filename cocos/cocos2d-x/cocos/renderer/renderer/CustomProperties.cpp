@@ -26,6 +26,7 @@
 
 RENDERER_BEGIN
 CustomProperties::CustomProperties()
+: _propertyBlock(&_properties)
 {
 }
 
@@ -43,6 +44,7 @@ void CustomProperties::setProperty(const std::string name, const Property& prope
         return;
     }
     _properties[name] = property;
+    _propertyBlock.invalidate();
     _dirty = true;
 }
 
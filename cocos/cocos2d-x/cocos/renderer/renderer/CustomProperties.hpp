@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include "../Macro.h"
 #include "Technique.h"
+#include "PropertyBlock.h"
 #include "base/CCValue.h"
 
 RENDERER_BEGIN
@@ -44,6 +45,7 @@ public:
     void define(const std::string& name, const Value& value);
     Value getDefine(const std::string& name) const;
     std::unordered_map<std::string, Property>* extractProperties();
+    PropertyBlock* extractPropertyBlock() { return &_propertyBlock; }
     ValueMap* extractDefines();
     const double getHash() const {return _hash; };
     
@@ -51,6 +53,7 @@ public:
 private:
     
     std::unordered_map<std::string, Property> _properties;
+    PropertyBlock _propertyBlock;
     ValueMap _defines;
     double _hash = 0;
     bool _dirty = false;
@@ -29,6 +29,7 @@ RENDERER_BEGIN
 
 Effect::Effect()
 : _hash(0)
+, _propertyBlock(&_properties)
 {}
 
 void Effect::init(const Vector<Technique*>& techniques,
@@ -37,6 +38,7 @@ void Effect::init(const Vector<Technique*>& techniques,
 {
     _techniques = techniques;
     _properties = properties;
+    _propertyBlock.invalidate();
     
     for (const auto& defineTemplate: defineTemplates)
         _defines.emplace(defineTemplate.at("name").asString(),
@@ -105,6 +107,7 @@ const Effect::Property& Effect::getProperty(const std::string& name) const
 void Effect::setProperty(const std::string& name, const Property& property)
 {
     _properties[name] = property;
+    _propertyBlock.invalidate();
 }
 
 void Effect::generateDefinesKey()
@@ -128,6 +131,7 @@ void Effect::copy(const Effect* effect)
     }
     _defines = effect->_defines;
     _properties = effect->_properties;
+    _propertyBlock.invalidate();
     _definesKey = effect->_definesKey;
 }
 
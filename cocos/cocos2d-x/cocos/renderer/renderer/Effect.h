@@ -32,6 +32,7 @@
 #include "../Macro.h"
 #include "Technique.h"
 #include "Pass.h"
+#include "PropertyBlock.h"
 
 RENDERER_BEGIN
 
@@ -126,6 +127,10 @@ public:
      *  @brief Extracts all propertyps.
      */
     std::unordered_map<std::string, Property>* extractProperties();
+    /*
+     *  @brief Extracts the compiled property block.
+     */
+    PropertyBlock* extractPropertyBlock() { return &_propertyBlock; }
     /**
      *  @brief Gets uniform property value by name.
      */
@@ -198,6 +203,7 @@ private:
     Vector<Technique*> _techniques;
     ValueMap _defines;
     std::unordered_map<std::string, Property> _properties;
+    PropertyBlock _propertyBlock;
     
     void generateDefinesKey();
     
@@ -37,12 +37,20 @@
 #include "Pass.h"
 #include "Camera.h"
 #include "Light.h"
+#include "gfx/Program.h"
 #include <algorithm>
 
 #include "math/MathUtil.h"
 
 RENDERER_BEGIN
 
+namespace
+{
+    // Low bits of a draw key, they keep the submission order of items which are otherwise equal.
+    const uint32_t DRAW_KEY_SEQUENCE_BITS = 16;
+    const uint32_t DRAW_KEY_SEQUENCE_MASK = (1 << DRAW_KEY_SEQUENCE_BITS) - 1;
+}
+
 ForwardRenderer::ForwardRenderer()
 {
     _arrayPool = new RecyclePool<float>([]()mutable->float*{return new float[16];}, 8);
@@ -90,6 +98,7 @@ void ForwardRenderer::render(Scene* scene)
 {
     resetData();
     updateLights(scene);
+    _programLib->processWarmUp(&_defines);
     scene->sortCameras();
     auto& cameras = scene->getCameras();
     for (auto& camera : cameras)
@@ -103,6 +112,7 @@ void ForwardRenderer::render(Scene* scene)
         BaseRenderer::render(*view, scene);
     }
     
+    _device->unbindVertexArray();
     scene->removeModels();
 }
 
@@ -120,6 +130,7 @@ void ForwardRenderer::renderCamera(Camera* camera, Scene* scene)
     camera->extractView(*view, width, height);
     BaseRenderer::render(*view, scene);
     
+    _device->unbindVertexArray();
     scene->removeModels();
 }
 
@@ -348,34 +359,141 @@ void ForwardRenderer::updateShaderDefines(StageItem& item)
     MathUtil::combineHash(item.definesKeyHash, _definesHash);
 }
 
-bool ForwardRenderer::compareItems(const StageItem &a, const StageItem &b)
+uint64_t ForwardRenderer::makeDrawKey(const Technique* technique, float depth, uint32_t sequence)
+{
+    // Keys sort ascending: higher layers first, then techniques with more passes, then far to near.
+    uint64_t layer = 127 - std::max(-128, std::min(127, technique->getLayer()));
+    uint64_t passes = 255 - std::min((ssize_t)255, technique->getPasses().size());
+    
+    // Flips the float bits so that they compare as unsigned integers, then inverts them for the far to near order.
+    // Negative zero would otherwise sort before positive zero.
+    if (depth == 0.0f) depth = 0.0f;
+    uint32_t depthBits = 0;
+    memcpy(&depthBits, &depth, sizeof(depthBits));
+    depthBits = (depthBits & 0x80000000) ? ~depthBits : (depthBits | 0x80000000);
+    depthBits = ~depthBits;
+    
+    return (layer << 56) | (passes << 48) | ((uint64_t)depthBits << DRAW_KEY_SEQUENCE_BITS) | std::min(sequence, DRAW_KEY_SEQUENCE_MASK);
+}
+
+void ForwardRenderer::sortItems(std::vector<StageItem>& items)
 {
-    const Technique* techA = a.technique;
-    const Technique* techB = b.technique;
+    std::size_t count = items.size();
+    if (count < 2) return;
     
-    if (techA->getLayer() != techB->getLayer()) {
-        return techA->getLayer() > techB->getLayer();
+    // Items are submitted in a similar order every frame, so the last sorted order is usually
+    // still sorted or close to it, and insertion sort finishes it in a single pass.
+    // Past the sequence bits the keys of equal items are equal too, only a sort starting from the
+    // submission order keeps it.
+    if (_sortOrder.size() != count || count > DRAW_KEY_SEQUENCE_MASK + 1)
+    {
+        _sortOrder.resize(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            _sortOrder[i] = (uint32_t)i;
+        }
     }
     
-    size_t pa = techA->getPasses().size();
-    size_t pb = techB->getPasses().size();
+    if (!insertionSort(std::max(count, (std::size_t)64)))
+    {
+        radixSort();
+    }
     
-    if (pa != pb) {
-        return pa > pb;
+    bool identity = true;
+    for (std::size_t i = 0; i < count && identity; i++)
+    {
+        identity = _sortOrder[i] == i;
     }
+    if (identity) return;
     
-    return a.sortKey > b.sortKey;
+    _sortedItems.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        _sortedItems[i] = items[_sortOrder[i]];
+    }
+    items.swap(_sortedItems);
 }
 
-void ForwardRenderer::sortItems(std::vector<StageItem>& items)
+bool ForwardRenderer::insertionSort(std::size_t maxMoves)
 {
-    std::sort(items.begin(), items.end(), compareItems);
+    const uint64_t* keys = _sortKeys.data();
+    uint32_t* order = _sortOrder.data();
+    std::size_t moves = 0;
+    for (std::size_t i = 1, count = _sortOrder.size(); i < count; i++)
+    {
+        uint32_t index = order[i];
+        uint64_t key = keys[index];
+        std::size_t j = i;
+        while (j > 0 && keys[order[j - 1]] > key)
+        {
+            order[j] = order[j - 1];
+            j--;
+            if (++moves > maxMoves)
+            {
+                order[j] = index;
+                return false;
+            }
+        }
+        order[j] = index;
+    }
+    return true;
+}
+
+void ForwardRenderer::radixSort()
+{
+    std::size_t count = _sortKeys.size();
+    _sortKeysTmp.resize(count);
+    _sortOrderTmp.resize(count);
+    
+    uint64_t* srcKeys = _sortKeys.data();
+    uint64_t* dstKeys = _sortKeysTmp.data();
+    uint32_t* srcOrder = _sortOrder.data();
+    uint32_t* dstOrder = _sortOrderTmp.data();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        srcOrder[i] = (uint32_t)i;
+    }
+    
+    // Least significant byte first, every pass is stable.
+    uint32_t histogram[256];
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        memset(histogram, 0, sizeof(histogram));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            histogram[(srcKeys[i] >> shift) & 0xff]++;
+        }
+        
+        // All keys share this byte, the pass wouldn't move anything.
+        if (histogram[(srcKeys[0] >> shift) & 0xff] == count) continue;
+        
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram)
+        {
+            uint32_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+        
+        for (std::size_t i = 0; i < count; i++)
+        {
+            uint32_t pos = histogram[(srcKeys[i] >> shift) & 0xff]++;
+            dstKeys[pos] = srcKeys[i];
+            dstOrder[pos] = srcOrder[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcOrder, dstOrder);
+    }
+    
+    if (srcOrder != _sortOrder.data())
+    {
+        memcpy(_sortOrder.data(), srcOrder, count * sizeof(uint32_t));
+    }
 }
 
 void ForwardRenderer::drawItems(const std::vector<StageItem>& items)
 {
-    size_t count = _shadowLights.size();
-    if (count == 0 && _numLights == 0)
+    if (_shadowLights.size() == 0 && _numLights == 0)
     {
         for (const auto& item : items)
         {
@@ -384,26 +502,47 @@ void ForwardRenderer::drawItems(const std::vector<StageItem>& items)
     }
     else
     {
-        std::vector<Texture*> shadowMaps;
-        shadowMaps.reserve(count);
-        std::vector<int> slots;
-        slots.reserve(count);
         for (const auto& item : items)
         {
-            shadowMaps.clear();
-            for(int i = 0; i < count; i++)
-            {
-                Light* light = _shadowLights.at(i);
-                shadowMaps.push_back(light->getShadowMap());
-                slots.push_back(allocTextureUnit());
-            }
-            _device->setTextureArray(cc_shadow_map, shadowMaps, slots);
             updateShaderDefines(const_cast<StageItem&>(item));
             draw(item);
         }
     }
 }
 
+void ForwardRenderer::beginStageUniforms(uint32_t builtinUniforms)
+{
+    _stageUniforms = builtinUniforms;
+    _submittedUniforms = 0;
+}
+
+void ForwardRenderer::submitBuiltinUniforms(uint32_t builtinUniforms)
+{
+    builtinUniforms &= _stageUniforms;
+    
+    // Lights and shadows are the same for the whole stage, submit them lazily the first time a program needs them.
+    uint32_t pending = builtinUniforms & ~_submittedUniforms;
+    if (pending & Program::BUILTIN_LIGHTS)
+        submitLightsUniforms();
+    if (pending & Program::BUILTIN_SHADOWS)
+        submitOtherStagesUniforms();
+    _submittedUniforms |= pending;
+    
+    size_t count = _shadowLights.size();
+    if ((builtinUniforms & Program::BUILTIN_SHADOWS) && count > 0)
+    {
+        _shadowMaps.clear();
+        _shadowMapSlots.clear();
+        for (int i = 0; i < count; i++)
+        {
+            Light* light = _shadowLights.at(i);
+            _shadowMaps.push_back(light->getShadowMap());
+            _shadowMapSlots.push_back(allocTextureUnit());
+        }
+        _device->setTextureArray(cc_shadow_map, _shadowMaps, _shadowMapSlots);
+    }
+}
+
 void ForwardRenderer::opaqueStage(const View& view, std::vector<StageItem>& items)
 {
     _device->setUniformMat4(cc_matView, view.matView);
@@ -414,14 +553,14 @@ void ForwardRenderer::opaqueStage(const View& view, std::vector<StageItem>& item
     view.getPosition(cameraPos3);
     cameraPos4.set(cameraPos3.x, cameraPos3.y, cameraPos3.z, 0);
     _device->setUniformVec4(cc_cameraPos, cameraPos4);
-    submitLightsUniforms();
-    submitOtherStagesUniforms();
+    beginStageUniforms(Program::BUILTIN_LIGHTS | Program::BUILTIN_SHADOWS);
     drawItems(items);
 }
 
 void ForwardRenderer::shadowStage(const View& view, std::vector<StageItem>& items)
 {
     submitShadowStageUniforms(view);
+    beginStageUniforms(0);
     
     for (auto& item : items)
     {
@@ -433,7 +572,7 @@ void ForwardRenderer::shadowStage(const View& view, std::vector<StageItem>& item
     }
 }
 
-void ForwardRenderer::transparentStage(const View& view, const std::vector<StageItem>& items)
+void ForwardRenderer::transparentStage(const View& view, std::vector<StageItem>& items)
 {
     _device->setUniformMat4(cc_matView, view.matView);
     _device->setUniformMat4(cc_matpProj, view.matProj);
@@ -448,12 +587,14 @@ void ForwardRenderer::transparentStage(const View& view, const std::vector<Stage
     static Vec3 tmpVec3;
     view.getForward(camFwd);
     
-    submitLightsUniforms();
-    submitOtherStagesUniforms();
+    beginStageUniforms(Program::BUILTIN_LIGHTS | Program::BUILTIN_SHADOWS);
     
+    std::size_t count = items.size();
+    _sortKeys.resize(count);
     NodeProxy* node;
-    for (auto& item : const_cast<std::vector<StageItem>&>(items))
+    for (std::size_t i = 0; i < count; i++)
     {
+        const auto& item = items[i];
         node = const_cast<NodeProxy*>(item.model->getNode());
         if (node != nullptr)
         {
@@ -465,10 +606,10 @@ void ForwardRenderer::transparentStage(const View& view, const std::vector<Stage
         }
         
         Vec3::subtract(tmpVec3, tmpVec3, &cameraPos3);
-        item.sortKey = -Vec3::dot(tmpVec3, camFwd);
+        _sortKeys[i] = makeDrawKey(item.technique, -Vec3::dot(tmpVec3, camFwd), (uint32_t)i);
     }
     
-    sortItems(const_cast<std::vector<StageItem>&>(items));
+    sortItems(items);
     drawItems(items);
 }
 
@@ -63,7 +63,18 @@ public:
      *  @brief Renders the given render scene with a given camera setting.
      */
     void renderCamera(Camera* camera, Scene* scene);
+    /**
+     *  @brief Gets the width of the default render target.
+     */
+    int getWidth() const { return _width; }
+    /**
+     *  @brief Gets the height of the default render target.
+     */
+    int getHeight() const { return _height; }
 private:
+    // The host tests check the draw key sort against the comparator it replaced.
+    friend class ForwardRendererSortTest;
+    
     void updateLights(Scene* scene);
     void updateDefines();
     void submitLightsUniforms();
@@ -71,12 +82,16 @@ private:
     void submitOtherStagesUniforms();
     void updateShaderDefines(StageItem& item);
     void sortItems(std::vector<StageItem>& items);
+    bool insertionSort(std::size_t maxMoves);
+    void radixSort();
     void drawItems(const std::vector<StageItem>& items);
     void opaqueStage(const View& view, std::vector<StageItem>& items);
     void shadowStage(const View& view, std::vector<StageItem>& items);
-    void transparentStage(const View& view, const std::vector<StageItem>& items);
+    void transparentStage(const View& view, std::vector<StageItem>& items);
     void resetData();
-    static bool compareItems(const StageItem& a, const StageItem& b);
+    void beginStageUniforms(uint32_t builtinUniforms);
+    virtual void submitBuiltinUniforms(uint32_t builtinUniforms) override;
+    static uint64_t makeDrawKey(const Technique* technique, float depth, uint32_t sequence);
     
     Vector<Light*> _directionalLights;
     Vector<Light*> _pointLights;
@@ -85,6 +100,18 @@ private:
     Vector<Light*> _ambientLights;
     
     RecyclePool<float>* _arrayPool = nullptr;
+    std::vector<Texture*> _shadowMaps;
+    std::vector<int> _shadowMapSlots;
+    uint32_t _stageUniforms = 0;
+    uint32_t _submittedUniforms = 0;
+    
+    // Draw keys of the items being sorted, indexed by their submission order.
+    std::vector<uint64_t> _sortKeys;
+    std::vector<uint64_t> _sortKeysTmp;
+    // Sorted item indices, kept as the starting order of the next sort.
+    std::vector<uint32_t> _sortOrder;
+    std::vector<uint32_t> _sortOrderTmp;
+    std::vector<StageItem> _sortedItems;
     
     int _width = 0;
     int _height = 0;
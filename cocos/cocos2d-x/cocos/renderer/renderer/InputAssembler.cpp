@@ -46,33 +46,43 @@ InputAssembler::~InputAssembler()
 {
     RENDERER_SAFE_RELEASE(_vertexBuffer);
     RENDERER_SAFE_RELEASE(_indexBuffer);
+    RENDERER_SAFE_RELEASE(_instanceBuffer);
 }
 
 void InputAssembler::clear()
 {
     CC_SAFE_RELEASE(_vertexBuffer);
     CC_SAFE_RELEASE(_indexBuffer);
+    CC_SAFE_RELEASE(_instanceBuffer);
     
     _vertexBuffer = nullptr;
     _indexBuffer = nullptr;
+    _instanceBuffer = nullptr;
     _primitiveType = PrimitiveType::TRIANGLES;
     _start = 0;
     _count = -1;
+    _instanceStart = 0;
+    _instanceCount = 0;
 }
 
 InputAssembler& InputAssembler::operator=(const InputAssembler& o)
 {
     CC_SAFE_RELEASE(_vertexBuffer);
     CC_SAFE_RELEASE(_indexBuffer);
+    CC_SAFE_RELEASE(_instanceBuffer);
     
     _vertexBuffer = o._vertexBuffer;
     _indexBuffer = o._indexBuffer;
+    _instanceBuffer = o._instanceBuffer;
     _start = o._start;
     _count = o._count;
+    _instanceStart = o._instanceStart;
+    _instanceCount = o._instanceCount;
     _primitiveType = o._primitiveType;
     
     CC_SAFE_RETAIN(_vertexBuffer);
     CC_SAFE_RETAIN(_indexBuffer);
+    CC_SAFE_RETAIN(_instanceBuffer);
     
     return *this;
 }
@@ -81,17 +91,24 @@ InputAssembler& InputAssembler::operator=(InputAssembler&& o)
 {
     CC_SAFE_RELEASE(_vertexBuffer);
     CC_SAFE_RELEASE(_indexBuffer);
+    CC_SAFE_RELEASE(_instanceBuffer);
     
     _vertexBuffer = o._vertexBuffer;
     _indexBuffer = o._indexBuffer;
+    _instanceBuffer = o._instanceBuffer;
     _start = o._start;
     _count = o._count;
+    _instanceStart = o._instanceStart;
+    _instanceCount = o._instanceCount;
     _primitiveType = o._primitiveType;
     
     o._indexBuffer = nullptr;
     o._vertexBuffer = nullptr;
+    o._instanceBuffer = nullptr;
     o._start = 0;
     o._count = -1;
+    o._instanceStart = 0;
+    o._instanceCount = 0;
     
     return *this;
 }
@@ -120,6 +137,13 @@ void InputAssembler::setIndexBuffer(IndexBuffer* ib)
     RENDERER_SAFE_RETAIN(_indexBuffer);
 }
 
+void InputAssembler::setInstanceBuffer(VertexBuffer* vb)
+{
+    RENDERER_SAFE_RELEASE(_instanceBuffer);
+    _instanceBuffer = vb;
+    RENDERER_SAFE_RETAIN(_instanceBuffer);
+}
+
 uint32_t InputAssembler::getPrimitiveCount() const
 {
     if (-1 != _count)
@@ -134,7 +158,7 @@ uint32_t InputAssembler::getPrimitiveCount() const
 
 bool InputAssembler::isMergeable(const InputAssembler& ia) const
 {
-    if (_indexBuffer != ia._indexBuffer || _vertexBuffer != ia._vertexBuffer)
+    if (_indexBuffer != ia._indexBuffer || _vertexBuffer != ia._vertexBuffer || _instanceBuffer || ia._instanceBuffer)
     {
         return false;
     }
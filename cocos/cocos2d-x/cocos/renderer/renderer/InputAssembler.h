@@ -103,6 +103,30 @@ public:
      *  @brief Sets the primitive type.
      */
     inline void setPrimitiveType(PrimitiveType type) { _primitiveType = type; }
+    /**
+     *  @brief Sets the vertex buffer which provides per instance attributes, the elements are drawn once per instance if it is set.
+     */
+    void setInstanceBuffer(VertexBuffer* vb);
+    /**
+     *  @brief Gets the instance buffer.
+     */
+    inline VertexBuffer* getInstanceBuffer() const { return _instanceBuffer; }
+    /**
+     *  @brief Sets the first instance in the instance buffer.
+     */
+    inline void setInstanceStart(int start) { _instanceStart = start; }
+    /**
+     *  @brief Gets the first instance in the instance buffer.
+     */
+    inline int getInstanceStart() const { return _instanceStart; }
+    /**
+     *  @brief Sets the count of instances.
+     */
+    inline void setInstanceCount(int count) { _instanceCount = count; }
+    /**
+     *  @brief Gets the count of instances.
+     */
+    inline int getInstanceCount() const { return _instanceCount; }
     /**
      *  @brief Clears all field.
      */
@@ -116,9 +140,12 @@ private:
     
     VertexBuffer* _vertexBuffer = nullptr;
     IndexBuffer* _indexBuffer = nullptr;
+    VertexBuffer* _instanceBuffer = nullptr;
     PrimitiveType _primitiveType = PrimitiveType::TRIANGLES;
     int _start = 0;
     int _count = -1;
+    int _instanceStart = 0;
+    int _instanceCount = 0;
 };
 
 RENDERER_END
@@ -91,7 +91,7 @@ void Model::setEffect(Effect* effect, CustomProperties* customProperties)
     if (effect != nullptr)
     {
         _definesList.push_back(effect->extractDefines());
-        _uniforms.push_back(effect->extractProperties());
+        _uniforms.push_back(effect->extractPropertyBlock());
         
         MathUtil::combineHash(_definesKeyHash, std::hash<std::string>{}(effect->getDefinesKey()));
     }
@@ -99,7 +99,7 @@ void Model::setEffect(Effect* effect, CustomProperties* customProperties)
     if (customProperties != nullptr)
     {
         _definesList.push_back(customProperties->extractDefines());
-        _uniforms.push_back(customProperties->extractProperties());
+        _uniforms.push_back(customProperties->extractPropertyBlock());
         
         MathUtil::combineHash(_definesKeyHash, std::hash<std::string>{}(customProperties->getDefinesKey()));
     }
@@ -131,7 +131,7 @@ void Model::extractDrawItem(DrawItem& out) const
     out.ia = const_cast<InputAssembler*>(&_inputAssembler);
     out.effect = _effect;
     out.defines = const_cast<std::vector<ValueMap*>*>(&_definesList);
-    out.uniforms = const_cast<std::vector<std::unordered_map<std::string, Effect::Property>*>*>(&_uniforms);
+    out.uniforms = const_cast<std::vector<PropertyBlock*>*>(&_uniforms);
     out.definesKeyHash = _definesKeyHash;
 }
 
@@ -142,6 +142,7 @@ void Model::reset()
     _inputAssembler.clear();
     _uniforms.clear();
     _definesList.clear();
+    _palette.clear();
 }
 
 RENDERER_END
@@ -54,7 +54,7 @@ struct DrawItem
     Effect* effect = nullptr;
     std::vector<ValueMap*>* defines = nullptr;
     size_t definesKeyHash = 0;
-    std::vector<std::unordered_map<std::string, Effect::Property>*>* uniforms = nullptr;
+    std::vector<PropertyBlock*>* uniforms = nullptr;
 };
 
 class Model;
@@ -107,6 +107,16 @@ public:
      *  @brief Adds an effect.
      */
     void setEffect(Effect* effect, CustomProperties* customProperties);
+    /**
+     *  @brief Sets the node matrices of a palette batch, empty if the vertices are in world space.
+     *  @param[in] data Two rows of an affine transform per node.
+     *  @param[in] count Count of floats.
+     */
+    inline void setPalette(const float* data, std::size_t count) { _palette.assign(data, data + count); }
+    /**
+     *  @brief Gets the node matrices of a palette batch.
+     */
+    inline const std::vector<float>& getPalette() const { return _palette; }
     /**
      *  @brief Set user key.
      */
@@ -136,7 +146,8 @@ private:
     
     InputAssembler _inputAssembler;
     std::vector<ValueMap*> _definesList;
-    std::vector<std::unordered_map<std::string, Effect::Property>*> _uniforms;
+    std::vector<PropertyBlock*> _uniforms;
+    std::vector<float> _palette;
     bool _dynamicIA = false;
     int _cullingMask = -1;
     int _userKey = -1;
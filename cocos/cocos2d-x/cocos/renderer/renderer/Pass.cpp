@@ -140,4 +140,44 @@ void Pass::copy(const Pass& pass)
     _hashName = pass._hashName;
 }
 
+size_t Pass::getStateHash() const
+{
+    size_t hash = _hashName;
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    
+    combine(_blend);
+    combine((size_t)_blendEq);
+    combine((size_t)_blendAlphaEq);
+    combine((size_t)_blendSrc);
+    combine((size_t)_blendDst);
+    combine((size_t)_blendSrcAlpha);
+    combine((size_t)_blendDstAlpha);
+    combine(_blendColor);
+    
+    combine(_depthTest);
+    combine(_depthWrite);
+    combine((size_t)_depthFunc);
+    
+    combine(_stencilTest);
+    combine(_stencilRefFront);
+    combine((size_t)_stencilFuncFront);
+    combine((size_t)_stencilFailOpFront);
+    combine((size_t)_stencilZFailOpFront);
+    combine((size_t)_stencilZPassOpFront);
+    combine(_stencilWriteMaskFront);
+    combine(_stencilMaskFront);
+    combine(_stencilRefBack);
+    combine((size_t)_stencilFuncBack);
+    combine((size_t)_stencilFailOpBack);
+    combine((size_t)_stencilZFailOpBack);
+    combine((size_t)_stencilZPassOpBack);
+    combine(_stencilWriteMaskBack);
+    combine(_stencilMaskBack);
+    
+    combine((size_t)_cullMode);
+    return hash;
+}
+
 RENDERER_END
@@ -131,6 +131,10 @@ public:
     inline const std::string& getProgramName() const { return _programName; }
     
     inline size_t getHashName() const { return _hashName; }
+    /**
+     *  @brief Gets a hash of the linked program and all render states of the pass.
+     */
+    size_t getStateHash() const;
     /**
      *  @brief Disable stencil test.
      */
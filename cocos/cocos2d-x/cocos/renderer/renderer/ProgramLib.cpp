@@ -22,12 +22,14 @@
  THE SOFTWARE.
  ****************************************************************************/
 #include "ProgramLib.h"
+#include "Effect.h"
 #include "../gfx/Program.h"
 #include "gfx/DeviceGraphics.h"
 
+#include "cocos2d.h"
 #include "math/MathUtil.h"
 
-#include <regex>
+#include <map>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -35,42 +37,87 @@
 namespace {
     uint32_t _shdID = 0;
 
+    // The preprocessed sources follow the header and are compared on load, so that a digest collision never links a wrong binary.
+    struct ProgramBinaryHeader
+    {
+        uint32_t magic = 0x32504343; // CCP2
+        uint32_t format = 0;
+        uint32_t length = 0;
+        uint32_t sourceLength = 0;
+        uint64_t sourceHash = 0;
+        uint64_t driverHash = 0;
+    };
+
+    // 64-bit FNV-1a, std::hash is only 32-bit on armv7 and differs between standard libraries.
+    uint64_t hashString(const std::string& text, uint64_t hash = 0xcbf29ce484222325ULL)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Key of the source cache and content of binary files, a separator keeps vert and frag boundaries distinct.
+    std::string joinSources(const std::string& vert, const std::string& frag)
+    {
+        std::string sources;
+        sources.reserve(vert.length() + frag.length() + 1);
+        sources.append(vert).append(1, '\0').append(frag);
+        return sources;
+    }
+
     std::string generateDefines(const std::vector<cocos2d::ValueMap*>& definesList)
     {
-        std::string ret;
-        std::string v;
-        cocos2d::ValueMap cache;
+        // Sorted so that equal define sets always produce the same source.
+        std::map<std::string, std::string> defines;
         for (int i = (int)definesList.size() - 1; i >= 0; i--)
         {
             cocos2d::ValueMap* defMap = definesList[i];
             for (const auto& def : *defMap)
             {
-                if (cache.find(def.first) != cache.end())
+                if (defines.find(def.first) != defines.end())
                 {
                     continue;
                 }
                 
                 if (def.second.getType() == cocos2d::Value::Type::BOOLEAN)
                 {
-                    v = def.second.asBool() ? "1" : "0";
+                    defines.emplace(def.first, def.second.asBool() ? "1" : "0");
                 }
                 else
                 {
-                    v = std::to_string(def.second.asUnsignedInt());
+                    defines.emplace(def.first, std::to_string(def.second.asUnsignedInt()));
                 }
-                
-                ret += "#define "  + def.first + " " + v + "\n";
-                
-                cache.emplace(def.first, def.second);
             }
         }
+        
+        std::string ret;
+        for (const auto& def : defines)
+        {
+            ret += "#define "  + def.first + " " + def.second + "\n";
+        }
        
         return ret;
     }
 
+    void replaceAll(std::string& str, const std::string& from, const std::string& to)
+    {
+        if (from.empty())
+            return;
+        
+        std::string::size_type pos = 0;
+        while ((pos = str.find(from, pos)) != std::string::npos)
+        {
+            str.replace(pos, from.length(), to);
+            pos += to.length();
+        }
+    }
+
     std::string replaceMacroNums(const std::string str, const std::vector<cocos2d::ValueMap*>& definesList)
     {
-        cocos2d::ValueMap cache;
+        std::map<std::string, std::string> cache;
         std::string tmp = str;
         for (int i = (int)definesList.size() - 1; i >= 0; i--)
         {
@@ -85,72 +132,177 @@ namespace {
                 
                 if (def.second.getType() == cocos2d::Value::Type::INTEGER || def.second.getType() == cocos2d::Value::Type::UNSIGNED)
                 {
-                    cache.emplace(def.first, def.second);
+                    cache.emplace(def.first, def.second.asString());
                 }
             }
         }
         
-        for (const auto& def : cache)
+        // Define names are plain identifiers, reverse order replaces longer names before their prefixes.
+        for (auto iter = cache.rbegin(); iter != cache.rend(); ++iter)
         {
-            std::regex pattern(def.first);
-            tmp = std::regex_replace(tmp, pattern, def.second.asString());
+            replaceAll(tmp, iter->first, iter->second);
         }
         
         return tmp;
     }
 
-    using RegexReplaceCallback = std::function<std::string(const std::match_results<std::string::const_iterator>&)>;
-
-    static std::string regexReplaceString(const std::string& text, const std::string& pattern, const RegexReplaceCallback& replaceCallback)
+    // Parses "name in range(begin, end)" following "#pragma for ".
+    bool parseLoopHeader(const std::string& text, size_t& pos, std::string& name, int32_t& begin, int32_t& end)
     {
-        std::string ret = text;
-        std::regex re(pattern);
+        auto skipSpaces = [&]() {
+            while (pos < text.length() && isspace((unsigned char)text[pos]))
+                ++pos;
+        };
+        auto expect = [&](const char* token) {
+            size_t len = strlen(token);
+            if (text.compare(pos, len, token) != 0)
+                return false;
+            pos += len;
+            return true;
+        };
+        auto parseNumber = [&](int32_t& out) {
+            size_t start = pos;
+            while (pos < text.length() && isdigit((unsigned char)text[pos]))
+                ++pos;
+            if (pos == start)
+                return false;
+            out = atoi(text.c_str() + start);
+            return true;
+        };
+
+        size_t start = pos;
+        while (pos < text.length() && (isalnum((unsigned char)text[pos]) || text[pos] == '_'))
+            ++pos;
+        if (pos == start)
+            return false;
+        name = text.substr(start, pos - start);
+
+        if (!expect(" in range("))
+            return false;
+        skipSpaces();
+        if (!parseNumber(begin))
+            return false;
+        skipSpaces();
+        if (!expect(","))
+            return false;
+        skipSpaces();
+        if (!parseNumber(end))
+            return false;
+        skipSpaces();
+        return expect(")");
+    }
 
-        std::string::const_iterator text_iter = text.cbegin();
-        std::match_results<std::string::const_iterator> results;
+    std::string unrollLoops(const std::string& text)
+    {
+        static const std::string forToken = "#pragma for ";
+        static const std::string endForToken = "#pragma endFor";
 
-        size_t start = 0;
-        size_t offset = 0;
-        while (std::regex_search(text_iter, text.end(), results, re))
+        std::string ret;
+        size_t copied = 0;
+        size_t searchPos = 0;
+        size_t forPos = 0;
+        while ((forPos = text.find(forToken, searchPos)) != std::string::npos)
         {
-            offset = start + results.position();
-            std::string replacement = replaceCallback(results);
-            ret = ret.replace(offset, results.length(), replacement);
-            start = offset + replacement.length();
+            size_t pos = forPos + forToken.length();
+            searchPos = pos;
+
+            std::string name;
+            int32_t parsedBegin = 0;
+            int32_t parsedEnd = 0;
+            if (!parseLoopHeader(text, pos, name, parsedBegin, parsedEnd))
+                continue;
+
+            // The loop body has at least one character.
+            size_t endForPos = text.find(endForToken, pos + 1);
+            if (endForPos == std::string::npos)
+                break;
 
-            text_iter = results[0].second;
+            std::string snippet = text.substr(pos, endForPos - pos);
+            std::string placeholder = "{" + name + "}";
+
+            ret.append(text, copied, forPos - copied);
+            for (int32_t i = parsedBegin; i < parsedEnd; ++i)
+            {
+                std::string unroll = snippet;
+                replaceAll(unroll, placeholder, std::to_string(i));
+                ret += unroll;
+            }
+
+            copied = searchPos = endForPos + endForToken.length();
         }
+        ret.append(text, copied, std::string::npos);
 
         return ret;
     }
 
-    std::string unrollLoops(const std::string& text)
+    std::string getProgramBinaryPath(const std::string& dir, uint64_t sourceHash, uint64_t driverHash)
     {
-        auto func = [](const std::match_results<std::string::const_iterator>& results) -> std::string {
-            assert(results.size() == 5);
-            std::string snippet = results[4].str();
-            std::string replacePatternStr = "\\{" + results[1].str() + "\\}";
-            std::regex replacePattern(replacePatternStr);
+        char name[48] = {0};
+        snprintf(name, sizeof(name), "%016llx%016llx.bin", (unsigned long long)sourceHash, (unsigned long long)driverHash);
+        return dir + name;
+    }
 
-            int32_t parsedBegin = atoi(results[2].str().c_str());
-            int32_t parsedEnd = atoi(results[3].str().c_str());
-            if (parsedBegin < 0 || parsedEnd < 0)
+    bool loadProgramBinary(cocos2d::renderer::Program* program, const std::string& path, const ProgramBinaryHeader& expected, const std::string& sources)
+    {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr)
+            return false;
+
+        ProgramBinaryHeader header;
+        std::vector<uint8_t> binary;
+        if (fread(&header, sizeof(header), 1, fp) == 1
+            && header.magic == expected.magic
+            && header.sourceHash == expected.sourceHash
+            && header.driverHash == expected.driverHash
+            && header.sourceLength == expected.sourceLength
+            && header.length > 0)
+        {
+            std::string storedSources(header.sourceLength, '\0');
+            if (fread(&storedSources[0], header.sourceLength, 1, fp) == 1 && storedSources == sources)
             {
-                RENDERER_LOGE("Unroll For Loops Error: begin and end of range must be an int num.");
+                binary.resize(header.length);
+                if (fread(binary.data(), header.length, 1, fp) != 1)
+                    binary.clear();
             }
+        }
+        fclose(fp);
 
-            std::string unroll;
-            char tmp[256] = {0};
-            for (int32_t i = parsedBegin; i < parsedEnd; ++i)
-            {
-                snprintf(tmp, 256, "%d", i);
-                std::string replaceFormat(tmp);
-                unroll += std::regex_replace(snippet, replacePattern, replaceFormat);
-            }
-            return unroll;
-        };
+        if (binary.empty())
+            return false;
 
-        return regexReplaceString(text, "#pragma for (\\w+) in range\\(\\s*(\\d+)\\s*,\\s*(\\d+)\\s*\\)([\\s\\S]+?)#pragma endFor", func);
+        if (!program->linkBinary((GLenum)header.format, binary.data(), (GLsizei)binary.size()))
+        {
+            // Usually a driver update, the program is linked from source and the file rewritten.
+            RENDERER_LOGD("Program binary rejected: %s", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void saveProgramBinary(const cocos2d::renderer::Program* program, const std::string& path, ProgramBinaryHeader header, const std::string& sources)
+    {
+        GLenum format = 0;
+        std::vector<uint8_t> binary;
+        if (!program->getBinary(format, binary))
+            return;
+
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (fp == nullptr)
+        {
+            RENDERER_LOGE("Failed to write program binary %s", path.c_str());
+            return;
+        }
+
+        header.format = (uint32_t)format;
+        header.length = (uint32_t)binary.size();
+        bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+            && fwrite(sources.data(), sources.length(), 1, fp) == 1
+            && fwrite(binary.data(), binary.size(), 1, fp) == 1;
+        fclose(fp);
+        if (!written)
+        {
+            remove(path.c_str());
+        }
     }
 }
 
@@ -168,10 +320,40 @@ ProgramLib::ProgramLib(DeviceGraphics* device, std::vector<Template>& templates)
     
     for (auto& templ : templates)
         define(templ.name, templ.vert, templ.frag, templ.defines);
+    
+    if (_device && _device->isProgramBinarySupported())
+    {
+        // Binaries are only valid for the driver and engine which produced them.
+        const char* vendor = (const char*)glGetString(GL_VENDOR);
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        const char* version = (const char*)glGetString(GL_VERSION);
+        auto fileUtils = FileUtils::getInstance();
+        std::string dir = fileUtils->getWritablePath() + "program-cache/";
+        if (vendor == nullptr || renderer == nullptr || version == nullptr)
+        {
+            RENDERER_LOGW("Program binary cache disabled, driver strings unavailable");
+        }
+        else if (fileUtils->isDirectoryExist(dir) || fileUtils->createDirectory(dir))
+        {
+            _binaryCacheDir = dir;
+            
+            std::string driver = vendor;
+            driver += renderer;
+            driver += version;
+            driver += cocos2dVersion();
+            _driverHash = hashString(driver);
+        }
+    }
 }
 
 ProgramLib::~ProgramLib()
 {
+    for (auto& item : _warmUpQueue)
+    {
+        RENDERER_SAFE_RELEASE(item.effect);
+    }
+    _warmUpQueue.clear();
+    
     RENDERER_SAFE_RELEASE(_device);
     _device = nullptr;
 }
@@ -274,22 +456,10 @@ Program* ProgramLib::switchProgram(const size_t programNameHash, const size_t de
         return iter->second;
     }
 
-    Program* program = nullptr;
-    auto templIter = _templates.find(programNameHash);
-    if (templIter != _templates.end())
-    {
-        const auto& tmpl = templIter->second;
-        std::string customDef = generateDefines(definesList) + "\n";
-        std::string vert = replaceMacroNums(tmpl.vert, definesList);
-        vert = customDef + unrollLoops(vert);
-        std::string frag = replaceMacroNums(tmpl.frag, definesList);
-        frag = customDef + unrollLoops(frag);
-        
-        program = new Program();
-        program->init(_device, vert.c_str(), frag.c_str());
-        program->link();
+    Program* program = getProgram(programNameHash, definesList);
+    if (program)
+    {
         _cache.emplace(programHash, program);
-        
         program->setHash(programHash);
     }
     
@@ -298,6 +468,119 @@ Program* ProgramLib::switchProgram(const size_t programNameHash, const size_t de
     return program;
 }
 
+Program* ProgramLib::getProgram(size_t programNameHash, const std::vector<ValueMap*>& definesList)
+{
+    auto templIter = _templates.find(programNameHash);
+    if (templIter == _templates.end())
+    {
+        return nullptr;
+    }
+
+    const auto& tmpl = templIter->second;
+    std::string customDef = generateDefines(definesList) + "\n";
+    std::string vert = replaceMacroNums(tmpl.vert, definesList);
+    vert = customDef + unrollLoops(vert);
+    std::string frag = replaceMacroNums(tmpl.frag, definesList);
+    frag = customDef + unrollLoops(frag);
+    
+    std::string sources = joinSources(vert, frag);
+    auto iter = _sourceCache.find(sources);
+    if (iter != _sourceCache.end())
+    {
+        return iter->second;
+    }
+    
+    Program* program = new Program();
+    program->init(_device, vert.c_str(), frag.c_str());
+    
+    std::string binaryPath;
+    ProgramBinaryHeader header;
+    header.sourceHash = hashString(sources);
+    header.driverHash = _driverHash;
+    header.sourceLength = (uint32_t)sources.length();
+    bool binaryLoaded = false;
+    if (!_binaryCacheDir.empty())
+    {
+        binaryPath = getProgramBinaryPath(_binaryCacheDir, header.sourceHash, _driverHash);
+        binaryLoaded = loadProgramBinary(program, binaryPath, header, sources);
+    }
+    
+    if (!binaryLoaded)
+    {
+        program->link();
+        if (!binaryPath.empty() && program->isLinked())
+        {
+            saveProgramBinary(program, binaryPath, header, sources);
+        }
+    }
+    
+    _sourceCache.emplace(std::move(sources), program);
+    return program;
+}
+
+void ProgramLib::warmUp(const std::vector<std::pair<Effect*, ValueMap>>& items)
+{
+    for (const auto& item : items)
+    {
+        if (item.first == nullptr)
+            continue;
+        
+        WarmUpItem warmUpItem;
+        warmUpItem.effect = item.first;
+        warmUpItem.defines = item.second;
+        RENDERER_SAFE_RETAIN(warmUpItem.effect);
+        _warmUpQueue.push_back(std::move(warmUpItem));
+    }
+}
+
+size_t ProgramLib::processWarmUp(ValueMap* rendererDefines, uint32_t maxPrograms)
+{
+    uint32_t prepared = 0;
+    while (!_warmUpQueue.empty() && prepared < maxPrograms)
+    {
+        WarmUpItem& item = _warmUpQueue.front();
+        
+        // Same define list order as a model drawn by the renderer.
+        std::vector<ValueMap*> definesList;
+        definesList.push_back(item.effect->extractDefines());
+        definesList.push_back(&item.defines);
+        if (rendererDefines)
+            definesList.push_back(rendererDefines);
+        
+        size_t passIndex = 0;
+        bool finished = true;
+        for (const auto& technique : item.effect->getTechniques())
+        {
+            for (const auto& pass : technique->getPasses())
+            {
+                if (passIndex++ < item.nextPass)
+                    continue;
+                
+                if (prepared == maxPrograms)
+                {
+                    finished = false;
+                    break;
+                }
+                
+                getProgram(pass->getHashName(), definesList);
+                ++item.nextPass;
+                ++prepared;
+            }
+            
+            if (!finished)
+                break;
+        }
+        
+        if (!finished)
+            break;
+        
+        RENDERER_SAFE_RELEASE(item.effect);
+        _warmUpQueue.pop_front();
+    }
+    
+    return _warmUpQueue.size();
+}
+
 const Value* ProgramLib::getValueFromDefineList(const std::string& name, const std::vector<ValueMap*>& definesList)
 {
     for (int i = (int)definesList.size() - 1; i >= 0; i--)
@@ -313,6 +596,28 @@ const Value* ProgramLib::getValueFromDefineList(const std::string& name, const s
     return nullptr;
 }
 
+void ProgramLib::setInstancedVariant(const std::string& name, const std::string& instancedName)
+{
+    _instancedVariants[std::hash<std::string>{}(name)] = std::hash<std::string>{}(instancedName);
+}
+
+size_t ProgramLib::getInstancedVariant(size_t programNameHash) const
+{
+    auto iter = _instancedVariants.find(programNameHash);
+    return iter != _instancedVariants.end() ? iter->second : 0;
+}
+
+void ProgramLib::setPaletteVariant(const std::string& name, const std::string& paletteName)
+{
+    _paletteVariants[std::hash<std::string>{}(name)] = std::hash<std::string>{}(paletteName);
+}
+
+size_t ProgramLib::getPaletteVariant(size_t programNameHash) const
+{
+    auto iter = _paletteVariants.find(programNameHash);
+    return iter != _paletteVariants.end() ? iter->second : 0;
+}
+
 uint32_t ProgramLib::getValueKey(const Value *v)
 {
     if (v->getType() == Value::Type::BOOLEAN)
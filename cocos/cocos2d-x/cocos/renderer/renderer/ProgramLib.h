@@ -29,12 +29,14 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <functional>
 
 RENDERER_BEGIN
 
 class DeviceGraphics;
 class Program;
+class Effect;
 
 /**
  * @addtogroup renderer
@@ -80,9 +82,46 @@ public:
     Program* switchProgram(const size_t programNameHash, const size_t definesKeyHash, const std::vector<ValueMap*>& definesList);
     
     const Value* getValueFromDefineList(const std::string& name, const std::vector<ValueMap*>& definesList);
+    
+    /**
+     *  @brief Registers the template used instead of the named one when the input assembler draws instances.
+     */
+    void setInstancedVariant(const std::string& name, const std::string& instancedName);
+    /**
+     *  @brief Gets the hashed name of the instanced variant of a template, 0 if it has none.
+     */
+    size_t getInstancedVariant(size_t programNameHash) const;
+    /**
+     *  @brief Registers the template used instead of the named one when the model carries a matrix palette.
+     */
+    void setPaletteVariant(const std::string& name, const std::string& paletteName);
+    /**
+     *  @brief Gets the hashed name of the palette variant of a template, 0 if it has none.
+     */
+    size_t getPaletteVariant(size_t programNameHash) const;
+    
+    /**
+     *  @brief Queues the programs of all effect passes to be prepared before their first draw, call it while a loading screen is shown.
+     *  @param[in] items Effects paired with the custom defines their models will be drawn with, the renderer defines are appended when the queue is processed.
+     */
+    void warmUp(const std::vector<std::pair<Effect*, ValueMap>>& items);
+    /**
+     *  @brief Prepares at most maxPrograms queued programs.
+     *  @param[in] rendererDefines Defines appended by the renderer to every draw.
+     *  @return The number of effects left in the queue.
+     */
+    size_t processWarmUp(ValueMap* rendererDefines, uint32_t maxPrograms = 2);
 
 private:
+    struct WarmUpItem
+    {
+        Effect* effect = nullptr;
+        ValueMap defines;
+        size_t nextPass = 0;
+    };
+
     uint32_t getValueKey(const Value* v);
+    Program* getProgram(size_t programNameHash, const std::vector<ValueMap*>& definesList);
     
 private:
     DeviceGraphics* _device = nullptr;
@@ -96,7 +135,16 @@ private:
     const char* _lowp = "lowp";
     
     std::unordered_map<size_t, Template> _templates;
+    std::unordered_map<size_t, size_t> _instancedVariants;
+    std::unordered_map<size_t, size_t> _paletteVariants;
     std::unordered_map<uint64_t, Program*> _cache;
+    // Programs keyed by their joined preprocessed sources, different define lists may result in the same program.
+    std::unordered_map<std::string, Program*> _sourceCache;
+    std::deque<WarmUpItem> _warmUpQueue;
+    
+    // Empty if program binaries are unsupported.
+    std::string _binaryCacheDir;
+    uint64_t _driverHash = 0;
     
     Program* _current = nullptr;
 };
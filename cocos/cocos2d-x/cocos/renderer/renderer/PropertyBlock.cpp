@@ -0,0 +1,143 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "PropertyBlock.h"
+#include "gfx/DeviceGraphics.h"
+#include "gfx/Texture.h"
+
+RENDERER_BEGIN
+
+PropertyBlock::PropertyBlock(const std::unordered_map<std::string, Property>* properties)
+: _properties(properties)
+{
+}
+
+void PropertyBlock::compile(DeviceGraphics* device, Texture* defaultTexture)
+{
+    _uniformEntries.clear();
+    _textureEntries.clear();
+    _data.clear();
+    _textures.clear();
+    
+    Entry entry;
+    for (const auto& iter : *_properties)
+    {
+        const Property& prop = iter.second;
+        Property::Type propType = prop.getType();
+        if (Property::Type::UNKNOWN == propType)
+        {
+            RENDERER_LOGW("Failed to set technique property, type unknown");
+            continue;
+        }
+        
+        entry = Entry();
+        entry.slot = device->getUniformSlot(prop.getHashName());
+        
+        if (Property::Type::TEXTURE_2D == propType ||
+            Property::Type::TEXTURE_CUBE == propType)
+        {
+            // Textures without value fall back to the default texture, whatever their count.
+            entry.count = nullptr == prop.getValue() ? 1 : prop.getCount();
+            if (0 == entry.count)
+                continue;
+            
+            entry.offset = (uint32_t)_textures.size();
+            if (1 == entry.count)
+            {
+                Texture* texture = (Texture*)prop.getValue();
+                _textures.push_back(texture ? texture : defaultTexture);
+            }
+            else
+            {
+                Texture** textures = (Texture**)prop.getValue();
+                for (uint8_t i = 0; i < entry.count; ++i)
+                    _textures.push_back(textures[i] ? textures[i] : defaultTexture);
+            }
+            _textureEntries.push_back(entry);
+            continue;
+        }
+        
+        if (Property::Type::INT == propType ||
+            Property::Type::INT2 == propType ||
+            Property::Type::INT3 == propType ||
+            Property::Type::INT4 == propType)
+            entry.elementType = UniformElementType::INT;
+        else
+            entry.elementType = UniformElementType::FLOAT;
+        
+        if (prop._jsValue != nullptr)
+        {
+            entry.shared = &prop;
+            _uniformEntries.push_back(entry);
+            continue;
+        }
+        
+        // Properties without value fall back to the default value of their type.
+        Property defaultProp;
+        const Property* valueProp = &prop;
+        if (nullptr == prop.getValue())
+        {
+            defaultProp = Property(prop.getName(), propType);
+            valueProp = &defaultProp;
+        }
+        
+        entry.bytes = valueProp->getBytes();
+        entry.offset = (uint32_t)_data.size();
+        _data.resize(_data.size() + ((entry.bytes + 3) & ~3));
+        memcpy(_data.data() + entry.offset, valueProp->getValue(), entry.bytes);
+        _uniformEntries.push_back(entry);
+    }
+    
+    _device = device;
+    _defaultTexture = defaultTexture;
+    _dirty = false;
+}
+
+void PropertyBlock::commit(DeviceGraphics* device, Texture* defaultTexture, int& textureSlot)
+{
+    if (_dirty || _device != device || _defaultTexture != defaultTexture)
+        compile(device, defaultTexture);
+    
+    const uint8_t* data = _data.data();
+    for (const auto& entry : _uniformEntries)
+    {
+        if (entry.shared)
+        {
+            const void* value = entry.shared->getValue();
+            if (value)
+                device->setUniformSlot(entry.slot, value, entry.shared->getBytes(), entry.elementType);
+        }
+        else
+            device->setUniformSlot(entry.slot, data + entry.offset, entry.bytes, entry.elementType);
+    }
+    
+    Texture* const* textures = _textures.data();
+    for (const auto& entry : _textureEntries)
+    {
+        device->setTextureSlot(entry.slot, textures + entry.offset, entry.count, textureSlot);
+        textureSlot += entry.count;
+    }
+}
+
+RENDERER_END
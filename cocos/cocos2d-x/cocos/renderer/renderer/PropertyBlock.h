@@ -0,0 +1,99 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include "../Macro.h"
+#include "../Types.h"
+#include "Technique.h"
+
+RENDERER_BEGIN
+
+class DeviceGraphics;
+class Texture;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/**
+ *  @brief Uniform properties compiled into a packed block.\n
+ *  Uniform slots, element types, texture slots and values are resolved once after the properties change,
+ *  so submitting them to the device is a linear walk copying packed values.
+ */
+class PropertyBlock
+{
+public:
+    using Property = Technique::Parameter;
+    
+    /**
+     *  @brief Constructor.
+     *  @param[in] properties The properties to compile, owned by Effect or CustomProperties.
+     */
+    explicit PropertyBlock(const std::unordered_map<std::string, Property>* properties);
+    
+    /**
+     *  @brief Marks the block to be compiled again, should be called whenever the properties change.
+     */
+    inline void invalidate() { _dirty = true; }
+    /**
+     *  @brief Submits all properties to the device.
+     *  @param[in] device DeviceGraphics pointer.
+     *  @param[in] defaultTexture Texture used by texture properties without value.
+     *  @param[in,out] textureSlot The first free texture slot, advanced by the texture slots used.
+     */
+    void commit(DeviceGraphics* device, Texture* defaultTexture, int& textureSlot);
+    
+private:
+    struct Entry
+    {
+        int slot = -1;
+        UniformElementType elementType = UniformElementType::FLOAT;
+        uint16_t bytes = 0;
+        // Offset in _data for uniforms, in _textures for textures
+        uint32_t offset = 0;
+        uint8_t count = 0;
+        // Properties sharing a JS typed array are read at commit time since their values change without notice
+        const Property* shared = nullptr;
+    };
+    
+    void compile(DeviceGraphics* device, Texture* defaultTexture);
+    
+    const std::unordered_map<std::string, Property>* _properties = nullptr;
+    std::vector<Entry> _uniformEntries;
+    std::vector<Entry> _textureEntries;
+    std::vector<uint8_t> _data;
+    std::vector<Texture*> _textures;
+    DeviceGraphics* _device = nullptr;
+    Texture* _defaultTexture = nullptr;
+    bool _dirty = true;
+    
+    CC_DISALLOW_COPY_ASSIGN_AND_MOVE(PropertyBlock);
+};
+
+RENDERER_END
@@ -0,0 +1,486 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "DynamicAtlas.hpp"
+#include "../gfx/DeviceGraphics.h"
+#include "../renderer/Technique.h"
+#include "../renderer/Pass.h"
+
+#include <algorithm>
+#include <functional>
+
+RENDERER_BEGIN
+
+namespace
+{
+    // Page effect hashes are negative, the hashes computed by the engine never are.
+    const uint64_t PAGE_EFFECT_KEY_MASK = (1ull << 52) - 1;
+    
+    inline void hashCombine(uint64_t& hash, uint64_t value)
+    {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+}
+
+DynamicAtlas::DynamicAtlas(DeviceGraphics* device)
+: _device(device)
+{
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    reset();
+}
+
+void DynamicAtlas::reset()
+{
+    for (auto& page : _pages)
+    {
+        RENDERER_SAFE_RELEASE(page.texture);
+    }
+    _pages.clear();
+    _frames.clear();
+    
+    for (auto& it : _pageEffects)
+    {
+        it.second.effect->release();
+    }
+    _pageEffects.clear();
+    
+    for (auto& it : _sourceKeys)
+    {
+        it.first->release();
+    }
+    _sourceKeys.clear();
+    _sourceKeyRefs.clear();
+}
+
+void DynamicAtlas::update()
+{
+    ++_frameCount;
+    
+    // Sources only retained by the atlas can not be drawn anymore.
+    for (auto iter = _sourceKeys.begin(); iter != _sourceKeys.end();)
+    {
+        if (iter->first->getReferenceCount() == 1)
+        {
+            releaseSourceKey(iter->second.key);
+            iter->first->release();
+            iter = _sourceKeys.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+DynamicAtlas::Page* DynamicAtlas::createPage()
+{
+    Texture2D* texture = new (std::nothrow) Texture2D();
+    if (!texture)
+    {
+        return nullptr;
+    }
+    
+    Texture::Options options;
+    options.width = PAGE_SIZE;
+    options.height = PAGE_SIZE;
+    options.glInternalFormat = GL_RGBA;
+    options.glFormat = GL_RGBA;
+    options.glType = GL_UNSIGNED_BYTE;
+    options.bpp = 32;
+    options.minFilter = Texture::Filter::LINEAR;
+    options.magFilter = Texture::Filter::LINEAR;
+    options.mipFilter = Texture::Filter::NONE;
+    texture->init(_device, options);
+    
+    _pages.emplace_back();
+    Page& page = _pages.back();
+    page.texture = texture;
+    page.skyline.push_back({ 0, 0, PAGE_SIZE });
+    return &page;
+}
+
+void DynamicAtlas::clearPage(std::size_t index)
+{
+    Page& page = _pages[index];
+    for (auto key : page.keys)
+    {
+        _frames.erase(key);
+    }
+    page.keys.clear();
+    page.skyline.clear();
+    page.skyline.push_back({ 0, 0, PAGE_SIZE });
+    
+    // The page is not drawn in the current frame, models still holding its effects retain them.
+    for (auto iter = _pageEffects.begin(); iter != _pageEffects.end();)
+    {
+        if (iter->second.page == index)
+        {
+            iter->second.effect->release();
+            iter = _pageEffects.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void DynamicAtlas::releaseSourceKey(uint64_t key)
+{
+    if (key == 0)
+    {
+        return;
+    }
+    
+    auto refIter = _sourceKeyRefs.find(key);
+    if (refIter == _sourceKeyRefs.end() || --refIter->second > 0)
+    {
+        return;
+    }
+    _sourceKeyRefs.erase(refIter);
+    
+    // No source resolves to the key anymore, its page effects can not be looked up again.
+    for (auto iter = _pageEffects.begin(); iter != _pageEffects.end();)
+    {
+        if (iter->second.sourceKey == key)
+        {
+            iter->second.effect->release();
+            iter = _pageEffects.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+bool DynamicAtlas::allocate(Page& page, uint16_t width, uint16_t height, uint16_t& x, uint16_t& y)
+{
+    auto& skyline = page.skyline;
+    std::size_t best = SIZE_MAX;
+    uint16_t bestY = PAGE_SIZE;
+    uint16_t bestWidth = PAGE_SIZE;
+    
+    // Bottom left rule, the rectangle rests on the highest segment below it.
+    for (std::size_t i = 0, len = skyline.size(); i < len; ++i)
+    {
+        if (skyline[i].x + width > PAGE_SIZE)
+        {
+            break;
+        }
+        
+        uint16_t top = 0;
+        int remaining = width;
+        for (std::size_t j = i; remaining > 0; ++j)
+        {
+            top = std::max(top, skyline[j].y);
+            remaining -= skyline[j].width;
+        }
+        
+        if (top + height > PAGE_SIZE)
+        {
+            continue;
+        }
+        
+        if (top < bestY || (top == bestY && skyline[i].width < bestWidth))
+        {
+            best = i;
+            bestY = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+    
+    if (best == SIZE_MAX)
+    {
+        return false;
+    }
+    
+    x = skyline[best].x;
+    y = bestY;
+    
+    // Raise the skyline under the rectangle and cut the segments it covers.
+    skyline.insert(skyline.begin() + best, { x, (uint16_t)(y + height), width });
+    for (std::size_t i = best + 1; i < skyline.size();)
+    {
+        const Segment& prev = skyline[i - 1];
+        Segment& cur = skyline[i];
+        uint16_t prevRight = prev.x + prev.width;
+        if (cur.x >= prevRight)
+        {
+            break;
+        }
+        
+        uint16_t shrink = prevRight - cur.x;
+        if (cur.width <= shrink)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        
+        cur.x += shrink;
+        cur.width -= shrink;
+        break;
+    }
+    
+    for (std::size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return true;
+}
+
+bool DynamicAtlas::insert(uint32_t key, uint16_t width, uint16_t height, const uint8_t* data, bool premultiplyAlpha)
+{
+    if (key == 0 || !data || width == 0 || height == 0 || width > MAX_FRAME_SIZE || height > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+    
+    remove(key);
+    
+    uint16_t paddedWidth = width + PADDING * 2;
+    uint16_t paddedHeight = height + PADDING * 2;
+    uint16_t x = 0, y = 0;
+    std::size_t index = 0, count = _pages.size();
+    for (; index < count; ++index)
+    {
+        if (allocate(_pages[index], paddedWidth, paddedHeight, x, y))
+        {
+            break;
+        }
+    }
+    
+    if (index == count && count < _maxPages)
+    {
+        Page* page = createPage();
+        if (!page || !allocate(*page, paddedWidth, paddedHeight, x, y))
+        {
+            return false;
+        }
+    }
+    else if (index == count)
+    {
+        // Recycle the least recently used page, pages drawn in the current frame are kept.
+        std::size_t lru = SIZE_MAX;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (_pages[i].lastUsed < _frameCount && (lru == SIZE_MAX || _pages[i].lastUsed < _pages[lru].lastUsed))
+            {
+                lru = i;
+            }
+        }
+        if (lru == SIZE_MAX)
+        {
+            return false;
+        }
+        
+        index = lru;
+        clearPage(index);
+        if (!allocate(_pages[index], paddedWidth, paddedHeight, x, y))
+        {
+            return false;
+        }
+    }
+    
+    // Extrude the edge pixels into the padding.
+    const std::size_t bytesPerRow = width * 4;
+    const std::size_t paddedBytesPerRow = paddedWidth * 4;
+    _padded.resize(paddedBytesPerRow * paddedHeight);
+    for (uint16_t row = 0; row < paddedHeight; ++row)
+    {
+        int srcRow = std::min(std::max(row - (int)PADDING, 0), (int)height - 1);
+        const uint8_t* src = data + srcRow * bytesPerRow;
+        uint8_t* dst = _padded.data() + row * paddedBytesPerRow;
+        for (uint16_t i = 0; i < PADDING; ++i)
+        {
+            memcpy(dst + i * 4, src, 4);
+            memcpy(dst + (PADDING + width + i) * 4, src + bytesPerRow - 4, 4);
+        }
+        memcpy(dst + PADDING * 4, src, bytesPerRow);
+    }
+    
+    Page& page = _pages[index];
+    Texture::SubImageOption option(x, y, paddedWidth, paddedHeight, 0, false, premultiplyAlpha);
+    option.imageData = _padded.data();
+    option.imageDataLength = (uint32_t)_padded.size();
+    page.texture->updateSubImage(option);
+    page.keys.push_back(key);
+    page.lastUsed = _frameCount;
+    
+    Frame& frame = _frames[key];
+    frame.page = (uint32_t)index;
+    frame.uvRect[0] = (float)(x + PADDING) / PAGE_SIZE;
+    frame.uvRect[1] = (float)(y + PADDING) / PAGE_SIZE;
+    frame.uvRect[2] = (float)width / PAGE_SIZE;
+    frame.uvRect[3] = (float)height / PAGE_SIZE;
+    return true;
+}
+
+void DynamicAtlas::remove(uint32_t key)
+{
+    auto iter = _frames.find(key);
+    if (iter == _frames.end())
+    {
+        return;
+    }
+    
+    auto& keys = _pages[iter->second.page].keys;
+    keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+    _frames.erase(iter);
+}
+
+const DynamicAtlas::Frame* DynamicAtlas::getFrame(uint32_t key)
+{
+    auto iter = _frames.find(key);
+    if (iter == _frames.end())
+    {
+        return nullptr;
+    }
+    
+    _pages[iter->second.page].lastUsed = _frameCount;
+    return &iter->second;
+}
+
+uint64_t DynamicAtlas::getSourceKey(Effect* source)
+{
+    auto iter = _sourceKeys.find(source);
+    if (iter != _sourceKeys.end() && iter->second.hash == source->getHash())
+    {
+        return iter->second.key;
+    }
+    
+    // Everything but the texture decides whether two effects may share a page effect.
+    uint64_t key = std::hash<std::string>{}(source->getDefinesKey());
+    for (const auto& tech : source->getTechniques())
+    {
+        hashCombine(key, tech->getStageIDs());
+        hashCombine(key, tech->getLayer());
+        for (const auto& pass : tech->getPasses())
+        {
+            hashCombine(key, pass->getStateHash());
+        }
+    }
+    
+    // Properties are hashed independently of their order.
+    uint64_t props = 0;
+    int textureCount = 0;
+    for (const auto& it : source->getProperties())
+    {
+        const Effect::Property& prop = it.second;
+        if (prop.getType() == Effect::Property::Type::TEXTURE_2D)
+        {
+            ++textureCount;
+            continue;
+        }
+        
+        uint64_t propHash = prop.getHashName();
+        hashCombine(propHash, (uint64_t)prop.getType());
+        if (prop.getValue())
+        {
+            hashCombine(propHash, std::hash<std::string>{}(std::string((const char*)prop.getValue(), prop.getBytes())));
+        }
+        props += propHash;
+    }
+    hashCombine(key, props);
+    
+    // Only effects sampling a single 2D texture can be redirected to a page.
+    if (textureCount != 1)
+    {
+        key = 0;
+    }
+    
+    if (iter == _sourceKeys.end())
+    {
+        source->retain();
+        iter = _sourceKeys.emplace(source, SourceKey()).first;
+    }
+    else
+    {
+        releaseSourceKey(iter->second.key);
+    }
+    if (key != 0)
+    {
+        ++_sourceKeyRefs[key];
+    }
+    iter->second.hash = source->getHash();
+    iter->second.key = key;
+    return key;
+}
+
+Effect* DynamicAtlas::getPageEffect(Effect* source, uint32_t page)
+{
+    if (!source || page >= _pages.size())
+    {
+        return nullptr;
+    }
+    
+    uint64_t sourceKey = getSourceKey(source);
+    if (sourceKey == 0)
+    {
+        return nullptr;
+    }
+    
+    uint64_t key = sourceKey;
+    hashCombine(key, page);
+    key &= PAGE_EFFECT_KEY_MASK;
+    auto iter = _pageEffects.find(key);
+    if (iter != _pageEffects.end())
+    {
+        return iter->second.effect;
+    }
+    
+    Effect* effect = new (std::nothrow) Effect();
+    if (!effect)
+    {
+        return nullptr;
+    }
+    
+    effect->copy(source);
+    for (const auto& it : source->getProperties())
+    {
+        if (it.second.getType() == Effect::Property::Type::TEXTURE_2D)
+        {
+            effect->setProperty(it.first, Effect::Property(it.first, Effect::Property::Type::TEXTURE_2D, _pages[page].texture));
+        }
+    }
+    effect->updateHash(-(double)(key + 1));
+    PageEffect& pageEffect = _pageEffects[key];
+    pageEffect.effect = effect;
+    pageEffect.sourceKey = sourceKey;
+    pageEffect.page = page;
+    return effect;
+}
+
+RENDERER_END
@@ -0,0 +1,176 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+
+#include "../Macro.h"
+#include "../gfx/Texture2D.h"
+#include "../renderer/Effect.h"
+
+RENDERER_BEGIN
+
+class DeviceGraphics;
+
+/**
+ * @addtogroup scene
+ * @{
+ */
+
+/**
+ *  @brief Packs small RGBA8 textures into shared pages, so sprites using different textures can be drawn in one batch.\n
+ *  Frames are placed with a skyline allocator, pages are reused by least recent use once the page limit is reached.
+ *  Assemblers refer to a frame by the key it is inserted with, see Assembler::setAtlasKey.\n
+ *  JS API: renderer.RenderFlow.insertAtlasFrame, renderer.RenderFlow.removeAtlasFrame
+ */
+class DynamicAtlas
+{
+public:
+    /**
+     *  @brief Location of an inserted texture.
+     */
+    struct Frame
+    {
+        /** index of the page which holds the frame */
+        uint32_t page = 0;
+        /** left, top, width and height of the frame in page texture coordinates */
+        float uvRect[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        
+        bool operator==(const Frame& o) const
+        {
+            return page == o.page && memcmp(uvRect, o.uvRect, sizeof(uvRect)) == 0;
+        }
+        bool operator!=(const Frame& o) const { return !(*this == o); }
+    };
+    
+    /** Width and height of a page */
+    static const uint16_t PAGE_SIZE = 2048;
+    /** Textures larger than this in any dimension are not packed */
+    static const uint16_t MAX_FRAME_SIZE = 512;
+    /** Edge pixels extruded around every frame, keeps linear filtering from sampling neighbours */
+    static const uint16_t PADDING = 1;
+    
+    /**
+     *  @brief Constructor
+     *  @param[in] device The device used to create page textures
+     */
+    DynamicAtlas(DeviceGraphics* device);
+    /**
+     *  @brief Destructor
+     */
+    ~DynamicAtlas();
+    
+    /**
+     *  @brief Inserts an RGBA8 image, the image is copied and may be released afterwards.
+     *  @param[in] key Non-zero key identifying the image, an existing frame of the key is replaced
+     *  @param[in] width Width of the image
+     *  @param[in] height Height of the image
+     *  @param[in] data Pixels of the image, rows in the same order as the source texture
+     *  @param[in] premultiplyAlpha Whether to premultiply alpha while uploading
+     *  @return false if the image is too large or no page could be made available.
+     */
+    bool insert(uint32_t key, uint16_t width, uint16_t height, const uint8_t* data, bool premultiplyAlpha);
+    /**
+     *  @brief Removes the frame of the given key, the space is reclaimed when its page is recycled.
+     */
+    void remove(uint32_t key);
+    /**
+     *  @brief Gets the frame of the given key and marks its page as used in the current frame.
+     *  @return nullptr if the key is not resident.
+     */
+    const Frame* getFrame(uint32_t key);
+    /**
+     *  @brief Gets the effect which samples the given page and keeps every other state of the source effect.
+     *  Source effects which only differ in their textures share the same page effect, hence the same batch.
+     */
+    Effect* getPageEffect(Effect* source, uint32_t page);
+    /**
+     *  @brief Advances the frame counter used for least recent use and releases source effects no longer referenced elsewhere, invoked once per rendered frame.
+     */
+    void update();
+    /**
+     *  @brief Releases all pages and frames.
+     */
+    void reset();
+    /**
+     *  @brief Sets the maximum page count, existing pages above the limit are kept until reset.
+     */
+    void setMaxPages(uint32_t count) { _maxPages = count; }
+    /**
+     *  @brief Gets the page count.
+     */
+    std::size_t getPageCount() const { return _pages.size(); }
+private:
+    struct Segment
+    {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+    };
+    
+    struct Page
+    {
+        Texture2D* texture = nullptr;
+        std::vector<Segment> skyline;
+        std::vector<uint32_t> keys;
+        uint32_t lastUsed = 0;
+    };
+    
+    struct SourceKey
+    {
+        double hash = 0;
+        uint64_t key = 0;
+    };
+    
+    struct PageEffect
+    {
+        Effect* effect = nullptr;
+        uint64_t sourceKey = 0;
+        uint32_t page = 0;
+    };
+    
+    Page* createPage();
+    void clearPage(std::size_t index);
+    bool allocate(Page& page, uint16_t width, uint16_t height, uint16_t& x, uint16_t& y);
+    uint64_t getSourceKey(Effect* source);
+    void releaseSourceKey(uint64_t key);
+    
+    DeviceGraphics* _device = nullptr;
+    std::vector<Page> _pages;
+    std::unordered_map<uint32_t, Frame> _frames;
+    std::unordered_map<Effect*, SourceKey> _sourceKeys;
+    // Number of source effects resolving to each non-zero source key.
+    std::unordered_map<uint64_t, uint32_t> _sourceKeyRefs;
+    std::unordered_map<uint64_t, PageEffect> _pageEffects;
+    std::vector<uint8_t> _padded;
+    uint32_t _frameCount = 1;
+    uint32_t _maxPages = 4;
+};
+
+
+RENDERER_END
@@ -0,0 +1,236 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "InstanceBuffer.hpp"
+#include "../Types.h"
+#include "ModelBatcher.hpp"
+#include "RenderFlow.hpp"
+#include "../gfx/DeviceGraphics.h"
+#include "../renderer/ProgramLib.h"
+
+RENDERER_BEGIN
+
+namespace
+{
+    const char* INSTANCED_PROGRAM_NAME = "builtin-2d-sprite-instanced";
+    const char* SPRITE_PROGRAM_NAME = "builtin-2d-sprite|vs|fs";
+    
+    const char* INSTANCED_SPRITE_VERT = R"(
+precision highp float;
+uniform mat4 cc_matViewProj;
+
+attribute vec2 a_position;
+attribute vec4 a_matrix;
+attribute vec4 a_translateUv;
+attribute vec4 a_color;
+varying vec4 v_color;
+
+#if USE_TEXTURE
+attribute vec4 a_uvAxes;
+varying vec2 v_uv0;
+#endif
+
+void main () {
+  vec2 pos = a_matrix.xy * a_position.x + a_matrix.zw * a_position.y + a_translateUv.xy;
+
+  #if USE_TEXTURE
+  v_uv0 = a_translateUv.zw + a_uvAxes.xy * a_position.x + a_uvAxes.zw * a_position.y;
+  #endif
+
+  v_color = a_color;
+
+  gl_Position = cc_matViewProj * vec4(pos, 0, 1);
+}
+)";
+    
+    // Same as the fragment shader of builtin-2d-sprite.
+    const char* INSTANCED_SPRITE_FRAG = R"(
+precision highp float;
+
+#if USE_ALPHA_TEST
+  uniform float alphaThreshold;
+#endif
+
+void ALPHA_TEST (in vec4 color) {
+  #if USE_ALPHA_TEST
+      if (color.a < alphaThreshold) discard;
+  #endif
+}
+
+void ALPHA_TEST (in float alpha) {
+  #if USE_ALPHA_TEST
+      if (alpha < alphaThreshold) discard;
+  #endif
+}
+
+varying vec4 v_color;
+
+#if USE_TEXTURE
+varying vec2 v_uv0;
+uniform sampler2D texture;
+#endif
+
+void main () {
+  vec4 o = vec4(1, 1, 1, 1);
+
+  #if USE_TEXTURE
+  o *= texture2D(texture, v_uv0);
+    #if CC_USE_ALPHA_ATLAS_TEXTURE
+    o.a *= texture2D(texture, v_uv0 + vec2(0, 0.5)).r;
+    #endif
+  #endif
+
+  o *= v_color;
+
+  ALPHA_TEST(o);
+
+  gl_FragColor = o;
+}
+)";
+    
+    const float QUAD_VERTICES[] = {
+        0, 0,
+        1, 0,
+        0, 1,
+        1, 1
+    };
+    const uint16_t QUAD_INDICES[] = {
+        0, 1, 2, 1, 3, 2
+    };
+}
+
+InstanceBuffer::InstanceBuffer(ModelBatcher* batcher)
+: _batcher(batcher)
+{
+    _vertexFmt = new VertexFormat(std::vector<VertexFormat::Info>({
+        VertexFormat::Info("a_matrix", AttribType::FLOAT32, 4),
+        VertexFormat::Info("a_translateUv", AttribType::FLOAT32, 4),
+        VertexFormat::Info("a_uvAxes", AttribType::FLOAT32, 4),
+        VertexFormat::Info(ATTRIB_NAME_COLOR, AttribType::UINT8, 4, true)
+    }));
+    _vertexFmt->setInstanced(true);
+    _quadFmt = new VertexFormat(std::vector<VertexFormat::Info>({
+        VertexFormat::Info(ATTRIB_NAME_POSITION, AttribType::FLOAT32, 2)
+    }));
+    
+    DeviceGraphics* device = _batcher->getFlow()->getDevice();
+    _quadVB = VertexBuffer::create(device, _quadFmt, Usage::STATIC, QUAD_VERTICES, sizeof(QUAD_VERTICES), 4);
+    _quadVB->retain();
+    _quadIB = IndexBuffer::create(device, IndexFormat::UINT16, Usage::STATIC, QUAD_INDICES, sizeof(QUAD_INDICES), QUAD_INDEX_COUNT);
+    _quadIB->retain();
+    
+    _dataCount = INIT_INSTANCE_COUNT;
+    reallocData(0);
+    
+    _mapRange = device->isMapBufferRangeSupported();
+    for (uint8_t ringPos = 0; ringPos < RING_SIZE; ringPos++)
+    {
+        _vbArr[ringPos] = VertexBuffer::create(device, _vertexFmt, Usage::DYNAMIC, nullptr, 0, 0);
+        _vbArr[ringPos]->retain();
+    }
+    _vb = _vbArr[0];
+    _vb->setBytes(_dataCount * sizeof(Record));
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+    for (uint8_t ringPos = 0; ringPos < RING_SIZE; ringPos++)
+    {
+        _vbArr[ringPos]->destroy();
+        _vbArr[ringPos]->release();
+        _vbArr[ringPos] = nullptr;
+    }
+    _vb = nullptr;
+    
+    _quadVB->destroy();
+    CC_SAFE_RELEASE_NULL(_quadVB);
+    _quadIB->destroy();
+    CC_SAFE_RELEASE_NULL(_quadIB);
+    
+    CC_SAFE_RELEASE_NULL(_vertexFmt);
+    CC_SAFE_RELEASE_NULL(_quadFmt);
+    
+    if (_data)
+    {
+        delete[] _data;
+        _data = nullptr;
+    }
+}
+
+void InstanceBuffer::reallocData(uint32_t count)
+{
+    auto oldData = _data;
+    _data = new Record[_dataCount];
+    if (oldData)
+    {
+        memcpy(_data, oldData, sizeof(Record) * count);
+        delete[] oldData;
+        oldData = nullptr;
+    }
+    if (_vb)
+    {
+        _vb->setBytes(_dataCount * sizeof(Record));
+    }
+}
+
+InstanceBuffer::Record* InstanceBuffer::request(uint32_t count)
+{
+    uint32_t offset = _instanceOffset + count;
+    if (offset > _dataCount)
+    {
+        while (_dataCount < offset)
+        {
+            _dataCount *= 2;
+        }
+        reallocData(_instanceOffset);
+    }
+    
+    Record* record = _data + _instanceOffset;
+    _instanceOffset = offset;
+    return record;
+}
+
+void InstanceBuffer::uploadData()
+{
+    _vb->replace(_data, _instanceOffset * sizeof(Record), _mapRange);
+}
+
+void InstanceBuffer::reset()
+{
+    _ringPos = (_ringPos + 1) % RING_SIZE;
+    _vb = _vbArr[_ringPos];
+    // The storage may have grown since this buffer was used last time.
+    _vb->setBytes(_dataCount * sizeof(Record));
+    _instanceStart = 0;
+    _instanceOffset = 0;
+}
+
+void InstanceBuffer::defineProgram(ProgramLib* programLib)
+{
+    ValueVector defines;
+    programLib->define(INSTANCED_PROGRAM_NAME, INSTANCED_SPRITE_VERT, INSTANCED_SPRITE_FRAG, defines);
+    programLib->setInstancedVariant(SPRITE_PROGRAM_NAME, INSTANCED_PROGRAM_NAME);
+}
+
+RENDERER_END
@@ -0,0 +1,147 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../Macro.h"
+#include "../gfx/VertexFormat.h"
+#include "../gfx/VertexBuffer.h"
+#include "../gfx/IndexBuffer.h"
+
+RENDERER_BEGIN
+
+class ModelBatcher;
+class ProgramLib;
+
+/**
+ * @addtogroup scene
+ * @{
+ */
+
+/**
+ *  @brief The buffer which stores per instance datas of quads drawn with instanced arrays.
+ *  Every instance is a unit quad transformed by its own matrix, so a sprite writes one record instead of four vertices and six indices.
+ */
+class InstanceBuffer
+{
+public:
+    /**
+     *  @brief Layout of a record, all values are in world space.
+     */
+    struct Record
+    {
+        /** x and y axes of the quad, scaled by its size */
+        float matrix[4];
+        /** origin of the quad followed by the uv of its origin */
+        float translateUv[4];
+        /** uv deltas along the x and y axes */
+        float uvAxes[4];
+        /** RGBA color packed in 4 bytes */
+        uint32_t color;
+    };
+    
+    /**
+     *  @brief Constructor
+     *  @param[in] batcher The ModelBatcher which creates the current buffer
+     */
+    InstanceBuffer(ModelBatcher* batcher);
+    /**
+     *  @brief Destructor
+     */
+    ~InstanceBuffer();
+    
+    /**
+     *  @brief Requests records for the given count of instances
+     *  @param[in] count Requested count of instances
+     *  @return The first requested record.
+     */
+    Record* request(uint32_t count);
+    
+    /**
+     *  @brief Upload data to GPU memory
+     */
+    void uploadData();
+    /**
+     *  @brief Reset all states and switches to the GL buffer of the next frame in the ring.
+     */
+    void reset();
+    
+    /**
+     *  @brief Gets the current instance start offset since last time updateOffset is invoked
+     */
+    uint32_t getInstanceStart() const { return _instanceStart; };
+    /**
+     *  @brief Gets the current instance offset, which should equals to total allocated instance count.
+     */
+    uint32_t getInstanceOffset() const { return _instanceOffset; };
+    /**
+     *  @brief Update the current allocated offset to the start offset.
+     */
+    void updateOffset() { _instanceStart = _instanceOffset; };
+    
+    /**
+     *  @brief Gets the vertex buffer of per instance datas.
+     */
+    VertexBuffer* getVertexBuffer() const { return _vb; };
+    /**
+     *  @brief Gets the vertex buffer of the unit quad shared by all instances.
+     */
+    VertexBuffer* getQuadVertexBuffer() const { return _quadVB; };
+    /**
+     *  @brief Gets the index buffer of the unit quad shared by all instances.
+     */
+    IndexBuffer* getQuadIndexBuffer() const { return _quadIB; };
+    
+    /**
+     *  @brief Defines the instanced variant of the builtin sprite program.
+     */
+    static void defineProgram(ProgramLib* programLib);
+    
+    static const int INIT_INSTANCE_COUNT = 1024;
+    static const int QUAD_INDEX_COUNT = 6;
+    static const uint8_t RING_SIZE = 3;
+private:
+    void reallocData(uint32_t count);
+    
+    uint32_t _instanceStart = 0;
+    uint32_t _instanceOffset = 0;
+    uint32_t _dataCount = 0;
+    bool _mapRange = false;
+    
+    Record* _data = nullptr;
+    
+    ModelBatcher* _batcher = nullptr;
+    VertexFormat* _vertexFmt = nullptr;
+    VertexFormat* _quadFmt = nullptr;
+    uint8_t _ringPos = 0;
+    VertexBuffer* _vbArr[RING_SIZE] = {};
+    VertexBuffer* _vb = nullptr;
+    VertexBuffer* _quadVB = nullptr;
+    IndexBuffer* _quadIB = nullptr;
+};
+
+
+RENDERER_END
@@ -0,0 +1,194 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "MatrixPalette.hpp"
+#include "../Types.h"
+#include "NodeProxy.hpp"
+#include "../renderer/ProgramLib.h"
+
+RENDERER_BEGIN
+
+namespace
+{
+    const char* PALETTE_PROGRAM_NAME = "builtin-2d-sprite-palette";
+    const char* SPRITE_PROGRAM_NAME = "builtin-2d-sprite|vs|fs";
+    const char* ATTRIB_NAME_NODE = "a_node";
+    
+    const char* PALETTE_SPRITE_VERT = R"(
+precision highp float;
+uniform mat4 cc_matViewProj;
+uniform vec4 cc_nodePalette[64];
+
+attribute vec3 a_position;
+attribute vec4 a_color;
+attribute float a_node;
+varying vec4 v_color;
+
+#if USE_TEXTURE
+attribute vec2 a_uv0;
+varying vec2 v_uv0;
+#endif
+
+void main () {
+  int slot = int(a_node + 0.5) * 2;
+  vec3 local = vec3(a_position.xy, 1);
+  vec2 pos = vec2(dot(cc_nodePalette[slot].xyz, local), dot(cc_nodePalette[slot + 1].xyz, local));
+
+  #if USE_TEXTURE
+  v_uv0 = a_uv0;
+  #endif
+
+  v_color = a_color;
+
+  gl_Position = cc_matViewProj * vec4(pos, 0, 1);
+}
+)";
+    
+    // Same as the fragment shader of builtin-2d-sprite.
+    const char* PALETTE_SPRITE_FRAG = R"(
+precision highp float;
+
+#if USE_ALPHA_TEST
+  uniform float alphaThreshold;
+#endif
+
+void ALPHA_TEST (in vec4 color) {
+  #if USE_ALPHA_TEST
+      if (color.a < alphaThreshold) discard;
+  #endif
+}
+
+void ALPHA_TEST (in float alpha) {
+  #if USE_ALPHA_TEST
+      if (alpha < alphaThreshold) discard;
+  #endif
+}
+
+varying vec4 v_color;
+
+#if USE_TEXTURE
+varying vec2 v_uv0;
+uniform sampler2D texture;
+#endif
+
+void main () {
+  vec4 o = vec4(1, 1, 1, 1);
+
+  #if USE_TEXTURE
+  o *= texture2D(texture, v_uv0);
+    #if CC_USE_ALPHA_ATLAS_TEXTURE
+    o.a *= texture2D(texture, v_uv0 + vec2(0, 0.5)).r;
+    #endif
+  #endif
+
+  o *= v_color;
+
+  ALPHA_TEST(o);
+
+  gl_FragColor = o;
+}
+)";
+}
+
+MatrixPalette::MatrixPalette()
+{
+    memset(_data, 0, sizeof(_data));
+}
+
+MatrixPalette::~MatrixPalette()
+{
+    for (auto& iter : _formats)
+    {
+        iter.first->release();
+        iter.second->release();
+    }
+    _formats.clear();
+}
+
+int MatrixPalette::addNode(NodeProxy* node)
+{
+    // Render datas of a node are committed one after another, they share its slot.
+    if (_lastNode == node && _count > 0)
+    {
+        return (int)_count - 1;
+    }
+    if (_count >= PALETTE_SIZE)
+    {
+        return -1;
+    }
+    
+    const float* m = node->getWorldMatrix().m;
+    float* row = _data + _count * FLOATS_PER_MATRIX;
+    row[0] = m[0];
+    row[1] = m[4];
+    row[2] = m[12];
+    row[3] = 0;
+    row[4] = m[1];
+    row[5] = m[5];
+    row[6] = m[13];
+    row[7] = 0;
+    
+    _lastNode = node;
+    return (int)_count++;
+}
+
+void MatrixPalette::reset()
+{
+    _count = 0;
+    _lastNode = nullptr;
+}
+
+VertexFormat* MatrixPalette::getVertexFormat(VertexFormat* fmt)
+{
+    auto iter = _formats.find(fmt);
+    if (iter != _formats.end())
+    {
+        return iter->second;
+    }
+    
+    std::vector<VertexFormat::Info> infos;
+    for (const auto& name : fmt->getAttributeNames())
+    {
+        const VertexFormat::Element* element = fmt->getElement(name);
+        infos.emplace_back(element->name, element->type, element->num, element->normalize);
+    }
+    infos.emplace_back(ATTRIB_NAME_NODE, AttribType::FLOAT32, 1);
+    
+    VertexFormat* paletteFmt = new VertexFormat(infos);
+    // Keeps the source alive so that its address can't be reused by another format.
+    fmt->retain();
+    _formats.emplace(fmt, paletteFmt);
+    return paletteFmt;
+}
+
+void MatrixPalette::defineProgram(ProgramLib* programLib)
+{
+    ValueVector defines;
+    programLib->define(PALETTE_PROGRAM_NAME, PALETTE_SPRITE_VERT, PALETTE_SPRITE_FRAG, defines);
+    programLib->setPaletteVariant(SPRITE_PROGRAM_NAME, PALETTE_PROGRAM_NAME);
+}
+
+RENDERER_END
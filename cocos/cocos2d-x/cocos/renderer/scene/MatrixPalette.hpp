@@ -0,0 +1,103 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include "../Macro.h"
+#include "../gfx/VertexFormat.h"
+
+RENDERER_BEGIN
+
+class NodeProxy;
+class ProgramLib;
+
+/**
+ * @addtogroup scene
+ * @{
+ */
+
+/**
+ *  @brief The world matrices of the nodes drawn by palette batches.
+ *  Vertices of a palette batch stay in local space and carry the slot of their node, the vertex shader transforms them by the matrix in that slot.
+ *  Moving a node only changes its matrix, so its vertices can be kept in the mesh buffer.
+ */
+class MatrixPalette
+{
+public:
+    /**
+     *  @brief Constructor
+     */
+    MatrixPalette();
+    /**
+     *  @brief Destructor
+     */
+    ~MatrixPalette();
+    
+    /**
+     *  @brief Stores the world matrix of a node in the palette.
+     *  @param[in] node The node whose vertices are filled next
+     *  @return The slot of the node, -1 if the palette is full.
+     */
+    int addNode(NodeProxy* node);
+    /**
+     *  @brief Removes all matrices, slots are given out from 0 again.
+     */
+    void reset();
+    
+    /**
+     *  @brief Gets the matrix data, every slot stores the first two rows of a 2D affine transform.
+     */
+    const float* getData() const { return _data; };
+    /**
+     *  @brief Gets the count of used slots.
+     */
+    uint32_t getCount() const { return _count; };
+    
+    /**
+     *  @brief Gets the vertex format of palette batches for the given vertex format, which is followed by the node slot.
+     *  @param[in] fmt The vertex format of the render data
+     */
+    VertexFormat* getVertexFormat(VertexFormat* fmt);
+    
+    /**
+     *  @brief Defines the palette variant of the builtin sprite program.
+     */
+    static void defineProgram(ProgramLib* programLib);
+    
+    static const uint32_t PALETTE_SIZE = 32;
+    static const uint32_t FLOATS_PER_MATRIX = 8;
+    static const uint32_t PALETTE_FLOATS = PALETTE_SIZE * FLOATS_PER_MATRIX;
+private:
+    float _data[PALETTE_FLOATS];
+    uint32_t _count = 0;
+    NodeProxy* _lastNode = nullptr;
+    
+    std::unordered_map<VertexFormat*, VertexFormat*> _formats;
+};
+
+
+RENDERER_END
@@ -38,30 +38,35 @@ MeshBuffer::MeshBuffer(ModelBatcher* batcher, VertexFormat* fmt)
 {
     _bytesPerVertex = _vertexFmt->getBytes();
     
-    DeviceGraphics* device = _batcher->getFlow()->getDevice();
-    _vb = VertexBuffer::create(device, _vertexFmt, Usage::DYNAMIC, nullptr, 0, 0);
-    _vbArr.pushBack(_vb);
-    
-    _ib = IndexBuffer::create(device, IndexFormat::UINT16, Usage::STATIC, nullptr, 0, 0);
-    _ib->retain();
-    
     _vDataCount = MeshBuffer::INIT_VERTEX_COUNT * 4 * _bytesPerVertex / sizeof(float);
     _iDataCount = MeshBuffer::INIT_VERTEX_COUNT * 6;
     
     reallocVBuffer();
     reallocIBuffer();
+    
+    setUploadMode(UploadMode::MAP_RANGE);
+    switchRing(0);
 }
 
 MeshBuffer::~MeshBuffer()
 {
-    for (std::size_t i = 0, n = _vbArr.size(); i < n; i++)
+    for (uint8_t ringPos = 0; ringPos < RING_SIZE; ringPos++)
     {
-         _vbArr.at(i)->destroy();
+        auto& vbArr = _vbArr[ringPos];
+        for (std::size_t i = 0, n = vbArr.size(); i < n; i++)
+        {
+            vbArr.at(i)->destroy();
+        }
+        vbArr.clear();
+        
+        auto ib = _ibArr[ringPos];
+        if (ib)
+        {
+            ib->destroy();
+            ib->release();
+            _ibArr[ringPos] = nullptr;
+        }
     }
-    _vbArr.clear();
-    
-    _ib->destroy();
-    _ib->release();
     
     if (iData)
     {
@@ -86,7 +91,10 @@ void MeshBuffer::reallocVBuffer()
         delete[] oldVData;
         oldVData = nullptr;
     }
-    _vb->setBytes(_vDataCount * VDATA_BYTE);
+    if (_vb)
+    {
+        _vb->setBytes(_vDataCount * VDATA_BYTE);
+    }
 }
 
 void MeshBuffer::reallocIBuffer()
@@ -99,9 +107,46 @@ void MeshBuffer::reallocIBuffer()
         delete[] oldIData;
         oldIData = nullptr;
     }
+    if (_ib)
+    {
+        _ib->setBytes(_iDataCount * IDATA_BYTE);
+    }
+}
+
+void MeshBuffer::switchRing(uint8_t ringPos)
+{
+    _ringPos = ringPos;
+    _vbPos = 0;
+    
+    DeviceGraphics* device = _batcher->getFlow()->getDevice();
+    auto& vbArr = _vbArr[_ringPos];
+    if (vbArr.empty())
+    {
+        vbArr.pushBack(VertexBuffer::create(device, _vertexFmt, Usage::DYNAMIC, nullptr, 0, 0));
+    }
+    if (!_ibArr[_ringPos])
+    {
+        _ibArr[_ringPos] = IndexBuffer::create(device, IndexFormat::UINT16, Usage::STATIC, nullptr, 0, 0);
+        _ibArr[_ringPos]->retain();
+    }
+    
+    // The storage may have grown since these buffers were used last time.
+    _vb = vbArr.at(0);
+    _vb->setBytes(_vDataCount * VDATA_BYTE);
+    _ib = _ibArr[_ringPos];
     _ib->setBytes(_iDataCount * IDATA_BYTE);
 }
 
+void MeshBuffer::setUploadMode(UploadMode mode)
+{
+    DeviceGraphics* device = _batcher->getFlow()->getDevice();
+    if (mode == UploadMode::MAP_RANGE && !device->isMapBufferRangeSupported())
+    {
+        mode = UploadMode::ORPHAN;
+    }
+    _uploadMode = mode;
+}
+
 const MeshBuffer::OffsetInfo& MeshBuffer::request(uint32_t vertexCount, uint32_t indexCount)
 {
     if (_batcher->getCurrentBuffer() != this)
@@ -121,20 +166,22 @@ const MeshBuffer::OffsetInfo& MeshBuffer::requestStatic(uint32_t vertexCount, ui
     if (MAX_VB_SIZE < byteOffset)
     {
         _batcher->flush();
-        _vb->update(0, vData, _byteOffset);
+        _epoch++;
+        _vb->replace(vData, _byteOffset, _uploadMode == UploadMode::MAP_RANGE);
         
+        auto& vbArr = _vbArr[_ringPos];
         _vbPos++;
-        if (_vbPos >= _vbArr.size())
+        if (_vbPos >= vbArr.size())
         {
             DeviceGraphics* device = _batcher->getFlow()->getDevice();
             _vb = VertexBuffer::create(device, _vertexFmt, Usage::DYNAMIC, nullptr, 0, 0);
-            _vb->setBytes(_vDataCount * VDATA_BYTE);
-            _vbArr.pushBack(_vb);
+            vbArr.pushBack(_vb);
         }
         else
         {
-            _vb = _vbArr.at(_vbPos);
+            _vb = vbArr.at(_vbPos);
         }
+        _vb->setBytes(_vDataCount * VDATA_BYTE);
         
         _byteStart = 0;
         _byteOffset = 0;
@@ -182,17 +229,38 @@ const MeshBuffer::OffsetInfo& MeshBuffer::requestStatic(uint32_t vertexCount, ui
     return _offsetInfo;
 }
 
+bool MeshBuffer::retainRange(FillRecord& record, const OffsetInfo& offset)
+{
+    bool retained = record.buffer == this &&
+                    record.frame + 1 == _frame &&
+                    record.epoch == _epoch &&
+                    record.vByte == offset.vByte &&
+                    record.vByteEnd == _byteOffset &&
+                    record.index == offset.index &&
+                    record.indexEnd == _indexOffset;
+    
+    record.buffer = this;
+    record.frame = _frame;
+    record.epoch = _epoch;
+    record.vByte = offset.vByte;
+    record.vByteEnd = _byteOffset;
+    record.index = offset.index;
+    record.indexEnd = _indexOffset;
+    return retained;
+}
+
 void MeshBuffer::uploadData()
 {
-    _vb->update(0, vData, _byteOffset);
-    _ib->update(0, iData, _indexOffset * IDATA_BYTE);
+    bool mapRange = _uploadMode == UploadMode::MAP_RANGE;
+    _vb->replace(vData, _byteOffset, mapRange);
+    _ib->replace(iData, _indexOffset * IDATA_BYTE, mapRange);
     _dirty = false;
 }
 
 void MeshBuffer::reset()
 {
-    _vbPos = 0;
-    _vb = _vbArr.at(0);
+    switchRing((_ringPos + 1) % RING_SIZE);
+    _frame++;
     _byteStart = 0;
     _byteOffset = 0;
     _vertexStart = 0;
@@ -61,6 +61,31 @@ public:
         uint32_t vertex = 0;
     };
     
+    /**
+     *  @brief It records the range filled by a render data, so that an unchanged render data can skip refilling it in the next frame.
+     */
+    struct FillRecord
+    {
+        const MeshBuffer* buffer = nullptr;
+        uint32_t frame = 0;
+        uint32_t epoch = 0;
+        uint32_t vByte = 0;
+        uint32_t vByteEnd = 0;
+        uint32_t index = 0;
+        uint32_t indexEnd = 0;
+    };
+    
+    /**
+     *  @brief The way vertex and index data are uploaded to GPU memory.
+     */
+    enum class UploadMode : uint8_t
+    {
+        /** Orphans the buffer storage with glBufferData and fills it with glBufferSubData */
+        ORPHAN,
+        /** Writes the buffer storage through glMapBufferRange with invalidate and unsynchronized flags */
+        MAP_RANGE
+    };
+    
     /**
      *  @brief Constructor
      *  @param[in] batcher The ModelBatcher which creates the current buffer
@@ -80,16 +105,33 @@ public:
      */
     const OffsetInfo& request(uint32_t vertexCount, uint32_t indexCount);
     const OffsetInfo& requestStatic(uint32_t vertexCount, uint32_t indexCount);
+    /**
+     *  @brief Checks whether the range returned by the last request still holds the data filled into it in the previous frame,
+     *  which is true if the same range was requested then and no vertex buffer rolled over since. The record is updated to the current range.
+     *  @param[in,out] record The range filled by the render data in the previous frame
+     *  @param[in] offset The result of the last request
+     *  @return Whether filling the range can be skipped.
+     */
+    bool retainRange(FillRecord& record, const OffsetInfo& offset);
     
     /**
      *  @brief Upload data to GPU memory
      */
     void uploadData();
     /**
-     *  @brief Reset all states.
+     *  @brief Reset all states and switches to the GL buffers of the next frame in the ring.
      */
     void reset();
     
+    /**
+     *  @brief Gets the upload mode, it is MAP_RANGE by default if glMapBufferRange is supported.
+     */
+    UploadMode getUploadMode() const { return _uploadMode; };
+    /**
+     *  @brief Sets the upload mode, MAP_RANGE is ignored if glMapBufferRange isn't supported.
+     */
+    void setUploadMode(UploadMode mode);
+    
     /**
      *  @brief Gets the current byte offset which indicates the start of empty range
      *  @return Byte offset.
@@ -151,9 +193,15 @@ public:
     static const int INIT_VERTEX_COUNT = 4096;
     static const uint8_t VDATA_BYTE = sizeof(float);
     static const uint8_t IDATA_BYTE = sizeof(uint16_t);
+    /**
+     *  @brief Count of frames whose GL buffers are kept apart, so that the buffers written in a frame
+     *  aren't read by the draws of the frames still in flight.
+     */
+    static const uint8_t RING_SIZE = 3;
 protected:
     void reallocVBuffer();
     void reallocIBuffer();
+    void switchRing(uint8_t ringPos);
 private:
     uint32_t _byteStart = 0;
     uint32_t _byteOffset = 0;
@@ -171,9 +219,16 @@ private:
     
     bool _dirty = false;
     
+    // The vertex data storage is refilled from the start when the vertex buffer rolls over.
+    uint32_t _frame = 1;
+    uint32_t _epoch = 0;
+    
     ModelBatcher* _batcher = nullptr;
+    UploadMode _uploadMode = UploadMode::ORPHAN;
+    uint8_t _ringPos = 0;
     std::size_t _vbPos = 0;
-    cocos2d::Vector<VertexBuffer*> _vbArr;
+    cocos2d::Vector<VertexBuffer*> _vbArr[RING_SIZE];
+    IndexBuffer* _ibArr[RING_SIZE] = {};
     VertexBuffer* _vb = nullptr;
     IndexBuffer* _ib = nullptr;
     OffsetInfo _offsetInfo;
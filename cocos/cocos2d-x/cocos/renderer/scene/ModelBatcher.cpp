@@ -27,6 +27,7 @@
 #include "StencilManager.hpp"
 #include "assembler/RenderDataList.hpp"
 #include "NodeProxy.hpp"
+#include "../gfx/DeviceGraphics.h"
 
 RENDERER_BEGIN
 
@@ -49,6 +50,13 @@ ModelBatcher::ModelBatcher(RenderFlow* flow)
     }
 
     _stencilMgr = StencilManager::getInstance();
+    _atlas = _flow->getDynamicAtlas();
+    
+    if (_flow->getDevice()->isInstancedArraysSupported())
+    {
+        _instanceBuffer = new InstanceBuffer(this);
+    }
+    _palette = new MatrixPalette();
 }
 
 ModelBatcher::~ModelBatcher()
@@ -69,6 +77,16 @@ ModelBatcher::~ModelBatcher()
         delete buffer;
     }
     _buffers.clear();
+    
+    if (_instanceBuffer)
+    {
+        delete _instanceBuffer;
+        _instanceBuffer = nullptr;
+    }
+    
+    // Deleted after the mesh buffers which use its vertex formats.
+    delete _palette;
+    _palette = nullptr;
 }
 
 void ModelBatcher::reset()
@@ -87,6 +105,14 @@ void ModelBatcher::reset()
     }
     _buffer = nullptr;
     
+    if (_instanceBuffer)
+    {
+        _instanceBuffer->reset();
+    }
+    _instancing = false;
+    _palette->reset();
+    _paletting = false;
+    
     _commitState = CommitState::None;
     setCurrentEffect(nullptr);
     setNode(nullptr);
@@ -145,6 +171,19 @@ void ModelBatcher::commit(NodeProxy* node, Assembler* assembler)
         Effect* effect = assembler->getEffect(i);
         CustomProperties* customProp = assembler->getCustomProperties();
         if (!effect) continue;
+        
+        uint32_t atlasKey = assembler->getAtlasKey(i);
+        if (atlasKey)
+        {
+            // Sprites packed into the same page share its effect, hence the same batch.
+            const DynamicAtlas::Frame* frame = _atlas->getFrame(atlasKey);
+            Effect* pageEffect = frame ? _atlas->getPageEffect(effect, frame->page) : nullptr;
+            assembler->updateAtlasFrame(i, pageEffect ? frame : nullptr);
+            if (pageEffect)
+            {
+                effect = pageEffect;
+            }
+        }
 
         if (_currEffect == nullptr ||
             _currEffect->getHash() != effect->getHash() ||
@@ -165,6 +204,50 @@ void ModelBatcher::commit(NodeProxy* node, Assembler* assembler)
             assembler->updateOpacity(i, node->getRealOpacity());
         }
         
+        if (_currEffectInstanceable && !useModel && assembler->isInstanceable(i))
+        {
+            if (!_instancing)
+            {
+                flush();
+                _buffer = nullptr;
+                _instancing = true;
+                _paletting = false;
+            }
+            assembler->fillInstance(node, _instanceBuffer, i);
+            continue;
+        }
+        
+        if (_currEffectPaletteable && !useModel && !ignoreWorldMatrix && assembler->isPaletteable(i))
+        {
+            if (!_paletting)
+            {
+                flush();
+                _paletting = true;
+            }
+            int slot = _palette->addNode(node);
+            if (slot < 0)
+            {
+                flush();
+                _palette->reset();
+                slot = _palette->addNode(node);
+            }
+            
+            VertexFormat* paletteFmt = _palette->getVertexFormat(vfmt);
+            MeshBuffer* buffer = _buffer;
+            if (!_buffer || paletteFmt != _buffer->_vertexFmt)
+            {
+                buffer = getBuffer(paletteFmt);
+            }
+            assembler->fillPalette(node, buffer, i, (uint32_t)slot);
+            continue;
+        }
+        
+        if (_paletting)
+        {
+            flush();
+            _paletting = false;
+        }
+        
         MeshBuffer* buffer = _buffer;
         if (!_buffer || vfmt != _buffer->_vertexFmt)
         {
@@ -247,28 +330,7 @@ void ModelBatcher::flushIA()
         return;
     }
     
-    _stencilMgr->handleEffect(_currEffect);
-    
-    Model* model = nullptr;
-    if (_modelOffset >= _modelPool.size())
-    {
-        model = new Model();
-        _modelPool.push_back(model);
-    }
-    else
-    {
-        model = _modelPool[_modelOffset];
-    }
-    _modelOffset++;
-    model->setWorldMatix(_modelMat);
-    model->setCullingMask(_cullingMask);
-    model->setEffect(_currEffect, _customProps);
-    model->setNode(_node);
-    model->setInputAssembler(_ia);
-    
-    _ia.clear();
-    
-    _flow->getRenderScene()->addModel(model);
+    submitModel();
 }
 
 void ModelBatcher::flush()
@@ -278,7 +340,18 @@ void ModelBatcher::flush()
         return;
     }
     
-    if (!_walking || !_currEffect || !_buffer)
+    if (!_walking || !_currEffect)
+    {
+        return;
+    }
+    
+    if (_instancing)
+    {
+        flushInstances();
+        return;
+    }
+    
+    if (!_buffer)
     {
         return;
     }
@@ -296,6 +369,40 @@ void ModelBatcher::flush()
     _ia.setStart(indexStart);
     _ia.setCount(indexCount);
     
+    submitModel();
+    if (_paletting)
+    {
+        // Slots are kept across batches, a batch may be flushed while the vertices of a node are filled.
+        _modelPool[_modelOffset - 1]->setPalette(_palette->getData(), MatrixPalette::PALETTE_FLOATS);
+    }
+    
+    _buffer->updateOffset();
+}
+
+void ModelBatcher::flushInstances()
+{
+    uint32_t instanceStart = _instanceBuffer->getInstanceStart();
+    int instanceCount = _instanceBuffer->getInstanceOffset() - instanceStart;
+    if (instanceCount <= 0)
+    {
+        return;
+    }
+    
+    _ia.setVertexBuffer(_instanceBuffer->getQuadVertexBuffer());
+    _ia.setIndexBuffer(_instanceBuffer->getQuadIndexBuffer());
+    _ia.setStart(0);
+    _ia.setCount(InstanceBuffer::QUAD_INDEX_COUNT);
+    _ia.setInstanceBuffer(_instanceBuffer->getVertexBuffer());
+    _ia.setInstanceStart(instanceStart);
+    _ia.setInstanceCount(instanceCount);
+    
+    submitModel();
+    
+    _instanceBuffer->updateOffset();
+}
+
+void ModelBatcher::submitModel()
+{
     _stencilMgr->handleEffect(_currEffect);
     
     Model* model = nullptr;
@@ -316,15 +423,27 @@ void ModelBatcher::flush()
     model->setInputAssembler(_ia);
     
     _ia.clear();
-
-    _flow->getRenderScene()->addModel(model);
     
-    _buffer->updateOffset();
+    _flow->getRenderScene()->addModel(model);
 }
 
 void ModelBatcher::startBatch()
 {
     reset();
+    
+    // The forward renderer may be initialized after the batcher is created.
+    if (!_programLib && _flow->getForward())
+    {
+        _programLib = _flow->getForward()->getProgramLib();
+        if (_programLib)
+        {
+            if (_instanceBuffer)
+            {
+                InstanceBuffer::defineProgram(_programLib);
+            }
+            MatrixPalette::defineProgram(_programLib);
+        }
+    }
     _walking = true;
 }
 
@@ -337,6 +456,10 @@ void ModelBatcher::terminateBatch()
     {
         iter.second->uploadData();
     }
+    if (_instanceBuffer)
+    {
+        _instanceBuffer->uploadData();
+    }
     
     _walking = false;
 }
@@ -361,6 +484,29 @@ void ModelBatcher::setCurrentEffect(Effect* effect)
     CC_SAFE_RELEASE(_currEffect);
     _currEffect = effect;
     CC_SAFE_RETAIN(_currEffect);
+    
+    // Only effects whose passes all have an instanced or palette program can draw instances or palette batches.
+    _currEffectInstanceable = false;
+    _currEffectPaletteable = false;
+    if (_currEffect && _programLib)
+    {
+        _currEffectInstanceable = _instanceBuffer && _instancingEnabled;
+        _currEffectPaletteable = _paletteEnabled;
+        for (const auto& technique : _currEffect->getTechniques())
+        {
+            for (const auto& pass : technique->getPasses())
+            {
+                if (_programLib->getInstancedVariant(pass->getHashName()) == 0)
+                {
+                    _currEffectInstanceable = false;
+                }
+                if (_programLib->getPaletteVariant(pass->getHashName()) == 0)
+                {
+                    _currEffectPaletteable = false;
+                }
+            }
+        }
+    }
 };
 
 MeshBuffer* ModelBatcher::getBuffer(VertexFormat* fmt)
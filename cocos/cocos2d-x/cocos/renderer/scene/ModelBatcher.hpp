@@ -30,6 +30,9 @@
 #include "assembler/Assembler.hpp"
 #include "assembler/CustomAssembler.hpp"
 #include "MeshBuffer.hpp"
+#include "InstanceBuffer.hpp"
+#include "MatrixPalette.hpp"
+#include "DynamicAtlas.hpp"
 #include "../renderer/Renderer.h"
 #include "math/CCMath.h"
 
@@ -37,6 +40,7 @@ RENDERER_BEGIN
 
 class RenderFlow;
 class StencilManager;
+class ProgramLib;
 
 /**
  * @addtogroup scene
@@ -119,7 +123,25 @@ public:
      *  @brief Sets the current MeshBuffer.
      *  @param[in] buffer
      */
-    void setCurrentBuffer(MeshBuffer* buffer) { _buffer = buffer; };
+    void setCurrentBuffer(MeshBuffer* buffer) { _buffer = buffer; _instancing = false; };
+    /**
+     *  @brief Enables drawing simple sprites as instances of a unit quad, it only takes effect if instanced arrays are supported.
+     */
+    void setInstancingEnabled(bool enabled) { _instancingEnabled = enabled; };
+    /**
+     *  @brief Whether drawing simple sprites as instances is enabled.
+     */
+    bool isInstancingEnabled() const { return _instancingEnabled; };
+    /**
+     *  @brief Enables palette batches, which keep vertices in local space and transform them by node matrices on the GPU.
+     *  Disabled by default, a palette batch is flushed every MatrixPalette::PALETTE_SIZE nodes and uploads their matrices
+     *  with each draw, so it only pays off when many of the batched nodes move every frame.
+     */
+    void setPaletteEnabled(bool enabled) { _paletteEnabled = enabled; };
+    /**
+     *  @brief Whether palette batches are enabled.
+     */
+    bool isPaletteEnabled() const { return _paletteEnabled; };
     /**
      *  @brief Gets the global RenderFlow pointer.
      */
@@ -132,17 +154,29 @@ public:
     void setCustomProperties(CustomProperties* props) { _customProps = props; };
 private:
     void changeCommitState(CommitState state);
+    void flushInstances();
+    void submitModel();
 private:
     int _modelOffset = 0;
     int _cullingMask = 0;
     bool _useModel = false;
     bool _walking = false;
+    bool _instancing = false;
+    bool _instancingEnabled = true;
+    bool _currEffectInstanceable = false;
+    bool _paletting = false;
+    bool _paletteEnabled = false;
+    bool _currEffectPaletteable = false;
     cocos2d::Mat4 _modelMat;
     CommitState _commitState = CommitState::None;
 
     NodeProxy* _node = nullptr;
     
     MeshBuffer* _buffer = nullptr;
+    InstanceBuffer* _instanceBuffer = nullptr;
+    MatrixPalette* _palette = nullptr;
+    ProgramLib* _programLib = nullptr;
+    DynamicAtlas* _atlas = nullptr;
     Effect* _currEffect = nullptr;
     RenderFlow* _flow = nullptr;
     CustomProperties* _customProps = nullptr;
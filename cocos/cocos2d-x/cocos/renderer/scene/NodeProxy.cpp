@@ -86,7 +86,7 @@ void NodeProxy::destroyImmediately()
     {
         _parent->removeChild(this);
     }
-    RenderFlow::getInstance()->removeNodeLevel(_level, _worldMat);
+    RenderFlow::getInstance()->removeNodeLevel(_level, _levelIndex);
     CC_SAFE_RELEASE_NULL(_assembler);
     _level = NODE_LEVEL_INVALID;
     _dirty = nullptr;
@@ -230,8 +230,9 @@ void NodeProxy::updateLevel()
     static RenderFlow::LevelInfo levelInfo;
     auto renderFlow = RenderFlow::getInstance();
 
-    renderFlow->removeNodeLevel(_level, _worldMat);
+    renderFlow->removeNodeLevel(_level, _levelIndex);
     
+    levelInfo.node = this;
     levelInfo.dirty = _dirty;
     levelInfo.localMat = _localMat;
     levelInfo.worldMat = _worldMat;
@@ -241,18 +242,14 @@ void NodeProxy::updateLevel()
     if (_parent)
     {
         _level = _parent->_level + 1;
-        levelInfo.parentWorldMat = _parent->_worldMat;
-        levelInfo.parentDirty = _parent->_dirty;
-        levelInfo.parentRealOpacity = &_parent->_realOpacity;
+        levelInfo.parent = _parent->_levelIndex;
     }
     else
     {
         _level = 0;
-        levelInfo.parentWorldMat = nullptr;
-        levelInfo.parentDirty = nullptr;
-        levelInfo.parentRealOpacity = nullptr;
+        levelInfo.parent = NODE_INDEX_INVALID;
     }
-    renderFlow->insertNodeLevel(_level, levelInfo);
+    _levelIndex = renderFlow->insertNodeLevel(_level, levelInfo);
     
     for (auto it = _children.begin(); it != _children.end(); it++)
     {
@@ -473,6 +470,9 @@ void NodeProxy::updateLocalMatrix()
 void NodeProxy::render(ModelBatcher* batcher, Scene* scene)
 {
     if (!_needVisit || _realOpacity == 0) return;
+    
+    uint8_t visibility = RenderFlow::getInstance()->getVisibility(_level, _levelIndex);
+    if (!(visibility & RenderFlow::SUBTREE_VISIBLE)) return;
 
     bool needRender = *_dirty & RenderFlow::RENDER;
     if (_needRender != needRender)
@@ -481,7 +481,7 @@ void NodeProxy::render(ModelBatcher* batcher, Scene* scene)
         _needRender = needRender;
     }
     
-    if (_assembler && needRender) _assembler->handle(this, batcher, scene);
+    if (_assembler && needRender && (visibility & RenderFlow::SELF_VISIBLE)) _assembler->handle(this, batcher, scene);
 
     reorderChildren();
     for (const auto& child : _children)
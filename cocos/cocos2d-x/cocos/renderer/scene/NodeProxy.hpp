@@ -48,6 +48,8 @@ class Scene;
 struct TRS;
 struct ParentInfo;
 
+#define NODE_INDEX_INVALID 0xffffffff
+
 /**
  * @addtogroup scene
  * @{
@@ -280,6 +282,19 @@ public:
      *  @brief Is node flag dirty
      */
     bool isDirty(uint32_t flag) const { return *_dirty & flag; }
+    
+    /*
+     *  @brief Gets the depth of the node in the tree
+     */
+    std::size_t getLevel() const { return _level; }
+    /*
+     *  @brief Gets the index of the node in its RenderFlow level, NODE_INDEX_INVALID if it isn't in any level
+     */
+    std::size_t getLevelIndex() const { return _levelIndex; }
+    /*
+     *  @brief Sets the index of the node in its RenderFlow level, only used by RenderFlow
+     */
+    void setLevelIndex(std::size_t index) { _levelIndex = index; }
 protected:
     void updateLevel();
     void childrenAlloc();
@@ -294,6 +309,7 @@ private:
     std::string _id = "";
     std::string _name = "";
     std::size_t _level = 0;
+    std::size_t _levelIndex = NODE_INDEX_INVALID;
     
     uint32_t* _dirty = nullptr;
     TRS* _trs = nullptr;
@@ -23,10 +23,36 @@
  ****************************************************************************/
 
 #include "ParallelTask.hpp"
+#include <stdio.h>
+#include <algorithm>
+
+namespace {
+    // Iterations an idle thread polls before it yields or parks.
+    const int SpinCount = 2000;
+    const int YieldCount = 64;
+    
+    long readCpuMaxFreq(int cpu)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+        FILE* fp = fopen(path, "r");
+        if (!fp) return -1;
+        long freq = -1;
+        if (fscanf(fp, "%ld", &freq) != 1) freq = -1;
+        fclose(fp);
+        return freq;
+    }
+}
 
 RENDERER_BEGIN
 
 ParallelTask::ParallelTask()
+: _generation(0)
+, _remainChunks(0)
+, _activeWorkers(0)
+, _sleepingWorkers(0)
+, _open(false)
+, _finished(false)
 {
     
 }
@@ -36,141 +62,202 @@ ParallelTask::~ParallelTask()
     destroy();
 }
 
-void ParallelTask::init(int threadNum)
+int ParallelTask::getBigCoreCount()
 {
-    _finished = false;
-    _threadNum = threadNum;
+    int cpuCount = (int)std::thread::hardware_concurrency();
+    if (cpuCount <= 0) return 1;
     
-    _tasks.resize(_threadNum);
-    _threads.resize(_threadNum);
-    _runFlags = new uint8_t[_threadNum];
-    memset(_runFlags, RunFlag::Stop, sizeof(uint8_t) * _threadNum);
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    std::vector<long> freqs;
+    freqs.reserve(cpuCount);
+    long maxFreq = 0, minFreq = 0;
+    for (int i = 0; i < cpuCount; i++)
+    {
+        long freq = readCpuMaxFreq(i);
+        if (freq <= 0) return cpuCount;
+        freqs.push_back(freq);
+        maxFreq = std::max(maxFreq, freq);
+        minFreq = minFreq == 0 ? freq : std::min(minFreq, freq);
+    }
+    
+    // Homogeneous cluster, every core counts.
+    if (minFreq == maxFreq) return cpuCount;
     
-    for(auto i = 0; i < _threadNum; i++)
+    int bigCount = 0;
+    for (auto freq : freqs)
     {
-        setThread(i);
+        if (freq > minFreq) bigCount++;
     }
+    return std::max(bigCount, 1);
+#else
+    (void)readCpuMaxFreq;
+    return cpuCount;
+#endif
 }
 
-void ParallelTask::pushTask(int tid, const Task& task)
+void ParallelTask::init(int threadNum)
 {
-    if (tid >= 0 && tid < _tasks.size())
+    _finished = false;
+    _threadNum = std::max(threadNum, 0);
+    
+    std::size_t slotNum = _threadNum + 1;
+    _slotStorage.reset(new char[sizeof(Slot) * slotNum + alignof(Slot)]);
+    uintptr_t address = (uintptr_t)_slotStorage.get();
+    address = (address + alignof(Slot) - 1) & ~(uintptr_t)(alignof(Slot) - 1);
+    _slots = (Slot*)address;
+    for (std::size_t i = 0; i < slotNum; i++)
     {
-        _tasks[tid].push_back(task);
+        new (&_slots[i]) Slot();
+        _slots[i].next = 0;
+        _slots[i].end = 0;
     }
-}
-
-void ParallelTask::clearTasks()
-{
-    for(std::size_t i = 0, n = _tasks.size(); i < n; i++)
+    
+    _threads.resize(_threadNum);
+    for (int i = 0; i < _threadNum; i++)
     {
-        _tasks[i].clear();
+        _threads[i].reset(new(std::nothrow) std::thread(&ParallelTask::threadMain, this, i));
     }
 }
 
-uint8_t* ParallelTask::getRunFlag()
-{
-    return _runFlags;
-}
-
 void ParallelTask::destroy()
 {
     _finished = true;
-    beginAllThreads();
-    for (int i = 0, n = (int)_threads.size(); i < n; ++i)
     {
-        joinThread(i);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.notify_all();
+    }
+    
+    for (auto& thread : _threads)
+    {
+        if (thread && thread->joinable())
+        {
+            thread->join();
+        }
     }
-    _tasks.clear();
     _threads.clear();
-    delete _runFlags;
-    _runFlags = nullptr;
+    // Slot is trivially destructible, releasing the storage is enough.
+    _slots = nullptr;
+    _slotStorage.reset();
     _threadNum = 0;
 }
 
-void ParallelTask::stopAllThreads()
+void ParallelTask::run(std::size_t count, std::size_t chunkSize, const Task& task)
 {
-    if (!_runFlags) return;
-    memset(_runFlags, RunFlag::Stop, sizeof(uint8_t) * _threadNum);
-}
-
-void ParallelTask::beginAllThreads()
-{
-    if (!_runFlags) return;
-    memset(_runFlags, RunFlag::Begin, sizeof(uint8_t) * _threadNum);
+    if (count == 0) return;
+    chunkSize = std::max(chunkSize, (std::size_t)1);
+    
+    std::size_t chunkNum = (count + chunkSize - 1) / chunkSize;
+    if (_threadNum == 0 || chunkNum == 1)
+    {
+        task(_threadNum, 0, count);
+        return;
+    }
     
+    // Split chunks evenly between slots, leftovers are handed out one per slot.
+    int slotNum = _threadNum + 1;
+    std::size_t perSlot = chunkNum / slotNum;
+    std::size_t leftover = chunkNum % slotNum;
+    std::size_t chunkBegin = 0;
+    for (int i = 0; i < slotNum; i++)
+    {
+        std::size_t num = perSlot + ((std::size_t)i < leftover ? 1 : 0);
+        _slots[i].next.store(chunkBegin, std::memory_order_relaxed);
+        _slots[i].end = chunkBegin + num;
+        chunkBegin += num;
+    }
+    
+    _task = &task;
+    _count = count;
+    _chunkSize = chunkSize;
+    _remainChunks.store(chunkNum, std::memory_order_relaxed);
+    _open = true;
+    _generation.fetch_add(1);
+    
+    if (_sleepingWorkers.load() > 0)
     {
         std::unique_lock<std::mutex> lock(_mutex);
         _cv.notify_all();
     }
+    
+    workLoop(_threadNum);
+    
+    // Tail chunks may still be executing on workers.
+    for (int spin = 0; _remainChunks.load(std::memory_order_acquire) > 0; spin++)
+    {
+        if (spin >= SpinCount) std::this_thread::yield();
+    }
+    
+    // Close the job and wait for workers which are still scanning slots,
+    // the slots are rewritten by the next run.
+    _open = false;
+    while (_activeWorkers.load() > 0)
+    {
+        std::this_thread::yield();
+    }
+    _task = nullptr;
 }
 
-void ParallelTask::waitAllThreads()
+void ParallelTask::drainSlot(int tid, Slot& slot)
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    _cv.wait(lock, [this]() {
-        if (!_runFlags) return true;
-        for (auto i = 0; i < _threadNum; i++)
-        {
-            if (_runFlags[i] == RunFlag::Begin) return false;
-        }
-        return true;
-    });
+    const Task& task = *_task;
+    std::size_t chunk = 0;
+    while ((chunk = slot.next.fetch_add(1, std::memory_order_relaxed)) < slot.end)
+    {
+        std::size_t begin = chunk * _chunkSize;
+        std::size_t end = std::min(begin + _chunkSize, _count);
+        task(tid, begin, end);
+        _remainChunks.fetch_sub(1, std::memory_order_release);
+    }
 }
 
-void ParallelTask::joinThread(int tid)
+void ParallelTask::workLoop(int tid)
 {
-    if (tid < 0 || tid >= (int)_threads.size())
-    {
-        return;
-    }
-    
-    if (_threads[tid]->joinable())
+    int slotNum = _threadNum + 1;
+    drainSlot(tid, _slots[tid]);
+    for (int i = 1; i < slotNum; i++)
     {
-        _threads[tid]->join();
+        drainSlot(tid, _slots[(tid + i) % slotNum]);
     }
 }
 
-void ParallelTask::setThread(int tid)
+void ParallelTask::threadMain(int tid)
 {
-    auto f = [this, tid]() {
-        uint8_t& runFlag = _runFlags[tid];
-        if (!runFlag) return;
-        
-        auto& taskQueue = _tasks[tid];
-        std::size_t idx = 0;
-        std::size_t taskCount = 0;
-        
-        while (!_finished)
+    uint32_t lastGeneration = _generation.load();
+    
+    while (!_finished)
+    {
+        uint32_t generation = _generation.load(std::memory_order_acquire);
+        if (generation == lastGeneration)
         {
-            switch (runFlag)
+            int spin = 0;
+            for (; spin < SpinCount + YieldCount; spin++)
+            {
+                generation = _generation.load(std::memory_order_acquire);
+                if (generation != lastGeneration || _finished) break;
+                if (spin >= SpinCount) std::this_thread::yield();
+            }
+            
+            if (generation == lastGeneration && !_finished)
             {
-                case RunFlag::Begin:
-                    for (idx = 0, taskCount = taskQueue.size(); idx < taskCount; idx++)
-                    {
-                        const Task& task = taskQueue[idx];
-                        task(tid);
-                    }
-                    runFlag = RunFlag::Stop;
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(_mutex);
-                        _cv.notify_all();
-                    }
-                break;
-                case RunFlag::Stop:
-                {
-                    std::unique_lock<std::mutex> lock(_mutex);
-                    _cv.wait(lock, [this, &runFlag]()
-                    {
-                        return runFlag == RunFlag::Begin || _finished;
-                    });
-                }
-                break;
+                std::unique_lock<std::mutex> lock(_mutex);
+                _sleepingWorkers.fetch_add(1);
+                _cv.wait(lock, [this, lastGeneration]() {
+                    return _generation.load() != lastGeneration || _finished;
+                });
+                _sleepingWorkers.fetch_sub(1);
             }
+            continue;
+        }
+        
+        lastGeneration = generation;
+        
+        _activeWorkers.fetch_add(1);
+        if (_open.load())
+        {
+            workLoop(tid);
         }
-    };
-    _threads[tid].reset(new(std::nothrow) std::thread(f));
+        _activeWorkers.fetch_sub(1);
+    }
 }
 
 RENDERER_END
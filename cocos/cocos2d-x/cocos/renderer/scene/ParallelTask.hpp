@@ -30,45 +30,86 @@
 #include <functional>
 #include <thread>
 #include <memory>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <new>
 
 RENDERER_BEGIN
 
+/**
+ *  @brief Small job system used by RenderFlow to spread per-frame work over cores.\n
+ *  A job is a range [0, count) split into fixed size chunks. Chunks are first
+ *  distributed evenly between the workers and the calling thread, a thread which
+ *  drains its own share steals remaining chunks from the others.
+ *  Idle workers spin for a short while before parking on a condition variable,
+ *  so back to back jobs in the same frame do not pay the wake up cost.
+ */
 class ParallelTask
 {
 public:
     
-    enum RunFlag{
-        Begin = 0x00,
-        Stop = 0x01,
-    };
-    
-    typedef std::function<void(int)> Task;
+    /**
+     *  @brief Task executed for a chunk.
+     *  @param[in] tid Id of the executing thread, workers use [0, threadNum), the calling thread uses threadNum.
+     *  @param[in] begin First index of the chunk.
+     *  @param[in] end One past the last index of the chunk.
+     */
+    typedef std::function<void(int tid, std::size_t begin, std::size_t end)> Task;
     
     ParallelTask();
     virtual ~ParallelTask();
     
-    void pushTask(int tid, const Task& task);
-    void clearTasks();
-    
-    uint8_t* getRunFlag();
+    /**
+     *  @brief Number of cores which should take part in rendering work.\n
+     *  On big.LITTLE devices the cores of the slowest cluster are left out, every faster core counts,
+     *  including the mid cores of tri-cluster SoCs.
+     */
+    static int getBigCoreCount();
     
+    /**
+     *  @brief Starts worker threads.
+     *  @param[in] threadNum Number of worker threads, the calling thread is not counted.
+     */
     void init(int threadNum);
     void destroy();
     
-    void waitAllThreads();
-    void stopAllThreads();
-    void beginAllThreads();
+    /**
+     *  @brief Gets the number of threads taking part in a job, including the calling thread.
+     */
+    int getConcurrency() const { return _threadNum + 1; }
+    
+    /**
+     *  @brief Runs task over [0, count) and returns when every chunk is done.
+     *  The calling thread takes part in the job.
+     */
+    void run(std::size_t count, std::size_t chunkSize, const Task& task);
 private:
-    void joinThread(int tid);
-    void setThread(int tid);
+    struct alignas(64) Slot
+    {
+        std::atomic<std::size_t> next;
+        std::size_t end = 0;
+    };
+    
+    void workLoop(int tid);
+    void drainSlot(int tid, Slot& slot);
+    void threadMain(int tid);
 private:
-    std::vector<std::vector<Task>> _tasks;
     std::vector<std::unique_ptr<std::thread>> _threads;
+    // new[] doesn't honour alignas(64) before C++17, the slots are aligned by hand in this storage.
+    std::unique_ptr<char[]> _slotStorage;
+    Slot* _slots = nullptr;
+    
+    const Task* _task = nullptr;
+    std::size_t _count = 0;
+    std::size_t _chunkSize = 0;
     
-    uint8_t* _runFlags = nullptr;
-    bool _finished = false;
+    std::atomic<uint32_t> _generation;
+    std::atomic<std::size_t> _remainChunks;
+    std::atomic<int> _activeWorkers;
+    std::atomic<int> _sleepingWorkers;
+    std::atomic<bool> _open;
+    std::atomic<bool> _finished;
     int _threadNum = 0;
     
     std::mutex _mutex;
@@ -25,21 +25,61 @@
 #include "RenderFlow.hpp"
 #include "NodeMemPool.hpp"
 #include "assembler/AssemblerSprite.hpp"
+#include "../gfx/TextureUploader.h"
 
 #if USE_MIDDLEWARE
 #include "MiddlewareManager.h"
 #endif
 
-#define SUB_RENDER_THREAD_COUNT 1
-#define RENDER_THREAD_COUNT (SUB_RENDER_THREAD_COUNT + 1)
+#include <chrono>
+#include <float.h>
+#include <math.h>
+
+// Upper bound of render threads including the main thread, the real count
+// depends on the big cores detected on the device.
+#define MAX_RENDER_THREAD_COUNT 8
 
 RENDERER_BEGIN
 
 const uint32_t InitLevelCount = 3;
 const uint32_t InitLevelNodeCount = 100;
 
-const uint32_t LocalMat_Use_Thread_Unit_Count = 5;
-const uint32_t WorldMat_Use_Thread_Node_count = 500;
+// Chunk sizes handed to the job system, a common unit holds up to a few hundred nodes.
+const std::size_t LocalMat_Chunk_Unit_Count = 1;
+const std::size_t WorldMat_Chunk_Node_Count = 128;
+
+// Weight of the newest sample in the stage cost averages.
+const float StageCost_Sample_Weight = 0.1f;
+// Lower bound of the dispatch cost, keeps tiny jobs serial.
+const float StageCost_Min_Dispatch_Ns = 2000.0f;
+// A serial sample is forced after this many parallel runs to refresh the item cost.
+const uint32_t StageCost_Resample_Interval = 120;
+
+namespace
+{
+    // Transforms a local box by an affine matrix, the result encloses all of its corners.
+    void transformBounds(const cocos2d::Mat4& mat, const cocos2d::Vec3& min, const cocos2d::Vec3& max, cocos2d::Vec3& outMin, cocos2d::Vec3& outMax)
+    {
+        const float* m = mat.m;
+        float cx = (min.x + max.x) * 0.5f, cy = (min.y + max.y) * 0.5f, cz = (min.z + max.z) * 0.5f;
+        float ex = (max.x - min.x) * 0.5f, ey = (max.y - min.y) * 0.5f, ez = (max.z - min.z) * 0.5f;
+        float* outMinData = &outMin.x;
+        float* outMaxData = &outMax.x;
+        for (int i = 0; i < 3; i++)
+        {
+            float center = m[i] * cx + m[4 + i] * cy + m[8 + i] * cz + m[12 + i];
+            float extent = fabsf(m[i]) * ex + fabsf(m[4 + i]) * ey + fabsf(m[8 + i]) * ez;
+            outMinData[i] = center - extent;
+            outMaxData[i] = center + extent;
+        }
+    }
+    
+    void mergeBounds(cocos2d::Vec3& min, cocos2d::Vec3& max, const cocos2d::Vec3& otherMin, const cocos2d::Vec3& otherMax)
+    {
+        min.set(std::min(min.x, otherMin.x), std::min(min.y, otherMin.y), std::min(min.z, otherMin.z));
+        max.set(std::max(max.x, otherMax.x), std::max(max.y, otherMax.y), std::max(max.z, otherMax.z));
+    }
+}
 
 RenderFlow* RenderFlow::_instance = nullptr;
 
@@ -50,68 +90,148 @@ RenderFlow::RenderFlow(DeviceGraphics* device, Scene* scene, ForwardRenderer* fo
 {
     _instance = this;
     
+    _atlas = new DynamicAtlas(device);
     _batcher = new ModelBatcher(this);
 
-#if SUB_RENDER_THREAD_COUNT > 0
-    _paralleTask = new ParallelTask();
-    _paralleTask->init(SUB_RENDER_THREAD_COUNT);
-    
-    for (uint32_t i = 0; i < SUB_RENDER_THREAD_COUNT; i++)
+    int threadCount = std::min(ParallelTask::getBigCoreCount(), MAX_RENDER_THREAD_COUNT);
+    if (threadCount > 1)
     {
-        _paralleTask->pushTask(i, [this](int tid){
-            switch(_parallelStage)
-            {
-                case ParallelStage::LOCAL_MAT:
-                    calculateLocalMatrix(tid);
-                break;
-                case ParallelStage::WORLD_MAT:
-                    calculateLevelWorldMatrix(tid, _parallelStage);
-                break;
-                default:
-                break;
-            }
-        });
+        _paralleTask = new ParallelTask();
+        _paralleTask->init(threadCount - 1);
     }
+    
+#if USE_MIDDLEWARE
+    middleware::MiddlewareManager::getInstance()->setParallelTask(_paralleTask);
 #endif
     
-    _levelInfoArr.resize(InitLevelCount);
+    _levels.resize(InitLevelCount);
     for (auto i = 0; i < InitLevelCount; i++)
     {
-        _levelInfoArr[i].reserve(InitLevelNodeCount);
+        _levels[i].reserve(InitLevelNodeCount);
     }
 }
 
 RenderFlow::~RenderFlow()
 {
+#if USE_MIDDLEWARE
+    middleware::MiddlewareManager::getInstance()->setParallelTask(nullptr);
+#endif
     CC_SAFE_DELETE(_paralleTask);
     CC_SAFE_DELETE(_batcher);
+    CC_SAFE_DELETE(_atlas);
+    CC_SAFE_DELETE(_commandBuffer);
+}
+
+void RenderFlow::setCommandRecording(bool enabled)
+{
+    if (enabled && !_commandBuffer)
+    {
+        _commandBuffer = new CommandBuffer();
+    }
+    else if (!enabled)
+    {
+        CC_SAFE_DELETE(_commandBuffer);
+    }
+}
+
+void RenderFlow::NodeLevel::reserve(std::size_t count)
+{
+    nodes.reserve(count);
+    parents.reserve(count);
+    dirties.reserve(count);
+    localMats.reserve(count);
+    worldMats.reserve(count);
+    opacities.reserve(count);
+    realOpacities.reserve(count);
+    changes.reserve(count);
+}
+
+void RenderFlow::NodeLevel::push(const LevelInfo& info)
+{
+    nodes.push_back(info.node);
+    parents.push_back((uint32_t)info.parent);
+    dirties.push_back(info.dirty);
+    localMats.push_back(info.localMat);
+    worldMats.push_back(info.worldMat);
+    opacities.push_back(info.opacity);
+    realOpacities.push_back(info.realOpacity);
+    changes.push_back(0);
 }
 
-void RenderFlow::removeNodeLevel(std::size_t level, cocos2d::Mat4* worldMat)
+void RenderFlow::NodeLevel::swapRemove(std::size_t index)
 {
-    if (level >= _levelInfoArr.size()) return;
-    auto& levelInfos = _levelInfoArr[level];
-    for(auto it = levelInfos.begin(); it != levelInfos.end(); it++)
+    nodes[index] = nodes.back();
+    nodes.pop_back();
+    parents[index] = parents.back();
+    parents.pop_back();
+    dirties[index] = dirties.back();
+    dirties.pop_back();
+    localMats[index] = localMats.back();
+    localMats.pop_back();
+    worldMats[index] = worldMats.back();
+    worldMats.pop_back();
+    opacities[index] = opacities.back();
+    opacities.pop_back();
+    realOpacities[index] = realOpacities.back();
+    realOpacities.pop_back();
+    changes[index] = changes.back();
+    changes.pop_back();
+}
+
+void RenderFlow::removeNodeLevel(std::size_t level, std::size_t index)
+{
+    if (level >= _levels.size()) return;
+    auto& nodeLevel = _levels[level];
+    if (index >= nodeLevel.size()) return;
+    
+    NodeLevel* lowerLevel = level + 1 < _levels.size() ? &_levels[level + 1] : nullptr;
+    NodeProxy* node = nodeLevel.nodes[index];
+    node->setLevelIndex(NODE_INDEX_INVALID);
+    
+    std::size_t last = nodeLevel.size() - 1;
+    nodeLevel.swapRemove(index);
+    NodeProxy* moved = index != last ? nodeLevel.nodes[index] : nullptr;
+    if (moved)
     {
-        if (it->worldMat == worldMat)
+        moved->setLevelIndex(index);
+    }
+    
+    if (!lowerLevel) return;
+    
+    // Children still in the lower level lose their parent, the children of the moved node follow it.
+    for (auto child : node->getChildren())
+    {
+        std::size_t childIndex = child->getLevelIndex();
+        if (childIndex < lowerLevel->size() && lowerLevel->nodes[childIndex] == child)
         {
-            levelInfos.erase(it);
-            return;
+            lowerLevel->parents[childIndex] = NODE_INDEX_INVALID;
+        }
+    }
+    if (moved)
+    {
+        for (auto child : moved->getChildren())
+        {
+            std::size_t childIndex = child->getLevelIndex();
+            if (childIndex < lowerLevel->size() && lowerLevel->nodes[childIndex] == child)
+            {
+                lowerLevel->parents[childIndex] = (uint32_t)index;
+            }
         }
     }
 }
 
-void RenderFlow::insertNodeLevel(std::size_t level, const LevelInfo& levelInfo)
+std::size_t RenderFlow::insertNodeLevel(std::size_t level, const LevelInfo& levelInfo)
 {
-    if (level >= _levelInfoArr.size())
+    if (level >= _levels.size())
     {
-        _levelInfoArr.resize(level + 1);
+        _levels.resize(level + 1);
     }
-    auto& levelInfos = _levelInfoArr[level];
-    levelInfos.push_back(levelInfo);
+    auto& nodeLevel = _levels[level];
+    nodeLevel.push(levelInfo);
+    return nodeLevel.size() - 1;
 }
 
-void RenderFlow::calculateLocalMatrix(int tid)
+void RenderFlow::calculateLocalMatrix(std::size_t begin, std::size_t end)
 {
     const uint16_t SPACE_FREE_FLAG = 0x0;
     cocos2d::Mat4 matTemp;
@@ -133,16 +253,7 @@ void RenderFlow::calculateLocalMatrix(int tid)
     cocos2d::Quaternion* quat = nullptr;
     float trsZ = 0.0f, trsSZ = 0.0f;
     
-    std::size_t begin = 0, end = commonList.size();
-    std::size_t fieldSize = end / RENDER_THREAD_COUNT;
-    if (tid >= 0)
-    {
-        begin = tid * fieldSize;
-        if (tid < RENDER_THREAD_COUNT - 1)
-        {
-            end = (tid + 1) * fieldSize;
-        }
-    }
+    end = std::min(end, commonList.size());
 
     for(auto i = begin; i < end; i++)
     {
@@ -188,165 +299,351 @@ void RenderFlow::calculateLocalMatrix(int tid)
     }
 }
 
-void RenderFlow::calculateLevelWorldMatrix(int tid, int stage)
+void RenderFlow::calculateLevelWorldMatrix(std::size_t level, std::size_t begin, std::size_t end)
 {
-    if (_curLevel >= _levelInfoArr.size())
+    if (level >= _levels.size())
     {
         return;
     }
     
-    auto& levelInfos = _levelInfoArr[_curLevel];
-
-    std::size_t begin = 0, end = levelInfos.size();
-    std::size_t fieldSize = end / RENDER_THREAD_COUNT;
-    if (tid >= 0)
-    {
-        begin = tid * fieldSize;
-        if (tid < RENDER_THREAD_COUNT - 1)
-        {
-            end = (tid + 1) * fieldSize;
-        }
-    }
+    auto& nodeLevel = _levels[level];
+    const NodeLevel* upperLevel = level > 0 ? &_levels[level - 1] : nullptr;
+    end = std::min(end, nodeLevel.size());
+    
+    const uint32_t* parents = nodeLevel.parents.data();
+    uint32_t* const* dirties = nodeLevel.dirties.data();
+    uint32_t* changes = nodeLevel.changes.data();
 
     for(std::size_t index = begin; index < end; index++)
     {
-        auto& info = levelInfos[index];
-        auto dirty = info.dirty;
-        auto parentDirty = info.parentDirty;
-        auto selfWorldDirty = *dirty & WORLD_TRANSFORM;
-        auto selfOpacityDirty = *dirty & OPACITY;
+        uint32_t* dirty = dirties[index];
+        uint32_t parent = parents[index];
+        uint32_t flags = *dirty;
+        bool hasParent = upperLevel && parent != NODE_INDEX_INVALID;
+        uint32_t parentChanges = hasParent ? upperLevel->changes[parent] : 0;
         
-        if (parentDirty)
+        if ((parentChanges & WORLD_TRANSFORM_CHANGED) || (flags & WORLD_TRANSFORM))
         {
-            if ((*parentDirty & WORLD_TRANSFORM_CHANGED) || selfWorldDirty)
+            if (hasParent)
             {
-                cocos2d::Mat4::multiply(*info.parentWorldMat, *info.localMat, info.worldMat);
-                *dirty |= WORLD_TRANSFORM_CHANGED;
-                *dirty &= ~WORLD_TRANSFORM;
+                cocos2d::Mat4::multiply(*upperLevel->worldMats[parent], *nodeLevel.localMats[index], nodeLevel.worldMats[index]);
             }
-            
-            if ((*parentDirty & NODE_OPACITY_CHANGED) || selfOpacityDirty)
+            else
             {
-                *info.realOpacity = *info.opacity * *info.parentRealOpacity / 255.0f;
-                *dirty |= NODE_OPACITY_CHANGED;
-                *dirty &= ~OPACITY;
+                *nodeLevel.worldMats[index] = *nodeLevel.localMats[index];
             }
+            flags |= WORLD_TRANSFORM_CHANGED;
+            flags &= ~WORLD_TRANSFORM;
         }
-        else
+        
+        if ((parentChanges & NODE_OPACITY_CHANGED) || (flags & OPACITY))
         {
-            if (selfWorldDirty)
+            if (hasParent)
             {
-                *info.worldMat = *info.localMat;
-                *dirty |= WORLD_TRANSFORM_CHANGED;
-                *dirty &= ~WORLD_TRANSFORM;
+                *nodeLevel.realOpacities[index] = *nodeLevel.opacities[index] * *upperLevel->realOpacities[parent] / 255.0f;
             }
-            
-            if (selfOpacityDirty)
+            else
             {
-                *info.realOpacity = *info.opacity;
-                *dirty |= NODE_OPACITY_CHANGED;
-                *dirty &= ~OPACITY;
+                *nodeLevel.realOpacities[index] = *nodeLevel.opacities[index];
             }
+            flags |= NODE_OPACITY_CHANGED;
+            flags &= ~OPACITY;
         }
+        
+        // Clean nodes skip the write back, which keeps their cache lines shared between the workers.
+        if (flags != *dirty)
+        {
+            *dirty = flags;
+        }
+        changes[index] = flags & (WORLD_TRANSFORM_CHANGED | NODE_OPACITY_CHANGED);
     }
 }
 
 void RenderFlow::calculateWorldMatrix()
 {
-    for(std::size_t level = 0, n = _levelInfoArr.size(); level < n; level++)
+    for(std::size_t level = 0, n = _levels.size(); level < n; level++)
+    {
+        calculateLevelWorldMatrix(level);
+    }
+}
+
+bool RenderFlow::CullingView::isVisible(const cocos2d::Vec3& min, const cocos2d::Vec3& max) const
+{
+    if (min.x > max.x) return false;
+    
+    for (const auto& plane : planes)
+    {
+        // The corner furthest along the plane normal.
+        float x = plane.x >= 0 ? max.x : min.x;
+        float y = plane.y >= 0 ? max.y : min.y;
+        float z = plane.z >= 0 ? max.z : min.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0) return false;
+    }
+    return true;
+}
+
+void RenderFlow::calculateVisibility()
+{
+    _visibilityValid = false;
+    _culledNodeCount = 0;
+    _submittedNodeCount = 0;
+    if (!_cullingEnabled || !_forward) return;
+    
+    _cullingViews.clear();
+    cocos2d::Mat4 viewProj;
+    for (const auto& camera : _scene->getCameras())
     {
-        auto& levelInfos = _levelInfoArr[level];
-        for(std::size_t index = 0, count = levelInfos.size(); index < count; index++)
+        if (!camera->getNode()) continue;
+        camera->calcViewProj(viewProj, _forward->getWidth(), _forward->getHeight());
+        
+        // Rows of the column major matrix, the planes follow the clip space of GL.
+        const float* m = viewProj.m;
+        cocos2d::Vec4 row0(m[0], m[4], m[8], m[12]);
+        cocos2d::Vec4 row1(m[1], m[5], m[9], m[13]);
+        cocos2d::Vec4 row2(m[2], m[6], m[10], m[14]);
+        cocos2d::Vec4 row3(m[3], m[7], m[11], m[15]);
+        
+        CullingView view;
+        view.planes[0] = row3 + row0;
+        view.planes[1] = row3 - row0;
+        view.planes[2] = row3 + row1;
+        view.planes[3] = row3 - row1;
+        view.planes[4] = row3 + row2;
+        view.planes[5] = row3 - row2;
+        view.viewProj = viewProj;
+        view.cullingMask = camera->getCullingMask();
+        _cullingViews.push_back(view);
+    }
+    
+    auto isVisible = [this](const cocos2d::Vec3& min, const cocos2d::Vec3& max, int cullingMask) {
+        for (const auto& view : _cullingViews)
         {
-            auto& info = levelInfos[index];
-            auto selfWorldDirty = *info.dirty & WORLD_TRANSFORM;
-            auto selfOpacityDirty = *info.dirty & OPACITY;
+            if ((view.cullingMask & cullingMask) && view.isVisible(min, max)) return true;
+        }
+        return false;
+    };
+    
+    const cocos2d::Vec3 emptyMin(FLT_MAX, FLT_MAX, FLT_MAX), emptyMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (auto& nodeLevel : _levels)
+    {
+        std::size_t count = nodeLevel.size();
+        nodeLevel.boundsMin.assign(count, emptyMin);
+        nodeLevel.boundsMax.assign(count, emptyMax);
+        nodeLevel.subtreeMasks.assign(count, 0);
+        nodeLevel.visibilities.assign(count, 0);
+    }
+    
+    // Bottom up, so that a subtree is complete when its root is tested.
+    cocos2d::Vec3 localMin, localMax, worldMin, worldMax;
+    for (std::size_t level = _levels.size(); level-- > 0;)
+    {
+        auto& nodeLevel = _levels[level];
+        NodeLevel* upperLevel = level > 0 ? &_levels[level - 1] : nullptr;
+        
+        for (std::size_t index = 0, count = nodeLevel.size(); index < count; index++)
+        {
+            NodeProxy* node = nodeLevel.nodes[index];
+            AssemblerBase* assembler = node->getAssembler();
+            uint32_t flags = *nodeLevel.dirties[index];
+            int cullingMask = node->getCullingMask();
+            cocos2d::Vec3& subtreeMin = nodeLevel.boundsMin[index];
+            cocos2d::Vec3& subtreeMax = nodeLevel.boundsMax[index];
+            int& subtreeMask = nodeLevel.subtreeMasks[index];
+            uint8_t visibility = 0;
             
-            if (info.parentDirty)
+            if (assembler && (flags & (RENDER | POST_RENDER)))
             {
-                if ((*info.parentDirty & WORLD_TRANSFORM_CHANGED) || selfWorldDirty)
+                // Nodes which also render after their children, e.g. masks, are never culled.
+                if ((flags & POST_RENDER) || !assembler->getLocalBounds(localMin, localMax))
                 {
-                    cocos2d::Mat4::multiply(*info.parentWorldMat, *info.localMat, info.worldMat);
-                    *info.dirty |= WORLD_TRANSFORM_CHANGED;
-                    *info.dirty &= ~WORLD_TRANSFORM;
+                    worldMin.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+                    worldMax.set(FLT_MAX, FLT_MAX, FLT_MAX);
                 }
-                
-                if ((*info.parentDirty & NODE_OPACITY_CHANGED) || selfOpacityDirty)
+                else if (localMin.x <= localMax.x)
                 {
-                    *info.realOpacity = *info.opacity * *info.parentRealOpacity / 255.0f;
-                    *info.dirty |= NODE_OPACITY_CHANGED;
-                    *info.dirty &= ~OPACITY;
+                    transformBounds(*nodeLevel.worldMats[index], localMin, localMax, worldMin, worldMax);
                 }
-            }
-            else
-            {
-                if (selfWorldDirty)
+                else
                 {
-                    *info.worldMat = *info.localMat;
-                    *info.dirty |= WORLD_TRANSFORM_CHANGED;
-                    *info.dirty &= ~WORLD_TRANSFORM;
+                    worldMin = emptyMin;
+                    worldMax = emptyMax;
                 }
                 
-                if (selfOpacityDirty)
+                mergeBounds(subtreeMin, subtreeMax, worldMin, worldMax);
+                if (isVisible(worldMin, worldMax, cullingMask))
                 {
-                    *info.realOpacity = *info.opacity;
-                    *info.dirty |= NODE_OPACITY_CHANGED;
-                    *info.dirty &= ~OPACITY;
+                    visibility |= SELF_VISIBLE;
+                    _submittedNodeCount++;
                 }
+                else
+                {
+                    _culledNodeCount++;
+                    
+                    // The changes are cleared next frame without being applied, fill everything again once visible.
+                    if (flags & (WORLD_TRANSFORM_CHANGED | NODE_OPACITY_CHANGED))
+                    {
+                        assembler->enableDirty(AssemblerBase::VERTICES_DIRTY | AssemblerBase::VERTICES_OPACITY_CHANGED);
+                        assembler->resetFillRecords();
+                    }
+                }
+            }
+            
+            subtreeMask |= cullingMask;
+            if (isVisible(subtreeMin, subtreeMax, subtreeMask))
+            {
+                visibility |= SUBTREE_VISIBLE;
+            }
+            nodeLevel.visibilities[index] = visibility;
+            
+            uint32_t parent = nodeLevel.parents[index];
+            if (upperLevel && parent != NODE_INDEX_INVALID)
+            {
+                mergeBounds(upperLevel->boundsMin[parent], upperLevel->boundsMax[parent], subtreeMin, subtreeMax);
+                upperLevel->subtreeMasks[parent] |= subtreeMask;
             }
         }
     }
+    
+    _visibilityValid = true;
+}
+
+float RenderFlow::getScreenCoverage(std::size_t level, std::size_t index) const
+{
+    if (!_visibilityValid || level >= _levels.size() || index >= _levels[level].boundsMin.size()) return 1.0f;
+    
+    const auto& nodeLevel = _levels[level];
+    const cocos2d::Vec3& min = nodeLevel.boundsMin[index];
+    const cocos2d::Vec3& max = nodeLevel.boundsMax[index];
+    if (min.x > max.x) return 0.0f;
+    if (min.x == -FLT_MAX || max.x == FLT_MAX) return 1.0f;
+    
+    float coverage = 0.0f;
+    for (const auto& view : _cullingViews)
+    {
+        if (!(view.cullingMask & nodeLevel.subtreeMasks[index])) continue;
+        
+        float ndcMinX = FLT_MAX, ndcMinY = FLT_MAX, ndcMaxX = -FLT_MAX, ndcMaxY = -FLT_MAX;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            cocos2d::Vec4 point((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z, 1.0f);
+            view.viewProj.transformVector(&point);
+            // A corner behind the camera, the bounds may cover the whole view.
+            if (point.w <= 0.0f) return 1.0f;
+            
+            ndcMinX = std::min(ndcMinX, point.x / point.w);
+            ndcMinY = std::min(ndcMinY, point.y / point.w);
+            ndcMaxX = std::max(ndcMaxX, point.x / point.w);
+            ndcMaxY = std::max(ndcMaxY, point.y / point.w);
+        }
+        
+        float width = std::min(ndcMaxX, 1.0f) - std::max(ndcMinX, -1.0f);
+        float height = std::min(ndcMaxY, 1.0f) - std::max(ndcMinY, -1.0f);
+        if (width > 0.0f && height > 0.0f)
+        {
+            coverage = std::max(coverage, width * height * 0.25f);
+        }
+    }
+    return coverage;
+}
+
+bool RenderFlow::StageCost::useParallel(std::size_t count, int concurrency) const
+{
+    // No serial sample yet, measure one first.
+    if (itemNs <= 0.0f || parallelRuns >= StageCost_Resample_Interval) return false;
+    float serialNs = itemNs * count;
+    float savedNs = serialNs - serialNs / concurrency;
+    return savedNs > dispatchNs;
+}
+
+void RenderFlow::StageCost::recordSerial(std::size_t count, float elapsedNs)
+{
+    if (count == 0) return;
+    float sample = elapsedNs / count;
+    parallelRuns = 0;
+    itemNs = itemNs <= 0.0f ? sample : itemNs + (sample - itemNs) * StageCost_Sample_Weight;
+}
+
+void RenderFlow::StageCost::recordParallel(std::size_t count, int concurrency, float elapsedNs)
+{
+    float sample = elapsedNs - itemNs * count / concurrency;
+    sample = std::max(sample, StageCost_Min_Dispatch_Ns);
+    parallelRuns++;
+    dispatchNs += (sample - dispatchNs) * StageCost_Sample_Weight;
+}
+
+void RenderFlow::StageCost::decay()
+{
+    // Let a pessimistic dispatch estimate recover, e.g. one measured while workers were parked.
+    dispatchNs = std::max(dispatchNs * 0.999f, StageCost_Min_Dispatch_Ns);
+}
+
+template<typename Serial, typename Parallel>
+void RenderFlow::runStage(StageCost& cost, std::size_t count, std::size_t chunkSize, const Serial& serial, const Parallel& parallel)
+{
+    if (count == 0) return;
+    
+    int concurrency = _paralleTask->getConcurrency();
+    bool useParallel = cost.useParallel(count, concurrency);
+    auto start = std::chrono::steady_clock::now();
+    
+    if (useParallel)
+    {
+        _paralleTask->run(count, chunkSize, parallel);
+    }
+    else
+    {
+        serial();
+    }
+    
+    float elapsedNs = (float)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (useParallel)
+    {
+        cost.recordParallel(count, concurrency, elapsedNs);
+    }
+    else
+    {
+        cost.recordSerial(count, elapsedNs);
+        cost.decay();
+    }
 }
 
 void RenderFlow::render(NodeProxy* scene, float deltaTime)
 {
     if (scene != nullptr)
     {
+        _device->getTextureUploader()->process();
         
 #if USE_MIDDLEWARE
         middleware::MiddlewareManager::getInstance()->update(deltaTime);
 #endif
         
-#if SUB_RENDER_THREAD_COUNT > 0
-
-        int mainThreadTid = RENDER_THREAD_COUNT - 1;
-
-        NodeMemPool* instance = NodeMemPool::getInstance();
-        auto& commonList = instance->getCommonList();
-        if (commonList.size() < LocalMat_Use_Thread_Unit_Count)
+        if (_paralleTask)
         {
-            _parallelStage = ParallelStage::NONE;
-            calculateLocalMatrix();
+            NodeMemPool* instance = NodeMemPool::getInstance();
+            std::size_t unitCount = instance->getCommonList().size();
+            runStage(_localMatCost, unitCount, LocalMat_Chunk_Unit_Count, [this]() {
+                calculateLocalMatrix();
+            }, [this](int tid, std::size_t begin, std::size_t end) {
+                calculateLocalMatrix(begin, end);
+            });
+            
+            for(std::size_t level = 0, count = _levels.size(); level < count; level++)
+            {
+                std::size_t nodeCount = _levels[level].size();
+                runStage(_worldMatCost, nodeCount, WorldMat_Chunk_Node_Count, [this, level]() {
+                    calculateLevelWorldMatrix(level);
+                }, [this, level](int tid, std::size_t begin, std::size_t end) {
+                    calculateLevelWorldMatrix(level, begin, end);
+                });
+            }
         }
         else
         {
-            _parallelStage = ParallelStage::LOCAL_MAT;
-            _paralleTask->beginAllThreads();
-            calculateLocalMatrix(mainThreadTid);
-            _paralleTask->waitAllThreads();
-        }
-
-        _curLevel = 0;
-        for(auto count = _levelInfoArr.size(); _curLevel < count; _curLevel++)
-        {
-            auto& levelInfos = _levelInfoArr[_curLevel];
-            if (levelInfos.size() < WorldMat_Use_Thread_Node_count)
-            {
-                _parallelStage = ParallelStage::NONE;
-                calculateLevelWorldMatrix();
-            }
-            else
-            {
-                _parallelStage = ParallelStage::WORLD_MAT;
-                _paralleTask->beginAllThreads();
-                calculateLevelWorldMatrix(mainThreadTid);
-                _paralleTask->waitAllThreads();
-            }
+            calculateLocalMatrix();
+            calculateWorldMatrix();
         }
-#else
-        calculateLocalMatrix();
-        calculateWorldMatrix();
-#endif
+        
+        calculateVisibility();
         
         _batcher->startBatch();
 
@@ -356,8 +653,19 @@ void RenderFlow::render(NodeProxy* scene, float deltaTime)
         
         scene->render(_batcher, _scene);
         _batcher->terminateBatch();
+        _atlas->update();
 
-        _forward->render(_scene);
+        if (_commandBuffer)
+        {
+            _device->beginRecording(_commandBuffer);
+            _forward->render(_scene);
+            _device->endRecording();
+            _device->execute(_commandBuffer);
+        }
+        else
+        {
+            _forward->render(_scene);
+        }
     }
 }
 
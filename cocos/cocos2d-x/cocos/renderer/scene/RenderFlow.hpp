@@ -27,9 +27,11 @@
 #include "../Macro.h"
 #include "NodeProxy.hpp"
 #include "ModelBatcher.hpp"
+#include "DynamicAtlas.hpp"
 #include "../renderer/Scene.h"
 #include "../renderer/ForwardRenderer.h"
 #include "../gfx/DeviceGraphics.h"
+#include "../gfx/CommandBuffer.h"
 #include "ParallelTask.hpp"
 
 RENDERER_BEGIN
@@ -75,18 +77,17 @@ public:
         NODE_OPACITY_CHANGED = 1 << 31,
     };
 
-    enum ParallelStage {
-        NONE = 1 << 0,
-        LOCAL_MAT = 1 << 1,
-        WORLD_MAT = 1 << 2,
-        CALC_VERTICES = 1 << 3,
+    enum NodeVisibility {
+        SELF_VISIBLE = 1 << 0,
+        SUBTREE_VISIBLE = 1 << 1,
+        ALL_VISIBLE = SELF_VISIBLE | SUBTREE_VISIBLE,
     };
-    
+
     struct LevelInfo{
+        NodeProxy* node = nullptr;
+        // Index of the parent in the upper level, NODE_INDEX_INVALID for a root.
+        std::size_t parent = NODE_INDEX_INVALID;
         uint32_t* dirty = nullptr;
-        uint32_t* parentDirty = nullptr;
-        cocos2d::Mat4* parentWorldMat = nullptr;
-        uint8_t* parentRealOpacity = nullptr;
         cocos2d::Mat4* localMat = nullptr;
         cocos2d::Mat4* worldMat = nullptr;
         uint8_t* opacity = nullptr;
@@ -122,6 +123,56 @@ public:
      *  @brief Gets the render Scene which manages all render Models.
      */
     Scene* getRenderScene() const { return _scene; };
+    /*
+     *  @brief Gets the ForwardRenderer which renders the Models.
+     */
+    ForwardRenderer* getForward() const { return _forward; };
+    /*
+     *  @brief Gets the DynamicAtlas which packs small textures into shared pages.
+     */
+    DynamicAtlas* getDynamicAtlas() const { return _atlas; };
+    /*
+     *  @brief Records the device commands of each frame into a CommandBuffer before executing them.
+     */
+    void setCommandRecording(bool enabled);
+    /*
+     *  @brief Gets the commands of the last rendered frame, nullptr if command recording is disabled.
+     */
+    const CommandBuffer* getCommandBuffer() const { return _commandBuffer; };
+    /*
+     *  @brief Skips render nodes whose bounds are outside of every camera that renders them.
+     */
+    void setCullingEnabled(bool enabled) { _cullingEnabled = enabled; };
+    /*
+     *  @brief Whether visibility culling is enabled.
+     */
+    bool isCullingEnabled() const { return _cullingEnabled; };
+    /*
+     *  @brief Gets the count of render nodes culled in the last frame.
+     */
+    uint32_t getCulledNodeCount() const { return _culledNodeCount; };
+    /*
+     *  @brief Gets the count of render nodes which passed culling in the last frame.
+     */
+    uint32_t getSubmittedNodeCount() const { return _submittedNodeCount; };
+    /*
+     *  @brief Gets the NodeVisibility flags of a node in the current frame, ALL_VISIBLE if culling didn't run.
+     *  @param[in] level Node level.
+     *  @param[in] index Index of the node in the level.
+     */
+    uint8_t getVisibility(std::size_t level, std::size_t index) const
+    {
+        if (!_visibilityValid || level >= _levels.size()) return ALL_VISIBLE;
+        const auto& visibilities = _levels[level].visibilities;
+        return index < visibilities.size() ? visibilities[index] : (uint8_t)ALL_VISIBLE;
+    };
+    /*
+     *  @brief Gets the fraction of the screen covered by the bounds of a node and its subtree in the current frame,
+     *  the largest one over the cameras which render it. 1 if culling didn't run or the bounds are unknown.
+     *  @param[in] level Node level.
+     *  @param[in] index Index of the node in the level.
+     */
+    float getScreenCoverage(std::size_t level, std::size_t index) const;
     /**
      *  @brief Render the scene specified by its root node.
      *  @param[in] scene The root node.
@@ -133,27 +184,36 @@ public:
     void visit(NodeProxy* rootNode);
     /**
      *  @brief Calculate local matrix.
-     *  @param[in] tid It must rather than -1 if enable multiple thread.
+     *  @param[in] begin First unit index of the common list.
+     *  @param[in] end One past the last unit index, the whole list is used if it is out of range.
      */
-    void calculateLocalMatrix(int tid = -1);
+    void calculateLocalMatrix(std::size_t begin = 0, std::size_t end = SIZE_MAX);
     /**
      *  @brief Calculate world matrix.
      */
     void calculateWorldMatrix();
     /**
      *  @brief Calculate world matrix by level.
-     *  @param[in] tid Thread id.
-     *  @param[level] level Node level.
+     *  @param[in] level Node level.
+     *  @param[in] begin First node index of the level.
+     *  @param[in] end One past the last node index, the whole level is used if it is out of range.
+     */
+    void calculateLevelWorldMatrix(std::size_t level, std::size_t begin = 0, std::size_t end = SIZE_MAX);
+    /**
+     *  @brief Computes the world bounds of every node and subtree after the world matrix pass, and tests them against the cameras of the render scene.
      */
-    void calculateLevelWorldMatrix(int tid = -1, int stage = -1);
+    void calculateVisibility();
     /**
-     *  @brief remove node level
+     *  @brief Removes a node from its level, the last node of the level is moved into its place.
+     *  @param[in] level Node level.
+     *  @param[in] index Index of the node in the level.
      */
-    void removeNodeLevel(std::size_t level, cocos2d::Mat4* worldMat);
+    void removeNodeLevel(std::size_t level, std::size_t index);
     /**
-     *  @brief insert node level
+     *  @brief Appends a node to a level.
+     *  @return The index of the node in the level.
      */
-    void insertNodeLevel(std::size_t level, const LevelInfo& levelInfo);
+    std::size_t insertNodeLevel(std::size_t level, const LevelInfo& levelInfo);
 private:
     
     static RenderFlow *_instance;
@@ -162,10 +222,78 @@ private:
     Scene* _scene = nullptr;
     DeviceGraphics* _device = nullptr;
     ForwardRenderer* _forward = nullptr;
-    std::size_t _curLevel = 0;
-    std::vector<std::vector<LevelInfo>> _levelInfoArr;
+    DynamicAtlas* _atlas = nullptr;
+    CommandBuffer* _commandBuffer = nullptr;
+    
+    /*
+     *  Nodes of the same depth stored as parallel arrays, so that the world matrix
+     *  pass walks each field linearly and finds parents by index in the upper level.
+     */
+    struct NodeLevel
+    {
+        std::vector<NodeProxy*> nodes;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t*> dirties;
+        std::vector<cocos2d::Mat4*> localMats;
+        std::vector<cocos2d::Mat4*> worldMats;
+        std::vector<uint8_t*> opacities;
+        std::vector<uint8_t*> realOpacities;
+        // WORLD_TRANSFORM_CHANGED and NODE_OPACITY_CHANGED of each node in the current frame, read by the lower level.
+        std::vector<uint32_t> changes;
+        // Rebuilt by calculateVisibility every frame.
+        std::vector<cocos2d::Vec3> boundsMin;
+        std::vector<cocos2d::Vec3> boundsMax;
+        std::vector<int> subtreeMasks;
+        std::vector<uint8_t> visibilities;
+        
+        std::size_t size() const { return nodes.size(); }
+        void reserve(std::size_t count);
+        void push(const LevelInfo& info);
+        void swapRemove(std::size_t index);
+    };
+    std::vector<NodeLevel> _levels;
+    
+    /*
+     *  Frustum planes of a camera, a point p is inside if dot(plane.xyz, p) + plane.w >= 0 for all of them.
+     */
+    struct CullingView
+    {
+        cocos2d::Vec4 planes[6];
+        cocos2d::Mat4 viewProj;
+        int cullingMask = 0;
+        
+        bool isVisible(const cocos2d::Vec3& min, const cocos2d::Vec3& max) const;
+    };
+    std::vector<CullingView> _cullingViews;
+    bool _cullingEnabled = true;
+    bool _visibilityValid = false;
+    uint32_t _culledNodeCount = 0;
+    uint32_t _submittedNodeCount = 0;
 
-    ParallelStage _parallelStage = ParallelStage::NONE;
+    /*
+     *  Measured cost of a parallel stage, decides at runtime whether
+     *  a job is large enough to be worth dispatching to the workers.
+     */
+    struct StageCost
+    {
+        // Average serial cost of a single item in nanoseconds.
+        float itemNs = 0.0f;
+        // Average fixed cost of dispatching a job in nanoseconds.
+        float dispatchNs = 20000.0f;
+        // Parallel runs since the last serial sample.
+        uint32_t parallelRuns = 0;
+        
+        bool useParallel(std::size_t count, int concurrency) const;
+        void recordSerial(std::size_t count, float elapsedNs);
+        void recordParallel(std::size_t count, int concurrency, float elapsedNs);
+        void decay();
+    };
+    
+    template<typename Serial, typename Parallel>
+    void runStage(StageCost& cost, std::size_t count, std::size_t chunkSize, const Serial& serial, const Parallel& parallel);
+    
+    StageCost _localMatCost;
+    StageCost _worldMatCost;
     ParallelTask* _paralleTask = nullptr;
 };
 
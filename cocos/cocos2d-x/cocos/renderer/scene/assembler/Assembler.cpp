@@ -24,6 +24,9 @@
 
 #include "Assembler.hpp"
 
+#include <float.h>
+#include <algorithm>
+
 #include "../NodeProxy.hpp"
 #include "../ModelBatcher.hpp"
 #include "../MeshBuffer.hpp"
@@ -48,6 +51,9 @@ Assembler::IARenderData::IARenderData(const IARenderData& o)
     verticesCount = o.verticesCount;
     indicesStart = o.indicesStart;
     indicesCount = o.indicesCount;
+    atlasKey = o.atlasKey;
+    atlased = o.atlased;
+    atlasFrame = o.atlasFrame;
     setEffect(o.getEffect());
 }
 
@@ -88,6 +94,7 @@ void Assembler::updateMeshIndex(std::size_t iaIndex, int meshIndex)
     }
     IARenderData& ia = _iaDatas[iaIndex];
     ia.meshIndex = meshIndex;
+    ia.fillRecord = MeshBuffer::FillRecord();
 }
 
 void Assembler::updateIndicesRange(std::size_t iaIndex, int start, int count)
@@ -99,6 +106,7 @@ void Assembler::updateIndicesRange(std::size_t iaIndex, int start, int count)
     IARenderData& ia = _iaDatas[iaIndex];
     ia.indicesStart = start;
     ia.indicesCount = count;
+    ia.fillRecord = MeshBuffer::FillRecord();
 }
 
 void Assembler::updateVerticesRange(std::size_t iaIndex, int start, int count)
@@ -110,6 +118,7 @@ void Assembler::updateVerticesRange(std::size_t iaIndex, int start, int count)
     IARenderData& ia = _iaDatas[iaIndex];
     ia.verticesStart = start;
     ia.verticesCount = count;
+    ia.fillRecord = MeshBuffer::FillRecord();
 }
 
 void Assembler::updateEffect(std::size_t iaIndex, Effect* effect)
@@ -122,6 +131,94 @@ void Assembler::updateEffect(std::size_t iaIndex, Effect* effect)
     ia.setEffect(effect);
 }
 
+void Assembler::setAtlasKey(std::size_t iaIndex, uint32_t key)
+{
+    if (iaIndex >= _iaDatas.size())
+    {
+        _iaDatas.resize(iaIndex + 1);
+    }
+    IARenderData& ia = _iaDatas[iaIndex];
+    ia.atlasKey = key;
+}
+
+void Assembler::updateAtlasFrame(std::size_t index, const DynamicAtlas::Frame* frame)
+{
+    IARenderData& ia = _iaDatas[index];
+    bool atlased = frame != nullptr;
+    if (atlased == ia.atlased && (!atlased || *frame == ia.atlasFrame))
+    {
+        return;
+    }
+    
+    ia.atlased = atlased;
+    if (atlased)
+    {
+        ia.atlasFrame = *frame;
+    }
+    // Vertices retained in the mesh buffer were remapped into the previous frame.
+    ia.fillRecord = MeshBuffer::FillRecord();
+}
+
+void Assembler::remapAtlasUV(std::size_t index, float* vertices, uint32_t vertexCount, uint32_t bytesPerVertex) const
+{
+    const IARenderData& ia = _iaDatas[index];
+    if (!ia.atlased || !_vfUv || _vfUv->type != AttribType::FLOAT32)
+    {
+        return;
+    }
+    
+    const float* rect = ia.atlasFrame.uvRect;
+    size_t dataPerVertex = (bytesPerVertex > 0 ? bytesPerVertex : _bytesPerVertex) / sizeof(float);
+    float* uv = vertices + _vfUv->offset / sizeof(float);
+    for (uint32_t i = 0; i < vertexCount; ++i, uv += dataPerVertex)
+    {
+        uv[0] = rect[0] + uv[0] * rect[2];
+        uv[1] = rect[1] + uv[1] * rect[3];
+    }
+}
+
+bool Assembler::getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const
+{
+    if (!_datas || !_vfmt || _ignoreWorldMatrix)
+    {
+        return false;
+    }
+    
+    min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    uint32_t num = _vfPos->num;
+    size_t dataPerVertex = _bytesPerVertex / sizeof(float);
+    
+    for (std::size_t index = 0, count = _iaDatas.size(); index < count; index++)
+    {
+        const IARenderData& ia = _iaDatas[index];
+        std::size_t meshIndex = ia.meshIndex >= 0 ? ia.meshIndex : index;
+        RenderData* data = _datas->getRenderData(meshIndex);
+        if (!data) continue;
+        
+        uint32_t vertexCount = ia.verticesCount >= 0 ? (uint32_t)ia.verticesCount : (uint32_t)data->getVBytes() / _bytesPerVertex;
+        const float* pos = (const float*)(data->getVertices() + ia.verticesStart * _bytesPerVertex) + _posOffset;
+        for (uint32_t i = 0; i < vertexCount; ++i, pos += dataPerVertex)
+        {
+            min.x = std::min(min.x, pos[0]);
+            min.y = std::min(min.y, pos[1]);
+            max.x = std::max(max.x, pos[0]);
+            max.y = std::max(max.y, pos[1]);
+            if (num > 2)
+            {
+                min.z = std::min(min.z, pos[2]);
+                max.z = std::max(max.z, pos[2]);
+            }
+        }
+    }
+    
+    if (num <= 2 && min.x <= max.x)
+    {
+        min.z = max.z = 0;
+    }
+    return true;
+}
+
 void Assembler::reset()
 {
     _iaDatas.clear();
@@ -162,6 +259,7 @@ void Assembler::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t ind
 
     float* worldVerts = buffer->vData + vBufferOffset;
     memcpy(worldVerts, data->getVertices() + vertexStart * _bytesPerVertex, vertexCount * _bytesPerVertex);
+    remapAtlasUV(index, worldVerts, vertexCount);
     
     if (!_useModel && !_ignoreWorldMatrix)
     {
@@ -171,21 +269,10 @@ void Assembler::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t ind
         
         switch (num) {
             case 3:
-                for (uint32_t i = 0; i < vertexCount; ++i)
-                {
-                    ((cocos2d::Vec3*)ptrPos)->transformMat4(*((cocos2d::Vec3*)ptrPos), worldMat);
-                    ptrPos += dataPerVertex;
-                }
+                MathUtil::transformVec3Batch(worldMat.m, ptrPos, vertexCount, dataPerVertex);
                 break;
             case 2:
-                for (uint32_t i = 0; i < vertexCount; ++i)
-                {
-                    float z = ptrPos[2];
-                    ptrPos[2] = 0;
-                    worldMat.transformPoint((cocos2d::Vec3*)ptrPos);
-                    ptrPos[2] = z;
-                    ptrPos += dataPerVertex;
-                }
+                MathUtil::transformVec2Batch(worldMat.m, ptrPos, vertexCount, dataPerVertex);
                 break;
         }
     }
@@ -198,6 +285,59 @@ void Assembler::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t ind
     }
 }
 
+void Assembler::fillPalette(NodeProxy* node, MeshBuffer* buffer, std::size_t index, uint32_t slot)
+{
+    if(!_datas || !_vfmt)
+    {
+        return;
+    }
+    
+    IARenderData& ia = _iaDatas[index];
+    std::size_t meshIndex = ia.meshIndex >= 0 ? ia.meshIndex : index;
+    
+    RenderData* data = _datas->getRenderData(meshIndex);
+    if (!data)
+    {
+        return;
+    }
+    
+    CCASSERT(data->getVBytes() % _bytesPerVertex == 0, "Assembler::fillPalette vertices data doesn't follow vertex format");
+    uint32_t vertexCount = ia.verticesCount >= 0 ? (uint32_t)ia.verticesCount : (uint32_t)data->getVBytes() / _bytesPerVertex;
+    uint32_t indexCount = ia.indicesCount >= 0 ? (uint32_t)ia.indicesCount : (uint32_t)data->getIBytes() / sizeof(unsigned short);
+    uint32_t vertexStart = (uint32_t)ia.verticesStart;
+    
+    auto& bufferOffset = buffer->request(vertexCount, indexCount);
+    uint32_t indexId = bufferOffset.index;
+    uint32_t vertexOffset = bufferOffset.vertex - vertexStart;
+    
+    // Local vertices don't change with the node transform, only with the render data or the slot.
+    bool retained = buffer->retainRange(ia.fillRecord, bufferOffset);
+    if (retained && _verticesTracked && ia.paletteSlot == (int)slot)
+    {
+        return;
+    }
+    ia.paletteSlot = (int)slot;
+    
+    uint32_t paletteBytesPerVertex = buffer->_vertexFmt->getBytes();
+    float* paletteVerts = buffer->vData + bufferOffset.vByte / sizeof(float);
+    const uint8_t* src = data->getVertices() + vertexStart * _bytesPerVertex;
+    uint8_t* dstVert = (uint8_t*)paletteVerts;
+    float slotValue = (float)slot;
+    for (uint32_t i = 0; i < vertexCount; ++i, src += _bytesPerVertex, dstVert += paletteBytesPerVertex)
+    {
+        memcpy(dstVert, src, _bytesPerVertex);
+        memcpy(dstVert + _bytesPerVertex, &slotValue, sizeof(float));
+    }
+    remapAtlasUV(index, paletteVerts, vertexCount, paletteBytesPerVertex);
+    
+    uint16_t* indices = (uint16_t*)data->getIndices();
+    uint16_t* dst = buffer->iData;
+    for (auto i = 0, j = ia.indicesStart; i < indexCount; ++i, ++j)
+    {
+        dst[indexId++] = vertexOffset + indices[j];
+    }
+}
+
 void Assembler::setVertexFormat(VertexFormat* vfmt)
 {
     if (_vfmt == vfmt) return;
@@ -209,7 +349,10 @@ void Assembler::setVertexFormat(VertexFormat* vfmt)
         _bytesPerVertex = _vfmt->getBytes();
         _vfPos = _vfmt->getElement(ATTRIB_NAME_POSITION);
         _posOffset = _vfPos->offset / 4;
+        _vfUv = _vfmt->getElement(ATTRIB_NAME_UV0);
         _vfColor = _vfmt->getElement(ATTRIB_NAME_COLOR);
+        // The palette program transforms 2D positions only.
+        _paletteable = _vfPos && _vfPos->type == AttribType::FLOAT32 && _vfPos->num == 2;
         if (_vfColor != nullptr)
         {
             _alphaOffset = _vfColor->offset + 3;
@@ -223,6 +366,15 @@ void Assembler::setRenderDataList(RenderDataList* datas)
     CC_SAFE_RELEASE(_datas);
     _datas = datas;
     CC_SAFE_RETAIN(_datas);
+    resetFillRecords();
+}
+
+void Assembler::resetFillRecords()
+{
+    for (auto& ia : _iaDatas)
+    {
+        ia.fillRecord = MeshBuffer::FillRecord();
+    }
 }
 
 void Assembler::updateOpacity(std::size_t index, uint8_t opacity)
@@ -232,7 +384,8 @@ void Assembler::updateOpacity(std::size_t index, uint8_t opacity)
         return;
     }
     
-    const IARenderData& ia = _iaDatas[index];
+    IARenderData& ia = _iaDatas[index];
+    ia.fillRecord = MeshBuffer::FillRecord();
     std::size_t meshIndex = ia.meshIndex >= 0 ? ia.meshIndex : index;
     
     RenderData* data = _datas->getRenderData(meshIndex);
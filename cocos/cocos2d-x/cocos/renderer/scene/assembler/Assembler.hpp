@@ -27,6 +27,8 @@
 #include "../../Macro.h"
 #include "AssemblerBase.hpp"
 #include "../MeshBuffer.hpp"
+#include "../InstanceBuffer.hpp"
+#include "../DynamicAtlas.hpp"
 #include "math/CCMath.h"
 #include "../../renderer/Effect.h"
 #include "RenderDataList.hpp"
@@ -66,6 +68,12 @@ public:
         int verticesCount = -1;
         int indicesStart = 0;
         int indicesCount = -1;
+        MeshBuffer::FillRecord fillRecord;
+        int paletteSlot = -1;
+        
+        uint32_t atlasKey = 0;
+        bool atlased = false;
+        DynamicAtlas::Frame atlasFrame;
     };
     
     Assembler();
@@ -89,6 +97,29 @@ public:
      *  @param[in] node
      */
     virtual void fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t index);
+    /*
+     *  @brief Whether render data in given index can be drawn as an instance of the unit quad
+     */
+    virtual bool isInstanceable(std::size_t index) const { return false; }
+    /*
+     *  @brief Fills render data in given index to the InstanceBuffer, only invoked if isInstanceable returns true
+     *  @param[in] buffer The shared instance buffer
+     *  @param[in] index The index of render data to be updated
+     *  @param[in] node
+     */
+    virtual void fillInstance(NodeProxy* node, InstanceBuffer* buffer, std::size_t index) {}
+    /*
+     *  @brief Whether render data in given index can be drawn in a palette batch, which requires its vertices in local space
+     */
+    virtual bool isPaletteable(std::size_t index) const { return _paletteable; }
+    /*
+     *  @brief Fills render data in given index to the MeshBuffer of a palette batch, the vertices are kept in local space and tagged with the node slot
+     *  @param[in] buffer The mesh buffer in the palette vertex format
+     *  @param[in] index The index of render data to be updated
+     *  @param[in] slot The slot of the node in the MatrixPalette
+     *  @param[in] node
+     */
+    virtual void fillPalette(NodeProxy* node, MeshBuffer* buffer, std::size_t index, uint32_t slot);
     
     /**
      *  @brief Sets IArenderDataList
@@ -154,6 +185,29 @@ public:
      */
     virtual void updateEffect(std::size_t iaIndex, Effect* effect);
     
+    /**
+     *  @brief Sets the key of the DynamicAtlas frame which replaces the texture of the given render data.
+     *  @param[in] iaIndex Render data index.
+     *  @param[in] key Frame key, 0 to use the texture of the effect.
+     */
+    void setAtlasKey(std::size_t iaIndex, uint32_t key);
+    /**
+     *  @brief Gets the DynamicAtlas frame key of the given render data.
+     */
+    inline uint32_t getAtlasKey(std::size_t index) const
+    {
+        return index < _iaDatas.size() ? _iaDatas[index].atlasKey : 0;
+    }
+    /**
+     *  @brief Updates the atlas frame the given render data is drawn with, the uv are remapped into it while filling buffers.
+     *  @param[in] index Render data index.
+     *  @param[in] frame The resident frame, nullptr if the render data uses its own texture.
+     */
+    void updateAtlasFrame(std::size_t index, const DynamicAtlas::Frame* frame);
+    /**
+     *  @brief Gets the bounds of all render datas, false if the vertices are in world space already.
+     */
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const override;
     /**
      *  @brief Resets ia data.
      */
@@ -182,9 +236,19 @@ public:
         return _iaDatas.size();
     }
     
+    /**
+     *  @brief Forces the render datas to be filled into the mesh buffer again in the next frame.
+     */
+    virtual void resetFillRecords() override;
+    
     inline void setCustomProperties(CustomProperties* customProp) { _customProp = customProp;};
     inline CustomProperties* getCustomProperties() { return _customProp;};
 protected:
+    /*
+     *  @brief Remaps the uv of filled vertices into the atlas frame of the given render data.
+     */
+    void remapAtlasUV(std::size_t index, float* vertices, uint32_t vertexCount, uint32_t bytesPerVertex = 0) const;
+    
     RenderDataList* _datas = nullptr;
     std::vector<IARenderData> _iaDatas;
     
@@ -194,9 +258,13 @@ protected:
     VertexFormat* _vfmt = nullptr;
     const VertexFormat::Element* _vfPos = nullptr;
     const VertexFormat::Element* _vfColor = nullptr;
+    const VertexFormat::Element* _vfUv = nullptr;
     
     bool _ignoreWorldMatrix = false;
     bool _ignoreOpacityFlag = false;
+    bool _paletteable = false;
+    // Whether every change of the render datas is flagged by VERTICES_DIRTY, so that unchanged vertices can be kept in the mesh buffer.
+    bool _verticesTracked = false;
     
     CustomProperties* _customProp = nullptr;
 };
@@ -27,6 +27,7 @@
 #include "../../Macro.h"
 #include <stdint.h>
 #include "base/CCVector.h"
+#include "math/Vec3.h"
 #include "../../renderer/Effect.h"
 #include "scripting/js-bindings/jswrapper/Object.hpp"
 
@@ -128,6 +129,17 @@ public:
         return false;
     }
     
+    /**
+     *  @brief Gets the bounds of the vertices before the node world transform is applied, used by visibility culling.
+     *  @return false if the bounds are unknown, the node is never culled then.
+     */
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const { return false; }
+    
+    /**
+     *  @brief Forgets the vertices kept in the mesh buffers, so that they are filled again in the next frame.
+     */
+    virtual void resetFillRecords() {}
+    
     /**
      *  @brief Resets data.
      */
@@ -23,13 +23,16 @@
  ****************************************************************************/
 
 #include "AssemblerSprite.hpp"
+
+#include <algorithm>
 #include "../RenderFlow.hpp"
+#include "math/MathUtil.h"
 
 RENDERER_BEGIN
 
 AssemblerSprite::AssemblerSprite()
 {
-    
+    _verticesTracked = true;
 }
 
 AssemblerSprite::~AssemblerSprite()
@@ -92,14 +95,22 @@ void AssemblerSprite::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size
     uint32_t vertexId = bufferOffset.vertex;
     uint32_t vertexOffset = vertexId - vertexStart;
     
-    if (*_dirty & VERTICES_DIRTY || node->isDirty(RenderFlow::WORLD_TRANSFORM_CHANGED | RenderFlow::NODE_OPACITY_CHANGED))
+    if (*_dirty & VERTICES_DIRTY || _localVertices || node->isDirty(RenderFlow::WORLD_TRANSFORM_CHANGED | RenderFlow::NODE_OPACITY_CHANGED))
     {
         generateWorldVertices();
         calculateWorldVertices(node->getWorldMatrix());
+        resetFillRecords();
+    }
+    
+    // The range still holds what was filled last frame.
+    if (buffer->retainRange(_iaDatas[index].fillRecord, bufferOffset))
+    {
+        return;
     }
     
     float* dstWorldVerts = buffer->vData + vBufferOffset;
     memcpy(dstWorldVerts, data->getVertices() + vertexStart * _bytesPerVertex, vertexCount * _bytesPerVertex);
+    remapAtlasUV(index, dstWorldVerts, vertexCount);
     
     uint16_t* srcIndices = (uint16_t*)data->getIndices();
     uint16_t* dstIndices = buffer->iData;
@@ -109,6 +120,46 @@ void AssemblerSprite::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size
     }
 }
 
+void AssemblerSprite::fillPalette(NodeProxy* node, MeshBuffer* buffer, std::size_t index, uint32_t slot)
+{
+    if(!_datas || !_vfmt)
+    {
+        return;
+    }
+    
+    // The node transform is applied by the palette, so only vertex changes require generating them again.
+    if (*_dirty & VERTICES_DIRTY || !_localVertices)
+    {
+        generateWorldVertices();
+        *_dirty &= ~VERTICES_DIRTY;
+        _localVertices = true;
+        resetFillRecords();
+    }
+    
+    Assembler::fillPalette(node, buffer, index, slot);
+}
+
+bool AssemblerSprite::getLocalDataBounds(std::size_t pairCount, cocos2d::Vec3& min, cocos2d::Vec3& max) const
+{
+    if (!_localData || _localLen < pairCount * 2 * sizeof(float))
+    {
+        return false;
+    }
+    
+    min.set(_localData[0], _localData[1], 0);
+    max.set(_localData[0], _localData[1], 0);
+    for (std::size_t i = 1; i < pairCount; i++)
+    {
+        float x = _localData[i * 2];
+        float y = _localData[i * 2 + 1];
+        min.x = std::min(min.x, x);
+        min.y = std::min(min.y, y);
+        max.x = std::max(max.x, x);
+        max.y = std::max(max.y, y);
+    }
+    return true;
+}
+
 void AssemblerSprite::calculateWorldVertices(const Mat4& worldMat)
 {
     if(!_datas || !_vfmt)
@@ -132,25 +183,15 @@ void AssemblerSprite::calculateWorldVertices(const Mat4& worldMat)
         
         switch (num) {
             case 3:
-                for (uint32_t i = 0; i < vertexCount; ++i)
-                {
-                    ((cocos2d::Vec3*)srcWorldVerts)->transformMat4(*((cocos2d::Vec3*)srcWorldVerts), worldMat);
-                    srcWorldVerts += dataPerVertex;
-                }
+                MathUtil::transformVec3Batch(worldMat.m, srcWorldVerts, vertexCount, dataPerVertex);
                 break;
             case 2:
-                for (uint32_t i = 0; i < vertexCount; ++i)
-                {
-                    float z = srcWorldVerts[2];
-                    srcWorldVerts[2] = 0;
-                    worldMat.transformPoint((cocos2d::Vec3*)srcWorldVerts);
-                    srcWorldVerts[2] = z;
-                    srcWorldVerts += dataPerVertex;
-                }
+                MathUtil::transformVec2Batch(worldMat.m, srcWorldVerts, vertexCount, dataPerVertex);
                 break;
         }
     }
     
     *_dirty &= ~VERTICES_DIRTY;
+    _localVertices = false;
 }
 RENDERER_END
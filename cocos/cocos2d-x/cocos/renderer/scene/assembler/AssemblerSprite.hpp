@@ -39,10 +39,26 @@ public:
     virtual void fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t index) override;
     virtual void calculateWorldVertices(const Mat4& worldMat);
     virtual void generateWorldVertices() {};
+    /*
+     *  @brief Only sprites which generate their vertices from local data can be drawn in palette batches.
+     */
+    virtual bool isPaletteable(std::size_t index) const override { return false; }
+    virtual void fillPalette(NodeProxy* node, MeshBuffer* buffer, std::size_t index, uint32_t slot) override;
+    /*
+     *  @brief The render data may hold world vertices, only sprites which know their local data report bounds.
+     */
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const override { return false; }
 protected:
+    /*
+     *  @brief Gets the bounds of the first pairCount x, y pairs of the local data.
+     */
+    bool getLocalDataBounds(std::size_t pairCount, cocos2d::Vec3& min, cocos2d::Vec3& max) const;
+    
     se::Object* _localObj = nullptr;
     float* _localData = nullptr;
     std::size_t _localLen = 0;
+    // Whether the render data holds the generated local vertices instead of world vertices.
+    bool _localVertices = false;
 };
 
 RENDERER_END
@@ -121,10 +121,41 @@ public:
     {
         _effects.clear();
     }
+    
+    /**
+     *  @brief Sets the bounds of the vertices in node space, e.g. of the last rendered pose, so that the node can be culled.
+     *  They are kept across reset until cleared.
+     */
+    void setLocalBounds(const cocos2d::Vec3& min, const cocos2d::Vec3& max)
+    {
+        _localMin = min;
+        _localMax = max;
+        _hasLocalBounds = true;
+    }
+    /**
+     *  @brief Clears the bounds, the node is never culled then.
+     */
+    void clearLocalBounds()
+    {
+        _hasLocalBounds = false;
+    }
+    /**
+     *  @brief Gets the bounds set by setLocalBounds.
+     */
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const override
+    {
+        if (!_hasLocalBounds) return false;
+        min = _localMin;
+        max = _localMax;
+        return true;
+    }
 protected:
     std::vector<cocos2d::renderer::InputAssembler*> _iaPool;
     cocos2d::Vector<Effect*> _effects;
     std::size_t _iaCount = 0;
+    cocos2d::Vec3 _localMin;
+    cocos2d::Vec3 _localMax;
+    bool _hasLocalBounds = false;
 };
 
 
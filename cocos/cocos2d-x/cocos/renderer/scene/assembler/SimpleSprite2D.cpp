@@ -24,6 +24,7 @@
 
 #include "SimpleSprite2D.hpp"
 #include "../RenderFlow.hpp"
+#include "math/MathUtil.h"
 
 RENDERER_BEGIN
 
@@ -50,41 +51,29 @@ void SimpleSprite2D::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_
     uint32_t indexId = bufferOffset.index;
     uint32_t vertexId = bufferOffset.vertex;
     
-    if (*_dirty & VERTICES_DIRTY || node->isDirty(RenderFlow::WORLD_TRANSFORM_CHANGED | RenderFlow::NODE_OPACITY_CHANGED))
+    if (*_dirty & VERTICES_DIRTY || _localVertices || node->isDirty(RenderFlow::WORLD_TRANSFORM_CHANGED | RenderFlow::NODE_OPACITY_CHANGED))
     {
-        float vl = _localData[0],
-        vr = _localData[2],
-        vb = _localData[1],
-        vt = _localData[3];
-        
         const Mat4& worldMat = node->getWorldMatrix();
         size_t dataPerVertex = _bytesPerVertex / sizeof(float);
         float* srcWorldVerts = (float*)data->getVertices();
         
-        float u = srcWorldVerts[2];
-        worldMat.transformVector(vl, vb, 0.0f, 1.0f, (cocos2d::Vec3*)srcWorldVerts);
-        srcWorldVerts[2] = u;
-
-        srcWorldVerts += dataPerVertex;
-        u = srcWorldVerts[2];
-        worldMat.transformVector(vr, vb, 0.0f, 1.0f, (cocos2d::Vec3*)srcWorldVerts);
-        srcWorldVerts[2] = u;
-
-        srcWorldVerts += dataPerVertex;
-        u = srcWorldVerts[2];
-        worldMat.transformVector(vl, vt, 0.0f, 1.0f, (cocos2d::Vec3*)srcWorldVerts);
-        srcWorldVerts[2] = u;
-
-        srcWorldVerts += dataPerVertex;
-        u = srcWorldVerts[2];
-        worldMat.transformVector(vr, vt, 0.0f, 1.0f, (cocos2d::Vec3*)srcWorldVerts);
-        srcWorldVerts[2] = u;
+        generateWorldVertices();
+        MathUtil::transformVec2Batch(worldMat.m, srcWorldVerts, 4, dataPerVertex);
         
         *_dirty &= ~VERTICES_DIRTY;
+        _localVertices = false;
+        resetFillRecords();
+    }
+    
+    // The range still holds what was filled last frame.
+    if (buffer->retainRange(_iaDatas[index].fillRecord, bufferOffset))
+    {
+        return;
     }
     
     float* dstWorldVerts = buffer->vData + vBufferOffset;
     memcpy(dstWorldVerts, data->getVertices(), 4 * _bytesPerVertex);
+    remapAtlasUV(index, dstWorldVerts, 4);
 
     uint16_t* srcIndices = (uint16_t*)data->getIndices();
     uint16_t* dstIndices = buffer->iData;
@@ -94,4 +83,108 @@ void SimpleSprite2D::fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_
     }
 }
 
+void SimpleSprite2D::generateWorldVertices()
+{
+    RenderData* data = _datas->getRenderData(0);
+    float vl = _localData[0],
+    vr = _localData[2],
+    vb = _localData[1],
+    vt = _localData[3];
+    
+    size_t dataPerVertex = _bytesPerVertex / sizeof(float);
+    float* verts = (float*)data->getVertices();
+    
+    verts[0] = vl;
+    verts[1] = vb;
+    verts[dataPerVertex] = vr;
+    verts[dataPerVertex + 1] = vb;
+    verts[dataPerVertex * 2] = vl;
+    verts[dataPerVertex * 2 + 1] = vt;
+    verts[dataPerVertex * 3] = vr;
+    verts[dataPerVertex * 3 + 1] = vt;
+}
+
+void SimpleSprite2D::setVertexFormat(VertexFormat* vfmt)
+{
+    AssemblerSprite::setVertexFormat(vfmt);
+    
+    // The instanced program only knows the layout of 2D position, uv and packed color.
+    _instanceable = _vfmt && _vfmt->getAttributeNames().size() == 3 &&
+                    _vfPos && _vfPos->type == AttribType::FLOAT32 && _vfPos->num == 2 &&
+                    _vfUv && _vfUv->type == AttribType::FLOAT32 && _vfUv->num == 2 &&
+                    _vfColor && _vfColor->type == AttribType::UINT8 && _vfColor->num == 4;
+}
+
+bool SimpleSprite2D::isInstanceable(std::size_t index) const
+{
+    return _instanceable && _localData;
+}
+
+bool SimpleSprite2D::isPaletteable(std::size_t index) const
+{
+    return _localData && Assembler::isPaletteable(index);
+}
+
+bool SimpleSprite2D::getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const
+{
+    // Left bottom and right top corners.
+    return getLocalDataBounds(2, min, max);
+}
+
+void SimpleSprite2D::fillInstance(NodeProxy* node, InstanceBuffer* buffer, std::size_t index)
+{
+    RenderData* data = _datas->getRenderData(0);
+    if (!data)
+    {
+        return;
+    }
+    
+    float vl = _localData[0],
+    vr = _localData[2],
+    vb = _localData[1],
+    vt = _localData[3];
+    float w = vr - vl;
+    float h = vt - vb;
+    const float* m = node->getWorldMatrix().m;
+    
+    // Vertices are ordered as left bottom, right bottom, left top and right top.
+    const uint8_t* verts = data->getVertices();
+    const float* uv0 = (const float*)(verts + _vfUv->offset);
+    const float* uv1 = (const float*)(verts + _bytesPerVertex + _vfUv->offset);
+    const float* uv2 = (const float*)(verts + _bytesPerVertex * 2 + _vfUv->offset);
+    
+    InstanceBuffer::Record* record = buffer->request(1);
+    record->matrix[0] = m[0] * w;
+    record->matrix[1] = m[1] * w;
+    record->matrix[2] = m[4] * h;
+    record->matrix[3] = m[5] * h;
+    record->translateUv[0] = m[0] * vl + m[4] * vb + m[12];
+    record->translateUv[1] = m[1] * vl + m[5] * vb + m[13];
+    record->translateUv[2] = uv0[0];
+    record->translateUv[3] = uv0[1];
+    record->uvAxes[0] = uv1[0] - uv0[0];
+    record->uvAxes[1] = uv1[1] - uv0[1];
+    record->uvAxes[2] = uv2[0] - uv0[0];
+    record->uvAxes[3] = uv2[1] - uv0[1];
+    memcpy(&record->color, verts + _vfColor->offset, sizeof(uint32_t));
+    
+    const IARenderData& ia = _iaDatas[index];
+    if (ia.atlased)
+    {
+        const float* rect = ia.atlasFrame.uvRect;
+        record->translateUv[2] = rect[0] + record->translateUv[2] * rect[2];
+        record->translateUv[3] = rect[1] + record->translateUv[3] * rect[3];
+        record->uvAxes[0] *= rect[2];
+        record->uvAxes[1] *= rect[3];
+        record->uvAxes[2] *= rect[2];
+        record->uvAxes[3] *= rect[3];
+    }
+    
+    // World vertices are left untouched, they are recalculated once the sprite is filled to a MeshBuffer again.
+    if (node->isDirty(RenderFlow::WORLD_TRANSFORM_CHANGED))
+    {
+        enableDirty(VERTICES_DIRTY);
+    }
+}
+
 RENDERER_END
@@ -34,6 +34,14 @@ public:
     SimpleSprite2D();
     virtual ~SimpleSprite2D();
     virtual void fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t index) override;
+    virtual void generateWorldVertices() override;
+    virtual void setVertexFormat(VertexFormat* vfmt) override;
+    virtual bool isInstanceable(std::size_t index) const override;
+    virtual void fillInstance(NodeProxy* node, InstanceBuffer* buffer, std::size_t index) override;
+    virtual bool isPaletteable(std::size_t index) const override;
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const override;
+private:
+    bool _instanceable = false;
 };
 
 RENDERER_END
@@ -54,4 +54,15 @@ void SlicedSprite2D::generateWorldVertices()
     }
 }
 
+bool SlicedSprite2D::isPaletteable(std::size_t index) const
+{
+    return _localData && Assembler::isPaletteable(index);
+}
+
+bool SlicedSprite2D::getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const
+{
+    // Positions of the four columns and rows of the nine slices.
+    return getLocalDataBounds(4, min, max);
+}
+
 RENDERER_END
@@ -34,6 +34,8 @@ public:
     SlicedSprite2D();
     virtual ~SlicedSprite2D();
     virtual void generateWorldVertices() override;
+    virtual bool isPaletteable(std::size_t index) const override;
+    virtual bool getLocalBounds(cocos2d::Vec3& min, cocos2d::Vec3& max) const override;
 };
 
 RENDERER_END
@@ -169,6 +169,22 @@ namespace se {
         return createTypedArray(TypedArrayType::UINT8, data, dataCount);
     }
 
+    Object* Object::createExternalArrayBufferObject(void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback)
+    {
+        Object* obj = createArrayBufferObject(data, byteLength);
+        if (releaseCallback != nullptr)
+            releaseCallback(data, byteLength);
+        return obj;
+    }
+
+    Object* Object::createExternalTypedArray(TypedArrayType type, void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback)
+    {
+        Object* obj = createTypedArray(type, data, byteLength);
+        if (releaseCallback != nullptr)
+            releaseCallback(data, byteLength);
+        return obj;
+    }
+
     Object* Object::createJSONObject(const std::string& jsonStr)
     {
         bool ok = false;
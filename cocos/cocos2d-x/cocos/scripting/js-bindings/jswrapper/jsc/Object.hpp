@@ -101,6 +101,31 @@ namespace se {
          */
         static Object* createArrayBufferObject(void* bytes, size_t byteLength);
 
+        using BufferReleaseCallback = std::function<void(void* data, size_t byteLength)>;
+
+        /**
+         *  @brief Creates a JavaScript Array Buffer object over externally owned memory.
+         *  @param[in] data A pointer to the memory, it has to stay valid until releaseCallback is invoked.
+         *  @param[in] byteLength The number of bytes pointed to by the parameter data.
+         *  @param[in] releaseCallback Invoked with data and byteLength once the memory isn't used any more.
+         *  @return A Array Buffer Object, or nullptr if there is an error.
+         *  @note The return value (non-null) has to be released manually.
+         *        This engine copies the memory and invokes releaseCallback before returning.
+         */
+        static Object* createExternalArrayBufferObject(void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback);
+
+        /**
+         *  @brief Creates a JavaScript Typed Array Object with specified format over externally owned memory.
+         *  @param[in] type The format of typed array.
+         *  @param[in] data A pointer to the memory, it has to stay valid until releaseCallback is invoked.
+         *  @param[in] byteLength The number of bytes pointed to by the parameter data.
+         *  @param[in] releaseCallback Invoked with data and byteLength once the memory isn't used any more.
+         *  @return A JavaScript Typed Array Object, or nullptr if there is an error.
+         *  @note The return value (non-null) has to be released manually.
+         *        This engine copies the memory and invokes releaseCallback before returning.
+         */
+        static Object* createExternalTypedArray(TypedArrayType type, void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback);
+
         /**
          *  @brief Creates a JavaScript Object from a JSON formatted string.
          *  @param[in] jsonStr The utf-8 string containing the JSON string to be parsed.
@@ -30,12 +30,103 @@
 #include "ScriptEngine.hpp"
 #include "../MappingUtils.hpp"
 
+#include <unordered_set>
+
 namespace se {
 
     std::unordered_map<Object*, void*> __objectMap; // Currently, the value `void*` is always nullptr
     
     namespace {
         v8::Isolate* __isolate = nullptr;
+
+        // Keeps an externally owned backing store alive until its Array Buffer is garbage collected.
+        struct ExternalBuffer
+        {
+            v8::Global<v8::ArrayBuffer> handle;
+            void* data;
+            size_t byteLength;
+            Object::BufferReleaseCallback releaseCallback;
+        };
+
+        std::unordered_set<ExternalBuffer*> __externalBuffers;
+
+        void releaseExternalBuffer(ExternalBuffer* buffer)
+        {
+            __externalBuffers.erase(buffer);
+            if (__isolate != nullptr)
+            {
+                __isolate->AdjustAmountOfExternalAllocatedMemory(-(int64_t)buffer->byteLength);
+            }
+            if (buffer->releaseCallback != nullptr)
+            {
+                buffer->releaseCallback(buffer->data, buffer->byteLength);
+            }
+            delete buffer;
+        }
+
+        void onExternalBufferReleased(const v8::WeakCallbackInfo<ExternalBuffer>& info)
+        {
+            releaseExternalBuffer(info.GetParameter());
+        }
+
+        void onExternalBufferCollected(const v8::WeakCallbackInfo<ExternalBuffer>& info)
+        {
+            // Only handles may be reset in the first pass, the release callback runs in the second one.
+            info.GetParameter()->handle.Reset();
+            info.SetSecondPassCallback(onExternalBufferReleased);
+        }
+
+        v8::Local<v8::ArrayBuffer> newExternalArrayBuffer(void* data, size_t byteLength, const Object::BufferReleaseCallback& releaseCallback)
+        {
+            v8::Local<v8::ArrayBuffer> jsobj = v8::ArrayBuffer::New(__isolate, data, byteLength, v8::ArrayBufferCreationMode::kExternalized);
+
+            ExternalBuffer* buffer = new ExternalBuffer();
+            buffer->handle.Reset(__isolate, jsobj);
+            buffer->handle.SetWeak(buffer, onExternalBufferCollected, v8::WeakCallbackType::kParameter);
+            buffer->data = data;
+            buffer->byteLength = byteLength;
+            buffer->releaseCallback = releaseCallback;
+            __externalBuffers.insert(buffer);
+
+            // Lets GC know the memory which it can reclaim.
+            __isolate->AdjustAmountOfExternalAllocatedMemory((int64_t)byteLength);
+            return jsobj;
+        }
+
+        v8::Local<v8::Object> newTypedArray(Object::TypedArrayType type, v8::Local<v8::ArrayBuffer> jsobj, size_t byteLength)
+        {
+            v8::Local<v8::Object> arr;
+            switch (type) {
+                case Object::TypedArrayType::INT8:
+                    arr = v8::Int8Array::New(jsobj, 0, byteLength);
+                    break;
+                case Object::TypedArrayType::INT16:
+                    arr = v8::Int16Array::New(jsobj, 0, byteLength / 2);
+                    break;
+                case Object::TypedArrayType::INT32:
+                    arr = v8::Int32Array::New(jsobj, 0, byteLength / 4);
+                    break;
+                case Object::TypedArrayType::UINT8:
+                    arr = v8::Uint8Array::New(jsobj, 0, byteLength);
+                    break;
+                case Object::TypedArrayType::UINT16:
+                    arr = v8::Uint16Array::New(jsobj, 0, byteLength / 2);
+                    break;
+                case Object::TypedArrayType::UINT32:
+                    arr = v8::Uint32Array::New(jsobj, 0, byteLength / 4);
+                    break;
+                case Object::TypedArrayType::FLOAT32:
+                    arr = v8::Float32Array::New(jsobj, 0, byteLength / 4);
+                    break;
+                case Object::TypedArrayType::FLOAT64:
+                    arr = v8::Float64Array::New(jsobj, 0, byteLength / 8);
+                    break;
+                default:
+                    assert(false); // Should never go here.
+                    break;
+            }
+            return arr;
+        }
     }
 
     Object::Object()
@@ -153,6 +244,18 @@ namespace se {
         }
 
         __objectMap.clear();
+
+        // Weak callbacks aren't invoked for buffers still alive when the isolate is disposed.
+        std::vector<ExternalBuffer*> externalBuffers(__externalBuffers.begin(), __externalBuffers.end());
+        for (auto buffer : externalBuffers)
+        {
+            // Collected ones are released by their pending second pass callbacks.
+            if (buffer->handle.IsEmpty())
+                continue;
+            buffer->handle.Reset();
+            releaseExternalBuffer(buffer);
+        }
+
         __isolate = nullptr;
     }
 
@@ -236,37 +339,38 @@ namespace se {
             memset(jsobj->GetContents().Data(), 0, byteLength);
         }
         
-        v8::Local<v8::Object> arr;
-        switch (type) {
-            case TypedArrayType::INT8:
-                arr = v8::Int8Array::New(jsobj, 0, byteLength);
-                break;
-            case TypedArrayType::INT16:
-                arr = v8::Int16Array::New(jsobj, 0, byteLength / 2);
-                break;
-            case TypedArrayType::INT32:
-                arr = v8::Int32Array::New(jsobj, 0, byteLength / 4);
-                break;
-            case TypedArrayType::UINT8:
-                arr = v8::Uint8Array::New(jsobj, 0, byteLength);
-                break;
-            case TypedArrayType::UINT16:
-                arr = v8::Uint16Array::New(jsobj, 0, byteLength / 2);
-                break;
-            case TypedArrayType::UINT32:
-                arr = v8::Uint32Array::New(jsobj, 0, byteLength / 4);
-                break;
-            case TypedArrayType::FLOAT32:
-                arr = v8::Float32Array::New(jsobj, 0, byteLength / 4);
-                break;
-            case TypedArrayType::FLOAT64:
-                arr = v8::Float64Array::New(jsobj, 0, byteLength / 8);
-                break;
-            default:
-                assert(false); // Should never go here.
-                break;
+        v8::Local<v8::Object> arr = newTypedArray(type, jsobj, byteLength);
+        Object* obj = Object::_createJSObject(nullptr, arr);
+        return obj;
+    }
+
+    Object* Object::createExternalArrayBufferObject(void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback)
+    {
+        if (data == nullptr || byteLength == 0)
+        {
+            Object* obj = createArrayBufferObject(data, byteLength);
+            if (releaseCallback != nullptr)
+                releaseCallback(data, byteLength);
+            return obj;
+        }
+
+        v8::Local<v8::ArrayBuffer> jsobj = newExternalArrayBuffer(data, byteLength, releaseCallback);
+        Object* obj = Object::_createJSObject(nullptr, jsobj);
+        return obj;
+    }
+
+    Object* Object::createExternalTypedArray(TypedArrayType type, void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback)
+    {
+        if (type == TypedArrayType::NONE || type == TypedArrayType::UINT8_CLAMPED || data == nullptr || byteLength == 0)
+        {
+            Object* obj = createTypedArray(type, data, byteLength);
+            if (releaseCallback != nullptr)
+                releaseCallback(data, byteLength);
+            return obj;
         }
 
+        v8::Local<v8::ArrayBuffer> jsobj = newExternalArrayBuffer(data, byteLength, releaseCallback);
+        v8::Local<v8::Object> arr = newTypedArray(type, jsobj, byteLength);
         Object* obj = Object::_createJSObject(nullptr, arr);
         return obj;
     }
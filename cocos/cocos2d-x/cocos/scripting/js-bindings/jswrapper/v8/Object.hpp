@@ -106,6 +106,29 @@ namespace se {
          */
         static Object* createArrayBufferObject(void* bytes, size_t byteLength);
 
+        using BufferReleaseCallback = std::function<void(void* data, size_t byteLength)>;
+
+        /**
+         *  @brief Creates a JavaScript Array Buffer object over externally owned memory without copying it.
+         *  @param[in] data A pointer to the memory, it has to stay valid until releaseCallback is invoked.
+         *  @param[in] byteLength The number of bytes pointed to by the parameter data.
+         *  @param[in] releaseCallback Invoked with data and byteLength once the Array Buffer object is garbage collected or the script engine is cleaned up.
+         *  @return A Array Buffer Object whose backing store is the memory pointed to data, or nullptr if there is an error.
+         *  @note The return value (non-null) has to be released manually.
+         */
+        static Object* createExternalArrayBufferObject(void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback);
+
+        /**
+         *  @brief Creates a JavaScript Typed Array Object with specified format over externally owned memory without copying it.
+         *  @param[in] type The format of typed array.
+         *  @param[in] data A pointer to the memory, it has to stay valid until releaseCallback is invoked.
+         *  @param[in] byteLength The number of bytes pointed to by the parameter data.
+         *  @param[in] releaseCallback Invoked with data and byteLength once the backing store is garbage collected or the script engine is cleaned up.
+         *  @return A JavaScript Typed Array Object whose backing store is the memory pointed to data, or nullptr if there is an error.
+         *  @note The return value (non-null) has to be released manually.
+         */
+        static Object* createExternalTypedArray(TypedArrayType type, void* data, size_t byteLength, const BufferReleaseCallback& releaseCallback);
+
         /**
          *  @brief Creates a JavaScript Object from a JSON formatted string.
          *  @param[in] jsonStr The utf-8 string containing the JSON string to be parsed.
@@ -110,6 +110,90 @@ namespace se {
             return stackStr;
         }
 
+        // Scripts shorter than this compile faster than their code caches are read.
+        const size_t CODE_CACHE_MIN_SCRIPT_LENGTH = 16 * 1024;
+        const uint32_t CODE_CACHE_MAGIC = 0x48434353; // "SCCH"
+
+        struct CodeCacheHeader
+        {
+            uint32_t magic;
+            // Changes with V8 version and flags, V8 rejects caches produced with other ones.
+            uint32_t versionTag;
+            uint64_t sourceHash;
+            uint32_t sourceLength;
+            uint32_t dataLength;
+        };
+
+        uint64_t hashCodeCacheSource(const char* data, size_t length)
+        {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < length; ++i)
+            {
+                hash ^= (uint8_t)data[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        std::string getCodeCachePath(const std::string& dir, const std::string& sourceUrl)
+        {
+            char name[32] = {0};
+            snprintf(name, sizeof(name), "%016llx.cache", (unsigned long long)hashCodeCacheSource(sourceUrl.c_str(), sourceUrl.length()));
+            return dir + name;
+        }
+
+        v8::ScriptCompiler::CachedData* loadCodeCache(const std::string& path, const CodeCacheHeader& expected)
+        {
+            FILE* fp = fopen(path.c_str(), "rb");
+            if (fp == nullptr)
+                return nullptr;
+
+            CodeCacheHeader header;
+            uint8_t* data = nullptr;
+            if (fread(&header, sizeof(header), 1, fp) == 1
+                && header.magic == expected.magic
+                && header.versionTag == expected.versionTag
+                && header.sourceHash == expected.sourceHash
+                && header.sourceLength == expected.sourceLength
+                && header.dataLength > 0)
+            {
+                data = new uint8_t[header.dataLength];
+                if (fread(data, header.dataLength, 1, fp) != 1)
+                {
+                    delete[] data;
+                    data = nullptr;
+                }
+            }
+            fclose(fp);
+
+            if (data == nullptr)
+                return nullptr;
+            return new v8::ScriptCompiler::CachedData(data, header.dataLength, v8::ScriptCompiler::CachedData::BufferOwned);
+        }
+
+        void saveCodeCache(const std::string& path, CodeCacheHeader header, v8::Local<v8::Script> script)
+        {
+            std::unique_ptr<v8::ScriptCompiler::CachedData> cachedData(v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript()));
+            if (!cachedData || cachedData->length <= 0)
+                return;
+
+            FILE* fp = fopen(path.c_str(), "wb");
+            if (fp == nullptr)
+            {
+                SE_LOGE("ScriptEngine: failed to write code cache %s\n", path.c_str());
+                return;
+            }
+
+            header.dataLength = (uint32_t)cachedData->length;
+            bool written = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(cachedData->data, cachedData->length, 1, fp) == 1;
+            fclose(fp);
+            if (!written)
+            {
+                remove(path.c_str());
+            }
+        }
+
         se::Value __oldConsoleLog;
         se::Value __oldConsoleDebug;
         se::Value __oldConsoleInfo;
@@ -612,6 +696,7 @@ namespace se {
         if (length < 0)
             length = strlen(script);
 
+        bool hasFileName = fileName != nullptr;
         if (fileName == nullptr)
             fileName = "(no filename)";
 
@@ -635,7 +720,33 @@ namespace se {
             return false;
 
         v8::ScriptOrigin origin(originStr.ToLocalChecked());
-        v8::MaybeLocal<v8::Script> maybeScript = v8::Script::Compile(_context.Get(_isolate), source.ToLocalChecked(), &origin);
+
+        // Only script files are worth caching, caches are keyed by file and validated against the source content.
+        bool useCodeCache = !_codeCacheDir.empty() && hasFileName && (size_t)length >= CODE_CACHE_MIN_SCRIPT_LENGTH;
+        std::string codeCachePath;
+        CodeCacheHeader codeCacheHeader = {};
+        v8::ScriptCompiler::CachedData* cachedData = nullptr;
+#if defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
+        auto compileStart = std::chrono::steady_clock::now();
+#endif
+        if (useCodeCache)
+        {
+            codeCachePath = getCodeCachePath(_codeCacheDir, sourceUrl);
+            codeCacheHeader.magic = CODE_CACHE_MAGIC;
+            codeCacheHeader.versionTag = v8::ScriptCompiler::CachedDataVersionTag();
+            codeCacheHeader.sourceHash = hashCodeCacheSource(script, length);
+            codeCacheHeader.sourceLength = (uint32_t)length;
+            cachedData = loadCodeCache(codeCachePath, codeCacheHeader);
+        }
+
+        // The source takes the ownership of cached data.
+        v8::ScriptCompiler::Source compilerSource(source.ToLocalChecked(), origin, cachedData);
+        v8::MaybeLocal<v8::Script> maybeScript = v8::ScriptCompiler::Compile(_context.Get(_isolate), &compilerSource,
+            cachedData != nullptr ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions);
+        bool codeCacheHit = cachedData != nullptr && !compilerSource.GetCachedData()->rejected;
+#if defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
+        auto runStart = std::chrono::steady_clock::now();
+#endif
 
         bool success = false;
 
@@ -655,7 +766,24 @@ namespace se {
 
                 success = true;
             }
+
+            // Produced after running, so that functions compiled lazily during the first run are included.
+            if (success && useCodeCache && !codeCacheHit)
+            {
+                saveCodeCache(codeCachePath, codeCacheHeader, v8Script);
+            }
+        }
+
+#if defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
+        if (useCodeCache)
+        {
+            auto runEnd = std::chrono::steady_clock::now();
+            SE_LOGD("ScriptEngine::evalString %s, compile: %.2fms (code cache %s), run: %.2fms\n", sourceUrl.c_str(),
+                    std::chrono::duration<float, std::milli>(runStart - compileStart).count(),
+                    codeCacheHit ? "hit" : (cachedData != nullptr ? "rejected" : "miss"),
+                    std::chrono::duration<float, std::milli>(runEnd - runStart).count());
         }
+#endif
 
         if (!success)
         {
@@ -684,6 +812,11 @@ namespace se {
         return _fileOperationDelegate;
     }
 
+    void ScriptEngine::setCodeCacheDirectory(const std::string& dir)
+    {
+        _codeCacheDir = dir;
+    }
+
     bool ScriptEngine::runScript(const std::string& path, Value* ret/* = nullptr */)
     {
         assert(!path.empty());
@@ -214,6 +214,13 @@ namespace se {
          */
         bool runScript(const std::string& path, Value* rval = nullptr);
 
+        /**
+         *  @brief Sets the directory where V8 code caches of evaluated script files are stored.
+         *  A script compiled without a valid cache produces one after its first run, later launches consume it instead of compiling from source.
+         *  @param[in] dir A writable directory ending with '/', passing an empty string disables code caches.
+         */
+        void setCodeCacheDirectory(const std::string& dir);
+
         /**
          *  @brief Tests whether script engine is doing garbage collection.
          *  @return true if it's in garbage collection, otherwise false.
@@ -309,6 +316,7 @@ namespace se {
 
         FileOperationDelegate _fileOperationDelegate;
         ExceptionCallback _exceptionCallback;
+        std::string _codeCacheDir;
 
 #if SE_ENABLE_INSPECTOR
         node::Environment* _env;
@@ -400,6 +400,25 @@ static bool js_cocos2dx_dragonbones_BaseFactory_parseTextureAtlasData(se::State&
 }
 SE_BIND_FUNC(js_cocos2dx_dragonbones_BaseFactory_parseTextureAtlasData)
 
+static bool js_cocos2dx_dragonbones_CCArmatureDisplay_setLODPriority(se::State& s)
+{
+    dragonBones::CCArmatureDisplay* cobj = (dragonBones::CCArmatureDisplay*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_cocos2dx_dragonbones_CCArmatureDisplay_setLODPriority : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    if (argc == 1)
+    {
+        int32_t priority = 0;
+        bool ok = seval_to_int32(args[0], &priority);
+        SE_PRECONDITION2(ok, false, "js_cocos2dx_dragonbones_CCArmatureDisplay_setLODPriority : Error processing arguments");
+        cobj->getUpdateLOD().setPriority(priority);
+        return true;
+    }
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_cocos2dx_dragonbones_CCArmatureDisplay_setLODPriority)
+
 bool register_all_dragonbones_manual(se::Object* obj)
 {
     __jsb_dragonBones_Armature_proto->defineFunction("getDisplay", _SE(js_cocos2dx_dragonbones_Armature_getDisplay));
@@ -422,6 +441,8 @@ bool register_all_dragonbones_manual(se::Object* obj)
     __jsb_dragonBones_Slot_proto->defineFunction("setDisplay", _SE(js_cocos2dx_dragonbones_Slot_setDisplay));
 
     __jsb_dragonBones_BaseFactory_proto->defineFunction("parseTextureAtlasData", _SE(js_cocos2dx_dragonbones_BaseFactory_parseTextureAtlasData));
+
+    __jsb_dragonBones_CCArmatureDisplay_proto->defineFunction("setLODPriority", _SE(js_cocos2dx_dragonbones_CCArmatureDisplay_setLODPriority));
     
     dragonBones::BaseObject::setObjectRecycleOrDestroyCallback([](dragonBones::BaseObject* obj, int type){
 
@@ -863,6 +863,102 @@ bool js_register_gfx_VertexFormat(se::Object* obj)
     return true;
 }
 
+static bool js_gfx_DeviceGraphics_setTextureUploadBudget(se::State& s)
+{
+    cocos2d::renderer::DeviceGraphics* cobj = (cocos2d::renderer::DeviceGraphics*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_DeviceGraphics_setTextureUploadBudget : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 2) {
+        uint32_t bytes = 0;
+        float milliseconds = 0;
+        ok &= seval_to_uint32(args[0], &bytes);
+        ok &= seval_to_float(args[1], &milliseconds);
+        SE_PRECONDITION2(ok, false, "js_gfx_DeviceGraphics_setTextureUploadBudget : Error processing arguments");
+        cobj->getTextureUploader()->setBudget(bytes, milliseconds);
+        return true;
+    }
+
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 2);
+    return false;
+}
+SE_BIND_FUNC(js_gfx_DeviceGraphics_setTextureUploadBudget)
+
+static bool js_gfx_DeviceGraphics_getTextureUploadStats(se::State& s)
+{
+    cocos2d::renderer::DeviceGraphics* cobj = (cocos2d::renderer::DeviceGraphics*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_DeviceGraphics_getTextureUploadStats : Invalid Native Object");
+    TextureUploader::Stats stats = cobj->getTextureUploader()->getStats();
+    se::HandleObject obj(se::Object::createPlainObject());
+    obj->setProperty("queuedBytes", se::Value((double)stats.queuedBytes));
+    obj->setProperty("uploadedBytes", se::Value((double)stats.uploadedBytes));
+    obj->setProperty("queuedImages", se::Value(stats.queuedImages));
+    obj->setProperty("uploadedImages", se::Value(stats.uploadedImages));
+    s.rval().setObject(obj);
+    return true;
+}
+SE_BIND_FUNC(js_gfx_DeviceGraphics_getTextureUploadStats)
+
+static bool js_gfx_Texture2D_updateImageAsync(se::State& s)
+{
+    cocos2d::renderer::Texture2D* cobj = (cocos2d::renderer::Texture2D*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_Texture2D_updateImageAsync : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 1 || argc == 2) {
+        SE_PRECONDITION2(args[0].isObject(), false, "js_gfx_Texture2D_updateImageAsync : Error processing arguments");
+        se::Object* options = args[0].toObject();
+
+        TextureUploader::ImageInfo info;
+        se::Value imageVal, value;
+        ok &= options->getProperty("image", &imageVal) && imageVal.isObject() && imageVal.toObject()->isTypedArray();
+        ok &= options->getProperty("width", &value) && seval_to_uint16(value, &info.width);
+        ok &= options->getProperty("height", &value) && seval_to_uint16(value, &info.height);
+        SE_PRECONDITION2(ok, false, "js_gfx_Texture2D_updateImageAsync : Error processing arguments");
+        if (options->getProperty("level", &value) && value.isNumber())
+            info.level = value.toUint8();
+        if (options->getProperty("flipY", &value) && value.isBoolean())
+            info.flipY = value.toBoolean();
+        if (options->getProperty("premultiplyAlpha", &value) && value.isBoolean())
+            info.premultiplyAlpha = value.toBoolean();
+        if (options->getProperty("compressed", &value) && value.isBoolean())
+            info.compressed = value.toBoolean();
+
+        uint8_t* data = nullptr;
+        size_t length = 0;
+        imageVal.toObject()->getTypedArrayData(&data, &length);
+        std::vector<uint8_t> pixels(data, data + length);
+
+        TextureUploader::Callback callback = nullptr;
+        if (argc == 2 && args[1].isObject() && args[1].toObject()->isFunction())
+        {
+            // Kept alive until the upload completes or is cancelled.
+            se::Object* funcObj = args[1].toObject();
+            funcObj->root();
+            funcObj->incRef();
+            std::shared_ptr<se::Object> func(funcObj, [](se::Object* obj) {
+                obj->unroot();
+                obj->decRef();
+            });
+            callback = [func](bool success) {
+                se::AutoHandleScope hs;
+                se::ValueArray callbackArgs;
+                callbackArgs.push_back(se::Value(success));
+                func->call(callbackArgs, nullptr);
+            };
+        }
+
+        DeviceGraphics::getInstance()->getTextureUploader()->enqueue(cobj, info, std::move(pixels), callback);
+        return true;
+    }
+
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 2);
+    return false;
+}
+SE_BIND_FUNC(js_gfx_Texture2D_updateImageAsync)
+
 bool jsb_register_gfx_manual(se::Object* global)
 {
     se::Value nsVal;
@@ -878,6 +974,10 @@ bool jsb_register_gfx_manual(se::Object* global)
     
     __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("clear", _SE(js_gfx_DeviceGraphics_clear));
     __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("setUniform", _SE(js_gfx_DeviceGraphics_setUniform));
+    __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("setTextureUploadBudget", _SE(js_gfx_DeviceGraphics_setTextureUploadBudget));
+    __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("getTextureUploadStats", _SE(js_gfx_DeviceGraphics_getTextureUploadStats));
+    
+    __jsb_cocos2d_renderer_Texture2D_proto->defineFunction("updateImageAsync", _SE(js_gfx_Texture2D_updateImageAsync));
 
     __jsb_cocos2d_renderer_VertexBuffer_proto->defineFunction("init", _SE(js_gfx_VertexBuffer_init));
     __jsb_cocos2d_renderer_VertexBuffer_proto->defineFunction("update", _SE(js_gfx_VertexBuffer_update));
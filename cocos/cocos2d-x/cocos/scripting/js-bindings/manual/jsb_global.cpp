@@ -223,6 +223,14 @@ void jsb_init_file_operation_delegate()
         assert(delegate.isValid());
 
         se::ScriptEngine::getInstance()->setFileOperationDelegate(delegate);
+
+#if SCRIPT_ENGINE_TYPE == SCRIPT_ENGINE_V8
+        std::string codeCacheDir = FileUtils::getInstance()->getWritablePath() + "v8-code-cache/";
+        if (FileUtils::getInstance()->createDirectory(codeCacheDir))
+        {
+            se::ScriptEngine::getInstance()->setCodeCacheDirectory(codeCacheDir);
+        }
+#endif
     }
 }
 
@@ -826,9 +834,20 @@ bool jsb_global_load_image(const std::string& path, const se::Value& callbackVal
                 if (loadSucceed)
                 {
                     se::HandleObject retObj(se::Object::createPlainObject());
-                    Data data;
-                    data.copy(imgInfo->data, imgInfo->length);    
-                    Data_to_seval(data, &dataVal);
+                    // Hands the pixels to script without copying them, they are freed with the typed array.
+                    se::Object::BufferReleaseCallback releaseData;
+                    if (imgInfo->freeData)
+                    {
+                        imgInfo->freeData = false;
+                        releaseData = [](void* data, size_t){ delete [] (uint8_t*)data; };
+                    }
+                    else
+                    {
+                        img->retain();
+                        releaseData = [img](void*, size_t){ img->release(); };
+                    }
+                    se::HandleObject dataObj(se::Object::createExternalTypedArray(se::Object::TypedArrayType::UINT8, imgInfo->data, imgInfo->length, releaseData));
+                    dataVal.setObject(dataObj, true);
                     retObj->setProperty("data", dataVal);
                     retObj->setProperty("width", se::Value(imgInfo->width));
                     retObj->setProperty("height", se::Value(imgInfo->height));
@@ -29,6 +29,7 @@
 #include "cocos/scripting/js-bindings/manual/jsb_conversions.hpp"
 #include "scene/NodeProxy.hpp"
 #include "scene/assembler/Assembler.hpp"
+#include "scene/RenderFlow.hpp"
 #include "jsb_conversions.hpp"
 
 using namespace cocos2d;
@@ -615,6 +616,193 @@ static bool js_renderer_CustomProperties_setProperty(se::State& s)
 }
 SE_BIND_FUNC(js_renderer_CustomProperties_setProperty);
 
+static bool js_renderer_ProgramLib_warmUp(se::State& s)
+{
+    cocos2d::renderer::ProgramLib* cobj = (cocos2d::renderer::ProgramLib*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_ProgramLib_warmUp : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 1)
+    {
+        // [{ effect, defines }, ...]
+        ok &= args[0].isObject() && args[0].toObject()->isArray();
+        SE_PRECONDITION2(ok, false, "js_renderer_ProgramLib_warmUp : Error processing arguments");
+        se::Object* arr = args[0].toObject();
+        uint32_t len = 0;
+        arr->getArrayLength(&len);
+        
+        std::vector<std::pair<cocos2d::renderer::Effect*, cocos2d::ValueMap>> items;
+        items.reserve(len);
+        se::Value element;
+        se::Value effectVal;
+        se::Value definesVal;
+        for (uint32_t i = 0; i < len; ++i)
+        {
+            ok &= arr->getArrayElement(i, &element) && element.isObject();
+            ok &= element.toObject()->getProperty("effect", &effectVal);
+            SE_PRECONDITION2(ok, false, "js_renderer_ProgramLib_warmUp : Error processing arguments");
+            
+            std::pair<cocos2d::renderer::Effect*, cocos2d::ValueMap> item(nullptr, cocos2d::ValueMap());
+            ok &= seval_to_native_ptr(effectVal, &item.first);
+            if (element.toObject()->getProperty("defines", &definesVal) && definesVal.isObject())
+            {
+                ok &= seval_to_ccvaluemap(definesVal, &item.second);
+            }
+            SE_PRECONDITION2(ok, false, "js_renderer_ProgramLib_warmUp : Error processing arguments");
+            items.push_back(std::move(item));
+        }
+        
+        cobj->warmUp(items);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_ProgramLib_warmUp);
+
+static bool js_renderer_RenderFlow_setCommandRecording(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_setCommandRecording : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 1)
+    {
+        bool arg0;
+        ok &= seval_to_boolean(args[0], &arg0);
+        SE_PRECONDITION2(ok, false, "js_renderer_RenderFlow_setCommandRecording : Error processing arguments");
+        cobj->setCommandRecording(arg0);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_setCommandRecording);
+
+static bool js_renderer_RenderFlow_dumpCommands(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_dumpCommands : Invalid Native Object");
+    const auto* buffer = cobj->getCommandBuffer();
+    s.rval().setString(buffer ? buffer->dump() : "");
+    return true;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_dumpCommands);
+
+static bool js_renderer_RenderFlow_insertAtlasFrame(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_insertAtlasFrame : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 5)
+    {
+        uint32_t key = 0;
+        uint16_t width = 0, height = 0;
+        bool premultiplyAlpha = false;
+        ok &= seval_to_uint32(args[0], &key);
+        ok &= seval_to_uint16(args[1], &width);
+        ok &= seval_to_uint16(args[2], &height);
+        ok &= args[3].isObject() && args[3].toObject()->isTypedArray();
+        ok &= seval_to_boolean(args[4], &premultiplyAlpha);
+        SE_PRECONDITION2(ok, false, "js_renderer_RenderFlow_insertAtlasFrame : Error processing arguments");
+        
+        uint8_t* data = nullptr;
+        size_t length = 0;
+        args[3].toObject()->getTypedArrayData(&data, &length);
+        SE_PRECONDITION2(length >= (size_t)width * height * 4, false, "js_renderer_RenderFlow_insertAtlasFrame : Image data is too short");
+        
+        bool result = cobj->getDynamicAtlas()->insert(key, width, height, data, premultiplyAlpha);
+        s.rval().setBoolean(result);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 5);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_insertAtlasFrame);
+
+static bool js_renderer_RenderFlow_removeAtlasFrame(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_removeAtlasFrame : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 1)
+    {
+        uint32_t key = 0;
+        ok &= seval_to_uint32(args[0], &key);
+        SE_PRECONDITION2(ok, false, "js_renderer_RenderFlow_removeAtlasFrame : Error processing arguments");
+        cobj->getDynamicAtlas()->remove(key);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_removeAtlasFrame);
+
+static bool js_renderer_RenderFlow_setCullingEnabled(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_setCullingEnabled : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 1)
+    {
+        bool arg0;
+        ok &= seval_to_boolean(args[0], &arg0);
+        SE_PRECONDITION2(ok, false, "js_renderer_RenderFlow_setCullingEnabled : Error processing arguments");
+        cobj->setCullingEnabled(arg0);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_setCullingEnabled);
+
+static bool js_renderer_RenderFlow_getCullingStats(se::State& s)
+{
+    cocos2d::renderer::RenderFlow* cobj = (cocos2d::renderer::RenderFlow*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_RenderFlow_getCullingStats : Invalid Native Object");
+    se::HandleObject obj(se::Object::createPlainObject());
+    obj->setProperty("culled", se::Value(cobj->getCulledNodeCount()));
+    obj->setProperty("submitted", se::Value(cobj->getSubmittedNodeCount()));
+    s.rval().setObject(obj);
+    return true;
+}
+SE_BIND_FUNC(js_renderer_RenderFlow_getCullingStats);
+
+static bool js_renderer_Assembler_setAtlasKey(se::State& s)
+{
+    cocos2d::renderer::Assembler* cobj = (cocos2d::renderer::Assembler*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_renderer_Assembler_setAtlasKey : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 2)
+    {
+        uint32_t index = 0, key = 0;
+        ok &= seval_to_uint32(args[0], &index);
+        ok &= seval_to_uint32(args[1], &key);
+        SE_PRECONDITION2(ok, false, "js_renderer_Assembler_setAtlasKey : Error processing arguments");
+        cobj->setAtlasKey(index, key);
+        return true;
+    }
+    
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 2);
+    return false;
+}
+SE_BIND_FUNC(js_renderer_Assembler_setAtlasKey);
+
 bool jsb_register_renderer_manual(se::Object* global)
 {
     se::Value nsVal;
@@ -654,6 +842,17 @@ bool jsb_register_renderer_manual(se::Object* global)
     __jsb_cocos2d_renderer_Effect_proto->defineFunction("init", _SE(js_renderer_Effect_init));
     __jsb_cocos2d_renderer_CustomProperties_proto->defineFunction("setProperty", _SE(js_renderer_CustomProperties_setProperty));
     
+    __jsb_cocos2d_renderer_ProgramLib_proto->defineFunction("warmUp", _SE(js_renderer_ProgramLib_warmUp));
+    
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("setCommandRecording", _SE(js_renderer_RenderFlow_setCommandRecording));
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("dumpCommands", _SE(js_renderer_RenderFlow_dumpCommands));
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("insertAtlasFrame", _SE(js_renderer_RenderFlow_insertAtlasFrame));
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("removeAtlasFrame", _SE(js_renderer_RenderFlow_removeAtlasFrame));
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("setCullingEnabled", _SE(js_renderer_RenderFlow_setCullingEnabled));
+    __jsb_cocos2d_renderer_RenderFlow_proto->defineFunction("getCullingStats", _SE(js_renderer_RenderFlow_getCullingStats));
+    
+    __jsb_cocos2d_renderer_Assembler_proto->defineFunction("setAtlasKey", _SE(js_renderer_Assembler_setAtlasKey));
+    
     return true;
 }
 
@@ -39,6 +39,7 @@
 #include "spine-creator-support/SkeletonDataMgr.h"
 #include "spine-creator-support/SkeletonRenderer.h"
 #include "spine-creator-support/spine-cocos2dx.h"
+#include "UpdateLOD.h"
 
 #include "cocos2d.h"
 #include "cocos/editor-support/spine/spine.h"
@@ -94,6 +95,11 @@ static bool js_register_spine_initSkeletonData (se::State& s)
     SE_PRECONDITION2(ok, false, "js_register_spine_initSkeletonData: Invalid scale!");
     
     
+    // Accounts the data under its uuid, the parser temporaries are freed right away so they aren't packed into regions.
+    // The arena is closed once loaded, nothing below allocates through spine while the scope lasts.
+    spine::SpineAllocator::Arena* arena = spine::SpineAllocator::createArena(uuid, false);
+    spine::SpineAllocator::Scope scope(arena);
+    
     _preloadedAtlasTextures = &textures;
     spine::spAtlasPage_setCustomTextureLoader(_getPreloadedAtlasTexture);
 
@@ -108,6 +114,7 @@ static bool js_register_spine_initSkeletonData (se::State& s)
     spine::SkeletonData* skeletonData = json->readSkeletonData(skeletonDataFile.c_str());
     CCASSERT(skeletonData, !json->getError().isEmpty() ? json->getError().buffer() : "Error reading skeleton data.");
     delete json;
+    spine::SpineAllocator::closeArena(arena);
     
     if (skeletonData) {
         std::vector<int> texturesIndex;
@@ -204,6 +211,57 @@ static bool js_register_spine_retainSkeletonData(se::State& s)
 }
 SE_BIND_FUNC(js_register_spine_retainSkeletonData)
 
+static bool js_spine_SkeletonRenderer_setLODPriority(se::State& s)
+{
+    spine::SkeletonRenderer* cobj = (spine::SkeletonRenderer*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_spine_SkeletonRenderer_setLODPriority : Invalid Native Object");
+    const auto& args = s.args();
+    int argc = (int)args.size();
+    if (argc != 1) {
+        SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", argc, 1);
+        return false;
+    }
+    
+    int32_t priority = 0;
+    bool ok = seval_to_int32(args[0], &priority);
+    SE_PRECONDITION2(ok, false, "js_spine_SkeletonRenderer_setLODPriority : Error processing arguments");
+    cobj->getUpdateLOD().setPriority(priority);
+    return true;
+}
+SE_BIND_FUNC(js_spine_SkeletonRenderer_setLODPriority)
+
+// Counts of the skeletons updated at each UpdateLOD level in the last frame, spine and dragonbones together.
+static bool js_register_spine_getLODStats(se::State& s)
+{
+    se::HandleObject array(se::Object::createArrayObject(middleware::UpdateLOD::LEVEL_COUNT));
+    for (int i = 0; i < middleware::UpdateLOD::LEVEL_COUNT; i++) {
+        uint32_t count = middleware::UpdateLOD::getLevelCount((middleware::UpdateLOD::Level)i);
+        array->setArrayElement(i, se::Value(count));
+    }
+    s.rval().setObject(array);
+    return true;
+}
+SE_BIND_FUNC(js_register_spine_getLODStats)
+
+static bool js_register_spine_getLiveBytes(se::State& s)
+{
+    const auto& args = s.args();
+    int argc = (int)args.size();
+    if (argc != 1) {
+        SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", argc, 1);
+        return false;
+    }
+    bool ok = false;
+    
+    std::string uuid;
+    ok = seval_to_std_string(args[0], &uuid);
+    SE_PRECONDITION2(ok, false, "js_register_spine_getLiveBytes: Invalid uuid content!");
+    
+    s.rval().setNumber((double)spine::SpineAllocator::getLiveBytes(uuid));
+    return true;
+}
+SE_BIND_FUNC(js_register_spine_getLiveBytes)
+
 bool register_all_spine_manual(se::Object* obj)
 {
     se::Value nsVal;
@@ -219,6 +277,10 @@ bool register_all_spine_manual(se::Object* obj)
     ns->defineFunction("initSkeletonData", _SE(js_register_spine_initSkeletonData));
     ns->defineFunction("retainSkeletonData", _SE(js_register_spine_retainSkeletonData));
     ns->defineFunction("disposeSkeletonData", _SE(js_register_spine_disposeSkeletonData));
+    ns->defineFunction("getLODStats", _SE(js_register_spine_getLODStats));
+    ns->defineFunction("getLiveBytes", _SE(js_register_spine_getLiveBytes));
+    
+    __jsb_spine_SkeletonRenderer_proto->defineFunction("setLODPriority", _SE(js_spine_SkeletonRenderer_setLODPriority));
     
     spine::setSpineObjectDisposeCallback([](void* spineObj){
         se::Object* seObj = nullptr;
@@ -31,6 +31,7 @@
 #include <functional>
 #include <algorithm>
 #include <sstream>
+#include <memory>
 #include "cocos/scripting/js-bindings/jswrapper/SeApi.h"
 #include "cocos/scripting/js-bindings/manual/jsb_conversions.hpp"
 #include "cocos/network/HttpClient.h"
@@ -154,7 +155,7 @@ public:
     uint16_t getStatus() const { return _status; }
     const std::string& getStatusText() const { return _statusText; }
     const std::string& getResponseText() const { return _responseText; }
-    const cocos2d::Data& getResponseData() const { return _responseData; }
+    const std::shared_ptr<std::vector<char>>& getResponseData() const { return _responseData; }
     ResponseType getResponseType() const { return _responseType; }
     void setResponseType(ResponseType type) { _responseType = type; }
 
@@ -189,7 +190,8 @@ private:
     std::string _statusText;
     std::string _overrideMimeType;
 
-    cocos2d::Data _responseData;
+    // Shared with the array buffers handed to script.
+    std::shared_ptr<std::vector<char>> _responseData;
 
     cocos2d::network::HttpRequest*  _httpRequest;
 
@@ -418,7 +420,7 @@ void XMLHttpRequest::onResponse(HttpClient* client, HttpResponse* response)
     sprintf(statusString, "HTTP Status Code: %ld, tag = %s", statusCode, tag.c_str());
 
     _responseText.clear();
-    _responseData.clear();
+    _responseData.reset();
 
     if (!response->isSucceed())
     {
@@ -463,7 +465,7 @@ void XMLHttpRequest::onResponse(HttpClient* client, HttpResponse* response)
     }
     else
     {
-        _responseData.copy((unsigned char*)buffer->data(), buffer->size());
+        _responseData = std::make_shared<std::vector<char>>(std::move(*buffer));
     }
 
     _status = statusCode;
@@ -964,8 +966,10 @@ static bool XMLHttpRequest_getResponse(se::State& s)
             }
             else if (xhr->getResponseType() == XMLHttpRequest::ResponseType::ARRAY_BUFFER)
             {
-                const Data& data = xhr->getResponseData();
-                se::HandleObject seObj(se::Object::createArrayBufferObject(data.getBytes(), data.getSize()));
+                // The array buffer keeps the response data alive instead of copying it.
+                std::shared_ptr<std::vector<char>> data = xhr->getResponseData();
+                se::HandleObject seObj(data ? se::Object::createExternalArrayBufferObject(data->data(), data->size(), [data](void*, size_t){})
+                                            : se::Object::createArrayBufferObject(nullptr, 0));
                 if (!seObj.isEmpty())
                 {
                     s.rval().setObject(seObj);
@@ -0,0 +1,174 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Frames recorded into a CommandBuffer must dump the same stream when nothing changed, and replaying
+// them must reach GL the way the immediate path does. Recording by itself must not call GL at all.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include "renderer/gfx/CommandBuffer.h"
+#include "renderer/gfx/IndexBuffer.h"
+#include "renderer/gfx/VertexBuffer.h"
+#include "renderer/renderer/Model.h"
+#include "renderer/scene/MeshBuffer.hpp"
+
+#include <string>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    bool sameCounters(const nullgl::Stats& a, const nullgl::Stats& b)
+    {
+        return a.calls == b.calls &&
+               a.drawCalls == b.drawCalls &&
+               a.primitives == b.primitives &&
+               a.stateChanges == b.stateChanges &&
+               a.uniformUpdates == b.uniformUpdates &&
+               a.bytesUploaded == b.bytesUploaded;
+    }
+    
+    // Renders a frame with the camera panned away first, so that the view uniforms change every frame.
+    nullgl::Stats render(host::Scene& scene)
+    {
+        scene.panCamera(host::Scene::Width / 2 + 10, host::Scene::Height / 2);
+        scene.render();
+        scene.panCamera(host::Scene::Width / 2, host::Scene::Height / 2);
+        nullgl::resetStats();
+        scene.render();
+        return nullgl::getStats();
+    }
+    
+    std::size_t countLines(const std::string& dump, const char* prefix)
+    {
+        std::size_t count = 0;
+        std::size_t length = strlen(prefix);
+        for (std::size_t begin = 0; begin < dump.size();)
+        {
+            if (dump.compare(begin, length, prefix) == 0) count++;
+            std::size_t end = dump.find('\n', begin);
+            if (end == std::string::npos) break;
+            begin = end + 1;
+        }
+        return count;
+    }
+}
+
+int main()
+{
+    host::Scene scene;
+    RenderFlow* flow = scene.getFlow();
+    
+    // Sprites, and a masked panel so that the stream has stencil states and several draws.
+    for (int i = 0; i < 12; i++)
+    {
+        NodeProxy* node = scene.createNode(scene.getRoot());
+        scene.setPosition(node, 60.0f + i * 70, 100);
+        scene.setRotation(node, i * 15.0f);
+        scene.addSprite(node, 40, 40);
+    }
+    NodeProxy* panel = scene.createNode(scene.getRoot());
+    scene.setPosition(panel, 480, 400);
+    scene.addMask(panel, 300, 200);
+    for (int i = 0; i < 4; i++)
+    {
+        NodeProxy* child = scene.createNode(panel);
+        scene.setPosition(child, -120.0f + i * 80, 0);
+        scene.addSprite(child, 60, 60);
+    }
+    
+    // Every frame of the mesh buffer ring creates its GL buffers the first time, compare steady frames only.
+    for (int i = 0; i < MeshBuffer::RING_SIZE; i++)
+    {
+        render(scene);
+    }
+    nullgl::Stats immediate = render(scene);
+    HOST_CHECK(flow->getCommandBuffer() == nullptr);
+    HOST_CHECK(immediate.drawCalls > 1);
+    HOST_CHECK(immediate.uniformUpdates > 0);
+    
+    flow->setCommandRecording(true);
+    nullgl::Stats replayed = render(scene);
+    const CommandBuffer* commands = flow->getCommandBuffer();
+    if (!HOST_CHECK(commands != nullptr)) return host::failedChecks();
+    HOST_CHECK(sameCounters(immediate, replayed));
+    
+    std::string first = commands->dump();
+    HOST_CHECK(countLines(first, "draw ") == immediate.drawCalls);
+    HOST_CHECK(countLines(first, "clear ") > 0);
+    HOST_CHECK(countLines(first, "  uniform cc_matViewProj ") > 0);
+    HOST_CHECK(first.find(" stencil=") != std::string::npos);
+    
+    // Consecutive frames draw from different buffers of the ring, the frame using the same ones dumps the same stream.
+    // Every render above is two frames, which still visits all the slots of the ring.
+    for (int i = 1; i < MeshBuffer::RING_SIZE; i++)
+    {
+        HOST_CHECK(sameCounters(immediate, render(scene)));
+        HOST_CHECK(commands->dump() != first);
+    }
+    HOST_CHECK(sameCounters(immediate, render(scene)));
+    HOST_CHECK(commands->dump() == first);
+    
+    // The forward renderer consumes the models of the frame, hand it a quad to record the pass alone.
+    DeviceGraphics* device = scene.getDevice();
+    float vertices[4 * 5] = {};
+    uint16_t indices[6] = { 0, 1, 2, 1, 3, 2 };
+    auto vertexBuffer = new VertexBuffer();
+    vertexBuffer->init(device, VertexFormat::XY_UV_Color, Usage::STATIC, vertices, sizeof(vertices), 4);
+    auto indexBuffer = new IndexBuffer();
+    indexBuffer->init(device, IndexFormat::UINT16, Usage::STATIC, indices, sizeof(indices), 6);
+    InputAssembler ia;
+    ia.init(vertexBuffer, indexBuffer);
+    Model model;
+    model.setCullingMask(1);
+    model.setEffect(scene.getEffect(), nullptr);
+    model.setNode(scene.getRoot());
+    model.setInputAssembler(ia);
+    scene.getRenderScene()->addModel(&model);
+    
+    CommandBuffer buffer;
+    nullgl::resetStats();
+    device->beginRecording(&buffer);
+    scene.getForward()->render(scene.getRenderScene());
+    device->endRecording();
+    HOST_CHECK(nullgl::getStats().calls == 0);
+    HOST_CHECK(countLines(buffer.dump(), "draw ") == 1);
+    
+    device->execute(&buffer);
+    HOST_CHECK(nullgl::getStats().drawCalls == 1);
+    HOST_CHECK(nullgl::getStats().primitives == 6);
+    vertexBuffer->release();
+    indexBuffer->release();
+    
+    // Switching back keeps the immediate path working.
+    flow->setCommandRecording(false);
+    HOST_CHECK(flow->getCommandBuffer() == nullptr);
+    nullgl::Stats back = render(scene);
+    HOST_CHECK(back.drawCalls == immediate.drawCalls);
+    
+    return host::failedChecks();
+}
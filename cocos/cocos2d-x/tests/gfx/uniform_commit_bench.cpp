@@ -0,0 +1,206 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Replays the uniform traffic of a UI frame through DeviceGraphics on the null GL backend. Like
+// ForwardRenderer, every draw sets the view and world matrices and the material values again, most
+// of them unchanged since the last draw, and the programs switch between sprites, tinted sprites
+// and outlined labels. Prints the cost of a frame and how many of the uniform sets reach GL.
+// Usage: uniform_commit_bench [frames]
+
+#include "HostScene.h"
+
+#include "renderer/gfx/IndexBuffer.h"
+#include "renderer/gfx/Program.h"
+#include "renderer/gfx/VertexBuffer.h"
+
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    const int Panel_Count = 16;
+    const int Icon_Count = 6;
+    const int Button_Count = 3;
+    
+    const char* Tint_Frag = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D texture;
+uniform vec4 u_tint;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    gl_FragColor = texture2D(texture, v_uv0) * v_color * u_tint;
+}
+)";
+    
+    const char* Label_Frag = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D texture;
+uniform vec4 u_outlineColor;
+uniform float u_outlineWidth;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    vec4 glyph = texture2D(texture, v_uv0);
+    float outline = smoothstep(0.5 - u_outlineWidth, 0.5, glyph.a);
+    gl_FragColor = mix(u_outlineColor, v_color, glyph.r) * outline;
+}
+)";
+    
+    size_t hashOf(const char* name)
+    {
+        return std::hash<std::string>{}(name);
+    }
+    
+    Program* createProgram(DeviceGraphics* device, const char* frag)
+    {
+        auto program = new Program();
+        program->init(device, host::Scene::getSpriteVert(), frag);
+        program->link();
+        return program;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames <= 0) frames = 2000;
+    
+    host::Scene scene;
+    DeviceGraphics* device = scene.getDevice();
+    Program* sprite = createProgram(device, host::Scene::getSpriteFrag());
+    Program* tint = createProgram(device, Tint_Frag);
+    Program* label = createProgram(device, Label_Frag);
+    
+    // One quad, the replay is about uniforms, not geometry.
+    float vertices[4 * 5] = {};
+    uint16_t indices[6] = { 0, 1, 2, 1, 3, 2 };
+    auto vertexBuffer = new VertexBuffer();
+    vertexBuffer->init(device, VertexFormat::XY_UV_Color, Usage::STATIC, vertices, sizeof(vertices), 4);
+    auto indexBuffer = new IndexBuffer();
+    indexBuffer->init(device, IndexFormat::UINT16, Usage::STATIC, indices, sizeof(indices), 6);
+    
+    Texture2D* textures[3] = { scene.getTexture(), new Texture2D(), new Texture2D() };
+    Texture::Options options;
+    options.width = 64;
+    options.height = 64;
+    options.glFormat = GL_RGBA;
+    options.glInternalFormat = GL_RGBA;
+    options.glType = GL_UNSIGNED_BYTE;
+    textures[1]->init(device, options);
+    textures[2]->init(device, options);
+    
+    const size_t matView = hashOf("cc_matView");
+    const size_t matProj = hashOf("cc_matpProj");
+    const size_t matViewProj = hashOf("cc_matViewProj");
+    const size_t matWorld = hashOf("cc_matWorld");
+    const size_t texture = hashOf("texture");
+    const size_t tintColor = hashOf("u_tint");
+    const size_t outlineColor = hashOf("u_outlineColor");
+    const size_t outlineWidth = hashOf("u_outlineWidth");
+    
+    Mat4 view, projection, viewProjection;
+    Mat4::createTranslation(-480, -320, -1000, &view);
+    Mat4::createOrthographicOffCenter(-480, 480, -320, 320, 0.1f, 2000, &projection);
+    viewProjection = projection * view;
+    
+    uint64_t uniformSets = 0;
+    int draws = 0;
+    auto draw = [&](Program* program, Texture2D* drawTexture, const std::function<void()>& setMaterial) {
+        device->setVertexBuffer(0, vertexBuffer);
+        device->setIndexBuffer(indexBuffer);
+        device->setProgram(program);
+        device->setUniformMat4(matView, view);
+        device->setUniformMat4(matProj, projection);
+        device->setUniformMat4(matViewProj, viewProjection);
+        device->setUniformMat4(matWorld, Mat4::IDENTITY);
+        device->setTexture(texture, drawTexture, 0);
+        uniformSets += 5;
+        setMaterial();
+        device->draw(0, 6);
+        draws++;
+    };
+    
+    double total = 0;
+    uint64_t uploads = 0;
+    for (int frame = 0; frame < frames + 1; frame++)
+    {
+        uniformSets = 0;
+        draws = 0;
+        nullgl::resetStats();
+        auto start = std::chrono::steady_clock::now();
+        
+        for (int panel = 0; panel < Panel_Count; panel++)
+        {
+            draw(sprite, textures[0], [] {});
+            for (int icon = 0; icon < Icon_Count; icon++)
+            {
+                draw(sprite, textures[1 + icon % 2], [] {});
+            }
+            // Buttons change tint while pressed, one of them every few frames.
+            for (int button = 0; button < Button_Count; button++)
+            {
+                bool pressed = (frame + panel + button) % 16 == 0;
+                draw(tint, textures[0], [&] {
+                    device->setUniformf(tintColor, 1.0f, pressed ? 0.8f : 1.0f, pressed ? 0.8f : 1.0f, 1.0f);
+                    uniformSets++;
+                });
+            }
+            draw(label, textures[2], [&] {
+                device->setUniformf(outlineColor, 0.0f, 0.0f, 0.0f, 1.0f);
+                device->setUniformf(outlineWidth, 0.1f);
+                uniformSets += 2;
+            });
+        }
+        
+        auto end = std::chrono::steady_clock::now();
+        // The first frame uploads every value once.
+        if (frame == 0) continue;
+        total += std::chrono::duration<double, std::micro>(end - start).count();
+        uploads += nullgl::getStats().uniformUpdates;
+    }
+    
+    printf("%d frames, %d draws and %llu uniform sets per frame\n", frames, draws, (unsigned long long)uniformSets);
+    printf("frame %10.2f us, %6.1f glUniform calls\n", total / frames, (double)uploads / frames);
+    
+    indexBuffer->release();
+    vertexBuffer->release();
+    textures[1]->release();
+    textures[2]->release();
+    label->release();
+    tint->release();
+    sprite->release();
+    return draws > 0 ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "HostScene.h"
+
+#include "renderer/renderer/Config.h"
+
+#include "base/CCAutoreleasePool.h"
+#include "renderer/scene/MeshBuffer.hpp"
+
+#include <math.h>
+#include <string.h>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace host {
+
+namespace
+{
+    const char* SpriteVert = R"(
+uniform mat4 cc_matViewProj;
+attribute vec3 a_position;
+attribute vec2 a_uv0;
+attribute vec4 a_color;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    gl_Position = cc_matViewProj * vec4(a_position, 1);
+    v_uv0 = a_uv0;
+    v_color = a_color;
+}
+)";
+    
+    const char* SpriteFrag = R"(
+precision mediump float;
+uniform sampler2D texture;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    gl_FragColor = texture2D(texture, v_uv0) * v_color;
+}
+)";
+    
+    const uint32_t Node_Dirty_Init = RenderFlow::LOCAL_TRANSFORM | RenderFlow::OPACITY;
+    
+    // Counts Scene::render calls, a fill is only readable back during the render that made it.
+    uint32_t renderCount = 0;
+    
+    // Keeps the range of the last fill, so that tests can read back what was sent to the mesh buffer.
+    class RecordedSprite : public SimpleSprite2D
+    {
+    public:
+        virtual void fillBuffers(NodeProxy* node, MeshBuffer* buffer, std::size_t index) override
+        {
+            SimpleSprite2D::fillBuffers(node, buffer, index);
+            lastFill = _iaDatas[index].fillRecord;
+            lastFillRender = renderCount;
+        }
+        
+        virtual void fillInstance(NodeProxy* node, InstanceBuffer* buffer, std::size_t index) override
+        {
+            uint32_t offset = buffer->getInstanceOffset();
+            SimpleSprite2D::fillInstance(node, buffer, index);
+            if (buffer->getInstanceOffset() == offset) return;
+            // Requesting no record points right after the one just written.
+            lastInstance = *(buffer->request(0) - 1);
+            lastInstanceRender = renderCount;
+        }
+        
+        virtual void fillPalette(NodeProxy* node, MeshBuffer* buffer, std::size_t index, uint32_t slot) override
+        {
+            SimpleSprite2D::fillPalette(node, buffer, index, slot);
+            lastPalette = _iaDatas[index].fillRecord;
+            lastPaletteRender = renderCount;
+        }
+        
+        MeshBuffer::FillRecord lastFill;
+        uint32_t lastFillRender = 0;
+        MeshBuffer::FillRecord lastPalette;
+        uint32_t lastPaletteRender = 0;
+        InstanceBuffer::Record lastInstance;
+        uint32_t lastInstanceRender = 0;
+    };
+}
+
+const char* Scene::getSpriteVert()
+{
+    return SpriteVert;
+}
+
+const char* Scene::getSpriteFrag()
+{
+    return SpriteFrag;
+}
+
+Scene::Scene()
+{
+    // Registered by the JS renderer before anything uses them.
+    Config::addStage("opaque");
+    Config::addStage("shadowcast");
+    Config::addStage("transparent");
+    
+    _device = DeviceGraphics::getInstance();
+    
+    Texture::Options options;
+    options.width = 64;
+    options.height = 64;
+    options.glFormat = GL_RGBA;
+    options.glInternalFormat = GL_RGBA;
+    options.glType = GL_UNSIGNED_BYTE;
+    _texture = new Texture2D();
+    _texture->init(_device, options);
+    
+    std::vector<ProgramLib::Template> templates(1);
+    templates[0].id = 1;
+    templates[0].name = "sprite";
+    templates[0].vert = SpriteVert;
+    templates[0].frag = SpriteFrag;
+    
+    _forward = new ForwardRenderer();
+    _forward->init(_device, templates, _texture, Width, Height);
+    _scene = new cocos2d::renderer::Scene();
+    _pool = new NodeMemPool();
+    _flow = new RenderFlow(_device, _scene, _forward);
+    
+    Vector<Pass*> passes;
+    auto pass = new Pass("sprite");
+    pass->setCullMode(CullMode::NONE);
+    pass->setDepth(false, false);
+    pass->setBlend(BlendOp::ADD, BlendFactor::SRC_ALPHA, BlendFactor::ONE_MINUS_SRC_ALPHA,
+                   BlendOp::ADD, BlendFactor::SRC_ALPHA, BlendFactor::ONE_MINUS_SRC_ALPHA);
+    passes.pushBack(pass);
+    pass->release();
+    Vector<Technique*> techniques;
+    auto technique = new Technique({"opaque"}, passes);
+    techniques.pushBack(technique);
+    technique->release();
+    std::unordered_map<std::string, Effect::Property> properties;
+    properties.emplace("texture", Effect::Property("texture", Effect::Property::Type::TEXTURE_2D, _texture));
+    _effect = new Effect();
+    _effect->init(techniques, properties, {});
+    
+    _root = createNode(nullptr, "root");
+    _cameraNode = createNode(_root, "camera");
+    std::size_t index = 0;
+    UnitNode* unit = getUnit(_cameraNode, index);
+    *unit->getIs3D(index) = 1;
+    unit->getTRS(index)->z = 1000;
+    panCamera(Width / 2, Height / 2);
+    
+    _camera = new Camera();
+    _camera->setType(ProjectionType::ORTHOGRAPHIC);
+    _camera->setOrthoHeight(Height / 2);
+    _camera->setNear(0.1f);
+    _camera->setFar(2000);
+    _camera->setStages({"opaque"});
+    _camera->setClearFlags(ClearFlag::COLOR | ClearFlag::DEPTH | ClearFlag::STENCIL);
+    _camera->setCullingMask(0xffffffff);
+    _camera->setNode(_cameraNode);
+    _scene->addCamera(_camera);
+}
+
+Scene::~Scene()
+{
+    _scene->removeCamera(_camera);
+    _camera->release();
+    for (auto& it : _nodes)
+    {
+        it.first->destroyImmediately();
+        it.first->release();
+    }
+    _nodes.clear();
+    _sprites.clear();
+    _effect->release();
+    delete _flow;
+    delete _pool;
+    delete _scene;
+    delete _forward;
+    _texture->release();
+    PoolManager::getInstance()->getCurrentPool()->clear();
+}
+
+Scene::Slot Scene::allocSlot()
+{
+    if (_units.empty() || _units.back()->used == UnitCapacity)
+    {
+        std::unique_ptr<Unit> unit(new Unit());
+        unit->dirty.data.resize(UnitCapacity * sizeof(uint32_t));
+        unit->trs.data.resize(UnitCapacity * sizeof(TRS));
+        unit->localMat.data.resize(UnitCapacity * sizeof(Mat4));
+        unit->worldMat.data.resize(UnitCapacity * sizeof(Mat4));
+        unit->parent.data.resize(UnitCapacity * sizeof(ParentInfo));
+        unit->zOrder.data.resize(UnitCapacity * sizeof(int32_t));
+        unit->cullingMask.data.resize(UnitCapacity * sizeof(int32_t));
+        unit->opacity.data.resize(UnitCapacity);
+        unit->is3D.data.resize(UnitCapacity);
+        unit->node.data.resize(UnitCapacity * sizeof(uint64_t));
+        unit->common.data.resize(2 * sizeof(uint16_t));
+        unit->sign.data.resize(UnitCapacity * sizeof(Sign));
+        
+        std::size_t unitID = _units.size();
+        _pool->updateCommonData(unitID, unit->common.handle(), unit->sign.handle());
+        _pool->updateNodeData(unitID, unit->dirty.handle(), unit->trs.handle(), unit->localMat.handle(),
+                              unit->worldMat.handle(), unit->parent.handle(), unit->zOrder.handle(),
+                              unit->cullingMask.handle(), unit->opacity.handle(), unit->is3D.handle(), unit->node.handle());
+        _units.push_back(std::move(unit));
+    }
+    
+    Slot slot;
+    slot.unitID = _units.size() - 1;
+    Unit& unit = *_units.back();
+    slot.index = unit.used++;
+    unit.sign.as<Sign>()[slot.index].freeFlag = 1;
+    unit.common.as<uint16_t>()[1] = (uint16_t)unit.used;
+    return slot;
+}
+
+UnitNode* Scene::getUnit(NodeProxy* node, std::size_t& index) const
+{
+    auto it = _nodes.find(node);
+    index = it->second.index;
+    return _pool->getUnit(it->second.unitID);
+}
+
+NodeProxy* Scene::createNode(NodeProxy* parent, const std::string& name)
+{
+    Slot slot = allocSlot();
+    UnitNode* unit = _pool->getUnit(slot.unitID);
+    TRS* trs = unit->getTRS(slot.index);
+    memset(trs, 0, sizeof(TRS));
+    trs->qw = 1;
+    trs->sx = trs->sy = trs->sz = 1;
+    *unit->getOpacity(slot.index) = 255;
+    *unit->getCullingMask(slot.index) = 1;
+    *unit->getDirty(slot.index) = Node_Dirty_Init;
+    
+    auto node = new NodeProxy(slot.unitID, slot.index, std::to_string(_nodes.size()), name);
+    _nodes[node] = slot;
+    setParent(node, parent);
+    return node;
+}
+
+void Scene::setParent(NodeProxy* node, NodeProxy* parent)
+{
+    std::size_t index = 0;
+    UnitNode* unit = getUnit(node, index);
+    ParentInfo* parentInfo = unit->getParent(index);
+    if (parent)
+    {
+        const Slot& parentSlot = _nodes[parent];
+        parentInfo->unitID = (uint32_t)parentSlot.unitID;
+        parentInfo->index = (uint32_t)parentSlot.index;
+    }
+    else
+    {
+        parentInfo->unitID = PARENT_INVALID;
+        parentInfo->index = PARENT_INVALID;
+    }
+    *unit->getDirty(index) |= RenderFlow::LOCAL_TRANSFORM;
+    node->notifyUpdateParent();
+}
+
+void Scene::destroyNode(NodeProxy* node)
+{
+    auto it = _nodes.find(node);
+    if (it == _nodes.end()) return;
+    
+    // Children are detached first, as the JS engine destroys them before their parent.
+    auto children = node->getChildren();
+    for (auto child : children)
+    {
+        destroyNode(child);
+    }
+    
+    Unit& unit = *_units[it->second.unitID];
+    unit.sign.as<Sign>()[it->second.index].freeFlag = 0;
+    node->destroyImmediately();
+    node->release();
+    _nodes.erase(it);
+}
+
+void Scene::setPosition(NodeProxy* node, float x, float y)
+{
+    std::size_t index = 0;
+    UnitNode* unit = getUnit(node, index);
+    TRS* trs = unit->getTRS(index);
+    trs->x = x;
+    trs->y = y;
+    *unit->getDirty(index) |= RenderFlow::LOCAL_TRANSFORM;
+}
+
+void Scene::setRotation(NodeProxy* node, float degrees)
+{
+    std::size_t index = 0;
+    UnitNode* unit = getUnit(node, index);
+    TRS* trs = unit->getTRS(index);
+    float halfAngle = degrees * (float)M_PI / 360.0f;
+    trs->qx = trs->qy = 0;
+    trs->qz = sinf(halfAngle);
+    trs->qw = cosf(halfAngle);
+    *unit->getDirty(index) |= RenderFlow::LOCAL_TRANSFORM;
+}
+
+void Scene::setOpacity(NodeProxy* node, uint8_t opacity)
+{
+    node->setOpacity(opacity);
+}
+
+void Scene::setupSprite(SimpleSprite2D* assembler, float width, float height)
+{
+    std::unique_ptr<Sprite> sprite(new Sprite());
+    sprite->assembler = assembler;
+    sprite->dirty.data.resize(sizeof(uint32_t));
+    sprite->local.data.resize(4 * sizeof(float));
+    sprite->vertices.data.resize(4 * VertexFormat::XY_UV_Color->getBytes());
+    sprite->indices.data.resize(6 * sizeof(uint16_t));
+    
+    float* local = sprite->local.as<float>();
+    local[0] = -width / 2;
+    local[1] = -height / 2;
+    local[2] = width / 2;
+    local[3] = height / 2;
+    
+    // Left bottom, right bottom, left top and right top.
+    Vertex* vertices = sprite->vertices.as<Vertex>();
+    for (int i = 0; i < 4; i++)
+    {
+        vertices[i].u = (float)(i % 2);
+        vertices[i].v = (float)(1 - i / 2);
+        vertices[i].color = 0xffffffff;
+    }
+    const uint16_t indices[] = {0, 1, 2, 1, 3, 2};
+    memcpy(sprite->indices.data.data(), indices, sizeof(indices));
+    
+    assembler->setDirty(sprite->dirty.handle());
+    assembler->setVertexFormat(VertexFormat::XY_UV_Color);
+    auto datas = new RenderDataList();
+    datas->updateMesh(0, sprite->vertices.handle(), sprite->indices.handle());
+    assembler->setRenderDataList(datas);
+    datas->release();
+    assembler->setLocalData(sprite->local.handle());
+    assembler->updateEffect(0, _effect);
+    assembler->enableDirty(AssemblerBase::VERTICES_DIRTY | AssemblerBase::VERTICES_OPACITY_CHANGED);
+    _sprites.push_back(std::move(sprite));
+}
+
+SimpleSprite2D* Scene::addSprite(NodeProxy* node, float width, float height)
+{
+    auto assembler = new RecordedSprite();
+    setupSprite(assembler, width, height);
+    node->setAssembler(assembler);
+    assembler->release();
+    
+    addFlag(node, RenderFlow::RENDER);
+    return assembler;
+}
+
+MaskAssembler* Scene::addMask(NodeProxy* node, float width, float height)
+{
+    auto assembler = new MaskAssembler();
+    setupSprite(assembler, width, height);
+    assembler->setImageStencil(true);
+    
+    // Clears the stencil of the whole screen, like the clear graphics of a mask component.
+    auto clear = new SimpleSprite2D();
+    setupSprite(clear, Width * 4, Height * 4);
+    assembler->setClearSubHandle(clear);
+    clear->release();
+    node->setAssembler(assembler);
+    assembler->release();
+    
+    addFlag(node, RenderFlow::RENDER | RenderFlow::POST_RENDER);
+    return assembler;
+}
+
+void Scene::addFlag(NodeProxy* node, uint32_t flag)
+{
+    std::size_t index = 0;
+    UnitNode* unit = getUnit(node, index);
+    *unit->getDirty(index) |= flag;
+}
+
+void Scene::panCamera(float x, float y)
+{
+    setPosition(_cameraNode, x, y);
+}
+
+void Scene::render(float deltaTime)
+{
+    renderCount++;
+    _flow->render(_root, deltaTime);
+    PoolManager::getInstance()->getCurrentPool()->clear();
+}
+
+bool Scene::getFilledVertices(SimpleSprite2D* sprite, Vertex out[4]) const
+{
+    auto recorded = dynamic_cast<RecordedSprite*>(sprite);
+    if (!recorded) return false;
+    
+    const MeshBuffer::FillRecord& record = recorded->lastFill;
+    if (!record.buffer || recorded->lastFillRender != renderCount) return false;
+    memcpy(out, (const uint8_t*)record.buffer->vData + record.vByte, 4 * sizeof(Vertex));
+    return true;
+}
+
+bool Scene::getFilledPalette(SimpleSprite2D* sprite, PaletteVertex out[4], uint32_t& firstIndex) const
+{
+    auto recorded = dynamic_cast<RecordedSprite*>(sprite);
+    if (!recorded) return false;
+    
+    const MeshBuffer::FillRecord& record = recorded->lastPalette;
+    if (!record.buffer || recorded->lastPaletteRender != renderCount) return false;
+    memcpy(out, (const uint8_t*)record.buffer->vData + record.vByte, 4 * sizeof(PaletteVertex));
+    firstIndex = record.index;
+    return true;
+}
+
+bool Scene::getFilledInstance(SimpleSprite2D* sprite, InstanceBuffer::Record& out) const
+{
+    auto recorded = dynamic_cast<RecordedSprite*>(sprite);
+    if (!recorded || recorded->lastInstanceRender != renderCount) return false;
+    out = recorded->lastInstance;
+    return true;
+}
+
+} // namespace host
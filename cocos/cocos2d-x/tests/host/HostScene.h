@@ -0,0 +1,198 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#pragma once
+
+#include "HostTypedArray.h"
+
+#include "renderer/gfx/DeviceGraphics.h"
+#include "renderer/gfx/Texture2D.h"
+#include "renderer/gfx/VertexFormat.h"
+#include "renderer/renderer/Camera.h"
+#include "renderer/renderer/Effect.h"
+#include "renderer/renderer/ForwardRenderer.h"
+#include "renderer/renderer/Scene.h"
+#include "renderer/scene/NodeMemPool.hpp"
+#include "renderer/scene/NodeProxy.hpp"
+#include "renderer/scene/RenderFlow.hpp"
+#include "renderer/scene/assembler/MaskAssembler.hpp"
+#include "renderer/scene/assembler/RenderDataList.hpp"
+#include "renderer/scene/assembler/SimpleSprite2D.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+namespace host {
+
+/**
+ * A render scene fed from native code the way the JS engine feeds it: node units live in typed
+ * arrays, dirty flags are raised by the setters and RenderFlow draws the tree through the null GL
+ * backend. Sprites and masks use the layout of the 2D sprite assembler, position, uv and packed color.
+ */
+class Scene
+{
+public:
+    static const int Width = 960;
+    static const int Height = 640;
+    // Nodes per unit, the JS engine allocates units of the same size.
+    static const std::size_t UnitCapacity = 128;
+    
+    Scene();
+    ~Scene();
+    
+    /**
+     * @brief Creates a node at the origin, a root if parent is nullptr.
+     */
+    cocos2d::renderer::NodeProxy* createNode(cocos2d::renderer::NodeProxy* parent, const std::string& name = "");
+    /**
+     * @brief Detaches a node from its parent and its level, the node can't be used anymore.
+     */
+    void destroyNode(cocos2d::renderer::NodeProxy* node);
+    /**
+     * @brief Moves a node and its subtree under another parent, or to the roots if parent is nullptr.
+     */
+    void setParent(cocos2d::renderer::NodeProxy* node, cocos2d::renderer::NodeProxy* parent);
+    
+    void setPosition(cocos2d::renderer::NodeProxy* node, float x, float y);
+    void setRotation(cocos2d::renderer::NodeProxy* node, float degrees);
+    void setOpacity(cocos2d::renderer::NodeProxy* node, uint8_t opacity);
+    
+    /**
+     * @brief Renders a sprite of the given size centered on the node.
+     */
+    cocos2d::renderer::SimpleSprite2D* addSprite(cocos2d::renderer::NodeProxy* node, float width, float height);
+    /**
+     * @brief Clips the children of the node to a rectangle centered on it.
+     */
+    cocos2d::renderer::MaskAssembler* addMask(cocos2d::renderer::NodeProxy* node, float width, float height);
+    /**
+     * @brief Raises RenderFlow flags of the node, RENDER for a node given a custom assembler.
+     */
+    void addFlag(cocos2d::renderer::NodeProxy* node, uint32_t flag);
+    
+    /**
+     * @brief Moves the camera, the center of the screen is at (x, y).
+     */
+    void panCamera(float x, float y);
+    
+    void render(float deltaTime = 1.0f / 60);
+    
+    /**
+     * @brief Reads the vertices written for a sprite into the mesh buffer during the last render.
+     * @return false if the sprite wasn't filled.
+     */
+    struct Vertex
+    {
+        float x;
+        float y;
+        float u;
+        float v;
+        uint32_t color;
+    };
+    bool getFilledVertices(cocos2d::renderer::SimpleSprite2D* sprite, Vertex out[4]) const;
+    /**
+     * @brief Reads the record written for a sprite into the instance buffer during the last render.
+     * @return false if the sprite wasn't drawn as an instance.
+     */
+    bool getFilledInstance(cocos2d::renderer::SimpleSprite2D* sprite, cocos2d::renderer::InstanceBuffer::Record& out) const;
+    /**
+     * @brief Reads the local vertices written for a sprite into a palette batch during the last render.
+     * @param[out] firstIndex Offset of the sprite indices in the index buffer, drawn by the batch covering it.
+     * @return false if the sprite wasn't drawn in a palette batch.
+     */
+    struct PaletteVertex
+    {
+        Vertex vertex;
+        float slot;
+    };
+    bool getFilledPalette(cocos2d::renderer::SimpleSprite2D* sprite, PaletteVertex out[4], uint32_t& firstIndex) const;
+    
+    cocos2d::renderer::NodeProxy* getRoot() const { return _root; }
+    cocos2d::renderer::RenderFlow* getFlow() const { return _flow; }
+    cocos2d::renderer::DeviceGraphics* getDevice() const { return _device; }
+    cocos2d::renderer::ForwardRenderer* getForward() const { return _forward; }
+    cocos2d::renderer::Scene* getRenderScene() const { return _scene; }
+    cocos2d::renderer::Effect* getEffect() const { return _effect; }
+    cocos2d::renderer::Texture2D* getTexture() const { return _texture; }
+    
+    /**
+     * @brief GLSL of the sprite program, with a texture and a vertex color.
+     */
+    static const char* getSpriteVert();
+    static const char* getSpriteFrag();
+private:
+    struct Unit
+    {
+        TypedArray dirty;
+        TypedArray trs;
+        TypedArray localMat;
+        TypedArray worldMat;
+        TypedArray parent;
+        TypedArray zOrder;
+        TypedArray cullingMask;
+        TypedArray opacity;
+        TypedArray is3D;
+        TypedArray node;
+        TypedArray common;
+        TypedArray sign;
+        std::size_t used = 0;
+    };
+    struct Slot
+    {
+        std::size_t unitID;
+        std::size_t index;
+    };
+    struct Sprite
+    {
+        cocos2d::renderer::SimpleSprite2D* assembler;
+        TypedArray dirty;
+        TypedArray local;
+        TypedArray vertices;
+        TypedArray indices;
+    };
+    
+    Slot allocSlot();
+    cocos2d::renderer::UnitNode* getUnit(cocos2d::renderer::NodeProxy* node, std::size_t& index) const;
+    void setupSprite(cocos2d::renderer::SimpleSprite2D* assembler, float width, float height);
+    
+    cocos2d::renderer::DeviceGraphics* _device = nullptr;
+    cocos2d::renderer::Texture2D* _texture = nullptr;
+    cocos2d::renderer::ForwardRenderer* _forward = nullptr;
+    cocos2d::renderer::Scene* _scene = nullptr;
+    cocos2d::renderer::RenderFlow* _flow = nullptr;
+    cocos2d::renderer::NodeMemPool* _pool = nullptr;
+    cocos2d::renderer::Effect* _effect = nullptr;
+    cocos2d::renderer::Camera* _camera = nullptr;
+    cocos2d::renderer::NodeProxy* _root = nullptr;
+    cocos2d::renderer::NodeProxy* _cameraNode = nullptr;
+    
+    std::vector<std::unique_ptr<Unit>> _units;
+    std::unordered_map<cocos2d::renderer::NodeProxy*, Slot> _nodes;
+    std::vector<std::unique_ptr<Sprite>> _sprites;
+};
+
+} // namespace host
@@ -0,0 +1,135 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "HostSpine.h"
+
+#include "renderer/scene/assembler/CustomAssembler.hpp"
+
+#include <stdio.h>
+#include <string>
+
+using namespace cocos2d;
+
+namespace host {
+
+namespace
+{
+    // The texture loader of the spine runtime is a plain function.
+    Scene* textureScene = nullptr;
+    
+    middleware::Texture2D* loadTexture(const char* path)
+    {
+        auto texture = new middleware::Texture2D();
+        texture->autorelease();
+        texture->setPixelsWide(textureScene->getTexture()->getWidth());
+        texture->setPixelsHigh(textureScene->getTexture()->getHeight());
+        texture->setNativeTexture(textureScene->getTexture());
+        return texture;
+    }
+    
+    void disposeObject(void* object)
+    {
+    }
+    
+    // One page with a region per bone, laid out on a grid of the 64 x 64 texture.
+    std::string makeAtlas()
+    {
+        std::string atlas = "\nspine.png\nsize: 64,64\nformat: RGBA8888\nfilter: Linear,Linear\nrepeat: none\n";
+        for (int i = 0; i < SpineData::BoneCount; i++)
+        {
+            atlas += "r" + std::to_string(i) + "\n";
+            atlas += "  rotate: false\n";
+            atlas += "  xy: " + std::to_string(i % 4 * 16) + ", " + std::to_string(i / 4 * 16) + "\n";
+            atlas += "  size: 16, 16\n  orig: 16, 16\n  offset: 0, 0\n  index: -1\n";
+        }
+        return atlas;
+    }
+    
+    std::string makeSkeleton()
+    {
+        std::string bones = "{\"name\":\"root\"}";
+        std::string slots;
+        std::string attachments;
+        std::string timelines;
+        for (int i = 0; i < SpineData::BoneCount; i++)
+        {
+            std::string bone = "b" + std::to_string(i);
+            std::string parent = i == 0 ? "root" : "b" + std::to_string(i - 1);
+            std::string region = "r" + std::to_string(i);
+            std::string separator = i == 0 ? "" : ",";
+            bones += ",{\"name\":\"" + bone + "\",\"parent\":\"" + parent + "\",\"length\":16,\"x\":" + (i == 0 ? "0" : "16") + "}";
+            slots += separator + "{\"name\":\"s" + std::to_string(i) + "\",\"bone\":\"" + bone + "\",\"attachment\":\"" + region + "\"}";
+            attachments += separator + "\"s" + std::to_string(i) + "\":{\"" + region + "\":{\"x\":8,\"width\":16,\"height\":16}}";
+            timelines += separator + "\"" + bone + "\":{\"rotate\":[{\"time\":0,\"angle\":-10},{\"time\":0.5,\"angle\":10},{\"time\":1,\"angle\":-10}]}";
+        }
+        return "{\"skeleton\":{\"spine\":\"3.7.94\",\"width\":192,\"height\":192},"
+               "\"bones\":[" + bones + "],"
+               "\"slots\":[" + slots + "],"
+               "\"skins\":{\"default\":{" + attachments + "}},"
+               "\"animations\":{\"" + SpineData::getAnimationName() + "\":{\"bones\":{" + timelines + "}}}}";
+    }
+}
+
+SpineData::SpineData(Scene* scene)
+: _scene(scene)
+{
+    textureScene = scene;
+    spine::spAtlasPage_setCustomTextureLoader(loadTexture);
+    spine::setSpineObjectDisposeCallback(disposeObject);
+    
+    std::string atlas = makeAtlas();
+    _atlas = new spine::Atlas(atlas.c_str(), (int)atlas.size(), "", &_textureLoader);
+    _attachmentLoader = new spine::Cocos2dAtlasAttachmentLoader(_atlas);
+    spine::SkeletonJson json(_attachmentLoader);
+    _data = json.readSkeletonData(makeSkeleton().c_str());
+    if (!_data)
+    {
+        printf("skeleton data error: %s\n", json.getError().buffer());
+    }
+}
+
+SpineData::~SpineData()
+{
+    delete _data;
+    delete _attachmentLoader;
+    delete _atlas;
+}
+
+spine::SkeletonAnimation* SpineData::createAnimation(renderer::NodeProxy* node) const
+{
+    auto assembler = new renderer::CustomAssembler();
+    node->setAssembler(assembler);
+    assembler->release();
+    
+    auto animation = spine::SkeletonAnimation::createWithData(_data, false);
+    animation->retain();
+    animation->bindNodeProxy(node);
+    animation->setEffect(_scene->getEffect());
+    animation->setAnimation(0, getAnimationName(), true);
+    _scene->addFlag(node, renderer::RenderFlow::RENDER);
+    return animation;
+}
+
+} // namespace host
@@ -0,0 +1,63 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#pragma once
+
+#include "HostScene.h"
+
+#include "spine-creator-support/spine-cocos2dx.h"
+
+namespace host {
+
+/**
+ * Spine skeleton data built in memory: a chain of bones with a region each, swinging in a looping
+ * animation. The regions are drawn from the texture of the scene.
+ */
+class SpineData
+{
+public:
+    static const int BoneCount = 12;
+    static const char* getAnimationName() { return "swing"; }
+    
+    explicit SpineData(Scene* scene);
+    ~SpineData();
+    
+    /**
+     * @return nullptr if the data failed to load.
+     */
+    spine::SkeletonData* getSkeletonData() const { return _data; }
+    /**
+     * @brief Renders a retained skeleton playing the animation on the node, release it before destroying the node.
+     */
+    spine::SkeletonAnimation* createAnimation(cocos2d::renderer::NodeProxy* node) const;
+private:
+    Scene* _scene;
+    spine::Cocos2dTextureLoader _textureLoader;
+    spine::Atlas* _atlas = nullptr;
+    spine::Cocos2dAtlasAttachmentLoader* _attachmentLoader = nullptr;
+    spine::SkeletonData* _data = nullptr;
+};
+
+} // namespace host
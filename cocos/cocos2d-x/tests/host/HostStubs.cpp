@@ -0,0 +1,161 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Definitions of the platform and script engine symbols the renderer links against,
+// so that it runs on the host without Android, V8 or the JS bindings.
+
+#include "HostTypedArray.h"
+
+#include "platform/CCGL.h"
+#include "platform/CCApplication.h"
+#include "platform/CCFileUtils.h"
+#include "base/ccUtils.h"
+#include "scripting/js-bindings/jswrapper/SeApi.h"
+
+#include <android/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int ret = vprintf(fmt, args);
+    va_end(args);
+    putchar('\n');
+    return ret;
+}
+
+// Extension entry points resolved by the Android application at startup.
+// Program binaries stay unsupported, the host has no writable path to cache them in.
+PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESEXT = ::cocos2d::nullgl::GenVertexArrays;
+PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESEXT = ::cocos2d::nullgl::BindVertexArray;
+PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT = ::cocos2d::nullgl::DeleteVertexArrays;
+PFNGLMAPBUFFERRANGEEXTPROC glMapBufferRangeEXTEXT = ::cocos2d::nullgl::MapBufferRange;
+PFNGLUNMAPBUFFEROESPROC glUnmapBufferOESEXT = ::cocos2d::nullgl::UnmapBuffer;
+PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT = nullptr;
+PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXTEXT = ::cocos2d::nullgl::DrawElementsInstanced;
+PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT = ::cocos2d::nullgl::VertexAttribDivisor;
+
+NS_CC_BEGIN
+
+Application* Application::_instance = nullptr;
+
+GLint Application::getMainFBO() const
+{
+    return 0;
+}
+
+// No file system on the host, callers which need one are not linked or not reached.
+FileUtils* FileUtils::getInstance()
+{
+    return nullptr;
+}
+
+namespace utils
+{
+    double atof(const char* str)
+    {
+        return strtod(str, nullptr);
+    }
+}
+
+NS_CC_END
+
+namespace se {
+
+    void RefCounter::incRef()
+    {
+    }
+    
+    void RefCounter::decRef()
+    {
+    }
+    
+    Object* Object::createTypedArray(TypedArrayType type, void* data, size_t byteLength)
+    {
+        auto array = new host::TypedArray(byteLength);
+        if (data)
+        {
+            memcpy(array->data.data(), data, byteLength);
+        }
+        return array->handle();
+    }
+    
+    bool Object::getTypedArrayData(uint8_t** ptr, size_t* length) const
+    {
+        auto array = host::TypedArray::fromHandle(this);
+        *ptr = array->data.data();
+        *length = array->size();
+        return true;
+    }
+    
+    void Object::root()
+    {
+    }
+    
+    void Object::unroot()
+    {
+    }
+    
+    ScriptEngine* ScriptEngine::getInstance()
+    {
+        // Never constructed, only members which don't touch the instance are defined below.
+        alignas(ScriptEngine) static char storage[sizeof(ScriptEngine)];
+        return (ScriptEngine*)storage;
+    }
+    
+    void ScriptEngine::clearException()
+    {
+    }
+    
+    void ScriptEngine::addAfterInitHook(const std::function<void()>& hook)
+    {
+    }
+    
+    void ScriptEngine::addAfterCleanupHook(const std::function<void()>& hook)
+    {
+    }
+
+} // namespace se
+
+namespace v8 {
+
+    HandleScope::HandleScope(Isolate* isolate)
+    {
+    }
+    
+    HandleScope::~HandleScope()
+    {
+    }
+    
+    Isolate* Isolate::GetCurrent()
+    {
+        return nullptr;
+    }
+
+} // namespace v8
@@ -0,0 +1,75 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace se {
+    class Object;
+}
+
+namespace host {
+
+/**
+ * Stands in for a script typed array on the host.
+ * The engine only reads typed arrays through se::Object::getTypedArrayData, which the host
+ * stubs implement on top of this struct, so native units and render data can be fed without V8.
+ * The memory is owned by the test, reference counting of the handle is a no-op.
+ */
+struct TypedArray
+{
+    explicit TypedArray(size_t bytes = 0)
+    : data(bytes, 0)
+    {
+    }
+    
+    template<typename T>
+    T* as()
+    {
+        return (T*)data.data();
+    }
+    
+    size_t size() const
+    {
+        return data.size();
+    }
+    
+    se::Object* handle()
+    {
+        return (se::Object*)this;
+    }
+    
+    static TypedArray* fromHandle(const se::Object* object)
+    {
+        return (TypedArray*)object;
+    }
+    
+    std::vector<uint8_t> data;
+};
+
+} // namespace host
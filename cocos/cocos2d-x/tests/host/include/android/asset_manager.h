@@ -0,0 +1,5 @@
+#pragma once
+
+// Host replacement of the NDK asset manager header, assets are never read through it on the host.
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
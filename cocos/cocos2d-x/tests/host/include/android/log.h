@@ -0,0 +1,20 @@
+#pragma once
+
+// Host replacement of the NDK log header, the engine only builds against the Android platform layer.
+enum
+{
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+#ifdef __cplusplus
+extern "C"
+#endif
+int __android_log_print(int prio, const char* tag, const char* fmt, ...);
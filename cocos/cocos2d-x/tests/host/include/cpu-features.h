@@ -0,0 +1,40 @@
+#pragma once
+
+// Host replacement of the NDK cpu features header, the host is never taken for an ARM device.
+#include <stdint.h>
+
+typedef enum
+{
+    ANDROID_CPU_FAMILY_UNKNOWN = 0,
+    ANDROID_CPU_FAMILY_ARM,
+    ANDROID_CPU_FAMILY_X86,
+    ANDROID_CPU_FAMILY_MIPS,
+    ANDROID_CPU_FAMILY_ARM64,
+    ANDROID_CPU_FAMILY_X86_64,
+    ANDROID_CPU_FAMILY_MIPS64,
+} AndroidCpuFamily;
+
+enum
+{
+    ANDROID_CPU_ARM_FEATURE_ARMv7 = (1 << 0),
+    ANDROID_CPU_ARM_FEATURE_VFPv3 = (1 << 1),
+    ANDROID_CPU_ARM_FEATURE_NEON = (1 << 2),
+};
+
+static inline AndroidCpuFamily android_getCpuFamily()
+{
+#if defined(__x86_64__)
+    return ANDROID_CPU_FAMILY_X86_64;
+#elif defined(__i386__)
+    return ANDROID_CPU_FAMILY_X86;
+#elif defined(__aarch64__)
+    return ANDROID_CPU_FAMILY_ARM64;
+#else
+    return ANDROID_CPU_FAMILY_UNKNOWN;
+#endif
+}
+
+static inline uint64_t android_getCpuFeatures()
+{
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Host replacement of the JNI header, only the declarations reached by the engine headers are provided.
+#include <stdint.h>
+
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef int8_t jbyte;
+typedef uint8_t jboolean;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+struct _jobject {};
+struct _jarray : _jobject {};
+struct _jbyteArray : _jarray {};
+struct _jfloatArray : _jarray {};
+typedef _jobject* jobject;
+typedef jobject jclass;
+typedef jobject jstring;
+typedef _jarray* jarray;
+typedef _jbyteArray* jbyteArray;
+typedef _jfloatArray* jfloatArray;
+
+struct _jmethodID;
+typedef _jmethodID* jmethodID;
+
+struct JavaVM;
+
+// The host never calls into Java, every entry point is a no-op.
+struct JNIEnv
+{
+    template <typename... Ts> jobject NewObject(Ts...) { return nullptr; }
+    template <typename... Ts> jobject CallObjectMethod(Ts...) { return nullptr; }
+    template <typename... Ts> void CallVoidMethod(Ts...) {}
+    template <typename... Ts> jfloat CallFloatMethod(Ts...) { return 0; }
+    template <typename... Ts> jobject CallStaticObjectMethod(Ts...) { return nullptr; }
+    template <typename... Ts> void CallStaticVoidMethod(Ts...) {}
+    template <typename... Ts> jboolean CallStaticBooleanMethod(Ts...) { return JNI_FALSE; }
+    template <typename... Ts> jint CallStaticIntMethod(Ts...) { return 0; }
+    template <typename... Ts> jfloat CallStaticFloatMethod(Ts...) { return 0; }
+    template <typename... Ts> jdouble CallStaticDoubleMethod(Ts...) { return 0; }
+    jsize GetArrayLength(jarray) { return 0; }
+    jfloat* GetFloatArrayElements(jfloatArray, jboolean*) { return nullptr; }
+    void ReleaseFloatArrayElements(jfloatArray, jfloat*, jint) {}
+    void DeleteLocalRef(jobject) {}
+};
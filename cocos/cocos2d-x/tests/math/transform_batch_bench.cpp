@@ -0,0 +1,125 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the vertex transform of 10k vertex batches: the per vertex Mat4 calls the assemblers made
+// before, the scalar batch kernel and the kernel MathUtil dispatches to on this machine.
+// Usage: transform_batch_bench [iterations]
+
+#include "math/CCMath.h"
+#include "math/MathUtil.h"
+// The scalar kernels, the reference of the SIMD ones.
+#include "math/MathUtil.inl"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace
+{
+    const std::size_t Vertex_Count = 10000;
+    // Floats per vertex of VertexFormat::XY_UV_Color and XYZ_UV_Color.
+    const std::size_t Stride_2D = 5;
+    const std::size_t Stride_3D = 6;
+    
+    float sink = 0;
+    
+    template <typename Transform>
+    double measure(std::vector<float>& vertices, int iterations, Transform transform)
+    {
+        std::vector<float> source = vertices;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            // The assemblers transform local vertices copied in place, the copy is part of the cost.
+            memcpy(vertices.data(), source.data(), vertices.size() * sizeof(float));
+            transform(vertices.data());
+            sink += vertices[i % vertices.size()];
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    }
+    
+    std::vector<float> makeVertices(std::size_t stride)
+    {
+        std::vector<float> vertices(Vertex_Count * stride);
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {
+            vertices[i] = (float)(i % 997) - 498.0f;
+        }
+        return vertices;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    if (iterations <= 0) iterations = 2000;
+    
+    Mat4 m;
+    Mat4::createTranslation(120, -40, 3, &m);
+    m.rotateZ(0.3f);
+    m.scale(1.5f, 0.75f, 1.0f);
+    
+    std::vector<float> vertices2D = makeVertices(Stride_2D);
+    std::vector<float> vertices3D = makeVertices(Stride_3D);
+    
+    double vec2PerVertex = measure(vertices2D, iterations, [&](float* points) {
+        for (std::size_t i = 0; i < Vertex_Count; i++, points += Stride_2D)
+        {
+            float z = points[2];
+            points[2] = 0;
+            m.transformPoint((Vec3*)points);
+            points[2] = z;
+        }
+    });
+    double vec2Scalar = measure(vertices2D, iterations, [&](float* points) {
+        MathUtilC::transformVec2Batch(m.m, points, Vertex_Count, Stride_2D);
+    });
+    double vec2Batch = measure(vertices2D, iterations, [&](float* points) {
+        MathUtil::transformVec2Batch(m.m, points, Vertex_Count, Stride_2D);
+    });
+    
+    double vec3PerVertex = measure(vertices3D, iterations, [&](float* points) {
+        for (std::size_t i = 0; i < Vertex_Count; i++, points += Stride_3D)
+        {
+            ((Vec3*)points)->transformMat4(*(Vec3*)points, m);
+        }
+    });
+    double vec3Scalar = measure(vertices3D, iterations, [&](float* points) {
+        MathUtilC::transformVec3Batch(m.m, points, Vertex_Count, Stride_3D);
+    });
+    double vec3Batch = measure(vertices3D, iterations, [&](float* points) {
+        MathUtil::transformVec3Batch(m.m, points, Vertex_Count, Stride_3D);
+    });
+    
+    printf("%zu vertices, %d iterations, us per batch\n", Vertex_Count, iterations);
+    printf("%-6s %12s %12s %12s\n", "", "per vertex", "scalar", "MathUtil");
+    printf("%-6s %12.2f %12.2f %12.2f\n", "vec2", vec2PerVertex, vec2Scalar, vec2Batch);
+    printf("%-6s %12.2f %12.2f %12.2f\n", "vec3", vec3PerVertex, vec3Scalar, vec3Batch);
+    return sink == sink ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// The batched transforms, the scalar kernel and the one MathUtil dispatches to, must match a double
+// precision transform for every count, stride and kind of matrix, and leave the other vertex data alone.
+
+#include "HostCheck.h"
+
+#include "math/CCMath.h"
+#include "math/MathUtil.h"
+// The scalar kernels, the reference of the SIMD ones.
+#include "math/MathUtil.inl"
+
+#include <float.h>
+#include <random>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace
+{
+    std::mt19937 generator(7);
+    
+    float random(float min, float max)
+    {
+        return std::uniform_real_distribution<float>(min, max)(generator);
+    }
+    
+    Mat4 makeAffine()
+    {
+        Mat4 m;
+        Mat4::createTranslation(random(-500, 500), random(-500, 500), random(-10, 10), &m);
+        m.rotateZ(random(-3.2f, 3.2f));
+        m.rotateX(random(-0.5f, 0.5f));
+        m.scale(random(0.1f, 4.0f), random(0.1f, 4.0f), 1.0f);
+        return m;
+    }
+    
+    Mat4 makeProjective()
+    {
+        Mat4 projection;
+        Mat4::createPerspective(60.0f, 1.5f, 0.1f, 1000.0f, &projection);
+        Mat4 view;
+        Mat4::createTranslation(0, 0, -300, &view);
+        return projection * view * makeAffine();
+    }
+    
+    // Interleaved vertices with one more float after the last one.
+    std::vector<float> makeVertices(std::size_t count, std::size_t stride)
+    {
+        std::vector<float> vertices(count * stride + 1);
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {
+            vertices[i] = random(-200, 200);
+        }
+        return vertices;
+    }
+    
+    // Transforms a point in double precision, with the rounding error a float kernel may have for it.
+    // Kernels sum the terms in different orders, a result made of cancelling terms differs by a few
+    // ulps of the terms rather than of the result, and a projection scales that by 1 / w.
+    void transformReference(const Mat4& m, const float* point, double result[3], double error[3])
+    {
+        const double epsilon = 8.0 * FLT_EPSILON;
+        double x = point[0], y = point[1], z = point[2];
+        double w = x * m.m[3] + y * m.m[7] + z * m.m[11] + m.m[15];
+        double wMagnitude = fabs(x * m.m[3]) + fabs(y * m.m[7]) + fabs(z * m.m[11]) + fabs(m.m[15]);
+        double rhw = w != 0.0 ? 1.0 / w : 1.0;
+        for (int i = 0; i < 3; i++)
+        {
+            double value = x * m.m[i] + y * m.m[4 + i] + z * m.m[8 + i] + m.m[12 + i];
+            double magnitude = fabs(x * m.m[i]) + fabs(y * m.m[4 + i]) + fabs(z * m.m[8 + i]) + fabs(m.m[12 + i]);
+            result[i] = value * rhw;
+            error[i] = epsilon * fabs(rhw) * (magnitude + fabs(result[i]) * wMagnitude) + FLT_MIN;
+        }
+    }
+    
+    // Compares a transformed batch with the source, only the first components of each vertex may change.
+    bool checkBatch(const Mat4& m, const std::vector<float>& source, const std::vector<float>& batch,
+                    std::size_t count, std::size_t stride, int components)
+    {
+        for (std::size_t i = 0; i < source.size(); i++)
+        {
+            if (i >= count * stride || i % stride >= (std::size_t)components)
+            {
+                if (batch[i] != source[i]) return false;
+            }
+        }
+        
+        float point[3] = {};
+        double result[3], error[3];
+        for (std::size_t i = 0; i < count; i++)
+        {
+            memcpy(point, source.data() + i * stride, components * sizeof(float));
+            transformReference(m, point, result, error);
+            for (int j = 0; j < components; j++)
+            {
+                if (fabs(batch[i * stride + j] - result[j]) > error[j]) return false;
+            }
+        }
+        return true;
+    }
+    
+    void checkVec2(const Mat4& m, std::size_t count, std::size_t stride)
+    {
+        std::vector<float> source = makeVertices(count, stride);
+        std::vector<float> batch = source;
+        std::vector<float> scalar = source;
+        MathUtil::transformVec2Batch(m.m, batch.data(), count, stride);
+        MathUtilC::transformVec2Batch(m.m, scalar.data(), count, stride);
+        
+        if (!HOST_CHECK(checkBatch(m, source, batch, count, stride, 2) && checkBatch(m, source, scalar, count, stride, 2)))
+        {
+            printf("  transformVec2Batch count %zu stride %zu\n", count, stride);
+        }
+    }
+    
+    void checkVec3(const Mat4& m, std::size_t count, std::size_t stride)
+    {
+        std::vector<float> source = makeVertices(count, stride);
+        std::vector<float> batch = source;
+        std::vector<float> scalar = source;
+        MathUtil::transformVec3Batch(m.m, batch.data(), count, stride);
+        MathUtilC::transformVec3Batch(m.m, scalar.data(), count, stride);
+        
+        if (!HOST_CHECK(checkBatch(m, source, batch, count, stride, 3) && checkBatch(m, source, scalar, count, stride, 3)))
+        {
+            printf("  transformVec3Batch count %zu stride %zu\n", count, stride);
+        }
+    }
+}
+
+int main()
+{
+    // Strides of packed positions and of the 2D and 3D vertex formats with uv and packed color.
+    const std::size_t strides2D[] = { 2, 5, 6 };
+    const std::size_t strides3D[] = { 3, 6, 9 };
+    
+    for (int round = 0; round < 20; round++)
+    {
+        Mat4 affine = makeAffine();
+        Mat4 projective = makeProjective();
+        for (std::size_t count = 0; count <= 17; count++)
+        {
+            for (std::size_t stride : strides2D)
+            {
+                checkVec2(affine, count, stride);
+                checkVec2(Mat4::IDENTITY, count, stride);
+            }
+            for (std::size_t stride : strides3D)
+            {
+                checkVec3(affine, count, stride);
+                checkVec3(projective, count, stride);
+                checkVec3(Mat4::IDENTITY, count, stride);
+            }
+        }
+    }
+    
+    return host::failedChecks();
+}
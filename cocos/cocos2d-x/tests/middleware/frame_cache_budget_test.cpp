@@ -0,0 +1,173 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// FrameCacheBudget evicts the least recently used animations once the baked frames exceed the
+// budget, and never those used in the current or the previous frame.
+
+#include "HostCheck.h"
+
+#include "FrameCacheBudget.h"
+
+using namespace cocos2d::middleware;
+
+namespace
+{
+    // Releases its bytes when evicted, as SkeletonCache and ArmatureCache do through reset.
+    class Animation : public ICachedAnimation
+    {
+    public:
+        Animation ()
+        {
+            FrameCacheBudget::getInstance()->addAnimation(this);
+        }
+        
+        ~Animation ()
+        {
+            FrameCacheBudget::getInstance()->removeAnimation(this);
+        }
+        
+        void bake (std::size_t bytes)
+        {
+            FrameCacheBudget::getInstance()->resize(this, (std::ptrdiff_t)bytes);
+        }
+        
+        virtual void evictFrames () override
+        {
+            evictions++;
+            if (releases)
+            {
+                FrameCacheBudget::getInstance()->resize(this, -(std::ptrdiff_t)getCachedBytes());
+            }
+        }
+        
+        int evictions = 0;
+        bool releases = true;
+    };
+}
+
+int main()
+{
+    FrameCacheBudget* budget = FrameCacheBudget::getInstance();
+    budget->setBudget(1000);
+    
+    {
+        // Animations never played are evictable from the start.
+        Animation a, b, c;
+        a.bake(400);
+        b.bake(400);
+        HOST_CHECK(budget->getUsedBytes() == 800);
+        c.bake(400);
+        HOST_CHECK(a.evictions == 1 && b.evictions == 0 && c.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 800);
+    }
+    HOST_CHECK(budget->getUsedBytes() == 0);
+    
+    {
+        // The least recently used goes first, and only as many as needed.
+        Animation a, b, c, d;
+        budget->touch(&a);
+        a.bake(300);
+        budget->touch(&b);
+        b.bake(300);
+        budget->touch(&c);
+        c.bake(300);
+        budget->beginFrame();
+        budget->beginFrame();
+        budget->touch(&b);
+        budget->touch(&a);
+        budget->beginFrame();
+        budget->beginFrame();
+        d.bake(300);
+        HOST_CHECK(c.evictions == 1 && a.evictions == 0 && b.evictions == 0);
+        d.bake(300);
+        HOST_CHECK(b.evictions == 1 && a.evictions == 0 && d.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 900);
+    }
+    
+    {
+        // Animations played in this or the previous frame are kept even over the budget.
+        Animation a, b, c;
+        budget->beginFrame();
+        budget->touch(&a);
+        a.bake(600);
+        budget->beginFrame();
+        budget->touch(&b);
+        b.bake(600);
+        HOST_CHECK(a.evictions == 0 && b.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 1200);
+        
+        // Once a stops, it is evicted by the next bake.
+        budget->beginFrame();
+        budget->touch(&b);
+        budget->touch(&c);
+        c.bake(100);
+        HOST_CHECK(a.evictions == 1 && b.evictions == 0 && c.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 700);
+        
+        // The growing animation never evicts itself.
+        budget->beginFrame();
+        budget->beginFrame();
+        b.bake(600);
+        HOST_CHECK(b.evictions == 0 && c.evictions == 1);
+        HOST_CHECK(budget->getUsedBytes() == 1200);
+    }
+    
+    {
+        // Lowering the budget trims at once, 0 disables eviction.
+        Animation a, b;
+        a.bake(500);
+        b.bake(400);
+        budget->setBudget(0);
+        a.bake(5000);
+        HOST_CHECK(a.evictions == 0 && b.evictions == 0);
+        budget->setBudget(2000);
+        HOST_CHECK(a.evictions == 1 && b.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 400);
+        
+        // Releasing bytes never evicts.
+        budget->setBudget(300);
+        HOST_CHECK(b.evictions == 1);
+        b.bake(1000);
+        budget->touch(&b);
+        budget->resize(&b, -500);
+        HOST_CHECK(a.evictions == 1 && budget->getUsedBytes() == 500);
+    }
+    
+    {
+        // An animation which can't release its frames doesn't stall the trim.
+        Animation a, b;
+        budget->setBudget(1000);
+        a.releases = false;
+        a.bake(800);
+        b.bake(800);
+        HOST_CHECK(a.evictions == 1 && b.evictions == 0);
+        HOST_CHECK(budget->getUsedBytes() == 1600);
+        budget->resize(&a, -800);
+    }
+    HOST_CHECK(budget->getUsedBytes() == 0);
+    
+    FrameCacheBudget::destroyInstance();
+    return host::failedChecks();
+}
@@ -0,0 +1,260 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Frame cache files written by FrameCacheWriter must read back as written, and truncated or
+// corrupt files must be rejected or read within bounds, never past the loaded data.
+
+#include "HostCheck.h"
+
+#include "FrameCacheFile.h"
+#include "PackedMesh.h"
+
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::middleware;
+
+namespace
+{
+    const uint64_t Source_Hash = 0x0123456789abcdefULL;
+    const char* Animation_Name = "walk";
+    const std::size_t Array_Sizes[] = { 0, 1, 3, 4, 5, 64 };
+    const std::size_t Frame_Count = 3;
+    const uint32_t End_Marker = 0xe11df00d;
+    
+    // x, y, u, v of two quads, the first frame draws one of them.
+    const float Vertices[] = {
+        -10.0f, -20.0f, 0.0f, 1.0f,
+         10.0f, -20.0f, 1.0f, 1.0f,
+        -10.0f,  20.0f, 0.0f, 0.0f,
+         10.0f,  20.0f, 1.0f, 0.0f,
+         30.0f,  40.0f, 0.5f, 0.5f,
+         50.0f,  40.0f, 1.0f, 0.5f,
+         30.0f,  60.0f, 0.5f, 0.0f,
+         50.0f,  60.0f, 1.0f, 0.0f,
+    };
+    const uint16_t Indices[] = { 0, 1, 2, 1, 3, 2, 4, 5, 6, 5, 7, 6 };
+    
+    uint8_t arrayByte(std::size_t size, std::size_t i)
+    {
+        return (uint8_t)(size * 31 + i);
+    }
+    
+    // The second frame moves the quad and shares uvs and indices, the third adds a quad.
+    void packFrames(PackedMesh meshes[Frame_Count])
+    {
+        std::vector<float> moved(Vertices, Vertices + 16);
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            moved[i * 4] += 5.0f;
+        }
+        meshes[0].pack(Vertices, 4, 4, Indices, 6, nullptr);
+        meshes[1].pack(moved.data(), 4, 4, Indices, 6, &meshes[0]);
+        meshes[2].pack(Vertices, 8, 4, Indices, 12, &meshes[1]);
+    }
+    
+    std::vector<uint8_t> writeFile()
+    {
+        FrameCacheWriter writer(Source_Hash, Animation_Name);
+        writer.writeUint32(7);
+        writer.writeFloat(1.5f);
+        for (std::size_t size : Array_Sizes)
+        {
+            std::vector<uint8_t> bytes(size);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                bytes[i] = arrayByte(size, i);
+            }
+            writer.writeArray(bytes.data(), size);
+        }
+        
+        PackedMesh meshes[Frame_Count];
+        packFrames(meshes);
+        for (std::size_t i = 0; i < Frame_Count; i++)
+        {
+            meshes[i].write(writer, i > 0 ? &meshes[i - 1] : nullptr);
+        }
+        writer.writeUint32(End_Marker);
+        return writer.getBuffer();
+    }
+    
+    Data makeData(const std::vector<uint8_t>& bytes, std::size_t size)
+    {
+        Data data;
+        data.copy(bytes.data(), (ssize_t)size);
+        return data;
+    }
+    
+    // Reads everything writeFile wrote, whatever the values are. Arrays must lie inside the data and
+    // meshes which read must be usable, the values are only compared if exact is set.
+    bool readFile(const Data& data, bool exact)
+    {
+        FrameCacheReader reader;
+        if (!reader.open(data, Source_Hash, Animation_Name)) return false;
+        
+        uint32_t value = 0;
+        float number = 0;
+        reader.readUint32(value);
+        if (exact) HOST_CHECK(value == 7);
+        reader.readFloat(number);
+        if (exact) HOST_CHECK(number == 1.5f);
+        
+        for (std::size_t size : Array_Sizes)
+        {
+            // The reader keeps its own copy of the data, the count and the bytes must fit in what was left.
+            std::size_t remaining = reader.getRemaining();
+            std::size_t bytes = 0;
+            const uint8_t* array = reader.readArray(bytes);
+            if (!array) return false;
+            if (!HOST_CHECK(sizeof(uint32_t) + bytes <= remaining)) return false;
+            if (!exact) continue;
+            
+            bool equal = bytes == size;
+            for (std::size_t i = 0; equal && i < size; i++)
+            {
+                equal = array[i] == arrayByte(size, i);
+            }
+            HOST_CHECK(equal);
+        }
+        
+        PackedMesh meshes[Frame_Count];
+        for (std::size_t i = 0; i < Frame_Count; i++)
+        {
+            if (!meshes[i].read(reader, i > 0 ? &meshes[i - 1] : nullptr)) return false;
+            
+            std::size_t vertexCount = meshes[i].getVertexCount();
+            std::vector<float> vertices(vertexCount * 4);
+            meshes[i].unpack(0, vertexCount, vertices.data(), 4);
+            for (std::size_t j = 0; j < meshes[i].getIndexCount(); j++)
+            {
+                if (!HOST_CHECK(meshes[i].getIndices()[j] < vertexCount)) return false;
+            }
+        }
+        
+        if (!reader.readUint32(value) || !reader.isEnd()) return false;
+        if (exact) HOST_CHECK(value == End_Marker);
+        return !reader.isFailed();
+    }
+    
+    void checkMeshes()
+    {
+        PackedMesh written[Frame_Count];
+        packFrames(written);
+        std::vector<uint8_t> bytes = writeFile();
+        Data data = makeData(bytes, bytes.size());
+        FrameCacheReader reader;
+        HOST_CHECK(reader.open(data, Source_Hash, Animation_Name));
+        uint32_t value = 0;
+        float number = 0;
+        reader.readUint32(value);
+        reader.readFloat(number);
+        for (std::size_t i = 0; i < sizeof(Array_Sizes) / sizeof(Array_Sizes[0]); i++)
+        {
+            std::size_t size = 0;
+            reader.readArray(size);
+        }
+        
+        PackedMesh meshes[Frame_Count];
+        for (std::size_t i = 0; i < Frame_Count; i++)
+        {
+            HOST_CHECK(meshes[i].read(reader, i > 0 ? &meshes[i - 1] : nullptr));
+            HOST_CHECK(meshes[i].getVertexCount() == written[i].getVertexCount());
+            HOST_CHECK(meshes[i].getIndexCount() == written[i].getIndexCount());
+            HOST_CHECK(meshes[i].getByteSize() == written[i].getByteSize());
+            
+            std::size_t vertexCount = written[i].getVertexCount();
+            std::vector<float> expected(vertexCount * 4), actual(vertexCount * 4);
+            written[i].unpack(0, vertexCount, expected.data(), 4);
+            meshes[i].unpack(0, vertexCount, actual.data(), 4);
+            HOST_CHECK(expected == actual);
+            HOST_CHECK(memcmp(meshes[i].getIndices(), Indices, meshes[i].getIndexCount() * sizeof(uint16_t)) == 0);
+        }
+        // Shared data stays shared.
+        HOST_CHECK(meshes[1].getIndices() == meshes[0].getIndices());
+        HOST_CHECK(meshes[2].getIndices() != meshes[1].getIndices());
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> bytes = writeFile();
+    HOST_CHECK(bytes.size() % 4 == 0);
+    HOST_CHECK(readFile(makeData(bytes, bytes.size()), true));
+    checkMeshes();
+    
+    // Files of another source, animation or format.
+    FrameCacheReader reader;
+    Data data = makeData(bytes, bytes.size());
+    HOST_CHECK(!reader.open(data, Source_Hash + 1, Animation_Name));
+    HOST_CHECK(!reader.open(data, Source_Hash, "walk2"));
+    HOST_CHECK(!reader.open(data, Source_Hash, "wal"));
+    HOST_CHECK(!reader.open(Data(), Source_Hash, Animation_Name));
+    for (std::size_t field = 0; field < 2; field++)
+    {
+        std::vector<uint8_t> header = bytes;
+        header[field * 4] ^= 1;
+        HOST_CHECK(!reader.open(makeData(header, header.size()), Source_Hash, Animation_Name));
+    }
+    
+    // Every truncation fails.
+    for (std::size_t size = 0; size < bytes.size(); size++)
+    {
+        if (!HOST_CHECK(!readFile(makeData(bytes, size), false)))
+        {
+            printf("  truncated to %zu bytes\n", size);
+        }
+    }
+    
+    // Corrupt bytes may read as other values, but must never be read out of bounds.
+    const uint8_t masks[] = { 0x01, 0x80, 0xff };
+    int rejected = 0, total = 0;
+    for (std::size_t i = 0; i < bytes.size(); i++)
+    {
+        for (uint8_t mask : masks)
+        {
+            std::vector<uint8_t> corrupt = bytes;
+            corrupt[i] ^= mask;
+            rejected += readFile(makeData(corrupt, corrupt.size()), false) ? 0 : 1;
+            total++;
+        }
+        std::vector<uint8_t> corrupt = bytes;
+        memset(corrupt.data() + (i & ~(std::size_t)3), 0xff, 4);
+        rejected += readFile(makeData(corrupt, corrupt.size()), false) ? 0 : 1;
+        total++;
+    }
+    printf("%d of %d corrupt files rejected\n", rejected, total);
+    
+    // Indices past the vertices of their mesh are rejected.
+    PackedMesh mesh;
+    const uint16_t outOfRange[] = { 0, 1, 4 };
+    mesh.pack(Vertices, 4, 4, outOfRange, 3, nullptr);
+    FrameCacheWriter writer(Source_Hash, Animation_Name);
+    mesh.write(writer, nullptr);
+    HOST_CHECK(reader.open(makeData(writer.getBuffer(), writer.getBuffer().size()), Source_Hash, Animation_Name));
+    PackedMesh read;
+    HOST_CHECK(!read.read(reader, nullptr));
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,186 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Skeletons without listeners are updated on the workers in runs, the ones with listeners in list
+// order between them. Listeners changing other skeletons must take effect in the same frame as in
+// a serial update: the listener calls and the poses of every frame match the ones of a serial run.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+#include "HostSpine.h"
+
+#include "MiddlewareManager.h"
+#include "renderer/scene/ParallelTask.hpp"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+using cocos2d::middleware::MiddlewareManager;
+
+namespace
+{
+    // Exact in binary, so that track times print the same in both runs.
+    const float Frame_Time = 1.0f / 16;
+    const int Frame_Count = 48;
+    const int Skeleton_Count = 16;
+    
+    std::vector<std::string> run(bool parallel)
+    {
+        std::vector<std::string> log;
+        host::Scene scene;
+        host::SpineData spineData(&scene);
+        if (!HOST_CHECK(spineData.getSkeletonData() != nullptr)) return log;
+        
+        // The scene sets the workers of the render flow, which depend on the cores of the machine.
+        ParallelTask task;
+        if (parallel) task.init(3);
+        MiddlewareManager::getInstance()->setParallelTask(parallel ? &task : nullptr);
+        
+        std::vector<NodeProxy*> nodes;
+        std::vector<spine::SkeletonAnimation*> skeletons;
+        for (int i = 0; i < Skeleton_Count; i++)
+        {
+            NodeProxy* node = scene.createNode(scene.getRoot());
+            scene.setPosition(node, host::Scene::Width / 2, host::Scene::Height / 2);
+            spine::SkeletonAnimation* skeleton = spineData.createAnimation(node);
+            skeleton->getUpdateLOD().setPriority(1);
+            // Animations complete in different frames.
+            skeleton->setTimeScale(1.0f + 0.25f * (i % 5));
+            nodes.push_back(node);
+            skeletons.push_back(skeleton);
+        }
+        
+        int frame = 0;
+        auto record = [&](int skeleton, const char* type, spine::TrackEntry* entry) {
+            char line[128];
+            snprintf(line, sizeof(line), "frame %d skeleton %d %s %s %g", frame, skeleton, type,
+                     entry->getAnimation()->getName().buffer(), entry->getTrackTime());
+            log.push_back(line);
+        };
+        auto listen = [&](int skeleton) {
+            spine::SkeletonAnimation* animation = skeletons[skeleton];
+            animation->setStartListener([=, &record](spine::TrackEntry* entry) { record(skeleton, "start", entry); });
+            animation->setInterruptListener([=, &record](spine::TrackEntry* entry) { record(skeleton, "interrupt", entry); });
+            animation->setEndListener([=, &record](spine::TrackEntry* entry) { record(skeleton, "end", entry); });
+        };
+        const std::string name = host::SpineData::getAnimationName();
+        
+        // Skeleton 1 restarts 4 in the run after it, and 14 with a listener.
+        listen(1);
+        skeletons[1]->setCompleteListener([&](spine::TrackEntry* entry) {
+            record(1, "complete", entry);
+            skeletons[4]->setAnimation(0, name, false);
+            skeletons[14]->setStartListener([&](spine::TrackEntry* entry) { record(14, "start", entry); });
+            skeletons[14]->setAnimation(0, name, true);
+        });
+        // Skeleton 7 restarts 2 before it and slows down 8 after it.
+        listen(7);
+        skeletons[7]->setCompleteListener([&](spine::TrackEntry* entry) {
+            record(7, "complete", entry);
+            skeletons[2]->setAnimation(0, name, false);
+            skeletons[8]->setTimeScale(skeletons[8]->getTimeScale() * 0.5f);
+        });
+        // Skeleton 0 restarts 15 with a listener of the track entry.
+        listen(0);
+        skeletons[0]->setCompleteListener([&](spine::TrackEntry* entry) {
+            record(0, "complete", entry);
+            spine::TrackEntry* restarted = skeletons[15]->setAnimation(0, name, true);
+            skeletons[15]->setTrackCompleteListener(restarted, [&](spine::TrackEntry* entry) { record(15, "track complete", entry); });
+        });
+        
+        if (parallel)
+        {
+            HOST_CHECK(!skeletons[1]->isParallelUpdatable());
+            HOST_CHECK(skeletons[3]->isParallelUpdatable());
+        }
+        
+        for (frame = 0; frame < Frame_Count; frame++)
+        {
+            scene.render(Frame_Time);
+            for (int i = 0; i < Skeleton_Count; i++)
+            {
+                char line[128];
+                spine::TrackEntry* entry = skeletons[i]->getCurrent(0);
+                snprintf(line, sizeof(line), "frame %d skeleton %d at %g loop %d", frame, i, entry->getTrackTime(), (int)entry->getLoop());
+                log.push_back(line);
+            }
+        }
+        
+        if (parallel)
+        {
+            // Listeners given in callbacks keep their skeletons out of the workers too.
+            HOST_CHECK(!skeletons[14]->isParallelUpdatable());
+            HOST_CHECK(!skeletons[15]->isParallelUpdatable());
+            HOST_CHECK(skeletons[8]->isParallelUpdatable());
+        }
+        
+        MiddlewareManager::getInstance()->setParallelTask(nullptr);
+        for (int i = 0; i < Skeleton_Count; i++)
+        {
+            skeletons[i]->release();
+            scene.destroyNode(nodes[i]);
+        }
+        return log;
+    }
+    
+    bool contains(const std::vector<std::string>& log, const std::string& text, const std::string& more = "")
+    {
+        for (const auto& line : log)
+        {
+            if (line.find(text) != std::string::npos && line.find(more) != std::string::npos) return true;
+        }
+        return false;
+    }
+}
+
+int main()
+{
+    std::vector<std::string> serial = run(false);
+    std::vector<std::string> parallel = run(true);
+    
+    // The listeners ran and changed the skeletons they were meant to.
+    HOST_CHECK(contains(serial, "skeleton 1 complete"));
+    HOST_CHECK(contains(serial, "skeleton 7 complete"));
+    HOST_CHECK(contains(serial, "skeleton 14 start"));
+    HOST_CHECK(contains(serial, "skeleton 15 track complete"));
+    HOST_CHECK(contains(serial, "skeleton 4 at", "loop 0"));
+    HOST_CHECK(contains(serial, "skeleton 2 at", "loop 0"));
+    
+    HOST_CHECK(serial.size() == parallel.size());
+    for (std::size_t i = 0; i < serial.size() && i < parallel.size(); i++)
+    {
+        if (serial[i] != parallel[i])
+        {
+            printf("serial:   %s\nparallel: %s\n", serial[i].c_str(), parallel[i].c_str());
+            HOST_CHECK(serial[i] == parallel[i]);
+            break;
+        }
+    }
+    
+    return host::failedChecks();
+}
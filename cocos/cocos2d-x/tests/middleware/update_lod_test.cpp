@@ -0,0 +1,219 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// UpdateLOD picks the update rate of a skeleton from the culling and the screen coverage of its
+// node in the last frame, and hands the time of the skipped frames to the next update.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+#include "HostSpine.h"
+
+#include "UpdateLOD.h"
+
+#include <memory>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+using cocos2d::middleware::UpdateLOD;
+
+namespace
+{
+    // Exact in binary, so that sums of frame times compare exactly.
+    const float Frame_Time = 1.0f / 64;
+    const int Frame_Count = 8;
+    
+    struct Stepped
+    {
+        NodeProxy* node;
+        UpdateLOD::Level level;
+        bool constraints;
+        UpdateLOD lod;
+        int updates = 0;
+        float time = 0;
+    };
+    
+    NodeProxy* createSprite(host::Scene& scene, float x, float y, float width, float height)
+    {
+        NodeProxy* node = scene.createNode(scene.getRoot());
+        scene.setPosition(node, x, y);
+        scene.addSprite(node, width, height);
+        return node;
+    }
+    
+    int getInterval(UpdateLOD::Level level)
+    {
+        return level == UpdateLOD::FULL ? 1 : (level == UpdateLOD::HALF ? 2 : 4);
+    }
+    
+    void checkLevels()
+    {
+        host::Scene scene;
+        const float centerX = host::Scene::Width / 2;
+        const float centerY = host::Scene::Height / 2;
+        
+        // Coverages of the 960 x 640 screen: 19.5%, 1.04%, 0.26% and 0.065%.
+        NodeProxy* large = createSprite(scene, centerX, centerY, 400, 300);
+        NodeProxy* medium = createSprite(scene, 100, 100, 80, 80);
+        NodeProxy* small = createSprite(scene, 200, 100, 40, 40);
+        NodeProxy* tiny = createSprite(scene, 300, 100, 20, 20);
+        NodeProxy* offscreen = createSprite(scene, -5000, -5000, 80, 80);
+        
+        std::vector<std::unique_ptr<Stepped>> stepped;
+        auto add = [&](NodeProxy* node, int priority, UpdateLOD::Level level, bool constraints) {
+            stepped.emplace_back(new Stepped());
+            Stepped& item = *stepped.back();
+            item.node = node;
+            item.level = level;
+            item.constraints = constraints;
+            item.lod.setPriority(priority);
+        };
+        add(large, 0, UpdateLOD::FULL, true);
+        add(medium, 0, UpdateLOD::HALF, true);
+        add(small, 0, UpdateLOD::QUARTER, true);
+        add(tiny, 0, UpdateLOD::QUARTER, false);
+        add(offscreen, 0, UpdateLOD::CULLED, false);
+        // Above 0 the rate is never reduced, below 0 the coverage counts for a quarter.
+        add(tiny, 1, UpdateLOD::FULL, true);
+        add(offscreen, 1, UpdateLOD::FULL, true);
+        add(medium, -1, UpdateLOD::QUARTER, true);
+        // Without a node there is nothing to measure.
+        add(nullptr, 0, UpdateLOD::FULL, true);
+        
+        scene.render();
+        HOST_CHECK(fabsf(scene.getFlow()->getScreenCoverage(large->getLevel(), large->getLevelIndex()) - 400.0f * 300 / (960 * 640)) < 0.001f);
+        
+        for (int frame = 0; frame < Frame_Count; frame++)
+        {
+            scene.render(Frame_Time);
+            for (auto& item : stepped)
+            {
+                float time = item->lod.step(item->node, Frame_Time);
+                HOST_CHECK(item->lod.getLevel() == item->level);
+                HOST_CHECK(item->lod.needsConstraints() == item->constraints);
+                HOST_CHECK(item->lod.isUpdated() == (time > 0));
+                // The pose of an off screen skeleton only changes when it is updated.
+                HOST_CHECK(item->lod.canSkipRender() == (item->level == UpdateLOD::CULLED && time == 0));
+                if (time > 0)
+                {
+                    // The first update of a reduced rate may come before a whole interval.
+                    HOST_CHECK(time == Frame_Time * getInterval(item->level) || item->updates == 0);
+                    item->updates++;
+                }
+                item->time += time;
+            }
+        }
+        
+        for (auto& item : stepped)
+        {
+            int interval = getInterval(item->level);
+            HOST_CHECK(item->updates == Frame_Count / interval);
+            // The time of the frames since the last update is still pending.
+            float pending = Frame_Count * Frame_Time - item->time;
+            HOST_CHECK(pending >= 0 && pending < interval * Frame_Time);
+        }
+        
+        // The counts of the last frame are taken when the next one begins.
+        scene.render(Frame_Time);
+        HOST_CHECK(UpdateLOD::getLevelCount(UpdateLOD::FULL) == 4);
+        HOST_CHECK(UpdateLOD::getLevelCount(UpdateLOD::HALF) == 1);
+        HOST_CHECK(UpdateLOD::getLevelCount(UpdateLOD::QUARTER) == 3);
+        HOST_CHECK(UpdateLOD::getLevelCount(UpdateLOD::CULLED) == 1);
+        
+        // A skeleton not stepped in this frame is rendered, it may no longer be updated at all.
+        Stepped& culled = *stepped[4];
+        HOST_CHECK(!culled.lod.canSkipRender());
+        
+        // Back on screen, the level follows in the next frame.
+        scene.setPosition(offscreen, centerX, centerY);
+        scene.render(Frame_Time);
+        culled.lod.step(offscreen, Frame_Time);
+        HOST_CHECK(culled.lod.getLevel() == UpdateLOD::HALF);
+        
+        UpdateLOD::setEnabled(false);
+        for (auto& item : stepped)
+        {
+            HOST_CHECK(item->lod.step(item->node, Frame_Time) > 0);
+            HOST_CHECK(item->lod.getLevel() == UpdateLOD::FULL);
+        }
+        UpdateLOD::setEnabled(true);
+    }
+    
+    // Skeletons step their LOD in their update, an off screen one keeps the pace of the animation.
+    void checkSkeletons()
+    {
+        host::Scene scene;
+        host::SpineData spineData(&scene);
+        if (!HOST_CHECK(spineData.getSkeletonData() != nullptr)) return;
+        
+        NodeProxy* visibleNode = scene.createNode(scene.getRoot());
+        scene.setPosition(visibleNode, host::Scene::Width / 2, host::Scene::Height / 2);
+        spine::SkeletonAnimation* visible = spineData.createAnimation(visibleNode);
+        visible->getUpdateLOD().setPriority(1);
+        
+        NodeProxy* offscreenNode = scene.createNode(scene.getRoot());
+        scene.setPosition(offscreenNode, -5000, -5000);
+        spine::SkeletonAnimation* offscreen = spineData.createAnimation(offscreenNode);
+        
+        // Bounds reported while rendering a frame are culled by the next one, and read by the update after it.
+        float total = 0;
+        for (int frame = 0; frame < 2; frame++)
+        {
+            scene.render(Frame_Time);
+            total += Frame_Time;
+        }
+        float trackTime = offscreen->getCurrent(0)->getTrackTime();
+        int updates = 0;
+        for (int frame = 0; frame < Frame_Count * 2; frame++)
+        {
+            scene.render(Frame_Time);
+            total += Frame_Time;
+            float time = offscreen->getCurrent(0)->getTrackTime();
+            if (time != trackTime)
+            {
+                HOST_CHECK(time - trackTime == 4 * Frame_Time || updates == 0);
+                updates++;
+            }
+            trackTime = time;
+        }
+        HOST_CHECK(offscreen->getUpdateLOD().getLevel() == UpdateLOD::CULLED);
+        HOST_CHECK(updates == Frame_Count * 2 / 4);
+        HOST_CHECK(total - trackTime >= 0 && total - trackTime < 4 * Frame_Time);
+        HOST_CHECK(visible->getCurrent(0)->getTrackTime() == total);
+        
+        visible->release();
+        offscreen->release();
+        scene.destroyNode(visibleNode);
+        scene.destroyNode(offscreenNode);
+    }
+}
+
+int main()
+{
+    checkLevels();
+    checkSkeletons();
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Sprites moved or faded while culled must be filled with their new state once visible again.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+using namespace cocos2d::renderer;
+
+namespace
+{
+    bool near(float a, float b)
+    {
+        return fabsf(a - b) < 0.01f;
+    }
+    
+    // Checks the quad of a sprite of the given size centered on (x, y) with the given alpha.
+    void checkQuad(const host::Scene& scene, SimpleSprite2D* sprite, float x, float y, float size, uint8_t alpha)
+    {
+        host::Scene::Vertex vertices[4];
+        if (!HOST_CHECK(scene.getFilledVertices(sprite, vertices))) return;
+        
+        HOST_CHECK(near(vertices[0].x, x - size / 2) && near(vertices[0].y, y - size / 2));
+        HOST_CHECK(near(vertices[3].x, x + size / 2) && near(vertices[3].y, y + size / 2));
+        for (int i = 0; i < 4; i++)
+        {
+            HOST_CHECK(vertices[i].color >> 24 == alpha);
+        }
+    }
+}
+
+int main()
+{
+    host::Scene scene;
+    const float centerX = host::Scene::Width / 2;
+    const float centerY = host::Scene::Height / 2;
+    
+    // A sprite culled by itself, and one culled with its parent.
+    NodeProxy* node = scene.createNode(scene.getRoot());
+    scene.setPosition(node, centerX, centerY);
+    SimpleSprite2D* sprite = scene.addSprite(node, 20, 20);
+    
+    NodeProxy* parent = scene.createNode(scene.getRoot());
+    scene.setPosition(parent, centerX, centerY - 100);
+    NodeProxy* child = scene.createNode(parent);
+    SimpleSprite2D* childSprite = scene.addSprite(child, 10, 10);
+    
+    scene.render();
+    checkQuad(scene, sprite, centerX, centerY, 20, 255);
+    checkQuad(scene, childSprite, centerX, centerY - 100, 10, 255);
+    
+    scene.panCamera(centerX + 10000, centerY);
+    scene.render();
+    HOST_CHECK(scene.getFlow()->getCulledNodeCount() == 2);
+    
+    // The changes are flagged for one frame only, render a second frame while still culled.
+    scene.setPosition(node, centerX + 30, centerY - 20);
+    scene.setOpacity(node, 128);
+    scene.setPosition(parent, centerX - 50, centerY - 150);
+    scene.setOpacity(parent, 64);
+    scene.render();
+    scene.render();
+    host::Scene::Vertex vertices[4];
+    HOST_CHECK(!scene.getFilledVertices(sprite, vertices));
+    HOST_CHECK(!scene.getFilledVertices(childSprite, vertices));
+    
+    scene.panCamera(centerX, centerY);
+    scene.render();
+    checkQuad(scene, sprite, centerX + 30, centerY - 20, 20, 128);
+    checkQuad(scene, childSprite, centerX - 50, centerY - 150, 10, 64);
+    
+    // Nothing changed, the next fill keeps the same state.
+    scene.render();
+    checkQuad(scene, sprite, centerX + 30, centerY - 20, 20, 128);
+    checkQuad(scene, childSprite, centerX - 50, centerY - 150, 10, 64);
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,361 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Transparent items are sorted by packed draw keys. The order must match the comparator the keys
+// replaced: higher layers first, then techniques with more passes, then far to near, with the
+// submission index deciding ties, whatever the order carried over from the previous frame.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include "renderer/renderer/ForwardRenderer.h"
+#include "renderer/renderer/Pass.h"
+#include "renderer/renderer/Technique.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+RENDERER_BEGIN
+
+class ForwardRendererSortTest
+{
+public:
+    static uint64_t makeDrawKey(const Technique* technique, float depth, uint32_t sequence)
+    {
+        return ForwardRenderer::makeDrawKey(technique, depth, sequence);
+    }
+    static std::vector<uint64_t>& getKeys(ForwardRenderer* forward) { return forward->_sortKeys; }
+    static std::vector<uint32_t>& getOrder(ForwardRenderer* forward) { return forward->_sortOrder; }
+    static void sortItems(ForwardRenderer* forward, std::vector<BaseRenderer::StageItem>& items) { forward->sortItems(items); }
+    static bool insertionSort(ForwardRenderer* forward, std::size_t maxMoves) { return forward->insertionSort(maxMoves); }
+    static void radixSort(ForwardRenderer* forward) { forward->radixSort(); }
+};
+
+RENDERER_END
+
+namespace
+{
+    typedef BaseRenderer::StageItem StageItem;
+    
+    struct Item
+    {
+        int layer;
+        int passes;
+        float depth;
+    };
+    
+    // The comparator of the std::sort the draw keys replaced, on the untruncated depth.
+    bool compareItems(const Item& a, const Item& b)
+    {
+        if (a.layer != b.layer) return a.layer > b.layer;
+        if (a.passes != b.passes) return a.passes > b.passes;
+        return a.depth > b.depth;
+    }
+    
+    class Sorter
+    {
+    public:
+        Sorter(ForwardRenderer* forward)
+        : _forward(forward)
+        {
+        }
+        
+        ~Sorter()
+        {
+            for (auto& it : _techniques)
+            {
+                it.second->release();
+            }
+        }
+        
+        Technique* getTechnique(int layer, int passes)
+        {
+            auto& technique = _techniques[std::make_pair(layer, passes)];
+            if (!technique)
+            {
+                Vector<Pass*> passList;
+                for (int i = 0; i < passes; i++)
+                {
+                    auto pass = new Pass("sprite");
+                    passList.pushBack(pass);
+                    pass->release();
+                }
+                technique = new Technique({"transparent"}, passList, layer);
+            }
+            return technique;
+        }
+        
+        // Submission order sorted by compareItems, ties kept in submission order.
+        static std::vector<uint32_t> expectedOrder(const std::vector<Item>& items)
+        {
+            std::vector<uint32_t> order(items.size());
+            for (std::size_t i = 0; i < order.size(); i++)
+            {
+                order[i] = (uint32_t)i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return compareItems(items[a], items[b]);
+            });
+            return order;
+        }
+        
+        // Fills the keys like the transparent stage.
+        void fillKeys(const std::vector<Item>& items)
+        {
+            auto& keys = ForwardRendererSortTest::getKeys(_forward);
+            keys.resize(items.size());
+            for (std::size_t i = 0; i < items.size(); i++)
+            {
+                keys[i] = ForwardRendererSortTest::makeDrawKey(getTechnique(items[i].layer, items[i].passes), items[i].depth, (uint32_t)i);
+            }
+        }
+        
+        // Sorts stage items made of the given items, starting from the order left by the last sort.
+        std::vector<uint32_t> sort(const std::vector<Item>& items)
+        {
+            std::vector<StageItem> stageItems(items.size());
+            for (std::size_t i = 0; i < items.size(); i++)
+            {
+                stageItems[i].technique = getTechnique(items[i].layer, items[i].passes);
+                stageItems[i].sortKey = (int)i;
+            }
+            fillKeys(items);
+            ForwardRendererSortTest::sortItems(_forward, stageItems);
+            
+            std::vector<uint32_t> order;
+            for (const auto& item : stageItems)
+            {
+                order.push_back((uint32_t)item.sortKey);
+            }
+            return order;
+        }
+        
+        void resetOrder()
+        {
+            ForwardRendererSortTest::getOrder(_forward).clear();
+        }
+        
+        // Runs the bounded insertion sort from the submission order.
+        bool insertionSort(const std::vector<Item>& items, std::size_t maxMoves)
+        {
+            fillKeys(items);
+            auto& order = ForwardRendererSortTest::getOrder(_forward);
+            order.resize(items.size());
+            for (std::size_t i = 0; i < order.size(); i++)
+            {
+                order[i] = (uint32_t)i;
+            }
+            return ForwardRendererSortTest::insertionSort(_forward, maxMoves);
+        }
+        
+        // Runs the bounded insertion sort from the order left by the last sort.
+        bool resumeInsertionSort(const std::vector<Item>& items, std::size_t maxMoves)
+        {
+            fillKeys(items);
+            return ForwardRendererSortTest::insertionSort(_forward, maxMoves);
+        }
+        
+        std::vector<uint32_t> radixSort(const std::vector<Item>& items)
+        {
+            fillKeys(items);
+            ForwardRendererSortTest::getOrder(_forward).resize(items.size());
+            ForwardRendererSortTest::radixSort(_forward);
+            return ForwardRendererSortTest::getOrder(_forward);
+        }
+    private:
+        ForwardRenderer* _forward;
+        std::map<std::pair<int, int>, Technique*> _techniques;
+    };
+    
+    uint32_t random(uint32_t& seed)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    }
+    
+    // Every combination of the edge values, in a shuffled submission order.
+    std::vector<Item> makeEdgeItems(uint32_t seed)
+    {
+        const int layers[] = { -128, -1, 0, 1, 127 };
+        const int passes[] = { 1, 2, 15, 16, 17, 40 };
+        const float depths[] = { -1e30f, -100.5f, -1.0f, -1e-30f, -0.0f, 0.0f, 1e-30f, 1.0f, 100.5f, 1e30f };
+        std::vector<Item> items;
+        for (int layer : layers)
+        {
+            for (int passCount : passes)
+            {
+                for (float depth : depths)
+                {
+                    items.push_back({ layer, passCount, depth });
+                }
+            }
+        }
+        for (std::size_t i = items.size() - 1; i > 0; i--)
+        {
+            std::swap(items[i], items[random(seed) % (i + 1)]);
+        }
+        return items;
+    }
+    
+    // Distinct depths, near to far, which is the reverse of the sorted order.
+    std::vector<Item> makeReversedItems(std::size_t count)
+    {
+        std::vector<Item> items;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            items.push_back({ 0, 1, (float)i });
+        }
+        return items;
+    }
+    
+    std::vector<uint32_t> identity(std::size_t count)
+    {
+        std::vector<uint32_t> order(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            order[i] = (uint32_t)i;
+        }
+        return order;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    host::Scene scene;
+    Sorter sorter(scene.getForward());
+    
+    // Keys order every pair like the comparator, the submission index breaks ties.
+    {
+        std::vector<Item> items = makeEdgeItems(1);
+        int mismatches = 0;
+        for (uint32_t i = 0; i < items.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < items.size(); j++)
+            {
+                uint64_t keyI = ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(items[i].layer, items[i].passes), items[i].depth, i);
+                uint64_t keyJ = ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(items[j].layer, items[j].passes), items[j].depth, j);
+                bool expected = !compareItems(items[j], items[i]);
+                if ((keyI < keyJ) != expected && mismatches++ == 0)
+                {
+                    printf("layer %d passes %d depth %g submitted %u before layer %d passes %d depth %g submitted %u\n",
+                           items[i].layer, items[i].passes, items[i].depth, i, items[j].layer, items[j].passes, items[j].depth, j);
+                }
+            }
+        }
+        HOST_CHECK(mismatches == 0);
+        
+        // Signed zeros are the same depth.
+        Technique* technique = sorter.getTechnique(0, 1);
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(technique, -0.0f, 0) < ForwardRendererSortTest::makeDrawKey(technique, 0.0f, 1));
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(technique, 0.0f, 0) < ForwardRendererSortTest::makeDrawKey(technique, -0.0f, 1));
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(technique, -0.0f, 1) < ForwardRendererSortTest::makeDrawKey(technique, -1e-30f, 0));
+        // Layers at the ends of the range, pass counts above 15.
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(127, 1), -1e30f, 1) <
+                   ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(126, 40), 1e30f, 0));
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(-127, 1), -1e30f, 1) <
+                   ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(-128, 40), 1e30f, 0));
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(0, 17), -1e30f, 1) <
+                   ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(0, 16), 1e30f, 0));
+        HOST_CHECK(ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(0, 16), -1e30f, 1) <
+                   ForwardRendererSortTest::makeDrawKey(sorter.getTechnique(0, 15), 1e30f, 0));
+    }
+    
+    // A shuffled first frame, then frames which keep most of the last order.
+    {
+        sorter.resetOrder();
+        std::vector<Item> items = makeEdgeItems(2);
+        HOST_CHECK(sorter.sort(items) == Sorter::expectedOrder(items));
+        
+        uint32_t seed = 3;
+        for (int frame = 0; frame < 4; frame++)
+        {
+            // A few items move in depth, the others stay where the last frame sorted them.
+            for (int i = 0; i < 3; i++)
+            {
+                items[random(seed) % items.size()].depth = (float)(random(seed) % 200) - 100.0f;
+            }
+            std::vector<uint32_t> expected = Sorter::expectedOrder(items);
+            HOST_CHECK(sorter.sort(items) == expected);
+        }
+    }
+    
+    // An item passing its neighbour costs the insertion sort a single move.
+    {
+        std::vector<Item> items = makeReversedItems(200);
+        sorter.resetOrder();
+        sorter.sort(items);
+        items[100].depth = 101.5f;
+        HOST_CHECK(sorter.resumeInsertionSort(items, 1));
+        HOST_CHECK(ForwardRendererSortTest::getOrder(scene.getForward()) == Sorter::expectedOrder(items));
+        items[50].depth = 48.5f;
+        HOST_CHECK(sorter.sort(items) == Sorter::expectedOrder(items));
+    }
+    
+    // Past the move limit of the insertion sort the radix sort takes over.
+    {
+        // 11 reversed items take 55 moves, 12 take 66.
+        HOST_CHECK(sorter.insertionSort(makeReversedItems(11), 64));
+        HOST_CHECK(ForwardRendererSortTest::getOrder(scene.getForward()) == Sorter::expectedOrder(makeReversedItems(11)));
+        HOST_CHECK(!sorter.insertionSort(makeReversedItems(12), 64));
+        
+        std::vector<Item> items = makeReversedItems(12);
+        HOST_CHECK(sorter.radixSort(items) == Sorter::expectedOrder(items));
+        items = makeEdgeItems(4);
+        HOST_CHECK(sorter.radixSort(items) == Sorter::expectedOrder(items));
+        
+        for (std::size_t count : { 12, 64, 200 })
+        {
+            sorter.resetOrder();
+            items = makeReversedItems(count);
+            HOST_CHECK(sorter.sort(items) == Sorter::expectedOrder(items));
+        }
+    }
+    
+    // Equal keys are drawn in submission order, whatever order the last frame left.
+    {
+        std::vector<Item> items = makeReversedItems(200);
+        sorter.resetOrder();
+        sorter.sort(items);
+        for (std::size_t i = 0; i < items.size(); i++)
+        {
+            items[i].depth = i % 2 ? 0.0f : -0.0f;
+        }
+        HOST_CHECK(sorter.sort(items) == identity(items.size()));
+        
+        // More items than the sequence bits tell apart, the last one was drawn first in the last frame.
+        items.assign(70000, { 0, 1, 5.0f });
+        items.back().depth = 6.0f;
+        sorter.sort(items);
+        items.back().depth = 5.0f;
+        HOST_CHECK(sorter.sort(items) == identity(items.size()));
+    }
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,227 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Sprites using different textures must be drawn in one batch once their textures are packed into a
+// DynamicAtlas page, with uvs remapped into their frames. Recycling a page must never evict frames
+// drawn in the current frame.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include "renderer/scene/DynamicAtlas.hpp"
+
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    const int Sprite_Count = 12;
+    
+    struct Source
+    {
+        Texture2D* texture;
+        Effect* effect;
+        uint16_t width;
+        uint16_t height;
+        std::vector<uint8_t> pixels;
+    };
+    
+    uint64_t renderDraws(host::Scene& scene)
+    {
+        nullgl::resetStats();
+        scene.render();
+        return nullgl::getStats().drawCalls;
+    }
+    
+    bool near(float a, float b)
+    {
+        return fabsf(a - b) < 1e-5f;
+    }
+    
+    // Left, top, right and bottom of the frame with its extruded edges, in pixels of the page.
+    void getPaddedRect(const DynamicAtlas::Frame& frame, float rect[4])
+    {
+        const float size = DynamicAtlas::PAGE_SIZE;
+        rect[0] = frame.uvRect[0] * size - DynamicAtlas::PADDING;
+        rect[1] = frame.uvRect[1] * size - DynamicAtlas::PADDING;
+        rect[2] = (frame.uvRect[0] + frame.uvRect[2]) * size + DynamicAtlas::PADDING;
+        rect[3] = (frame.uvRect[1] + frame.uvRect[3]) * size + DynamicAtlas::PADDING;
+    }
+    
+    bool overlaps(const float a[4], const float b[4])
+    {
+        return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3];
+    }
+    
+    // The sprite quads of the host scene map (0, 0) to (1, 1) of their texture.
+    void checkUVs(const host::Scene& scene, SimpleSprite2D* sprite, const float rect[4])
+    {
+        host::Scene::Vertex vertices[4];
+        if (!HOST_CHECK(scene.getFilledVertices(sprite, vertices))) return;
+        for (int i = 0; i < 4; i++)
+        {
+            HOST_CHECK(near(vertices[i].u, rect[0] + (float)(i % 2) * rect[2]));
+            HOST_CHECK(near(vertices[i].v, rect[1] + (float)(1 - i / 2) * rect[3]));
+        }
+    }
+}
+
+int main()
+{
+    host::Scene scene;
+    DynamicAtlas* atlas = scene.getFlow()->getDynamicAtlas();
+    
+    // Every sprite samples a texture of its own, as the effects of different sprite frames do.
+    std::vector<Source> sources(Sprite_Count);
+    std::vector<SimpleSprite2D*> sprites;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        Source& source = sources[i];
+        source.width = (uint16_t)(16 + i * 7);
+        source.height = (uint16_t)(40 - i * 2);
+        source.pixels.resize(source.width * source.height * 4, (uint8_t)(i * 20));
+        
+        Texture::Options options;
+        options.width = source.width;
+        options.height = source.height;
+        options.glFormat = GL_RGBA;
+        options.glInternalFormat = GL_RGBA;
+        options.glType = GL_UNSIGNED_BYTE;
+        source.texture = new Texture2D();
+        source.texture->init(scene.getDevice(), options);
+        
+        source.effect = new Effect();
+        source.effect->copy(scene.getEffect());
+        source.effect->setProperty("texture", Effect::Property("texture", Effect::Property::Type::TEXTURE_2D, source.texture));
+        source.effect->updateHash(i + 1);
+        
+        NodeProxy* node = scene.createNode(scene.getRoot());
+        scene.setPosition(node, 40.0f + i * 70, 320);
+        SimpleSprite2D* sprite = scene.addSprite(node, source.width, source.height);
+        sprite->updateEffect(0, source.effect);
+        sprites.push_back(sprite);
+    }
+    HOST_CHECK(renderDraws(scene) == Sprite_Count);
+    
+    // Each insert uploads the frame with its edges extruded by the padding.
+    const uint16_t padding = DynamicAtlas::PADDING;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        const Source& source = sources[i];
+        nullgl::resetStats();
+        HOST_CHECK(atlas->insert(i + 1, source.width, source.height, source.pixels.data(), false));
+        HOST_CHECK(nullgl::getStats().bytesUploaded == (uint64_t)(source.width + padding * 2) * (source.height + padding * 2) * 4);
+        sprites[i]->setAtlasKey(0, i + 1);
+    }
+    HOST_CHECK(atlas->getPageCount() == 1);
+    HOST_CHECK(renderDraws(scene) == 1);
+    
+    // The uvs land on the frame, and no padded frame overlaps another one or leaves the page.
+    std::vector<DynamicAtlas::Frame> frames;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        const DynamicAtlas::Frame* frame = atlas->getFrame(i + 1);
+        if (!HOST_CHECK(frame != nullptr)) return host::failedChecks();
+        HOST_CHECK(near(frame->uvRect[2] * DynamicAtlas::PAGE_SIZE, sources[i].width));
+        HOST_CHECK(near(frame->uvRect[3] * DynamicAtlas::PAGE_SIZE, sources[i].height));
+        checkUVs(scene, sprites[i], frame->uvRect);
+        frames.push_back(*frame);
+    }
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        float rect[4];
+        getPaddedRect(frames[i], rect);
+        HOST_CHECK(rect[0] >= 0 && rect[1] >= 0);
+        HOST_CHECK(rect[2] <= DynamicAtlas::PAGE_SIZE && rect[3] <= DynamicAtlas::PAGE_SIZE);
+        for (int j = 0; j < i; j++)
+        {
+            float other[4];
+            getPaddedRect(frames[j], other);
+            HOST_CHECK(!overlaps(rect, other));
+        }
+    }
+    
+    // Inserting a key again moves its frame, the sprite is filled again though nothing else changed.
+    HOST_CHECK(atlas->insert(1, sources[0].width, sources[0].height, sources[0].pixels.data(), false));
+    const DynamicAtlas::Frame* moved = atlas->getFrame(1);
+    HOST_CHECK(*moved != frames[0]);
+    frames[0] = *moved;
+    HOST_CHECK(renderDraws(scene) == 1);
+    checkUVs(scene, sprites[0], frames[0].uvRect);
+    
+    // A removed frame sends its sprite back to its own texture and batch.
+    atlas->remove(Sprite_Count);
+    HOST_CHECK(renderDraws(scene) == 2);
+    const float fullRect[4] = { 0, 0, 1, 1 };
+    checkUVs(scene, sprites[Sprite_Count - 1], fullRect);
+    checkUVs(scene, sprites[0], frames[0].uvRect);
+    
+    // Fill the atlas with the largest frames while the page of the sprites is drawn in the current frame.
+    // Inserting marks the page as used too, so once both pages are full nothing can be recycled.
+    const uint16_t large = DynamicAtlas::MAX_FRAME_SIZE;
+    std::vector<uint8_t> largePixels(large * large * 4, 0xff);
+    std::vector<uint32_t> largePages;
+    atlas->setMaxPages(2);
+    HOST_CHECK(atlas->getFrame(1)->page == 0);
+    const uint32_t firstLarge = 100;
+    const uint32_t perPage = (DynamicAtlas::PAGE_SIZE / (large + padding * 2)) * (DynamicAtlas::PAGE_SIZE / (large + padding * 2));
+    uint32_t key = firstLarge;
+    for (; key <= firstLarge + perPage * 2 && atlas->insert(key, large, large, largePixels.data(), false); key++)
+    {
+        largePages.push_back(atlas->getFrame(key)->page);
+    }
+    HOST_CHECK(key <= firstLarge + perPage * 2);
+    HOST_CHECK(atlas->getPageCount() == 2);
+    HOST_CHECK(largePages.back() == 1);
+    for (int i = 0; i < Sprite_Count - 1; i++)
+    {
+        HOST_CHECK(atlas->getFrame(i + 1) != nullptr);
+    }
+    
+    // The next frame only draws the first page, the second one is recycled for the new frame.
+    scene.render();
+    atlas->getFrame(1);
+    HOST_CHECK(atlas->insert(key, large, large, largePixels.data(), false));
+    HOST_CHECK(atlas->getFrame(key)->page == 1);
+    for (uint32_t i = firstLarge; i < key; i++)
+    {
+        HOST_CHECK((atlas->getFrame(i) != nullptr) == (largePages[i - firstLarge] == 0));
+    }
+    for (int i = 0; i < Sprite_Count - 1; i++)
+    {
+        HOST_CHECK(atlas->getFrame(i + 1) != nullptr && atlas->getFrame(i + 1)->page == 0);
+    }
+    HOST_CHECK(renderDraws(scene) == 2);
+    checkUVs(scene, sprites[0], frames[0].uvRect);
+    
+    for (auto& source : sources)
+    {
+        source.effect->release();
+        source.texture->release();
+    }
+    return host::failedChecks();
+}
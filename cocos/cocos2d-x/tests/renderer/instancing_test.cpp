@@ -0,0 +1,180 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Simple sprites drawn as instances of the unit quad must land where their mesh path vertices do,
+// and sprites fall back to the mesh path when the effect has no instanced variant or instancing is off.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include "renderer/renderer/ProgramLib.h"
+#include "renderer/scene/ModelBatcher.hpp"
+
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    const int Sprite_Count = 40;
+    
+    const char* InstancedVert = R"(
+uniform mat4 cc_matViewProj;
+attribute vec2 a_position;
+attribute vec4 a_matrix;
+attribute vec4 a_translateUv;
+attribute vec4 a_uvAxes;
+attribute vec4 a_color;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    vec2 pos = a_matrix.xy * a_position.x + a_matrix.zw * a_position.y + a_translateUv.xy;
+    gl_Position = cc_matViewProj * vec4(pos, 0, 1);
+    v_uv0 = a_translateUv.zw + a_uvAxes.xy * a_position.x + a_uvAxes.zw * a_position.y;
+    v_color = a_color;
+}
+)";
+    
+    struct Frame
+    {
+        uint64_t drawCalls;
+        uint64_t primitives;
+        uint64_t bytesUploaded;
+    };
+    
+    Frame render(host::Scene& scene)
+    {
+        nullgl::resetStats();
+        scene.render();
+        const nullgl::Stats& stats = nullgl::getStats();
+        return { stats.drawCalls, stats.primitives, stats.bytesUploaded };
+    }
+    
+    bool near(float a, float b)
+    {
+        return fabsf(a - b) < 0.01f;
+    }
+    
+    // Evaluates the instance at the corners of the unit quad, in the vertex order of the mesh path.
+    bool matches(const InstanceBuffer::Record& record, const host::Scene::Vertex vertices[4])
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            float x = (float)(i % 2);
+            float y = (float)(i / 2);
+            const host::Scene::Vertex& vertex = vertices[i];
+            if (!near(record.matrix[0] * x + record.matrix[2] * y + record.translateUv[0], vertex.x) ||
+                !near(record.matrix[1] * x + record.matrix[3] * y + record.translateUv[1], vertex.y) ||
+                !near(record.translateUv[2] + record.uvAxes[0] * x + record.uvAxes[2] * y, vertex.u) ||
+                !near(record.translateUv[3] + record.uvAxes[1] * x + record.uvAxes[3] * y, vertex.v) ||
+                record.color != vertex.color)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    host::Scene scene;
+    renderer::ModelBatcher* batcher = scene.getFlow()->getModelBatcher();
+    HOST_CHECK(scene.getDevice()->isInstancedArraysSupported());
+    
+    std::vector<NodeProxy*> nodes;
+    std::vector<SimpleSprite2D*> sprites;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        NodeProxy* node = scene.createNode(scene.getRoot());
+        scene.setPosition(node, 40.0f + i % 10 * 90, 80.0f + i / 10 * 140);
+        scene.setRotation(node, i * 9.0f);
+        scene.setOpacity(node, (uint8_t)(255 - i * 4));
+        nodes.push_back(node);
+        sprites.push_back(scene.addSprite(node, 20.0f + i, 30.0f));
+    }
+    
+    // The sprite program of the scene has no instanced variant yet.
+    Frame mesh = render(scene);
+    std::vector<host::Scene::Vertex> vertices(Sprite_Count * 4);
+    InstanceBuffer::Record record;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        HOST_CHECK(scene.getFilledVertices(sprites[i], &vertices[i * 4]));
+        HOST_CHECK(!scene.getFilledInstance(sprites[i], record));
+    }
+    HOST_CHECK(mesh.drawCalls == 1);
+    HOST_CHECK(mesh.primitives == Sprite_Count * 6);
+    
+    ProgramLib* programLib = scene.getForward()->getProgramLib();
+    ValueVector defines;
+    programLib->define("sprite-instanced", InstancedVert, host::Scene::getSpriteFrag(), defines);
+    programLib->setInstancedVariant("sprite", "sprite-instanced");
+    
+    Frame instanced = render(scene);
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        host::Scene::Vertex filled[4];
+        HOST_CHECK(!scene.getFilledVertices(sprites[i], filled));
+        if (HOST_CHECK(scene.getFilledInstance(sprites[i], record)))
+        {
+            HOST_CHECK(matches(record, &vertices[i * 4]));
+        }
+    }
+    // One instanced draw of the quad indices, and a record per sprite instead of its vertices and indices.
+    HOST_CHECK(instanced.drawCalls == 1);
+    HOST_CHECK(instanced.primitives == Sprite_Count * 6);
+    HOST_CHECK(instanced.bytesUploaded < mesh.bytesUploaded);
+    
+    // A sprite moved while drawn as an instance gets its world vertices back on the mesh path.
+    scene.setPosition(nodes[0], 500, 500);
+    scene.setRotation(nodes[0], 0);
+    render(scene);
+    HOST_CHECK(scene.getFilledInstance(sprites[0], record));
+    HOST_CHECK(near(record.translateUv[0], 500 - 10) && near(record.translateUv[1], 500 - 15));
+    
+    batcher->setInstancingEnabled(false);
+    Frame disabled = render(scene);
+    host::Scene::Vertex filled[4];
+    if (HOST_CHECK(scene.getFilledVertices(sprites[0], filled)))
+    {
+        HOST_CHECK(near(filled[0].x, 500 - 10) && near(filled[0].y, 500 - 15));
+        HOST_CHECK(near(filled[3].x, 500 + 10) && near(filled[3].y, 500 + 15));
+    }
+    for (int i = 1; i < Sprite_Count; i++)
+    {
+        HOST_CHECK(scene.getFilledVertices(sprites[i], filled));
+        HOST_CHECK(!scene.getFilledInstance(sprites[i], record));
+    }
+    HOST_CHECK(disabled.drawCalls == 1);
+    HOST_CHECK(disabled.primitives == Sprite_Count * 6);
+    
+    batcher->setInstancingEnabled(true);
+    render(scene);
+    HOST_CHECK(scene.getFilledInstance(sprites[Sprite_Count - 1], record));
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,149 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Builds 10k and 50k node trees through host::Scene and times the RenderFlow world matrix pass over
+// the node levels, once with every node dirty and once with a clean tree, then the level churn of
+// reparenting leaves, each move removes the node from its level and appends it again.
+// Usage: node_level_bench [iterations]
+
+#include "HostScene.h"
+
+#include "renderer/scene/RenderFlow.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace cocos2d::renderer;
+
+namespace
+{
+    const std::size_t Fan_Out = 8;
+    const std::size_t Moves_Per_Iteration = 256;
+    
+    struct Result
+    {
+        std::size_t nodes = 0;
+        std::size_t leaves = 0;
+        double dirtyPass = 0;
+        double cleanPass = 0;
+        double move = 0;
+    };
+    
+    template <typename Prepare, typename Work>
+    double measure(int iterations, Prepare prepare, Work work)
+    {
+        double total = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            prepare(i);
+            auto start = std::chrono::steady_clock::now();
+            work(i);
+            auto end = std::chrono::steady_clock::now();
+            total += std::chrono::duration<double, std::micro>(end - start).count();
+        }
+        return total / iterations;
+    }
+    
+    Result run(std::size_t nodeCount, int iterations)
+    {
+        Result result;
+        host::Scene scene;
+        RenderFlow* flow = scene.getFlow();
+        
+        // Breadth first, the parent of node i is node (i - 1) / Fan_Out, the root of the scene is node 0.
+        std::vector<NodeProxy*> nodes;
+        nodes.reserve(nodeCount);
+        nodes.push_back(scene.getRoot());
+        for (std::size_t i = 1; i < nodeCount; i++)
+        {
+            NodeProxy* node = scene.createNode(nodes[(i - 1) / Fan_Out]);
+            scene.setPosition(node, (float)(i % 31), (float)(i % 17));
+            nodes.push_back(node);
+        }
+        std::size_t firstLeaf = (nodeCount - 2) / Fan_Out + 1;
+        result.nodes = nodeCount;
+        result.leaves = nodeCount - firstLeaf;
+        
+        flow->calculateLocalMatrix();
+        flow->calculateWorldMatrix();
+        
+        // Moving the root changes the world matrix of every node.
+        result.dirtyPass = measure(iterations, [&](int i) {
+            scene.setPosition(scene.getRoot(), (float)(i % 2), 0);
+            flow->calculateLocalMatrix();
+        }, [&](int i) {
+            flow->calculateWorldMatrix();
+        });
+        result.cleanPass = measure(iterations, [&](int i) {
+            flow->calculateLocalMatrix();
+        }, [&](int i) {
+            flow->calculateWorldMatrix();
+        });
+        
+        // Leaves spread over the tree move under a neighbour of their parent and back in the next iteration.
+        std::size_t stride = result.leaves / Moves_Per_Iteration + 1;
+        std::vector<NodeProxy*> leaves;
+        std::vector<NodeProxy*> from;
+        std::vector<NodeProxy*> to;
+        for (std::size_t i = firstLeaf; i < nodeCount && leaves.size() < Moves_Per_Iteration; i += stride)
+        {
+            std::size_t parent = (i - 1) / Fan_Out;
+            std::size_t sibling = parent + 1 < firstLeaf ? parent + 1 : parent - 1;
+            leaves.push_back(nodes[i]);
+            from.push_back(nodes[parent]);
+            to.push_back(nodes[sibling]);
+        }
+        result.move = measure(iterations, [](int i) {}, [&](int i) {
+            auto& parents = i % 2 == 0 ? to : from;
+            for (std::size_t j = 0; j < leaves.size(); j++)
+            {
+                scene.setParent(leaves[j], parents[j]);
+            }
+        }) / leaves.size();
+        
+        // The tree still has every node in the right level.
+        flow->calculateLocalMatrix();
+        flow->calculateWorldMatrix();
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations <= 0) iterations = 200;
+    
+    Result results[] = { run(10000, iterations), run(50000, iterations) };
+    
+    printf("%d iterations, fan out %zu, %zu leaves moved per iteration\n", iterations, Fan_Out, Moves_Per_Iteration);
+    printf("%-8s %8s %14s %14s %12s\n", "nodes", "leaves", "dirty pass us", "clean pass us", "move us");
+    for (const auto& result : results)
+    {
+        printf("%-8zu %8zu %14.2f %14.2f %12.3f\n", result.nodes, result.leaves, result.dirtyPass, result.cleanPass, result.move);
+    }
+    return results[1].nodes > 0 ? 0 : 1;
+}
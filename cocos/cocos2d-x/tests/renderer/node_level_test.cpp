@@ -0,0 +1,177 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// RenderFlow keeps each level as parallel arrays, a removal swaps the last node of the level into
+// the hole and patches the parent indices of its children. World matrices must keep following the
+// right parents through removals and reparenting.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace cocos2d::renderer;
+
+namespace
+{
+    struct Tree
+    {
+        host::Scene& scene;
+        std::map<NodeProxy*, NodeProxy*> parents;
+        std::map<NodeProxy*, cocos2d::Vec2> positions;
+        
+        NodeProxy* create(NodeProxy* parent, float x, float y)
+        {
+            NodeProxy* node = scene.createNode(parent);
+            parents[node] = parent;
+            move(node, x, y);
+            return node;
+        }
+        
+        void move(NodeProxy* node, float x, float y)
+        {
+            scene.setPosition(node, x, y);
+            positions[node] = cocos2d::Vec2(x, y);
+        }
+        
+        void setParent(NodeProxy* node, NodeProxy* parent)
+        {
+            scene.setParent(node, parent);
+            parents[node] = parent;
+        }
+        
+        void destroy(NodeProxy* node)
+        {
+            std::vector<NodeProxy*> children;
+            for (auto& it : parents)
+            {
+                if (it.second == node) children.push_back(it.first);
+            }
+            for (auto child : children)
+            {
+                destroy(child);
+            }
+            scene.destroyNode(node);
+            parents.erase(node);
+            positions.erase(node);
+        }
+        
+        cocos2d::Vec2 getWorldPosition(NodeProxy* node) const
+        {
+            cocos2d::Vec2 position;
+            for (; node; node = parents.at(node))
+            {
+                position += positions.at(node);
+            }
+            return position;
+        }
+        
+        // Every node has a level below its parent and a slot of its own, and follows its parent.
+        void check() const
+        {
+            std::set<std::pair<std::size_t, std::size_t>> slots;
+            for (auto& it : parents)
+            {
+                NodeProxy* node = it.first;
+                NodeProxy* parent = it.second;
+                std::size_t level = parent ? parent->getLevel() + 1 : 0;
+                HOST_CHECK(node->getLevel() == level);
+                HOST_CHECK(slots.insert(std::make_pair(node->getLevel(), node->getLevelIndex())).second);
+                
+                const cocos2d::Mat4& world = node->getWorldMatrix();
+                cocos2d::Vec2 expected = getWorldPosition(node);
+                HOST_CHECK(fabsf(world.m[12] - expected.x) < 0.001f && fabsf(world.m[13] - expected.y) < 0.001f);
+            }
+        }
+    };
+}
+
+int main()
+{
+    host::Scene scene;
+    Tree tree = { scene };
+    NodeProxy* root = scene.getRoot();
+    
+    // Level 1 also holds the camera node, created by the scene.
+    NodeProxy* a = tree.create(root, 100, 0);
+    NodeProxy* b = tree.create(root, 200, 0);
+    NodeProxy* c = tree.create(root, 300, 0);
+    tree.create(a, 10, 10);
+    tree.create(a, 20, 10);
+    NodeProxy* b1 = tree.create(b, 30, 10);
+    NodeProxy* c1 = tree.create(c, 40, 10);
+    NodeProxy* c2 = tree.create(c, 50, 10);
+    tree.create(c1, 5, 5);
+    // The root is only checked for its level.
+    tree.parents[root] = nullptr;
+    tree.positions[root] = cocos2d::Vec2::ZERO;
+    scene.render();
+    tree.check();
+    
+    // The children of a are removed first, c2 and c1 are swapped into their slots, then c into the slot of a.
+    std::size_t indexOfA = a->getLevelIndex();
+    std::size_t indexOfA1 = a->getChildren().at(0)->getLevelIndex();
+    tree.destroy(a);
+    HOST_CHECK(c->getLevelIndex() == indexOfA);
+    HOST_CHECK(c2->getLevelIndex() == indexOfA1);
+    // Takes the slot c was moved from, children still pointing at it would follow this node.
+    tree.create(root, 600, 0);
+    tree.move(c, 400, 50);
+    tree.move(b, 250, 0);
+    scene.render();
+    tree.check();
+    
+    // Only the moved node changes, the others keep their parent.
+    tree.move(c, 500, 60);
+    scene.render();
+    tree.check();
+    
+    // A subtree moves one level down under c, then back to the root.
+    tree.setParent(b, c);
+    HOST_CHECK(b1->getLevel() == 3);
+    scene.render();
+    tree.check();
+    tree.move(c, 350, 70);
+    scene.render();
+    tree.check();
+    
+    tree.setParent(b, root);
+    tree.setParent(c1, b);
+    scene.render();
+    tree.check();
+    
+    // c2 is first in its level, the last node of the level is swapped into its slot.
+    HOST_CHECK(c2->getLevelIndex() == 0);
+    tree.destroy(c2);
+    tree.move(c, 360, 80);
+    tree.move(b, 260, 10);
+    scene.render();
+    tree.check();
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,223 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Renders a synthetic scene through the null GL backend and prints the CPU cost of each
+// RenderFlow stage, so that renderer changes can be measured without a device.
+// Usage: null_gl_frame [frames]
+
+#include "HostScene.h"
+#include "HostSpine.h"
+
+#include "base/CCAutoreleasePool.h"
+#include "renderer/gfx/TextureUploader.h"
+#include "MiddlewareManager.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    // Panels of groups of sprites, every other panel is clipped by a mask and a part of them is off screen.
+    const int Panel_Count = 24;
+    const int Group_Count = 8;
+    const int Sprite_Count = 12;
+    const int Skeleton_Count = 16;
+    
+    enum Stage
+    {
+        TEXTURE_UPLOAD,
+        MIDDLEWARE_UPDATE,
+        LOCAL_MATRIX,
+        WORLD_MATRIX,
+        VISIBILITY,
+        MIDDLEWARE_RENDER,
+        BATCH,
+        ATLAS,
+        FORWARD,
+        STAGE_COUNT
+    };
+    
+    const char* Stage_Names[STAGE_COUNT] = {
+        "texture upload",
+        "middleware update",
+        "local matrix",
+        "world matrix",
+        "visibility",
+        "middleware render",
+        "batch",
+        "atlas",
+        "forward render",
+    };
+    
+    host::Scene* hostScene = nullptr;
+    
+    void createSkeletons(const host::SpineData& spineData, NodeProxy* parent, std::vector<spine::SkeletonAnimation*>& animations)
+    {
+        for (int i = 0; i < Skeleton_Count; i++)
+        {
+            NodeProxy* node = hostScene->createNode(parent);
+            hostScene->setPosition(node, 60.0f + i % 8 * 110, 80.0f + i / 8 * 240);
+            node->setLocalZOrder(i);
+            
+            auto animation = spineData.createAnimation(node);
+            animation->update(i * 0.1f);
+            animations.push_back(animation);
+        }
+    }
+    
+    double elapsedMs(std::chrono::steady_clock::time_point& start)
+    {
+        auto now = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - start).count();
+        start = now;
+        return ms;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 300;
+    if (frames <= 0) frames = 300;
+    
+    hostScene = new host::Scene();
+    NodeProxy* root = hostScene->getRoot();
+    
+    std::vector<NodeProxy*> groups;
+    for (int p = 0; p < Panel_Count; p++)
+    {
+        // Six columns of panels, the last row is below the screen and culled.
+        NodeProxy* panel = hostScene->createNode(root);
+        hostScene->setPosition(panel, 80.0f + p % 6 * 160, 80.0f + p / 6 * 200);
+        if (p % 2)
+        {
+            hostScene->addMask(panel, 150, 190);
+        }
+        
+        for (int g = 0; g < Group_Count; g++)
+        {
+            NodeProxy* group = hostScene->createNode(panel);
+            hostScene->setPosition(group, -60.0f + g % 4 * 40, -60.0f + g / 4 * 120);
+            groups.push_back(group);
+            
+            for (int s = 0; s < Sprite_Count; s++)
+            {
+                NodeProxy* sprite = hostScene->createNode(group);
+                hostScene->setPosition(sprite, s % 3 * 10.0f, s / 3 * 10.0f);
+                hostScene->addSprite(sprite, 8, 8);
+            }
+        }
+    }
+    
+    host::SpineData spineData(hostScene);
+    std::vector<spine::SkeletonAnimation*> skeletons;
+    if (spineData.getSkeletonData())
+    {
+        createSkeletons(spineData, hostScene->createNode(root), skeletons);
+    }
+    
+    RenderFlow* flow = hostScene->getFlow();
+    DeviceGraphics* device = hostScene->getDevice();
+    renderer::ModelBatcher* batcher = flow->getModelBatcher();
+    auto middlewareManager = middleware::MiddlewareManager::getInstance();
+    
+    // The stages of RenderFlow::render, run one by one, the transform passes serially.
+    double totals[STAGE_COUNT] = {};
+    const float deltaTime = 1.0f / 60;
+    const int warmUpFrames = std::min(frames / 10, 30);
+    uint64_t drawCalls = 0, stateChanges = 0, uniformUpdates = 0, bytesUploaded = 0;
+    for (int frame = 0; frame < warmUpFrames + frames; frame++)
+    {
+        // A quarter of the groups spin every frame.
+        for (std::size_t i = frame % 4; i < groups.size(); i += 4)
+        {
+            hostScene->setRotation(groups[i], (float)(frame % 360));
+        }
+        
+        nullgl::resetStats();
+        double times[STAGE_COUNT];
+        auto start = std::chrono::steady_clock::now();
+        
+        device->getTextureUploader()->process();
+        times[TEXTURE_UPLOAD] = elapsedMs(start);
+        middlewareManager->update(deltaTime);
+        times[MIDDLEWARE_UPDATE] = elapsedMs(start);
+        flow->calculateLocalMatrix();
+        times[LOCAL_MATRIX] = elapsedMs(start);
+        flow->calculateWorldMatrix();
+        times[WORLD_MATRIX] = elapsedMs(start);
+        flow->calculateVisibility();
+        times[VISIBILITY] = elapsedMs(start);
+        batcher->startBatch();
+        middlewareManager->render(deltaTime);
+        times[MIDDLEWARE_RENDER] = elapsedMs(start);
+        root->render(batcher, flow->getRenderScene());
+        batcher->terminateBatch();
+        times[BATCH] = elapsedMs(start);
+        flow->getDynamicAtlas()->update();
+        times[ATLAS] = elapsedMs(start);
+        flow->getForward()->render(flow->getRenderScene());
+        times[FORWARD] = elapsedMs(start);
+        
+        cocos2d::PoolManager::getInstance()->getCurrentPool()->clear();
+        if (frame < warmUpFrames) continue;
+        
+        for (int i = 0; i < STAGE_COUNT; i++)
+        {
+            totals[i] += times[i];
+        }
+        const nullgl::Stats& stats = nullgl::getStats();
+        drawCalls += stats.drawCalls;
+        stateChanges += stats.stateChanges;
+        uniformUpdates += stats.uniformUpdates;
+        bytesUploaded += stats.bytesUploaded;
+    }
+    
+    printf("%d frames, %u nodes submitted, %u culled\n", frames, flow->getSubmittedNodeCount(), flow->getCulledNodeCount());
+    double total = 0;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        printf("%-18s %8.3f ms\n", Stage_Names[i], totals[i] / frames);
+        total += totals[i];
+    }
+    printf("%-18s %8.3f ms\n", "frame", total / frames);
+    printf("per frame: %llu draw calls, %llu state changes, %llu uniform updates, %llu bytes uploaded\n",
+           (unsigned long long)(drawCalls / frames), (unsigned long long)(stateChanges / frames),
+           (unsigned long long)(uniformUpdates / frames), (unsigned long long)(bytesUploaded / frames));
+    
+    for (auto skeleton : skeletons)
+    {
+        skeleton->release();
+    }
+    delete hostScene;
+    
+    // Nothing was submitted if the scene failed to draw.
+    return drawCalls > 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Sprites drawn in palette batches keep their vertices in local space, transformed by the matrix of
+// their node slot they must land where their mesh path vertices do. Moving a node only changes its
+// matrix. The path is off by default, it splits batches every MatrixPalette::PALETTE_SIZE nodes.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+
+#include "renderer/gfx/CommandBuffer.h"
+#include "renderer/gfx/Program.h"
+#include "renderer/renderer/ProgramLib.h"
+#include "renderer/scene/MatrixPalette.hpp"
+#include "renderer/scene/ModelBatcher.hpp"
+
+#include <string.h>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+
+namespace
+{
+    const int Sprite_Count = 40;
+    
+    const char* PaletteVert = R"(
+uniform mat4 cc_matViewProj;
+uniform vec4 cc_nodePalette[64];
+attribute vec2 a_position;
+attribute vec2 a_uv0;
+attribute vec4 a_color;
+attribute float a_node;
+varying vec2 v_uv0;
+varying vec4 v_color;
+void main () {
+    int slot = int(a_node + 0.5) * 2;
+    vec3 local = vec3(a_position, 1);
+    vec2 pos = vec2(dot(cc_nodePalette[slot].xyz, local), dot(cc_nodePalette[slot + 1].xyz, local));
+    gl_Position = cc_matViewProj * vec4(pos, 0, 1);
+    v_uv0 = a_uv0;
+    v_color = a_color;
+}
+)";
+    
+    struct Frame
+    {
+        uint64_t drawCalls;
+        uint64_t bytesUploaded;
+    };
+    
+    Frame render(host::Scene& scene)
+    {
+        nullgl::resetStats();
+        scene.render();
+        const nullgl::Stats& stats = nullgl::getStats();
+        return { stats.drawCalls, stats.bytesUploaded };
+    }
+    
+    // A recorded draw of a palette batch with the matrices it was drawn with.
+    struct PaletteDraw
+    {
+        uint32_t base;
+        uint32_t count;
+        std::vector<float> palette;
+    };
+    
+    // Uniform values are only recorded when they change, the palette of a draw is the last one recorded.
+    std::vector<PaletteDraw> getPaletteDraws(const CommandBuffer* commands)
+    {
+        std::vector<PaletteDraw> draws;
+        std::vector<float> palette;
+        for (const auto& command : commands->getCommands())
+        {
+            if (command.type != CommandBuffer::CommandType::DRAW) continue;
+            
+            const Program* program = commands->getState(command.draw.state)->getProgram();
+            bool paletteProgram = false;
+            for (const auto& uniform : program->getUniforms())
+            {
+                paletteProgram |= uniform.name.compare(0, strlen("cc_nodePalette"), "cc_nodePalette") == 0;
+            }
+            if (!paletteProgram) continue;
+            
+            for (uint32_t i = command.draw.uniformStart; i < command.draw.uniformStart + command.draw.uniformCount; i++)
+            {
+                const CommandBuffer::UniformValue& value = commands->getUniform(i);
+                if (program->getUniforms()[value.index].name.compare(0, strlen("cc_nodePalette"), "cc_nodePalette") != 0) continue;
+                const float* data = (const float*)commands->getUniformData(value);
+                palette.assign(data, data + value.bytes / sizeof(float));
+            }
+            draws.push_back({ command.draw.base, (uint32_t)command.draw.count, palette });
+        }
+        return draws;
+    }
+    
+    bool near(float a, float b)
+    {
+        return fabsf(a - b) < 0.01f;
+    }
+    
+    // Transforms the local vertices by the matrix of their slot in the draw covering them.
+    bool transform(const std::vector<PaletteDraw>& draws, uint32_t firstIndex, const host::Scene::PaletteVertex local[4], host::Scene::Vertex out[4])
+    {
+        for (const auto& draw : draws)
+        {
+            if (firstIndex < draw.base || firstIndex >= draw.base + draw.count) continue;
+            
+            uint32_t slot = (uint32_t)local[0].slot;
+            if (slot >= MatrixPalette::PALETTE_SIZE || (slot + 1) * MatrixPalette::FLOATS_PER_MATRIX > draw.palette.size()) return false;
+            const float* m = draw.palette.data() + slot * MatrixPalette::FLOATS_PER_MATRIX;
+            for (int i = 0; i < 4; i++)
+            {
+                if (local[i].slot != local[0].slot) return false;
+                out[i] = local[i].vertex;
+                out[i].x = m[0] * local[i].vertex.x + m[1] * local[i].vertex.y + m[2];
+                out[i].y = m[4] * local[i].vertex.x + m[5] * local[i].vertex.y + m[6];
+            }
+            return true;
+        }
+        return false;
+    }
+    
+    bool matches(const host::Scene::Vertex a[4], const host::Scene::Vertex b[4])
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (!near(a[i].x, b[i].x) || !near(a[i].y, b[i].y) ||
+                !near(a[i].u, b[i].u) || !near(a[i].v, b[i].v) || a[i].color != b[i].color)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    host::Scene scene;
+    renderer::ModelBatcher* batcher = scene.getFlow()->getModelBatcher();
+    HOST_CHECK(!batcher->isPaletteEnabled());
+    
+    std::vector<NodeProxy*> nodes;
+    std::vector<SimpleSprite2D*> sprites;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        NodeProxy* node = scene.createNode(scene.getRoot());
+        scene.setPosition(node, 40.0f + i % 10 * 90, 80.0f + i / 10 * 140);
+        scene.setRotation(node, i * 9.0f);
+        scene.setOpacity(node, (uint8_t)(255 - i * 4));
+        nodes.push_back(node);
+        sprites.push_back(scene.addSprite(node, 20.0f + i, 30.0f));
+    }
+    
+    // The program of the scene gets a palette variant, but the path stays off until enabled.
+    ProgramLib* programLib = scene.getForward()->getProgramLib();
+    ValueVector defines;
+    programLib->define("sprite-palette", PaletteVert, host::Scene::getSpriteFrag(), defines);
+    programLib->setPaletteVariant("sprite", "sprite-palette");
+    
+    Frame mesh = render(scene);
+    std::vector<host::Scene::Vertex> vertices(Sprite_Count * 4);
+    host::Scene::PaletteVertex local[4];
+    uint32_t firstIndex = 0;
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        HOST_CHECK(scene.getFilledVertices(sprites[i], &vertices[i * 4]));
+        HOST_CHECK(!scene.getFilledPalette(sprites[i], local, firstIndex));
+    }
+    HOST_CHECK(mesh.drawCalls == 1);
+    
+    batcher->setPaletteEnabled(true);
+    scene.getFlow()->setCommandRecording(true);
+    Frame palette = render(scene);
+    std::vector<PaletteDraw> draws = getPaletteDraws(scene.getFlow()->getCommandBuffer());
+    const uint64_t batches = (Sprite_Count + MatrixPalette::PALETTE_SIZE - 1) / MatrixPalette::PALETTE_SIZE;
+    HOST_CHECK(palette.drawCalls == batches);
+    HOST_CHECK(draws.size() == batches);
+    printf("%d sprites of one texture: %llu draws on the mesh path, %llu draws on the palette path\n", Sprite_Count,
+           (unsigned long long)mesh.drawCalls, (unsigned long long)palette.drawCalls);
+    
+    std::vector<host::Scene::PaletteVertex> locals(Sprite_Count * 4);
+    for (int i = 0; i < Sprite_Count; i++)
+    {
+        host::Scene::Vertex filled[4];
+        HOST_CHECK(!scene.getFilledVertices(sprites[i], filled));
+        if (!HOST_CHECK(scene.getFilledPalette(sprites[i], &locals[i * 4], firstIndex))) continue;
+        HOST_CHECK(locals[i * 4].slot == (float)(i % MatrixPalette::PALETTE_SIZE));
+        host::Scene::Vertex world[4];
+        if (HOST_CHECK(transform(draws, firstIndex, &locals[i * 4], world)))
+        {
+            HOST_CHECK(matches(world, &vertices[i * 4]));
+        }
+    }
+    
+    // A moved node keeps its local vertices and upload size, only its matrix follows it.
+    scene.setPosition(nodes[0], 500, 500);
+    scene.setRotation(nodes[0], 0);
+    Frame moved = render(scene);
+    draws = getPaletteDraws(scene.getFlow()->getCommandBuffer());
+    HOST_CHECK(moved.drawCalls == batches);
+    HOST_CHECK(moved.bytesUploaded == palette.bytesUploaded);
+    if (HOST_CHECK(scene.getFilledPalette(sprites[0], local, firstIndex)))
+    {
+        HOST_CHECK(memcmp(local, &locals[0], sizeof(local)) == 0);
+        host::Scene::Vertex world[4];
+        if (HOST_CHECK(transform(draws, firstIndex, local, world)))
+        {
+            HOST_CHECK(near(world[0].x, 500 - 10) && near(world[0].y, 500 - 15));
+            HOST_CHECK(near(world[3].x, 500 + 10) && near(world[3].y, 500 + 15));
+        }
+    }
+    
+    batcher->setPaletteEnabled(false);
+    Frame disabled = render(scene);
+    HOST_CHECK(disabled.drawCalls == 1);
+    host::Scene::Vertex filled[4];
+    if (HOST_CHECK(scene.getFilledVertices(sprites[0], filled)))
+    {
+        HOST_CHECK(near(filled[0].x, 500 - 10) && near(filled[0].y, 500 - 15));
+    }
+    HOST_CHECK(!scene.getFilledPalette(sprites[0], local, firstIndex));
+    
+    return host::failedChecks();
+}
@@ -0,0 +1,405 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// SpineAllocator hands out 16 byte aligned blocks, accounts them per tag and in total, and frees
+// the regions of an arena with its last block, from whatever thread frees it.
+
+#include "HostCheck.h"
+#include "HostScene.h"
+#include "HostSpine.h"
+
+#include "spine-creator-support/SpineAllocator.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace cocos2d;
+using namespace cocos2d::renderer;
+using spine::SpineAllocator;
+
+namespace
+{
+    struct Block
+    {
+        uint8_t* ptr;
+        size_t size;
+        uint8_t pattern;
+    };
+    
+    Block allocBlock(size_t size, uint8_t pattern)
+    {
+        Block block = { (uint8_t*)SpineAllocator::alloc(size), size, pattern };
+        if (block.ptr) memset(block.ptr, pattern, size);
+        return block;
+    }
+    
+    bool isAligned(const void* ptr)
+    {
+        return ((uintptr_t)ptr & 15) == 0;
+    }
+    
+    // A block overlapping another one has its pattern overwritten.
+    bool isIntact(const Block& block)
+    {
+        for (size_t i = 0; i < block.size; i++)
+        {
+            if (block.ptr[i] != block.pattern) return false;
+        }
+        return true;
+    }
+    
+    // Pooled classes, the class boundaries and large blocks.
+    const size_t Sizes[] = { 1, 8, 15, 16, 17, 31, 32, 33, 100, 255, 256, 257, 511, 512, 513, 1000, 4096, 70000 };
+    const size_t Size_Count = sizeof(Sizes) / sizeof(Sizes[0]);
+    
+    void checkBlocks(SpineAllocator::Arena* arena)
+    {
+        int64_t baseline = SpineAllocator::getTotalLiveBytes();
+        SpineAllocator::Scope scope(arena);
+        
+        std::vector<Block> blocks;
+        int64_t expected = 0;
+        for (int round = 0; round < 4; round++)
+        {
+            for (size_t i = 0; i < Size_Count; i++)
+            {
+                blocks.push_back(allocBlock(Sizes[i], (uint8_t)(blocks.size() + 1)));
+                HOST_CHECK(blocks.back().ptr != nullptr);
+                HOST_CHECK(isAligned(blocks.back().ptr));
+                expected += Sizes[i];
+            }
+        }
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == expected);
+        
+        bool intact = true;
+        for (auto& block : blocks)
+        {
+            intact = intact && isIntact(block);
+        }
+        HOST_CHECK(intact);
+        
+        // Every other block is freed and allocated again from the free lists.
+        for (size_t i = 0; i < blocks.size(); i += 2)
+        {
+            SpineAllocator::free(blocks[i].ptr);
+            expected -= blocks[i].size;
+        }
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == expected);
+        for (size_t i = 0; i < blocks.size(); i += 2)
+        {
+            blocks[i] = allocBlock(blocks[i].size, (uint8_t)(0x80 | i));
+            HOST_CHECK(isAligned(blocks[i].ptr));
+            expected += blocks[i].size;
+        }
+        intact = true;
+        for (auto& block : blocks)
+        {
+            intact = intact && isIntact(block);
+        }
+        HOST_CHECK(intact);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == expected);
+        
+        for (auto& block : blocks)
+        {
+            SpineAllocator::free(block.ptr);
+        }
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+    }
+    
+    void checkRealloc()
+    {
+        int64_t baseline = SpineAllocator::getTotalLiveBytes();
+        
+        HOST_CHECK(SpineAllocator::alloc(0) == nullptr);
+        
+        // Within the 32 byte class the block grows and shrinks in place.
+        Block block = allocBlock(20, 0x5a);
+        uint8_t* grown = (uint8_t*)SpineAllocator::realloc(block.ptr, 30);
+        HOST_CHECK(grown == block.ptr);
+        HOST_CHECK(isIntact(block));
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 30);
+        uint8_t* shrunk = (uint8_t*)SpineAllocator::realloc(grown, 10);
+        HOST_CHECK(shrunk == block.ptr);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 10);
+        
+        // Past the class the content moves, up to a large block and back down to a pooled one.
+        block.size = 10;
+        uint8_t* moved = (uint8_t*)SpineAllocator::realloc(shrunk, 100);
+        block.ptr = moved;
+        HOST_CHECK(isAligned(moved));
+        HOST_CHECK(isIntact(block));
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 100);
+        memset(moved, 0x3c, 100);
+        
+        block = { (uint8_t*)SpineAllocator::realloc(moved, 5000), 100, 0x3c };
+        HOST_CHECK(isAligned(block.ptr));
+        HOST_CHECK(isIntact(block));
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 5000);
+        
+        block = { (uint8_t*)SpineAllocator::realloc(block.ptr, 64), 64, 0x3c };
+        HOST_CHECK(isIntact(block));
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 64);
+        
+        HOST_CHECK(SpineAllocator::realloc(block.ptr, 0) == nullptr);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+        
+        void* fresh = SpineAllocator::realloc(nullptr, 40);
+        HOST_CHECK(fresh != nullptr && isAligned(fresh));
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == 40);
+        SpineAllocator::free(fresh);
+        SpineAllocator::free(nullptr);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+    }
+    
+    void checkArenas()
+    {
+        SpineAllocator::Arena* outer = SpineAllocator::createArena("outer");
+        SpineAllocator::Arena* inner = SpineAllocator::createArena("inner");
+        
+        void* outside = SpineAllocator::alloc(48);
+        void* outerBlock = nullptr;
+        void* innerBlock = nullptr;
+        void* unscoped = nullptr;
+        void* afterInner = nullptr;
+        {
+            SpineAllocator::Scope outerScope(outer);
+            outerBlock = SpineAllocator::alloc(64);
+            {
+                SpineAllocator::Scope innerScope(inner);
+                innerBlock = SpineAllocator::alloc(600);
+                {
+                    SpineAllocator::Scope noScope(nullptr);
+                    unscoped = SpineAllocator::alloc(24);
+                }
+            }
+            afterInner = SpineAllocator::alloc(8);
+        }
+        HOST_CHECK(SpineAllocator::getLiveBytes("outer") == 72);
+        HOST_CHECK(SpineAllocator::getLiveBytes("inner") == 600);
+        HOST_CHECK(SpineAllocator::getLiveBytes("missing") == 0);
+        
+        // A second arena of a tag adds to it.
+        SpineAllocator::Arena* sibling = SpineAllocator::createArena("outer");
+        void* siblingBlock = nullptr;
+        {
+            SpineAllocator::Scope scope(sibling);
+            siblingBlock = SpineAllocator::realloc(nullptr, 100);
+        }
+        HOST_CHECK(SpineAllocator::getLiveBytes("outer") == 172);
+        
+        // Blocks outlive the close of their arena, its regions go with the last one.
+        SpineAllocator::closeArena(outer);
+        SpineAllocator::closeArena(sibling);
+        HOST_CHECK(*(uint64_t*)memset(outerBlock, 0x11, 64) == 0x1111111111111111ull);
+        SpineAllocator::free(outerBlock);
+        HOST_CHECK(SpineAllocator::getLiveBytes("outer") == 108);
+        SpineAllocator::free(siblingBlock);
+        SpineAllocator::free(afterInner);
+        HOST_CHECK(SpineAllocator::getLiveBytes("outer") == 0);
+        
+        SpineAllocator::free(innerBlock);
+        SpineAllocator::closeArena(inner);
+        HOST_CHECK(SpineAllocator::getLiveBytes("inner") == 0);
+        
+        SpineAllocator::free(unscoped);
+        SpineAllocator::free(outside);
+        SpineAllocator::closeArena(nullptr);
+    }
+    
+    void checkUnpackedArena()
+    {
+        SpineAllocator::Arena* arena = SpineAllocator::createArena("unpacked", false);
+        checkBlocks(arena);
+        HOST_CHECK(SpineAllocator::getLiveBytes("unpacked") == 0);
+        
+        void* block = nullptr;
+        {
+            SpineAllocator::Scope scope(arena);
+            block = SpineAllocator::alloc(200);
+        }
+        HOST_CHECK(SpineAllocator::getLiveBytes("unpacked") == 200);
+        SpineAllocator::closeArena(arena);
+        SpineAllocator::free(block);
+        HOST_CHECK(SpineAllocator::getLiveBytes("unpacked") == 0);
+    }
+    
+    // Blocks of one arena allocated on a thread and freed on another, then threads sharing arenas.
+    void checkThreads()
+    {
+        int64_t baseline = SpineAllocator::getTotalLiveBytes();
+        
+        SpineAllocator::Arena* arena = SpineAllocator::createArena("threads");
+        std::vector<Block> blocks;
+        std::thread producer([&]() {
+            SpineAllocator::Scope scope(arena);
+            for (int i = 0; i < 256; i++)
+            {
+                blocks.push_back(allocBlock(Sizes[i % Size_Count], (uint8_t)i));
+            }
+        });
+        producer.join();
+        SpineAllocator::closeArena(arena);
+        bool intact = true;
+        for (auto& block : blocks)
+        {
+            intact = intact && isIntact(block);
+            SpineAllocator::free(block.ptr);
+        }
+        HOST_CHECK(intact);
+        HOST_CHECK(SpineAllocator::getLiveBytes("threads") == 0);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+        
+        const int Thread_Count = 4;
+        SpineAllocator::Arena* shared[2] = {
+            SpineAllocator::createArena("shared"),
+            SpineAllocator::createArena("shared"),
+        };
+        std::atomic<int> corrupted(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < Thread_Count; t++)
+        {
+            threads.emplace_back([&, t]() {
+                std::mt19937 random(t);
+                std::vector<Block> live;
+                for (int i = 0; i < 20000; i++)
+                {
+                    SpineAllocator::Scope scope(i % 3 == 2 ? nullptr : shared[(i + t) % 2]);
+                    uint32_t action = random() % 4;
+                    if (live.empty() || action < 2)
+                    {
+                        size_t size = 1 + random() % 700;
+                        live.push_back(allocBlock(size, (uint8_t)random()));
+                    }
+                    else
+                    {
+                        size_t index = random() % live.size();
+                        Block& block = live[index];
+                        if (!isIntact(block)) corrupted++;
+                        if (action == 2)
+                        {
+                            size_t size = 1 + random() % 700;
+                            block.ptr = (uint8_t*)SpineAllocator::realloc(block.ptr, size);
+                            block.size = std::min(block.size, size);
+                            if (!isIntact(block)) corrupted++;
+                            block.size = size;
+                            memset(block.ptr, block.pattern, size);
+                        }
+                        else
+                        {
+                            SpineAllocator::free(block.ptr);
+                            live[index] = live.back();
+                            live.pop_back();
+                        }
+                    }
+                }
+                for (auto& block : live)
+                {
+                    if (!isIntact(block)) corrupted++;
+                    SpineAllocator::free(block.ptr);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        HOST_CHECK(corrupted == 0);
+        HOST_CHECK(SpineAllocator::getLiveBytes("shared") == 0);
+        HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+        SpineAllocator::closeArena(shared[0]);
+        SpineAllocator::closeArena(shared[1]);
+    }
+    
+    // Every block a skeleton allocates goes back once it is destroyed.
+    void checkSkeletons()
+    {
+        host::Scene scene;
+        host::SpineData spineData(&scene);
+        if (!HOST_CHECK(spineData.getSkeletonData() != nullptr)) return;
+        
+        auto createSkeletons = [&](int count, std::vector<spine::SkeletonAnimation*>& animations, std::vector<NodeProxy*>& nodes) {
+            for (int i = 0; i < count; i++)
+            {
+                NodeProxy* node = scene.createNode(scene.getRoot());
+                scene.setPosition(node, 100.0f + i * 40, 200.0f);
+                animations.push_back(spineData.createAnimation(node));
+                nodes.push_back(node);
+            }
+        };
+        auto destroySkeletons = [&](std::vector<spine::SkeletonAnimation*>& animations, std::vector<NodeProxy*>& nodes) {
+            for (size_t i = 0; i < animations.size(); i++)
+            {
+                animations[i]->release();
+                scene.destroyNode(nodes[i]);
+            }
+            animations.clear();
+            nodes.clear();
+        };
+        
+        // The first skeleton lazily allocates the statics of the runtime.
+        std::vector<spine::SkeletonAnimation*> animations;
+        std::vector<NodeProxy*> nodes;
+        createSkeletons(1, animations, nodes);
+        scene.render();
+        destroySkeletons(animations, nodes);
+        scene.render();
+        
+        int64_t baseline = SpineAllocator::getTotalLiveBytes();
+        for (int round = 0; round < 5; round++)
+        {
+            createSkeletons(8, animations, nodes);
+            for (int frame = 0; frame < 10; frame++)
+            {
+                scene.render();
+            }
+            // Everything the skeletons hold lives in their arenas, tagged with the empty uuid of skeletons created from data.
+            HOST_CHECK(SpineAllocator::getLiveBytes("") > 0);
+            HOST_CHECK(SpineAllocator::getTotalLiveBytes() - baseline == SpineAllocator::getLiveBytes(""));
+            destroySkeletons(animations, nodes);
+            scene.render();
+            HOST_CHECK(SpineAllocator::getTotalLiveBytes() == baseline);
+            HOST_CHECK(SpineAllocator::getLiveBytes("") == 0);
+        }
+    }
+}
+
+int main()
+{
+    checkBlocks(nullptr);
+    SpineAllocator::Arena* arena = SpineAllocator::createArena("blocks");
+    checkBlocks(arena);
+    SpineAllocator::closeArena(arena);
+    HOST_CHECK(SpineAllocator::getLiveBytes("blocks") == 0);
+    
+    checkRealloc();
+    checkArenas();
+    checkUnpackedArena();
+    checkThreads();
+    checkSkeletons();
+    
+    return host::failedChecks();
+}